@@ -0,0 +1,179 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api/http_server.h"
+#include "blockchain/blockchain_client.h"
+#include "security/signature_verifier.h"
+#include "services/ingest_service.h"
+#include "storage/in_memory_telemetry_repository.h"
+
+namespace {
+
+struct RunResult {
+    double throughput{0.0};
+    double p50Micros{0.0};
+    double p99Micros{0.0};
+    std::size_t failures{0};
+};
+
+std::uint16_t PickFreePort() {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    close(fd);
+    return ntohs(address.sin_port);
+}
+
+int Connect(std::uint16_t port) {
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            return fd;
+        }
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+bool ReadResponse(int fd, std::string* pending) {
+    while (true) {
+        const std::size_t headerEnd = pending->find("\r\n\r\n");
+        if (headerEnd != std::string::npos) {
+            const std::size_t lengthAt = pending->find("Content-Length: ");
+            const std::size_t bodyBytes =
+                (lengthAt < headerEnd) ? std::strtoull(pending->c_str() + lengthAt + 16, nullptr, 10) : 0;
+            if (pending->size() >= headerEnd + 4 + bodyBytes) {
+                pending->erase(0, headerEnd + 4 + bodyBytes);
+                return true;
+            }
+        }
+        char buffer[4096];
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        pending->append(buffer, static_cast<std::size_t>(received));
+    }
+}
+
+std::string BuildRequest(std::size_t index) {
+    const std::string body = "{\"deviceId\":\"stm32-bench-" + std::to_string(index % 64) +
+                             "\",\"timestamp\":" + std::to_string(1700001000 + index) +
+                             ",\"telemetry\":{\"temperature\":24.5,\"humidity\":62.3,\"soilMoisture\":41.0},"
+                             "\"hash\":\"" + std::string(64, 'a') + "\",\"signature\":\"00\","
+                             "\"pubKeyId\":\"pubkey-1\",\"transport\":\"lora\",\"batchCode\":\"BATCH-BENCH-0001\"}";
+    return "POST /api/v1/ingest HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: " +
+           std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+RunResult RunBackend(agri::HttpIoBackend backend, std::size_t requests, std::size_t connections) {
+    agri::InMemoryTelemetryRepository repository;
+    agri::BasicSignatureVerifier verifier{agri::PublicKeyMap{}};
+    agri::MockBlockchainClient blockchain;
+    agri::IngestService ingestService(repository, verifier, blockchain);
+
+    agri::HttpServerConfig config;
+    config.ioBackend = backend;
+    config.maxRequestsPerConnection = requests;
+    const std::uint16_t port = PickFreePort();
+    agri::HttpServer server(port, ingestService, repository, config);
+    std::thread serverThread([&server] { server.Start(); });
+
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<std::size_t> failures(connections, 0);
+    const std::size_t perConnection = std::max<std::size_t>(1, requests / connections);
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (std::size_t c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c] {
+            const int fd = Connect(port);
+            if (fd < 0) {
+                failures[c] = perConnection;
+                return;
+            }
+            std::string pending;
+            latencies[c].reserve(perConnection);
+            for (std::size_t i = 0; i < perConnection; ++i) {
+                const std::string request = BuildRequest(c * perConnection + i);
+                const auto sentAt = std::chrono::steady_clock::now();
+                if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size()) ||
+                    !ReadResponse(fd, &pending)) {
+                    failures[c] += perConnection - i;
+                    break;
+                }
+                latencies[c].push_back(
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sentAt).count());
+            }
+            close(fd);
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    server.Stop();
+    serverThread.join();
+
+    std::vector<double> all;
+    RunResult result;
+    for (std::size_t c = 0; c < connections; ++c) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        result.failures += failures[c];
+    }
+    std::sort(all.begin(), all.end());
+    if (!all.empty()) {
+        result.throughput = static_cast<double>(all.size()) / seconds;
+        result.p50Micros = all[all.size() / 2];
+        result.p99Micros = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+    }
+    return result;
+}
+
+void Print(const char* name, const RunResult& result) {
+    std::cout << "backend=" << name << " throughput=" << static_cast<std::uint64_t>(result.throughput) << "/s"
+              << " p50=" << result.p50Micros << "us p99=" << result.p99Micros << "us"
+              << " failures=" << result.failures << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    const std::size_t requests = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    const std::size_t connections = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 16;
+
+    const RunResult epoll = RunBackend(agri::HttpIoBackend::kEpoll, requests, connections);
+    Print("epoll", epoll);
+    if (!agri::HttpServer::IoUringAvailable()) {
+        std::cout << "backend=io_uring unavailable (build with -DAGRI_ENABLE_IO_URING=ON on Linux 6.0+)" << std::endl;
+        return 0;
+    }
+    const RunResult uring = RunBackend(agri::HttpIoBackend::kIoUring, requests, connections);
+    Print("io_uring", uring);
+    std::cout << "io_uring/epoll=" << (uring.throughput / epoll.throughput) << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "api/http_request_parser.h"
+
+namespace {
+
+struct LegacyRequest {
+    std::string method;
+    std::string path;
+    std::string headers;
+    std::string body;
+};
+
+std::string LegacyToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return text;
+}
+
+std::string LegacyTrim(std::string_view text) {
+    std::size_t begin = 0;
+    while (begin < text.size() && std::isspace(static_cast<unsigned char>(text[begin])) != 0) {
+        ++begin;
+    }
+    std::size_t end = text.size();
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1])) != 0) {
+        --end;
+    }
+    return std::string(text.substr(begin, end - begin));
+}
+
+std::size_t LegacyParseContentLength(const std::string& headers) {
+    const std::regex pattern("Content-Length:\\s*([0-9]+)", std::regex_constants::icase);
+    std::smatch match;
+    if (!std::regex_search(headers, match, pattern)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(std::stoull(match[1].str()));
+}
+
+bool LegacyParse(const std::string& raw, LegacyRequest* request) {
+    const std::size_t headerEnd = raw.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) {
+        return false;
+    }
+    const std::size_t contentLength = LegacyParseContentLength(raw.substr(0, headerEnd));
+    if (raw.size() < headerEnd + 4 + contentLength) {
+        return false;
+    }
+
+    const std::string headers = raw.substr(0, headerEnd);
+    const std::size_t firstLineEnd = headers.find("\r\n");
+    std::istringstream lineStream(headers.substr(0, firstLineEnd));
+    std::string version;
+    if (!(lineStream >> request->method >> request->path >> version)) {
+        return false;
+    }
+    request->headers = headers.substr(firstLineEnd + 2);
+    request->body = raw.substr(headerEnd + 4);
+    return true;
+}
+
+std::string LegacyGetHeaderValue(const std::string& headers, const std::string& key) {
+    std::istringstream stream(headers);
+    std::string line;
+    const std::string target = LegacyToLower(key);
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        const std::size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        if (LegacyToLower(LegacyTrim(line.substr(0, colon))) == target) {
+            return LegacyTrim(line.substr(colon + 1));
+        }
+    }
+    return "";
+}
+
+std::string BuildIngestRequest() {
+    const std::string body =
+        "{\"deviceId\":\"stm32-node-1\",\"timestamp\":1700001000,"
+        "\"telemetry\":{\"temperature\":24.5,\"humidity\":62.3},"
+        "\"hash\":\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\","
+        "\"signature\":\"bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb\",\"pubKeyId\":\"pubkey-1\",\"transport\":\"lora\"}";
+    return "POST /api/v1/ingest HTTP/1.1\r\n"
+           "Host: 10.0.0.2:8080\r\n"
+           "User-Agent: lora-gateway/2.1\r\n"
+           "Accept: */*\r\n"
+           "Content-Type: application/json\r\n"
+           "X-Gateway-Id: lora-gw-7\r\n"
+           "Connection: keep-alive\r\n"
+           "Content-Length: " +
+           std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+template <typename Fn>
+double NanosPerIteration(std::size_t iterations, Fn&& fn) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const std::size_t iterations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const std::string raw = BuildIngestRequest();
+    std::size_t sink = 0;
+
+    const double legacyNs = NanosPerIteration(iterations, [&] {
+        LegacyRequest request;
+        if (LegacyParse(raw, &request)) {
+            sink += LegacyGetHeaderValue(request.headers, "Connection").size();
+            sink += LegacyGetHeaderValue(request.headers, "Content-Type").size();
+            sink += request.body.size();
+        }
+    });
+
+    agri::HttpRequestParser parser;
+    const double parserNs = NanosPerIteration(iterations, [&] {
+        parser.Reset();
+        if (parser.Parse(raw) == agri::HttpRequestParser::Status::kComplete) {
+            const agri::HttpRequest& request = parser.Request();
+            sink += request.headers.Get(agri::HttpHeaderId::kConnection).size();
+            sink += request.headers.Get(agri::HttpHeaderId::kContentType).size();
+            sink += request.body.size();
+        }
+    });
+
+    std::cout << "request_bytes=" << raw.size() << " iterations=" << iterations << std::endl;
+    std::cout << "legacy_regex_istringstream ns/request=" << legacyNs << std::endl;
+    std::cout << "incremental_parser ns/request=" << parserNs << std::endl;
+    std::cout << "speedup=" << (legacyNs / parserNs) << "x (checksum " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+#include "transport/json_parser.h"
+#include "transport/json_structural_index.h"
+
+namespace {
+
+std::optional<std::string> LegacyExtractString(std::string_view json, const std::string& key) {
+    const std::regex pattern("\"" + key + "\"\\s*:\\s*\"([^\"]*)\"");
+    std::match_results<std::string_view::const_iterator> match;
+    if (!std::regex_search(json.begin(), json.end(), match, pattern)) {
+        return std::nullopt;
+    }
+    return std::string(match[1].first, match[1].second);
+}
+
+std::optional<std::uint64_t> LegacyExtractUnsigned(std::string_view json, const std::string& key) {
+    const std::regex pattern("\"" + key + "\"\\s*:\\s*([0-9]+)");
+    std::match_results<std::string_view::const_iterator> match;
+    if (!std::regex_search(json.begin(), json.end(), match, pattern)) {
+        return std::nullopt;
+    }
+    return std::stoull(std::string(match[1].first, match[1].second));
+}
+
+std::optional<std::string> LegacyExtractObject(std::string_view json, const std::string& key) {
+    const std::size_t keyPos = json.find("\"" + key + "\"");
+    const std::size_t objectStart = (keyPos == std::string_view::npos) ? keyPos : json.find('{', keyPos);
+    if (objectStart == std::string_view::npos) {
+        return std::nullopt;
+    }
+    int depth = 0;
+    bool inString = false;
+    bool escape = false;
+    for (std::size_t i = objectStart; i < json.size(); ++i) {
+        const char c = json[i];
+        if (escape) {
+            escape = false;
+        } else if (c == '\\') {
+            escape = true;
+        } else if (c == '"') {
+            inString = !inString;
+        } else if (!inString && c == '{') {
+            ++depth;
+        } else if (!inString && c == '}' && --depth == 0) {
+            return std::string(json.substr(objectStart, i - objectStart + 1));
+        }
+    }
+    return std::nullopt;
+}
+
+bool LegacyParse(std::string_view payload, agri::TelemetryPacket* packet) {
+    const auto deviceId = LegacyExtractString(payload, "deviceId");
+    const auto timestamp = LegacyExtractUnsigned(payload, "timestamp");
+    const auto telemetry = LegacyExtractObject(payload, "telemetry");
+    const auto hash = LegacyExtractString(payload, "hash");
+    const auto signature = LegacyExtractString(payload, "signature");
+    if (!deviceId || !timestamp || !telemetry || !hash || !signature) {
+        return false;
+    }
+    packet->deviceId = *deviceId;
+    packet->timestamp = *timestamp;
+    packet->telemetryJson = *telemetry;
+    packet->hashHex = *hash;
+    packet->signature = *signature;
+    packet->pubKeyId = LegacyExtractString(payload, "pubKeyId").value_or("default-pubkey");
+    packet->transport = LegacyExtractString(payload, "transport").value_or("wifi");
+    packet->batchCode = LegacyExtractString(payload, "batchCode").value_or("");
+    return true;
+}
+
+const std::string kPacket =
+    "{\"deviceId\":\"stm32-node-1\",\"timestamp\":1700001000,"
+    "\"telemetry\":{\"temperature\":24.5,\"humidity\":62.3,\"soilMoisture\":41.2,\"battery\":3.71},"
+    "\"hash\":\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\","
+    "\"signature\":\"3045022100bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"
+    "02200ccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc\","
+    "\"pubKeyId\":\"pubkey-1\",\"transport\":\"lora\",\"batchCode\":\"BATCH-2026-0001\"}";
+
+std::string SpectralPacket() {
+    std::string bands;
+    for (int i = 0; i < 512; ++i) {
+        bands += (i == 0 ? "" : ",") + std::to_string(400 + i) + "." + std::to_string((i * 37) % 1000);
+    }
+    return "{\"deviceId\":\"spectral-node-1\",\"timestamp\":1700001000,"
+           "\"telemetry\":{\"sensor\":\"as7341\",\"unit\":\"uW/cm2\",\"bands\":[" +
+           bands +
+           "]},"
+           "\"hash\":\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\","
+           "\"signature\":\"bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb\",\"pubKeyId\":\"pubkey-1\"}";
+}
+
+template <typename Fn>
+double NanosPerIteration(std::size_t iterations, Fn&& fn) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const std::size_t iterations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    std::size_t sink = 0;
+
+    const double legacyNs = NanosPerIteration(iterations, [&] {
+        agri::TelemetryPacket packet;
+        if (LegacyParse(kPacket, &packet)) {
+            sink += packet.telemetryJson.size();
+        }
+    });
+
+    const double tokenizerNs = NanosPerIteration(iterations, [&] {
+        const agri::ParseTelemetryResult parsed = agri::ParseTelemetryPacketJson(kPacket);
+        if (parsed.ok) {
+            sink += parsed.packet.telemetryJson.size();
+        }
+    });
+
+    std::cout << "packet_bytes=" << kPacket.size() << " iterations=" << iterations << std::endl;
+    std::cout << "legacy_regex ns/packet=" << legacyNs << std::endl;
+    std::cout << "single_pass_tokenizer ns/packet=" << tokenizerNs << std::endl;
+    std::cout << "speedup=" << (legacyNs / tokenizerNs) << "x (checksum " << sink << ")" << std::endl;
+
+    const std::string spectral = SpectralPacket();
+    const std::string_view telemetry = std::string_view(spectral).substr(spectral.find("{\"sensor\""));
+    const std::size_t scanIterations = iterations * 10;
+    std::cout << "spectral_packet_bytes=" << spectral.size() << " iterations=" << scanIterations << std::endl;
+    for (const agri::JsonScanBackend backend :
+         {agri::JsonScanBackend::kScalar, agri::JsonScanBackend::kSse2, agri::JsonScanBackend::kAvx2,
+          agri::JsonScanBackend::kNeon}) {
+        if (!agri::JsonScanBackendSupported(backend)) {
+            continue;
+        }
+        const double scanNs = NanosPerIteration(scanIterations, [&] {
+            std::size_t length = 0;
+            if (agri::ScanJsonContainer(telemetry, backend, &length)) {
+                sink += length;
+            }
+        });
+        std::cout << "structural_scan backend=" << agri::JsonScanBackendName(backend) << " ns/telemetry=" << scanNs
+                  << " MB/s=" << (static_cast<double>(telemetry.size()) * 1000.0 / scanNs) << std::endl;
+    }
+    const double spectralNs = NanosPerIteration(scanIterations, [&] {
+        const agri::ParseTelemetryResult parsed = agri::ParseTelemetryPacketJson(spectral);
+        sink += parsed.packet.telemetryJson.size();
+    });
+    std::cout << "spectral_packet_parse backend=" << agri::JsonScanBackendName(agri::DefaultJsonScanBackend())
+              << " ns/packet=" << spectralNs << " (checksum " << sink << ")" << std::endl;
+    return 0;
+}
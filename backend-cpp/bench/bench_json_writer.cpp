@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "transport/json_parser.h"
+#include "transport/json_writer.h"
+
+namespace {
+
+std::string LegacyReceiptToJson(const std::optional<agri::BlockchainReceipt>& receipt) {
+    if (!receipt.has_value()) {
+        return "null";
+    }
+    std::ostringstream out;
+    out << "{"
+        << "\"txHash\":\"" << agri::JsonEscape(receipt->txHash) << "\","
+        << "\"blockHeight\":" << receipt->blockHeight << ","
+        << "\"submittedAt\":\"" << agri::JsonEscape(receipt->submittedAtIso8601) << "\""
+        << "}";
+    return out.str();
+}
+
+std::string LegacyRecordToJson(const agri::TelemetryRecord& record) {
+    std::ostringstream out;
+    out << "{"
+        << "\"recordId\":" << record.recordId << ","
+        << "\"deviceId\":\"" << agri::JsonEscape(record.packet.deviceId) << "\","
+        << "\"timestamp\":" << record.packet.timestamp << ","
+        << "\"telemetry\":" << record.packet.telemetryJson << ","
+        << "\"hash\":\"" << agri::JsonEscape(record.packet.hashHex) << "\","
+        << "\"signature\":\"" << agri::JsonEscape(record.packet.signature) << "\","
+        << "\"pubKeyId\":\"" << agri::JsonEscape(record.packet.pubKeyId) << "\","
+        << "\"transport\":\"" << agri::JsonEscape(record.packet.transport) << "\"";
+    if (!record.packet.batchCode.empty()) {
+        out << ",\"batchCode\":\"" << agri::JsonEscape(record.packet.batchCode) << "\"";
+    }
+    out << ",\"receipt\":" << LegacyReceiptToJson(record.receipt) << "}";
+    return out.str();
+}
+
+std::vector<agri::TelemetryRecord> TraceRecords(std::size_t count) {
+    std::vector<agri::TelemetryRecord> records(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        agri::TelemetryRecord& record = records[i];
+        record.recordId = 1000000 + i;
+        record.packet.deviceId = "greenhouse-3-node-" + std::to_string(i % 64);
+        record.packet.timestamp = 1700000000 + i;
+        record.packet.telemetryJson = "{\"temperature\":24.5,\"humidity\":61.2,\"soilMoisture\":33.8,\"lux\":18250}";
+        record.packet.hashHex = std::string(64, 'a');
+        record.packet.signature = std::string(142, 'b');
+        record.packet.pubKeyId = "stm32-key-" + std::to_string(i % 64);
+        record.packet.transport = (i % 2 == 0) ? "lora" : "wifi";
+        record.packet.batchCode = "lot-2024-07";
+        record.receipt = agri::BlockchainReceipt{"0x" + std::string(64, 'c'), 18000000 + i, "2024-07-01T12:00:00Z"};
+    }
+    return records;
+}
+
+template <typename Fn>
+double MillisPerIteration(std::size_t iterations, Fn&& fn) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / static_cast<double>(iterations);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const std::size_t records = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    const std::size_t iterations = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 20;
+    const std::vector<agri::TelemetryRecord> trace = TraceRecords(records);
+    std::size_t sink = 0;
+
+    const double legacyMs = MillisPerIteration(iterations, [&] {
+        std::string body = "{\"batchCode\":\"" + agri::JsonEscape(trace.front().packet.batchCode) + "\",\"records\":[";
+        for (std::size_t i = 0; i < trace.size(); ++i) {
+            if (i != 0) {
+                body.push_back(',');
+            }
+            body.append(LegacyRecordToJson(trace[i]));
+        }
+        body.append("],\"count\":").append(std::to_string(trace.size())).append("}");
+        sink += body.size();
+    });
+
+    std::string body;
+    const double writerMs = MillisPerIteration(iterations, [&] {
+        body.clear();
+        agri::JsonWriter writer(&body);
+        writer.BeginObject().Key("batchCode").String(trace.front().packet.batchCode).Key("records").BeginArray();
+        for (const agri::TelemetryRecord& record : trace) {
+            agri::WriteTelemetryRecordJson(record, &writer);
+        }
+        writer.EndArray().Key("count").Uint(trace.size()).EndObject();
+        sink += body.size();
+    });
+
+    std::cout << "trace_records=" << records << " bytes=" << body.size() << " iterations=" << iterations << std::endl;
+    std::cout << "legacy_ostringstream ms/trace=" << legacyMs << std::endl;
+    std::cout << "json_writer ms/trace=" << writerMs << std::endl;
+    std::cout << "speedup=" << (legacyMs / writerMs) << "x (checksum " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/hash_utils.h"
+
+namespace {
+
+constexpr std::size_t kGroup = 64;
+
+template <typename Fn>
+double SecondsFor(std::size_t rounds, Fn&& fn) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void Report(std::string_view name, std::size_t messages, std::size_t bytes, double seconds) {
+    std::cout << name << " messages/s=" << static_cast<std::uint64_t>(static_cast<double>(messages) / seconds)
+              << " MB/s=" << (static_cast<double>(bytes) / seconds / 1e6) << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    const std::size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 4096;
+    const std::size_t rounds = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 50;
+
+    std::vector<std::string> devices(count);
+    std::vector<std::string> timestamps(count);
+    std::vector<std::string> telemetry(count);
+    std::vector<std::array<std::string_view, 5>> pieces(count);
+    std::vector<agri::Sha256Pieces> messages(count);
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        devices[i] = "greenhouse-3-node-" + std::to_string(i % 64);
+        timestamps[i] = std::to_string(1700000000 + i);
+        telemetry[i] = "{\"temperature\":" + std::to_string(18 + i % 10) + ".5,\"humidity\":61.2,\"soilMoisture\":" +
+                       std::to_string(20 + i % 30) + ".8,\"lux\":" + std::to_string(10000 + i) + "}";
+        pieces[i] = {devices[i], "|", timestamps[i], "|", telemetry[i]};
+        messages[i] = pieces[i];
+        for (const std::string_view piece : pieces[i]) {
+            bytes += piece.size();
+        }
+    }
+
+    std::cout << "messages=" << count << " average_bytes=" << (bytes / count) << " rounds=" << rounds
+              << " default_backend=" << agri::Sha256BackendName(agri::DefaultSha256Backend()) << std::endl;
+
+    std::vector<agri::Sha256Digest> reference(count);
+    const double perCallSeconds = SecondsFor(rounds, [&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::array<std::string_view, 5>& p = pieces[i];
+            reference[i] = agri::Sha256({p[0], p[1], p[2], p[3], p[4]});
+        }
+    });
+    Report(AGRI_USE_OPENSSL ? "per_call_evp" : "per_call", count * rounds, bytes * rounds, perCallSeconds);
+
+    std::vector<agri::Sha256Digest> digests(count);
+    for (const agri::Sha256Backend backend :
+         {agri::Sha256Backend::kScalar, agri::Sha256Backend::kShaNi, agri::Sha256Backend::kAvx2,
+          agri::Sha256Backend::kAvx512}) {
+        if (!agri::Sha256BackendSupported(backend)) {
+            continue;
+        }
+        const double seconds = SecondsFor(rounds, [&] {
+            for (std::size_t first = 0; first < count; first += kGroup) {
+                const std::size_t size = std::min(kGroup, count - first);
+                agri::Sha256Batch(std::span<const agri::Sha256Pieces>(messages).subspan(first, size), backend,
+                                  digests.data() + first);
+            }
+        });
+        if (digests != reference) {
+            std::cerr << "digest mismatch for backend " << agri::Sha256BackendName(backend) << std::endl;
+            return 1;
+        }
+        Report("batch_" + std::string(agri::Sha256BackendName(backend)), count * rounds, bytes * rounds, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,348 @@
+# Generates the telemetry envelope header from shared/contracts/telemetry.schema.json.
+# Usage: cmake -DSCHEMA=<schema.json> -DOUTPUT=<header.h> -P GenerateTelemetrySchema.cmake
+
+cmake_minimum_required(VERSION 3.20)
+
+if (NOT DEFINED SCHEMA OR NOT DEFINED OUTPUT)
+    message(FATAL_ERROR "SCHEMA and OUTPUT must be set")
+endif()
+
+file(READ "${SCHEMA}" schema)
+
+function(json_optional out)
+    string(JSON value ERROR_VARIABLE error GET "${schema}" ${ARGN})
+    if (error)
+        set(value "")
+    endif()
+    set(${out} "${value}" PARENT_SCOPE)
+endfunction()
+
+# Escapes text for use inside a C++ string literal. Control characters without a short escape become octal escapes,
+# which unlike \x escapes cannot swallow the characters that follow.
+function(cpp_escape out text)
+    string(REPLACE "\\" "\\\\" text "${text}")
+    string(REPLACE "\"" "\\\"" text "${text}")
+    string(REPLACE "\n" "\\n" text "${text}")
+    string(REPLACE "\r" "\\r" text "${text}")
+    string(REPLACE "\t" "\\t" text "${text}")
+    foreach (code RANGE 1 31)
+        string(ASCII ${code} char)
+        string(FIND "${text}" "${char}" position)
+        if (NOT position EQUAL -1)
+            math(EXPR high "${code} / 8")
+            math(EXPR low "${code} % 8")
+            string(REPLACE "${char}" "\\0${high}${low}" text "${text}")
+        endif()
+    endforeach()
+    set(${out} "${text}" PARENT_SCOPE)
+endfunction()
+
+function(char_code out text index)
+    string(SUBSTRING "${text}" ${index} 1 char)
+    string(HEX "${char}" hex)
+    math(EXPR code "0x${hex}")
+    set(${out} ${code} PARENT_SCOPE)
+endfunction()
+
+set(required)
+string(JSON requiredCount LENGTH "${schema}" required)
+if (requiredCount GREATER 0)
+    math(EXPR lastRequired "${requiredCount} - 1")
+    foreach (i RANGE ${lastRequired})
+        string(JSON name GET "${schema}" required ${i})
+        list(APPEND required "${name}")
+    endforeach()
+endif()
+
+set(names)
+set(enumerators)
+set(specs "")
+set(stringMembers "")
+set(enumValues "")
+set(enumCount 0)
+set(firsts)
+set(lasts)
+set(lengths)
+string(JSON fieldCount LENGTH "${schema}" properties)
+math(EXPR lastField "${fieldCount} - 1")
+foreach (i RANGE ${lastField})
+    string(JSON name MEMBER "${schema}" properties ${i})
+    string(LENGTH "${name}" length)
+    if (length EQUAL 0)
+        message(FATAL_ERROR "empty property name in ${SCHEMA}")
+    endif()
+    if (NOT name MATCHES "^[A-Za-z][A-Za-z0-9_]*$")
+        message(FATAL_ERROR "property name '${name}' in ${SCHEMA} cannot become a C++ enumerator")
+    endif()
+    list(APPEND names "${name}")
+
+    string(SUBSTRING "${name}" 0 1 head)
+    string(SUBSTRING "${name}" 1 -1 tail)
+    string(TOUPPER "${head}" head)
+    list(APPEND enumerators "k${head}${tail}")
+
+    math(EXPR lastChar "${length} - 1")
+    char_code(first "${name}" 0)
+    char_code(last "${name}" ${lastChar})
+    list(APPEND firsts ${first})
+    list(APPEND lasts ${last})
+    list(APPEND lengths ${length})
+
+    string(JSON type GET "${schema}" properties "${name}" type)
+    if (type STREQUAL "string")
+        set(cppType "kString")
+        json_optional(member properties "${name}" x-cppMember)
+        if (member STREQUAL "")
+            set(member "${name}")
+        endif()
+        if (NOT member MATCHES "^[A-Za-z_][A-Za-z0-9_]*$")
+            message(FATAL_ERROR "property ${name} has invalid x-cppMember '${member}'")
+        endif()
+        string(APPEND stringMembers
+            "        case TelemetryField::k${head}${tail}:\n"
+            "            return {&TelemetryPacketView::${member}, &TelemetryPacket::${member}};\n")
+    elseif (type STREQUAL "integer")
+        set(cppType "kInteger")
+    elseif (type STREQUAL "object")
+        set(cppType "kObject")
+    else()
+        message(FATAL_ERROR "property ${name} has unsupported type ${type}")
+    endif()
+
+    list(FIND required "${name}" requiredIndex)
+    if (requiredIndex EQUAL -1)
+        set(isRequired "false")
+    else()
+        set(isRequired "true")
+    endif()
+
+    json_optional(minLength properties "${name}" minLength)
+    if (minLength STREQUAL "")
+        set(minLength 0)
+    endif()
+    json_optional(maxLength properties "${name}" maxLength)
+    if (maxLength STREQUAL "")
+        set(maxLength "kUnboundedLength")
+    endif()
+
+    string(JSON defaultType ERROR_VARIABLE error TYPE "${schema}" properties "${name}" default)
+    if (error)
+        set(defaultValue "{}")
+        set(hasDefault "false")
+    elseif (defaultType STREQUAL "STRING")
+        string(JSON defaultValue GET "${schema}" properties "${name}" default)
+        cpp_escape(defaultValue "${defaultValue}")
+        set(defaultValue "\"${defaultValue}\"")
+        set(hasDefault "true")
+    else()
+        message(FATAL_ERROR "property ${name} has a non-string default")
+    endif()
+
+    set(enumBegin ${enumCount})
+    string(JSON propertyEnumCount ERROR_VARIABLE error LENGTH "${schema}" properties "${name}" enum)
+    if (error)
+        set(propertyEnumCount 0)
+    endif()
+    if (propertyEnumCount GREATER 0)
+        math(EXPR lastEnum "${propertyEnumCount} - 1")
+        foreach (e RANGE ${lastEnum})
+            string(JSON value GET "${schema}" properties "${name}" enum ${e})
+            cpp_escape(value "${value}")
+            string(APPEND enumValues "    \"${value}\",\n")
+            math(EXPR enumCount "${enumCount} + 1")
+        endforeach()
+    endif()
+
+    cpp_escape(literalName "${name}")
+    string(APPEND specs
+        "    {\"${literalName}\", TelemetryFieldType::${cppType}, ${isRequired}, ${minLength}, ${maxLength}, ${hasDefault}, "
+        "${defaultValue}, ${enumBegin}, ${propertyEnumCount}},\n")
+endforeach()
+
+foreach (name IN LISTS required)
+    list(FIND names "${name}" index)
+    if (index EQUAL -1)
+        message(FATAL_ERROR "required property ${name} is not declared")
+    endif()
+endforeach()
+
+# Search slot = (first * a + last * b + length) & (size - 1) for a collision-free table.
+set(found FALSE)
+foreach (size 8 16 32 64 128 256)
+    if (size LESS fieldCount)
+        continue()
+    endif()
+    math(EXPR mask "${size} - 1")
+    foreach (a RANGE 1 31)
+        foreach (b RANGE 0 31)
+            set(slots)
+            set(collision FALSE)
+            foreach (i RANGE ${lastField})
+                list(GET firsts ${i} first)
+                list(GET lasts ${i} last)
+                list(GET lengths ${i} length)
+                math(EXPR slot "(${first} * ${a} + ${last} * ${b} + ${length}) & ${mask}")
+                list(FIND slots ${slot} taken)
+                if (NOT taken EQUAL -1)
+                    set(collision TRUE)
+                    break()
+                endif()
+                list(APPEND slots ${slot})
+            endforeach()
+            if (NOT collision)
+                set(found TRUE)
+                set(slotCount ${size})
+                set(firstWeight ${a})
+                set(lastWeight ${b})
+                break()
+            endif()
+        endforeach()
+        if (found)
+            break()
+        endif()
+    endforeach()
+    if (found)
+        break()
+    endif()
+endforeach()
+if (NOT found)
+    message(FATAL_ERROR "no perfect hash found for the properties of ${SCHEMA}")
+endif()
+math(EXPR mask "${slotCount} - 1")
+
+set(slotTable "")
+foreach (slot RANGE ${mask})
+    list(FIND slots ${slot} index)
+    if (index EQUAL -1)
+        string(APPEND slotTable "    TelemetryField::kUnknown,\n")
+    else()
+        list(GET enumerators ${index} enumerator)
+        string(APPEND slotTable "    TelemetryField::${enumerator},\n")
+    endif()
+endforeach()
+
+set(enumeratorList "")
+foreach (enumerator IN LISTS enumerators)
+    string(APPEND enumeratorList "    ${enumerator},\n")
+endforeach()
+
+set(requiredList "")
+foreach (name IN LISTS required)
+    list(FIND names "${name}" index)
+    list(GET enumerators ${index} enumerator)
+    string(APPEND requiredList "    TelemetryField::${enumerator},\n")
+endforeach()
+list(LENGTH required requiredCount)
+
+if (enumCount EQUAL 0)
+    set(enumValues "    std::string_view(),\n")
+    set(enumStorage 1)
+else()
+    set(enumStorage ${enumCount})
+endif()
+
+get_filename_component(schemaName "${SCHEMA}" NAME)
+set(header "#pragma once
+
+// Generated from ${schemaName} by cmake/GenerateTelemetrySchema.cmake; do not edit.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include \"domain/telemetry_packet.h\"
+
+namespace agri {
+
+enum class TelemetryField : std::uint8_t {
+${enumeratorList}    kUnknown,
+};
+
+enum class TelemetryFieldType : std::uint8_t {
+    kString,
+    kInteger,
+    kObject,
+};
+
+struct TelemetryFieldSpec {
+    std::string_view name;
+    TelemetryFieldType type;
+    bool required;
+    std::size_t minLength;
+    std::size_t maxLength;
+    bool hasDefault;
+    std::string_view defaultValue;
+    std::size_t enumBegin;
+    std::size_t enumCount;
+};
+
+inline constexpr std::size_t kUnboundedLength = std::numeric_limits<std::size_t>::max();
+inline constexpr std::size_t kTelemetryFieldCount = ${fieldCount};
+
+inline constexpr std::array<std::string_view, ${enumStorage}> kTelemetryEnumValues{{
+${enumValues}}};
+
+inline constexpr std::array<TelemetryFieldSpec, kTelemetryFieldCount> kTelemetryFields{{
+${specs}}};
+
+inline constexpr std::array<TelemetryField, ${requiredCount}> kTelemetryRequiredFields{{
+${requiredList}}};
+
+inline constexpr std::array<TelemetryField, ${slotCount}> kTelemetryFieldSlots{{
+${slotTable}}};
+
+constexpr const TelemetryFieldSpec& TelemetryFieldSpecOf(TelemetryField field) {
+    return kTelemetryFields[static_cast<std::size_t>(field)];
+}
+
+// Packet members a string field is parsed into: x-cppMember in the schema, else the property name.
+struct TelemetryStringMembers {
+    std::string_view TelemetryPacketView::*view;
+    std::string TelemetryPacket::*owner;
+};
+
+constexpr TelemetryStringMembers TelemetryStringMembersOf(TelemetryField field) {
+    switch (field) {
+${stringMembers}        default:
+            return {nullptr, nullptr};
+    }
+}
+
+constexpr TelemetryField ClassifyTelemetryField(std::string_view key) {
+    if (key.empty()) {
+        return TelemetryField::kUnknown;
+    }
+    const std::size_t slot = (static_cast<unsigned char>(key.front()) * ${firstWeight}u +
+                              static_cast<unsigned char>(key.back()) * ${lastWeight}u + key.size()) &
+                             ${mask}u;
+    const TelemetryField field = kTelemetryFieldSlots[slot];
+    return (field != TelemetryField::kUnknown && TelemetryFieldSpecOf(field).name == key) ? field
+                                                                                          : TelemetryField::kUnknown;
+}
+
+constexpr bool TelemetryEnumAllows(TelemetryField field, std::string_view value) {
+    const TelemetryFieldSpec& spec = TelemetryFieldSpecOf(field);
+    if (spec.enumCount == 0) {
+        return true;
+    }
+    for (std::size_t i = spec.enumBegin; i < spec.enumBegin + spec.enumCount; ++i) {
+        if (kTelemetryEnumValues[i] == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+")
+
+if (EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+    if (previous STREQUAL header)
+        return()
+    endif()
+endif()
+file(WRITE "${OUTPUT}" "${header}")
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace agri {
+
+struct AdmissionConfig {
+    std::size_t maxInFlight{1};
+    std::size_t maxQueued{4096};
+    std::size_t maxQueuedPerGateway{512};
+    std::size_t quantumBytes{16 * 1024};
+};
+
+enum class AdmissionDecision {
+    kAdmitted,
+    kQueued,
+    kOverloaded,
+    kGatewayLimited,
+};
+
+struct AdmissionSnapshot {
+    std::size_t inFlight{0};
+    std::size_t queued{0};
+    std::size_t maxInFlight{0};
+    std::size_t maxQueued{0};
+    std::uint64_t admitted{0};
+    std::uint64_t shedOverloaded{0};
+    std::uint64_t shedGatewayLimited{0};
+    std::vector<std::pair<std::string, std::size_t>> queuedByGateway;
+};
+
+class AdmissionController {
+   public:
+    using Task = std::function<void()>;
+    using Dispatcher = std::function<void(Task)>;
+
+    AdmissionController(AdmissionConfig config, Dispatcher dispatcher);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    AdmissionDecision Submit(std::string_view gateway, std::size_t costBytes, Task task);
+    AdmissionSnapshot Snapshot(std::size_t maxGateways = 16) const;
+
+   private:
+    struct QueuedTask {
+        std::size_t cost{0};
+        Task task;
+    };
+
+    struct Gateway {
+        std::deque<QueuedTask> queue;
+        std::size_t deficit{0};
+        bool turnStarted{false};
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    void Dispatch(Task task);
+    void Finish();
+    bool PopNextLocked(Task* task);
+
+    AdmissionConfig config_;
+    Dispatcher dispatcher_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Gateway, KeyHash, std::equal_to<>> gateways_;
+    std::deque<std::string> active_;
+    std::size_t inFlight_{0};
+    std::size_t queued_{0};
+    std::uint64_t admitted_{0};
+    std::uint64_t shedOverloaded_{0};
+    std::uint64_t shedGatewayLimited_{0};
+};
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <netinet/in.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "services/ingest_service.h"
+#include "utils/work_stealing_pool.h"
+
+namespace agri {
+
+enum class FrameAckStatus : std::uint8_t {
+    kAccepted = 0,
+    kRejected = 1,
+    kMalformed = 2,
+};
+
+struct FrameIngestConfig {
+    std::uint16_t tcpPort{0};
+    std::uint16_t udpPort{0};
+    std::size_t maxFrameBytes{64 * 1024};
+    std::size_t maxDatagramBytes{2048};
+    std::size_t udpBatchSize{64};
+    std::size_t maxUdpBatchesInFlight{4};
+    std::uint32_t workerThreads{2};
+};
+
+struct FrameIngestStats {
+    std::uint64_t tcpConnections{0};
+    std::uint64_t tcpFrames{0};
+    std::uint64_t udpDatagrams{0};
+    std::uint64_t malformedFrames{0};
+    std::uint64_t ingestBatches{0};
+};
+
+std::string EncodeFrameAck(std::uint32_t sequence, FrameAckStatus status, std::uint64_t recordId, std::string_view message);
+
+class FrameIngestListener {
+   public:
+    using IngestObserver = std::function<void(const TelemetryPacketView&, const IngestResult&)>;
+
+    FrameIngestListener(FrameIngestConfig config, IngestService& ingestService, IngestObserver observer = {});
+    ~FrameIngestListener();
+
+    FrameIngestListener(const FrameIngestListener&) = delete;
+    FrameIngestListener& operator=(const FrameIngestListener&) = delete;
+
+    void Start();
+    void Stop();
+    FrameIngestStats Stats() const;
+
+   private:
+    struct Frame {
+        std::uint32_t sequence{0};
+        std::string payload;
+        bool truncated{false};
+        sockaddr_in peer{};
+    };
+
+    struct Connection {
+        int fd{-1};
+        std::uint64_t id{0};
+        std::string readBuffer;
+        std::string writeBuffer;
+        bool batchInFlight{false};
+        bool peerClosed{false};
+        bool watched{true};
+    };
+
+    struct Completion {
+        int fd{-1};
+        std::uint64_t connectionId{0};
+        std::string acks;
+    };
+
+    void OpenSockets();
+    void CloseSockets();
+    void AcceptConnections();
+    void HandleConnectionEvent(int fd, std::uint32_t events);
+    void DispatchFrames(Connection* connection);
+    bool FlushConnection(Connection* connection);
+    void UpdateInterest(Connection* connection);
+    void CloseConnection(int fd);
+    void ReadDatagrams();
+    void SetUdpInterest(bool enabled);
+    void PostCompletion(Completion completion);
+    void DrainCompletions();
+    std::vector<std::string> IngestFrames(const std::vector<Frame>& frames);
+    std::vector<std::string> ParseAndIngest(const std::vector<Frame>& frames);
+    static std::vector<std::string> RejectFrames(const std::vector<Frame>& frames, std::string_view message);
+
+    FrameIngestConfig config_;
+    IngestService& ingestService_;
+    IngestObserver observer_;
+    std::unique_ptr<WorkStealingPool> workerPool_;
+    std::atomic<bool> running_{true};
+
+    int epollFd_{-1};
+    int wakeFd_{-1};
+    int tcpFd_{-1};
+    int udpFd_{-1};
+    std::uint64_t nextConnectionId_{1};
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::vector<char> datagramBuffer_;
+    std::atomic<std::size_t> udpBatchesInFlight_{0};
+    bool udpPaused_{false};
+
+    std::mutex completionMutex_;
+    std::vector<Completion> completions_;
+
+    std::atomic<std::uint64_t> tcpConnections_{0};
+    std::atomic<std::uint64_t> tcpFrames_{0};
+    std::atomic<std::uint64_t> udpDatagrams_{0};
+    std::atomic<std::uint64_t> malformedFrames_{0};
+    std::atomic<std::uint64_t> ingestBatches_{0};
+};
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace agri {
+
+enum class HttpHeaderId : std::uint8_t {
+    kOther,
+    kConnection,
+    kContentLength,
+    kContentType,
+    kHost,
+    kSecWebSocketExtensions,
+    kSecWebSocketKey,
+    kTransferEncoding,
+    kUpgrade,
+    kCount,
+};
+
+struct HttpHeaderField {
+    std::string_view name;
+    std::string_view value;
+    HttpHeaderId id{HttpHeaderId::kOther};
+};
+
+class HttpHeaderTable {
+   public:
+    static constexpr std::size_t kMaxHeaders = 64;
+
+    bool Add(std::string_view name, std::string_view value, HttpHeaderId id);
+    std::string_view Get(HttpHeaderId id) const;
+    std::string_view Get(std::string_view name) const;
+    std::size_t Size() const { return size_; }
+    const HttpHeaderField& At(std::size_t index) const { return fields_[index]; }
+    void Clear();
+    void Rebase(const char* from, const char* to);
+
+   private:
+    std::array<HttpHeaderField, kMaxHeaders> fields_{};
+    std::array<std::uint8_t, static_cast<std::size_t>(HttpHeaderId::kCount)> slotById_{};
+    std::size_t size_{0};
+};
+
+struct HttpRequest {
+    std::string_view method;
+    std::string_view target;
+    std::string_view path;
+    std::string_view query;
+    std::string_view version;
+    std::string_view body;
+    HttpHeaderTable headers;
+    bool keepAlive{false};
+
+    void Rebase(const char* from, const char* to);
+};
+
+bool EqualsIgnoreCase(std::string_view left, std::string_view right);
+bool HeaderHasToken(std::string_view value, std::string_view token);
+bool HasMediaType(std::string_view contentType, std::string_view mediaType);
+
+class HttpRequestParser {
+   public:
+    enum class Status {
+        kIncomplete,
+        kComplete,
+        kError,
+    };
+
+    static constexpr std::size_t kMaxHeaderBytes = 64 * 1024;
+
+    explicit HttpRequestParser(std::size_t maxBodyBytes = 1024 * 1024);
+
+    Status Parse(std::string_view buffer);
+    void Reset();
+
+    const HttpRequest& Request() const { return request_; }
+    HttpRequest& MutableRequest() { return request_; }
+    std::size_t ConsumedBytes() const { return consumed_; }
+    int ErrorStatus() const { return errorStatus_; }
+    std::string_view ErrorMessage() const { return errorMessage_; }
+
+   private:
+    enum class State {
+        kRequestLine,
+        kHeaders,
+        kBody,
+        kDone,
+        kFailed,
+    };
+
+    struct Span {
+        std::uint32_t offset{0};
+        std::uint32_t length{0};
+    };
+
+    struct HeaderSpan {
+        Span name;
+        Span value;
+        HttpHeaderId id{HttpHeaderId::kOther};
+    };
+
+    Status Fail(int status, std::string_view message);
+    bool ParseRequestLine(std::string_view line);
+    bool ParseHeaderLine(std::string_view line, std::size_t lineOffset);
+    Status Finish(std::string_view buffer);
+
+    std::size_t maxBodyBytes_;
+    State state_{State::kRequestLine};
+    std::size_t scanOffset_{0};
+    std::size_t lineStart_{0};
+    std::size_t bodyStart_{0};
+    std::size_t contentLength_{0};
+    bool haveContentLength_{false};
+    std::size_t consumed_{0};
+    Span method_;
+    Span target_;
+    Span version_;
+    std::array<HeaderSpan, HttpHeaderTable::kMaxHeaders> headers_{};
+    std::size_t headerCount_{0};
+    HttpRequest request_;
+    int errorStatus_{0};
+    std::string_view errorMessage_;
+};
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace agri {
+
+std::string_view StatusText(int statusCode);
+
+class HttpBodyStream {
+   public:
+    virtual ~HttpBodyStream() = default;
+
+    virtual bool Next(std::string* chunk) = 0;
+};
+
+class ResponseHeaderBlock {
+   public:
+    static constexpr std::size_t kCapacity = 384;
+
+    void Render(
+        int statusCode,
+        std::string_view contentType,
+        std::size_t contentLength,
+        bool keepAlive,
+        std::uint32_t retryAfterSeconds = 0);
+    void RenderChunked(int statusCode, std::string_view contentType, bool keepAlive);
+    void RenderCloseDelimited(int statusCode, std::string_view contentType);
+    void RenderChunkSize(std::size_t size, bool afterChunk);
+    std::string_view View() const { return std::string_view(bytes_.data(), size_); }
+
+   private:
+    void AppendStatusLine(int statusCode);
+    void AppendContentType(std::string_view contentType);
+    void AppendHex(std::size_t value);
+    void Append(std::string_view text);
+
+    std::array<char, kCapacity> bytes_{};
+    std::size_t size_{0};
+};
+
+class OutboundQueue {
+   public:
+    enum class FlushStatus {
+        kDrained,
+        kBlocked,
+        kError,
+    };
+
+    void EnableZeroCopy(int fd, std::size_t thresholdBytes);
+    void PushResponse(
+        int statusCode,
+        std::string_view contentType,
+        std::string body,
+        bool keepAlive,
+        std::uint32_t retryAfterSeconds = 0);
+    void PushChunkedHead(int statusCode, std::string_view contentType, bool keepAlive);
+    // For HTTP/1.0 peers, which cannot decode chunked bodies: chunks are written unframed and the body ends when
+    // the connection closes.
+    void PushCloseDelimitedHead(int statusCode, std::string_view contentType);
+    void PushChunk(std::string data);
+    void PushLastChunk();
+    void PushRaw(std::string bytes);
+    FlushStatus Flush(int fd);
+    std::size_t GatherIovecs(iovec* iov, std::size_t maxIovecs) const;
+    void CompleteSend(std::size_t sent);
+    void ReapZeroCopyCompletions(int fd);
+
+    bool Empty() const { return entries_.empty(); }
+    std::size_t PendingBytes() const { return pendingBytes_; }
+    bool HasZeroCopyInFlight() const { return !zeroCopyInFlight_.empty(); }
+
+   private:
+    struct Entry {
+        ResponseHeaderBlock head;
+        bool hasHead{false};
+        std::string body;
+        std::size_t headSent{0};
+        std::size_t bodySent{0};
+        bool zeroCopy{false};
+        bool zeroCopyUsed{false};
+        std::uint32_t lastZeroCopySeq{0};
+    };
+
+    struct InFlightBody {
+        std::uint32_t seq{0};
+        std::string body;
+    };
+
+    FlushStatus FlushZeroCopyBody(int fd, Entry* entry);
+    void Advance(std::size_t sent);
+
+    std::deque<Entry> entries_;
+    std::deque<InFlightBody> zeroCopyInFlight_;
+    std::size_t pendingBytes_{0};
+    std::size_t zeroCopyThreshold_{0};
+    std::uint32_t nextZeroCopySeq_{0};
+    bool chunkOpen_{false};
+    bool chunked_{true};
+};
+
+}
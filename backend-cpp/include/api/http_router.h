@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agri {
+
+class RouteParams {
+   public:
+    static constexpr std::size_t kMaxParams = 8;
+
+    bool Add(std::string_view name, std::string_view value);
+    std::string_view Get(std::string_view name) const;
+    std::string_view At(std::size_t index) const { return values_[index]; }
+    std::size_t Size() const { return size_; }
+    void Truncate(std::size_t size) { size_ = size; }
+    void Clear() { size_ = 0; }
+
+   private:
+    std::array<std::string_view, kMaxParams> names_{};
+    std::array<std::string_view, kMaxParams> values_{};
+    std::size_t size_{0};
+};
+
+class QueryParams {
+   public:
+    static constexpr std::size_t kMaxParams = 32;
+
+    void Parse(std::string_view query);
+    std::optional<std::string_view> Get(std::string_view key) const;
+    std::size_t Size() const { return size_; }
+    std::string_view KeyAt(std::size_t index) const { return keys_[index]; }
+    std::string_view ValueAt(std::size_t index) const { return values_[index]; }
+
+    static std::string Decode(std::string_view raw);
+
+   private:
+    std::array<std::string_view, kMaxParams> keys_{};
+    std::array<std::string_view, kMaxParams> values_{};
+    std::size_t size_{0};
+};
+
+class HttpRouter {
+   public:
+    void Add(std::string_view method, std::string_view pattern, std::size_t routeId);
+    std::optional<std::size_t> Match(std::string_view method, std::string_view path, RouteParams* params) const;
+
+   private:
+    static constexpr std::uint32_t kNoNode = 0xFFFFFFFFU;
+    static constexpr std::size_t kNoRoute = static_cast<std::size_t>(-1);
+
+    struct LiteralEdge {
+        std::string segment;
+        std::uint32_t child{kNoNode};
+    };
+
+    struct Node {
+        std::vector<LiteralEdge> literals;
+        std::uint32_t paramChild{kNoNode};
+        std::string paramName;
+        std::size_t routeId{kNoRoute};
+    };
+
+    struct MethodRoot {
+        std::string method;
+        std::uint32_t root{kNoNode};
+    };
+
+    std::uint32_t NewNode();
+    bool MatchFrom(std::uint32_t node, std::string_view rest, RouteParams* params, std::size_t* routeId) const;
+
+    std::vector<Node> nodes_;
+    std::vector<MethodRoot> roots_;
+};
+
+}
@@ -1,61 +1,224 @@
 #pragma once
 
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "api/admission_controller.h"
+#include "api/http_request_parser.h"
+#include "api/http_response_writer.h"
+#include "api/http_router.h"
+#include "api/websocket_broadcaster.h"
 #include "services/ingest_service.h"
 #include "storage/telemetry_repository.h"
+#include "utils/io_uring.h"
+#include "utils/timer_wheel.h"
+#include "utils/work_stealing_pool.h"
 
 namespace agri {
 
+enum class HttpIoBackend {
+    kEpoll,
+    kIoUring,
+};
+
+HttpIoBackend ParseHttpIoBackend(std::string_view name);
+
+struct HttpServerConfig {
+    std::uint32_t idleTimeoutMs{15000};
+    std::uint32_t readTimeoutMs{10000};
+    std::uint32_t writeTimeoutMs{10000};
+    std::uint32_t maxRequestsPerConnection{1000};
+    std::uint32_t workerThreads{0};
+    std::uint32_t reactorThreads{1};
+    bool pinReactorThreads{true};
+    HttpIoBackend ioBackend{HttpIoBackend::kEpoll};
+    std::size_t zeroCopyThresholdBytes{256 * 1024};
+    std::uint32_t ingestMaxInFlight{0};
+    std::size_t ingestMaxQueued{4096};
+    std::size_t ingestMaxQueuedPerGateway{512};
+    std::uint32_t ingestRetryAfterSeconds{1};
+    std::size_t ingestMaxBatchPackets{1000};
+    std::size_t wsMaxQueuedFrames{256};
+    std::uint32_t wsPingIntervalMs{30000};
+    SlowClientPolicy wsSlowClientPolicy{SlowClientPolicy::kCoalesce};
+};
+
 class HttpServer {
    public:
-    struct HttpRequest {
-        std::string method;
-        std::string path;
-        std::string headers;
-        std::string body;
-    };
+    using HttpRequest = ::agri::HttpRequest;
 
     struct HttpResponse {
         int statusCode{200};
         std::string body;
         std::string contentType{"application/json"};
+        std::uint32_t retryAfterSeconds{0};
+        std::shared_ptr<HttpBodyStream> stream{};
     };
 
-    HttpServer(std::uint16_t port, IngestService& ingestService, const TelemetryRepository& repository);
+    HttpServer(
+        std::uint16_t port,
+        IngestService& ingestService,
+        const TelemetryRepository& repository,
+        HttpServerConfig config = {});
 
     void Start();
     void Stop();
+    void BroadcastIngestEvent(const TelemetryPacketView& packet, const IngestResult& result);
+
+    static bool IoUringAvailable();
 
    private:
-    bool HandleClient(int clientFd);
-    bool TryUpgradeWebSocket(int clientFd, const HttpRequest& request, const std::string& path);
-    void BroadcastIngestEvent(const TelemetryPacket& packet, const IngestResult& result);
-    void BroadcastMessage(const std::string& payload, std::vector<int>* clients);
+    enum class ConnectionState {
+        kOpen,
+        kDraining,
+        kLingering,
+        kUpgrading,
+        kUpgraded,
+    };
+
+    static constexpr std::size_t kRingSendIovecs = 256;
+    static constexpr std::size_t kRingIovecsPerSend = 64;
+
+    struct RingConnection {
+        bool recvArmed{false};
+        std::size_t sendsInFlight{0};
+        bool failed{false};
+        bool closePending{false};
+        std::array<iovec, kRingSendIovecs> iov{};
+        std::array<msghdr, kRingSendIovecs / kRingIovecsPerSend> messages{};
+    };
+
+    struct Reactor;
+
+    struct WebSocketUpgrade {
+        WebSocketChannel channel{WebSocketChannel::kTelemetry};
+        WebSocketSubscription subscription;
+        std::string handshake;
+        bool deflate{false};
+    };
+
+    struct Connection {
+        Reactor* reactor{nullptr};
+        int fd{-1};
+        std::uint64_t id{0};
+        std::string peerAddress;
+        ConnectionState state{ConnectionState::kOpen};
+        std::string readBuffer;
+        HttpRequestParser parser;
+        OutboundQueue output;
+        std::uint32_t requestsServed{0};
+        bool peerClosed{false};
+        bool requestInFlight{false};
+        bool http10Request{false};
+        std::shared_ptr<HttpBodyStream> stream;
+        bool chunkPending{false};
+        std::chrono::steady_clock::time_point lastActivity;
+        std::chrono::steady_clock::time_point lastWriteProgress;
+        std::chrono::steady_clock::time_point readStarted;
+        std::chrono::steady_clock::time_point armedDeadline;
+        TimerWheel::TimerId timer{TimerWheel::kInvalidTimer};
+        std::unique_ptr<RingConnection> ring;
+        std::unique_ptr<WebSocketUpgrade> upgrade;
+    };
+
+    struct PendingRequest {
+        std::string buffer;
+        HttpRequest request;
+    };
+
+    struct Completion {
+        int fd{-1};
+        std::uint64_t connectionId{0};
+        HttpResponse response;
+        bool keepAlive{false};
+        bool streamChunk{false};
+        bool streamDone{false};
+        bool streamFailed{false};
+    };
+
+    struct Reactor {
+        std::size_t index{0};
+        int listenFd{-1};
+        int epollFd{-1};
+        int wakeFd{-1};
+        std::unordered_map<int, Connection> connections;
+        std::uint64_t nextConnectionId{1};
+        std::mutex completionMutex;
+        std::vector<Completion> completions;
+        TimerWheel timers;
+        std::unique_ptr<IoUring> ring;
+        std::vector<IoUringCompletion> ringCompletions;
+    };
+
+    void OpenReactor(Reactor* reactor);
+    void RunReactor(Reactor* reactor);
+    void RunEventLoop(Reactor* reactor);
+    void AcceptConnections(Reactor* reactor);
+    void RegisterConnection(Reactor* reactor, int clientFd, const sockaddr_in& clientAddr);
+    void HandleConnectionEvent(Reactor* reactor, int fd, std::uint32_t events);
+    bool HandleReadable(Connection* connection);
+    bool ServiceConnection(Connection* connection);
+    bool ProcessBufferedRequests(Connection* connection, bool* stalledOnOutput);
+    void HandleRequest(Connection* connection);
+    void HandOffWebSocket(Connection* connection);
+    bool LingerForZeroCopy(Connection* connection);
+    void DispatchRequest(Connection* connection, bool keepAlive);
+    void PostCompletion(Reactor* reactor, Completion completion);
+    void DrainCompletions(Reactor* reactor);
+    void QueueResponse(Connection* connection, HttpResponse response, bool keepAlive);
+    void ScheduleStreamChunk(Connection* connection);
+    bool AppendStreamChunk(Connection* connection, Completion* completion);
+    bool FlushWriteBuffer(Connection* connection);
+    std::chrono::steady_clock::time_point ConnectionDeadline(const Connection& connection) const;
+    void ArmConnectionTimer(Connection* connection);
+    void ExpireConnections(Reactor* reactor);
+    bool OpenRing(Reactor* reactor);
+    void RunRingLoop(Reactor* reactor);
+    void HandleRingCompletion(Reactor* reactor, const IoUringCompletion& completion);
+    void HandleRingRecv(Connection* connection, const IoUringCompletion& completion);
+    void HandleRingSend(Connection* connection, const IoUringCompletion& completion);
+    void ArmRingRecv(Connection* connection);
+    void SubmitRingSend(Connection* connection);
+    void SettleRingConnection(Connection* connection);
+    void CloseConnection(Reactor* reactor, int fd, bool closeSocket);
+    void CloseAllConnections(Reactor* reactor);
+    bool PrepareWebSocketUpgrade(const HttpRequest& request, WebSocketUpgrade* upgrade, HttpResponse* rejection);
+    using RouteHandler = HttpResponse (HttpServer::*)(const HttpRequest&, const RouteParams&);
+
+    void RegisterRoutes();
     HttpResponse Route(const HttpRequest& request);
-    std::string BuildRawResponse(const HttpResponse& response) const;
+    HttpResponse HandleHealth(const HttpRequest& request, const RouteParams& params);
+    HttpResponse HandleIngest(const HttpRequest& request, const RouteParams& params);
+    HttpResponse HandleIngestBatch(const HttpRequest& request, const RouteParams& params);
+    HttpResponse HandleMetricsOverview(const HttpRequest& request, const RouteParams& params);
+    HttpResponse HandleDeviceLatest(const HttpRequest& request, const RouteParams& params);
+    HttpResponse HandleBatchTrace(const HttpRequest& request, const RouteParams& params);
+    HttpResponse HandleTransaction(const HttpRequest& request, const RouteParams& params);
     static std::string BuildWebSocketAccept(const std::string& key);
-    static std::string BuildWebSocketFrame(const std::string& payload);
-    static std::string GetHeaderValue(const std::string& headers, const std::string& key);
-    static std::string StripQuery(std::string path);
-    static bool ExtractPathParam(
-        const std::string& path,
-        const std::string& prefix,
-        const std::string& suffix,
-        std::string* value);
 
     std::uint16_t port_;
+    HttpServerConfig config_;
     IngestService& ingestService_;
     const TelemetryRepository& repository_;
+    HttpRouter router_;
+    std::vector<RouteHandler> routeHandlers_;
     std::atomic<bool> running_{false};
-    int listenFd_{-1};
-    std::mutex wsMutex_;
-    std::vector<int> telemetryWsClients_;
-    std::vector<int> alertWsClients_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    std::unique_ptr<WorkStealingPool> workerPool_;
+    std::unique_ptr<AdmissionController> ingestAdmission_;
+    WebSocketBroadcaster broadcaster_;
 };
 
 }
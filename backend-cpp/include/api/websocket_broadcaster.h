@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "api/websocket_deflate.h"
+#include "api/websocket_frame.h"
+#include "api/websocket_subscription.h"
+#include "utils/timer_wheel.h"
+
+namespace agri {
+
+enum class WebSocketChannel {
+    kTelemetry,
+    kAlerts,
+};
+
+enum class SlowClientPolicy {
+    kDrop,
+    kCoalesce,
+    kDisconnect,
+};
+
+SlowClientPolicy ParseSlowClientPolicy(std::string_view name);
+
+struct WebSocketBroadcasterConfig {
+    std::size_t maxQueuedFrames{256};
+    SlowClientPolicy slowClientPolicy{SlowClientPolicy::kCoalesce};
+    std::uint32_t pingIntervalMs{30000};
+};
+
+struct WebSocketBroadcasterStats {
+    std::uint64_t publishedMessages{0};
+    std::uint64_t sentFrames{0};
+    std::uint64_t droppedFrames{0};
+    std::uint64_t coalescedFrames{0};
+    std::uint64_t disconnectedClients{0};
+    std::uint64_t compressedMessages{0};
+    std::uint64_t subscriptionUpdates{0};
+    std::uint64_t pingTimeouts{0};
+};
+
+class WebSocketBroadcaster {
+   public:
+    explicit WebSocketBroadcaster(WebSocketBroadcasterConfig config = {});
+    ~WebSocketBroadcaster();
+
+    WebSocketBroadcaster(const WebSocketBroadcaster&) = delete;
+    WebSocketBroadcaster& operator=(const WebSocketBroadcaster&) = delete;
+
+    void Start();
+    void Stop();
+
+    void AddClient(
+        int fd,
+        WebSocketChannel channel,
+        WebSocketSubscription subscription,
+        std::string handshake,
+        bool deflate = false,
+        std::string inbound = {});
+    void Publish(WebSocketChannel channel, std::string_view payload, const WebSocketEventKeys& keys = {});
+
+    std::size_t ClientCount() const;
+    WebSocketBroadcasterStats Stats() const;
+
+   private:
+    struct Message {
+        std::string frame;
+        std::string coalesceKey;
+        bool control{false};
+        bool reply{false};
+    };
+
+    using SharedMessage = std::shared_ptr<const Message>;
+
+    struct Client {
+        int fd{-1};
+        WebSocketChannel channel{WebSocketChannel::kTelemetry};
+        WebSocketSubscription subscription;
+        std::string handshake;
+        std::size_t handshakeSent{0};
+        std::deque<SharedMessage> queue;
+        std::size_t frontSent{0};
+        std::size_t queuedReplies{0};
+        WebSocketReader reader;
+        bool deflate{false};
+        bool closing{false};
+        bool awaitingPong{false};
+        TimerWheel::TimerId timer{TimerWheel::kInvalidTimer};
+    };
+
+    struct PendingClient {
+        int fd{-1};
+        WebSocketChannel channel{WebSocketChannel::kTelemetry};
+        WebSocketSubscription subscription;
+        std::string handshake;
+        bool deflate{false};
+        std::string inbound;
+    };
+
+    struct Publication {
+        WebSocketChannel channel{WebSocketChannel::kTelemetry};
+        std::string payload;
+        std::string deviceId;
+        std::string batchCode;
+        std::string transport;
+    };
+
+    void RunLoop();
+    void Wake();
+    void DrainInbox();
+    void RegisterClient(PendingClient pending);
+    void DeliverPublication(const Publication& publication, std::vector<int>* doomed);
+    bool Enqueue(Client* client, const SharedMessage& message);
+    void EnqueueControl(Client* client, std::string frame, bool reply = false);
+    void EnqueueReply(Client* client, std::string_view payload);
+    bool ReserveReply(Client* client);
+    void StartClose(Client* client, std::uint16_t code);
+    bool FlushClient(Client* client);
+    bool ReadInbound(Client* client);
+    void ProcessInbound(Client* client);
+    void HandleTextMessage(Client* client, WebSocketInbound* inbound);
+    void ExpireTimers();
+    bool CloseClient(int fd);
+    void CloseAllClients();
+
+    WebSocketBroadcasterConfig config_;
+    std::atomic<bool> running_{false};
+    int epollFd_{-1};
+    int wakeFd_{-1};
+    std::thread thread_;
+
+    mutable std::mutex inboxMutex_;
+    std::vector<PendingClient> pendingClients_;
+    std::vector<Publication> publications_;
+    std::size_t clientCount_{0};
+
+    std::unordered_map<int, Client> clients_;
+    std::array<WebSocketSubscriptionIndex, 2> indexes_;
+    std::array<MessageDeflater, 2> deflaters_;
+    MessageInflater inflater_;
+    TimerWheel timers_;
+
+    std::atomic<std::uint64_t> publishedMessages_{0};
+    std::atomic<std::uint64_t> sentFrames_{0};
+    std::atomic<std::uint64_t> droppedFrames_{0};
+    std::atomic<std::uint64_t> coalescedFrames_{0};
+    std::atomic<std::uint64_t> disconnectedClients_{0};
+    std::atomic<std::uint64_t> compressedMessages_{0};
+    std::atomic<std::uint64_t> subscriptionUpdates_{0};
+    std::atomic<std::uint64_t> pingTimeouts_{0};
+};
+
+}
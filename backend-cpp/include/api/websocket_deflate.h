@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace agri {
+
+bool PerMessageDeflateAvailable();
+std::optional<std::string> NegotiatePerMessageDeflate(std::string_view extensionsHeader);
+
+class MessageDeflater {
+   public:
+    MessageDeflater();
+    ~MessageDeflater();
+
+    MessageDeflater(const MessageDeflater&) = delete;
+    MessageDeflater& operator=(const MessageDeflater&) = delete;
+
+    bool Compress(std::string_view payload, std::string* compressed);
+
+   private:
+    void* stream_{nullptr};
+};
+
+class MessageInflater {
+   public:
+    MessageInflater();
+    ~MessageInflater();
+
+    MessageInflater(const MessageInflater&) = delete;
+    MessageInflater& operator=(const MessageInflater&) = delete;
+
+    bool Decompress(std::string_view payload, std::size_t maxBytes, std::string* decompressed);
+
+   private:
+    void* stream_{nullptr};
+};
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace agri {
+
+enum class WebSocketOpcode : std::uint8_t {
+    kContinuation = 0x0,
+    kText = 0x1,
+    kBinary = 0x2,
+    kClose = 0x8,
+    kPing = 0x9,
+    kPong = 0xA,
+};
+
+constexpr std::uint16_t kWebSocketCloseNormal = 1000;
+constexpr std::uint16_t kWebSocketCloseGoingAway = 1001;
+constexpr std::uint16_t kWebSocketCloseProtocolError = 1002;
+constexpr std::uint16_t kWebSocketCloseUnsupportedData = 1003;
+constexpr std::uint16_t kWebSocketCloseInvalidPayload = 1007;
+constexpr std::uint16_t kWebSocketClosePolicyViolation = 1008;
+constexpr std::uint16_t kWebSocketCloseMessageTooBig = 1009;
+
+std::string EncodeWebSocketFrame(WebSocketOpcode opcode, std::string_view payload, bool compressed = false);
+std::string EncodeWebSocketClose(std::uint16_t code, std::string_view reason = {});
+
+// RFC 6455 requires text messages and close reasons to be well-formed UTF-8 (no overlong forms, surrogates or
+// code points above U+10FFFF).
+bool IsValidUtf8(std::string_view text);
+// Whether a peer may put this code on the wire; 1005, 1006 and 1015 are reserved for local reporting only.
+bool IsValidWebSocketCloseCode(std::uint16_t code);
+
+struct WebSocketInbound {
+    WebSocketOpcode opcode{WebSocketOpcode::kText};
+    bool compressed{false};
+    std::string payload;
+};
+
+class WebSocketReader {
+   public:
+    enum class Status {
+        kIncomplete,
+        kReady,
+        kError,
+    };
+
+    explicit WebSocketReader(std::size_t maxMessageBytes = 64 * 1024, bool compressionNegotiated = false);
+
+    void Append(const char* data, std::size_t size);
+    Status Next(WebSocketInbound* inbound);
+    std::uint16_t ErrorCode() const { return errorCode_; }
+    std::size_t BufferedBytes() const { return buffer_.size() - offset_; }
+
+   private:
+    Status Fail(std::uint16_t code);
+
+    std::size_t maxMessageBytes_;
+    bool compressionNegotiated_;
+    std::string buffer_;
+    std::size_t offset_{0};
+    std::string message_;
+    WebSocketOpcode messageOpcode_{WebSocketOpcode::kText};
+    bool messageCompressed_{false};
+    bool inMessage_{false};
+    std::uint16_t errorCode_{0};
+};
+
+}
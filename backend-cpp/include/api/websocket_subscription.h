@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace agri {
+
+struct WebSocketEventKeys {
+    std::string_view deviceId;
+    std::string_view batchCode;
+    std::string_view transport;
+};
+
+struct WebSocketSubscription {
+    std::vector<std::string> deviceIds;
+    std::vector<std::string> batchCodes;
+    std::vector<std::string> transports;
+    std::vector<std::string> deviceGroups;
+
+    bool Empty() const;
+    bool Matches(const WebSocketEventKeys& keys) const;
+};
+
+bool ParseWebSocketSubscription(std::string_view query, WebSocketSubscription* subscription, std::string* error);
+bool ParseWebSocketSubscribeMessage(std::string_view json, WebSocketSubscription* subscription, std::string* error);
+bool DeviceInGroup(std::string_view deviceId, std::string_view group);
+
+class WebSocketSubscriptionIndex {
+   public:
+    void Add(int fd, const WebSocketSubscription& subscription);
+    void Remove(int fd, const WebSocketSubscription& subscription);
+    std::size_t Size() const { return size_; }
+
+    template <typename Fn>
+    void ForEachCandidate(const WebSocketEventKeys& keys, Fn&& fn) const {
+        for (const int fd : unfiltered_) {
+            fn(fd);
+        }
+        VisitPostings(byDevice_, keys.deviceId, fn);
+        if (!keys.batchCode.empty()) {
+            VisitPostings(byBatch_, keys.batchCode, fn);
+        }
+        VisitPostings(byTransport_, keys.transport, fn);
+        for (std::size_t end = 0; end != std::string_view::npos;) {
+            end = keys.deviceId.find('-', end + 1);
+            VisitPostings(byGroup_, keys.deviceId.substr(0, end), fn);
+        }
+    }
+
+   private:
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    using Postings = std::unordered_map<std::string, std::vector<int>, KeyHash, std::equal_to<>>;
+
+    template <typename Fn>
+    static void VisitPostings(const Postings& postings, std::string_view key, Fn& fn) {
+        const auto it = postings.find(key);
+        if (it != postings.end()) {
+            for (const int fd : it->second) {
+                fn(fd);
+            }
+        }
+    }
+
+    Postings* SelectPostings(const WebSocketSubscription& subscription, const std::vector<std::string>** values);
+    static std::vector<std::string> IndexedGroups(const std::vector<std::string>& groups);
+
+    std::vector<int> unfiltered_;
+    Postings byDevice_;
+    Postings byBatch_;
+    Postings byGroup_;
+    Postings byTransport_;
+    std::size_t size_{0};
+};
+
+}
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "domain/telemetry_record.h"
 
@@ -16,4 +18,12 @@ struct IngestResult {
     std::uint64_t processingMs{0};
 };
 
+struct BatchIngestResult {
+    std::vector<IngestResult> results;
+    std::string merkleRoot;
+    std::optional<BlockchainReceipt> receipt;
+    std::size_t acceptedCount{0};
+    std::uint64_t processingMs{0};
+};
+
 }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <variant>
+
+namespace agri {
+
+struct TelemetryStringId {
+    std::uint32_t id{0};
+
+    bool operator==(const TelemetryStringId&) const = default;
+};
+
+using TelemetryValue = std::variant<double, bool, TelemetryStringId>;
+
+struct TelemetryMetric {
+    std::uint32_t keyId{0};
+    TelemetryValue value;
+
+    bool operator==(const TelemetryMetric&) const = default;
+};
+
+}
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "domain/telemetry_metric.h"
 
 namespace agri {
 
@@ -14,6 +19,44 @@ struct TelemetryPacket {
     std::string pubKeyId;
     std::string transport;
     std::string batchCode;
+    std::vector<TelemetryMetric> metrics;
+};
+
+struct TelemetryPacketView {
+    TelemetryPacketView() = default;
+    TelemetryPacketView(const TelemetryPacket& packet)
+        : deviceId(packet.deviceId),
+          timestamp(packet.timestamp),
+          telemetryJson(packet.telemetryJson),
+          hashHex(packet.hashHex),
+          signature(packet.signature),
+          pubKeyId(packet.pubKeyId),
+          transport(packet.transport),
+          batchCode(packet.batchCode),
+          metrics(packet.metrics) {}
+
+    TelemetryPacket Materialize() const {
+        return TelemetryPacket{
+            std::string(deviceId),
+            timestamp,
+            std::string(telemetryJson),
+            std::string(hashHex),
+            std::string(signature),
+            std::string(pubKeyId),
+            std::string(transport),
+            std::string(batchCode),
+            std::vector<TelemetryMetric>(metrics.begin(), metrics.end())};
+    }
+
+    std::string_view deviceId;
+    std::uint64_t timestamp{0};
+    std::string_view telemetryJson;
+    std::string_view hashHex;
+    std::string_view signature;
+    std::string_view pubKeyId;
+    std::string_view transport;
+    std::string_view batchCode;
+    std::span<const TelemetryMetric> metrics;
 };
 
 }
@@ -14,14 +14,14 @@ PublicKeyMap LoadPublicKeysFromDirectory(const std::string& directoryPath);
 class SignatureVerifier {
    public:
     virtual ~SignatureVerifier() = default;
-    virtual bool Verify(const TelemetryPacket& packet) const = 0;
+    virtual bool Verify(const TelemetryPacketView& packet) const = 0;
 };
 
 class BasicSignatureVerifier final : public SignatureVerifier {
    public:
     explicit BasicSignatureVerifier(PublicKeyMap publicKeys);
 
-    bool Verify(const TelemetryPacket& packet) const override;
+    bool Verify(const TelemetryPacketView& packet) const override;
 
    private:
     PublicKeyMap publicKeys_;
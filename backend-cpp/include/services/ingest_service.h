@@ -1,12 +1,17 @@
 #pragma once
 
 #include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "blockchain/blockchain_client.h"
 #include "domain/ingest_result.h"
 #include "domain/metrics_snapshot.h"
 #include "security/signature_verifier.h"
 #include "storage/telemetry_repository.h"
+#include "utils/hash_utils.h"
+#include "utils/work_stealing_pool.h"
 
 namespace agri {
 
@@ -17,12 +22,16 @@ class IngestService {
         const SignatureVerifier& signatureVerifier,
         BlockchainClient& blockchainClient);
 
-    IngestResult Ingest(const TelemetryPacket& packet);
+    IngestResult Ingest(const TelemetryPacketView& packet);
+    BatchIngestResult IngestBatch(const std::vector<TelemetryPacketView>& packets, WorkStealingPool* pool = nullptr);
     MetricsSnapshot GetMetricsSnapshot() const;
 
    private:
+    std::optional<std::string> Validate(
+        const TelemetryPacketView& packet, const Sha256Digest* payloadDigest = nullptr) const;
     void RecordAccepted(std::uint64_t processingMs);
     void RecordRejected(std::uint64_t processingMs);
+    void RecordBatch(std::size_t accepted, std::size_t rejected, std::uint64_t processingMs);
 
     TelemetryRepository& repository_;
     const SignatureVerifier& signatureVerifier_;
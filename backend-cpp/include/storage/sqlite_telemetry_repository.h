@@ -21,12 +21,18 @@ class SQLiteTelemetryRepository final : public TelemetryRepository {
     SQLiteTelemetryRepository(const SQLiteTelemetryRepository&) = delete;
     SQLiteTelemetryRepository& operator=(const SQLiteTelemetryRepository&) = delete;
 
-    std::uint64_t Save(const TelemetryPacket& packet) override;
+    std::uint64_t Save(const TelemetryPacketView& packet) override;
+    std::vector<std::uint64_t> SaveBatch(const std::vector<TelemetryPacketView>& packets) override;
     bool AttachReceipt(std::uint64_t recordId, const BlockchainReceipt& receipt) override;
+    bool AttachReceiptBatch(const std::vector<std::uint64_t>& recordIds, const BlockchainReceipt& receipt) override;
     bool Delete(std::uint64_t recordId) override;
     std::optional<TelemetryRecord> LatestByDevice(const std::string& deviceId) const override;
     std::optional<TelemetryRecord> FindByTransaction(const std::string& txHash) const override;
     std::vector<TelemetryRecord> FindByBatch(const std::string& batchCode) const override;
+    void ReadBatchPage(
+        TelemetryBatchCursor* cursor,
+        std::size_t limit,
+        std::vector<TelemetryRecord>* page) const override;
     std::uint64_t Size() const override;
 
    private:
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -10,16 +11,30 @@
 
 namespace agri {
 
+struct TelemetryBatchCursor {
+    std::string batchCode;
+    std::uint64_t lastTimestamp{0};
+    std::uint64_t lastRecordId{0};
+    bool started{false};
+    bool exhausted{false};
+};
+
 class TelemetryRepository {
    public:
     virtual ~TelemetryRepository() = default;
 
-    virtual std::uint64_t Save(const TelemetryPacket& packet) = 0;
+    virtual std::uint64_t Save(const TelemetryPacketView& packet) = 0;
+    virtual std::vector<std::uint64_t> SaveBatch(const std::vector<TelemetryPacketView>& packets) = 0;
     virtual bool AttachReceipt(std::uint64_t recordId, const BlockchainReceipt& receipt) = 0;
+    virtual bool AttachReceiptBatch(const std::vector<std::uint64_t>& recordIds, const BlockchainReceipt& receipt) = 0;
     virtual bool Delete(std::uint64_t recordId) = 0;
     virtual std::optional<TelemetryRecord> LatestByDevice(const std::string& deviceId) const = 0;
     virtual std::optional<TelemetryRecord> FindByTransaction(const std::string& txHash) const = 0;
     virtual std::vector<TelemetryRecord> FindByBatch(const std::string& batchCode) const = 0;
+    virtual void ReadBatchPage(
+        TelemetryBatchCursor* cursor,
+        std::size_t limit,
+        std::vector<TelemetryRecord>* page) const = 0;
     virtual std::uint64_t Size() const = 0;
 };
 
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "transport/json_parser.h"
+
+namespace agri {
+
+ParseTelemetryResult ParseTelemetryPacketCbor(std::string_view payload);
+bool ParseTelemetryBatchCbor(std::string_view payload, std::vector<ParseTelemetryResult>* packets, std::string* error);
+std::string RawEcdsaSignatureToDerHex(std::string_view raw);
+
+}
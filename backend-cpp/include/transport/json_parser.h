@@ -1,19 +1,33 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "domain/telemetry_packet.h"
+#include "utils/string_interner.h"
 
 namespace agri {
 
 struct ParseTelemetryResult {
     bool ok{false};
-    TelemetryPacket packet;
+    TelemetryPacketView packet;
     std::string error;
+    std::unique_ptr<TelemetryPacket> decoded;
+    std::vector<TelemetryMetric> metrics;
 };
 
 ParseTelemetryResult ParseTelemetryPacketJson(std::string_view payload);
+bool ApplyTelemetrySchema(std::uint32_t seen, TelemetryPacketView* packet, std::string* error);
+bool CheckTelemetryLengths(const TelemetryPacketView& packet, std::string* error);
+bool DecodeTelemetryMetrics(std::string_view telemetryJson, std::vector<TelemetryMetric>* metrics);
+bool InternTelemetryKey(std::string_view key, std::uint32_t* id);
+bool InternTelemetryValue(std::string_view value, std::uint32_t* id);
+StringInterner& TelemetryKeyTable();
+StringInterner& TelemetryValueTable();
+bool SplitTelemetryBatchJson(std::string_view payload, std::vector<std::string_view>* packets, std::string* error);
 bool IsHex64(std::string_view value);
 std::string JsonEscape(std::string_view value);
 
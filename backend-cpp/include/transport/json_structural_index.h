@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace agri {
+
+enum class JsonScanBackend {
+    kScalar,
+    kSse2,
+    kAvx2,
+    kNeon,
+};
+
+struct JsonStructuralIndex {
+    std::vector<std::uint32_t> positions;
+    std::size_t firstStringError{std::string_view::npos};
+    std::size_t firstBackslash{std::string_view::npos};
+};
+
+JsonScanBackend DefaultJsonScanBackend();
+bool JsonScanBackendSupported(JsonScanBackend backend);
+std::string_view JsonScanBackendName(JsonScanBackend backend);
+
+void BuildJsonStructuralIndex(std::string_view json, JsonScanBackend backend, JsonStructuralIndex* index);
+bool ScanJsonContainer(std::string_view json, std::size_t* length);
+bool ScanJsonContainer(std::string_view json, JsonScanBackend backend, std::size_t* length);
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "domain/telemetry_record.h"
+
+namespace agri {
+
+void AppendJsonEscaped(std::string_view value, std::string* out);
+
+class JsonWriter {
+   public:
+    explicit JsonWriter(std::string* out) : out_(out) {}
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+    JsonWriter& Key(std::string_view key);
+    JsonWriter& String(std::string_view value);
+    JsonWriter& Uint(std::uint64_t value);
+    JsonWriter& Bool(bool value);
+    JsonWriter& Null();
+    JsonWriter& Raw(std::string_view json);
+
+   private:
+    void Separate();
+
+    std::string* out_;
+    bool comma_{false};
+};
+
+void WriteBlockchainReceiptJson(const std::optional<BlockchainReceipt>& receipt, JsonWriter* writer);
+void WriteTelemetryRecordJson(const TelemetryRecord& record, JsonWriter* writer);
+
+}
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #ifndef AGRI_USE_OPENSSL
 #define AGRI_USE_OPENSSL 0
@@ -9,7 +14,25 @@
 
 namespace agri {
 
+using Sha256Digest = std::array<std::uint8_t, 32>;
+using Sha256Pieces = std::span<const std::string_view>;
+
+enum class Sha256Backend {
+    kScalar,
+    kShaNi,
+    kAvx2,
+    kAvx512,
+};
+
+Sha256Digest Sha256(std::initializer_list<std::string_view> pieces);
+Sha256Backend DefaultSha256Backend();
+bool Sha256BackendSupported(Sha256Backend backend);
+std::string_view Sha256BackendName(Sha256Backend backend);
+void Sha256Batch(std::span<const Sha256Pieces> messages, Sha256Digest* digests);
+void Sha256Batch(std::span<const Sha256Pieces> messages, Sha256Backend backend, Sha256Digest* digests);
+bool DecodeSha256Hex(std::string_view hex, Sha256Digest* digest);
 std::string Sha256Hex(std::string_view input);
+std::string MerkleRootHex(std::vector<std::string> leafHashesHex);
 std::string CurrentUtcIso8601();
 
 }
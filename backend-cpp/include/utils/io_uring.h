@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+struct msghdr;
+
+namespace agri {
+
+struct IoUringCompletion {
+    std::uint64_t userData{0};
+    std::int32_t result{0};
+    std::uint32_t flags{0};
+
+    bool More() const;
+    bool HasBuffer() const;
+    std::uint16_t BufferId() const;
+};
+
+class IoUring {
+   public:
+    IoUring();
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    static bool Available();
+
+    bool Init(unsigned entries);
+    bool RegisterBufferRing(std::uint16_t groupId, std::size_t bufferCount, std::size_t bufferBytes);
+
+    void PrepareMultishotAccept(int fd, int acceptFlags, std::uint64_t userData);
+    void PrepareMultishotRecv(int fd, std::uint16_t groupId, std::uint64_t userData);
+    void PrepareMultishotPoll(int fd, std::uint32_t events, std::uint64_t userData);
+    void PrepareSendMsg(int fd, const msghdr* message, int flags, bool linkNext, std::uint64_t userData);
+    void PrepareCancel(std::uint64_t targetUserData, std::uint64_t userData);
+
+    bool SubmitAndWait(int timeoutMs);
+    std::size_t ReapCompletions(std::vector<IoUringCompletion>* completions);
+
+    std::string_view Buffer(std::uint16_t bufferId, std::size_t length) const;
+    void RecycleBuffer(std::uint16_t bufferId);
+
+   private:
+    struct Ring;
+
+    void* NextSqe();
+
+    std::unique_ptr<Ring> ring_;
+};
+
+}
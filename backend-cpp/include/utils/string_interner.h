@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace agri {
+
+class StringInterner {
+   public:
+    static constexpr std::size_t kDefaultCapacity = 65536;
+
+    explicit StringInterner(std::size_t capacity = kDefaultCapacity);
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    bool Intern(std::string_view value, std::uint32_t* id);
+    bool Find(std::string_view value, std::uint32_t* id) const;
+    std::string_view Lookup(std::uint32_t id) const;
+    std::size_t Size() const;
+    std::uint64_t Overflows() const;
+
+   private:
+    std::size_t capacity_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string_view, std::uint32_t> ids_;
+    std::deque<std::string> values_;
+    std::atomic<std::uint64_t> overflows_{0};
+};
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace agri {
+
+class TimerWheel {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = std::uint32_t;
+
+    static constexpr TimerId kInvalidTimer = std::numeric_limits<TimerId>::max();
+    static constexpr std::chrono::milliseconds kDefaultTick{10};
+
+    explicit TimerWheel(std::chrono::milliseconds tick = kDefaultTick, Clock::time_point origin = Clock::now());
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    TimerId Create(std::uint64_t payload);
+    void Schedule(TimerId id, Clock::time_point deadline);
+    void Cancel(TimerId id);
+    void Destroy(TimerId id);
+    bool Scheduled(TimerId id) const;
+
+    void Advance(Clock::time_point now, std::vector<std::uint64_t>* expired);
+    int MillisecondsUntilNextExpiry(Clock::time_point now) const;
+    std::size_t ScheduledCount() const;
+
+   private:
+    static constexpr std::size_t kLevels = 4;
+    static constexpr unsigned kSlotBits = 6;
+    static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+    static constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+    struct Node {
+        std::uint32_t prev{kNone};
+        std::uint32_t next{kNone};
+        std::uint32_t bucket{0};
+        bool linked{false};
+        std::uint64_t expiry{0};
+        std::uint64_t payload{0};
+    };
+
+    std::uint64_t TickAt(Clock::time_point time, bool roundUp) const;
+    std::uint64_t NextEventTick() const;
+    void Link(std::uint32_t id);
+    void Unlink(std::uint32_t id);
+    void ProcessTick(std::uint64_t tick, std::vector<std::uint64_t>* expired);
+
+    std::chrono::milliseconds tick_;
+    Clock::time_point origin_;
+    std::uint64_t current_{0};
+    std::size_t scheduled_{0};
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> freeNodes_;
+    std::array<std::uint32_t, kLevels * kSlots> heads_;
+    std::array<std::uint64_t, kLevels> occupied_{};
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace agri {
+
+class WorkStealingPool {
+   public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(std::size_t workerCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void Submit(Task task);
+    void WaitIdle();
+    std::size_t WorkerCount() const;
+    std::uint64_t StolenTaskCount() const;
+    std::uint64_t FailedTaskCount() const;
+
+   private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(std::size_t index);
+    bool TryPopLocal(std::size_t index, Task* task);
+    bool TrySteal(std::size_t thief, Task* task);
+    void RunTask(Task& task);
+    void FinishTask();
+    void Park();
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<std::size_t> nextQueue_{0};
+    std::atomic<std::uint64_t> stolenTasks_{0};
+    std::atomic<std::uint64_t> failedTasks_{0};
+
+    // Submit and the pop paths only touch these counters and the per-worker queue locks. parkMutex_ is taken
+    // only when a worker is about to sleep or a submitter sees sleepers, and idleMutex_ only by WaitIdle and
+    // the task that brings unfinishedTasks_ to zero.
+    std::atomic<std::size_t> queuedTasks_{0};
+    std::atomic<std::size_t> unfinishedTasks_{0};
+    std::atomic<std::size_t> sleepingWorkers_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex parkMutex_;
+    std::condition_variable workAvailable_;
+    std::mutex idleMutex_;
+    std::condition_variable idle_;
+};
+
+}
@@ -0,0 +1,125 @@
+#include "api/admission_controller.h"
+
+#include <algorithm>
+
+namespace agri {
+
+AdmissionController::AdmissionController(AdmissionConfig config, Dispatcher dispatcher)
+    : config_(config), dispatcher_(std::move(dispatcher)) {
+    config_.maxInFlight = std::max<std::size_t>(1, config_.maxInFlight);
+    config_.quantumBytes = std::max<std::size_t>(1, config_.quantumBytes);
+}
+
+AdmissionDecision AdmissionController::Submit(std::string_view gateway, std::size_t costBytes, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inFlight_ < config_.maxInFlight && queued_ == 0) {
+            ++inFlight_;
+            ++admitted_;
+        } else if (queued_ >= config_.maxQueued) {
+            ++shedOverloaded_;
+            return AdmissionDecision::kOverloaded;
+        } else {
+            auto it = gateways_.find(gateway);
+            if (it == gateways_.end()) {
+                if (config_.maxQueuedPerGateway == 0) {
+                    ++shedGatewayLimited_;
+                    return AdmissionDecision::kGatewayLimited;
+                }
+                it = gateways_.emplace(std::string(gateway), Gateway{}).first;
+                active_.push_back(it->first);
+            } else if (it->second.queue.size() >= config_.maxQueuedPerGateway) {
+                ++shedGatewayLimited_;
+                return AdmissionDecision::kGatewayLimited;
+            }
+            it->second.queue.push_back(QueuedTask{costBytes, std::move(task)});
+            ++queued_;
+            return AdmissionDecision::kQueued;
+        }
+    }
+
+    Dispatch(std::move(task));
+    return AdmissionDecision::kAdmitted;
+}
+
+AdmissionSnapshot AdmissionController::Snapshot(std::size_t maxGateways) const {
+    AdmissionSnapshot snapshot;
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot.inFlight = inFlight_;
+    snapshot.queued = queued_;
+    snapshot.maxInFlight = config_.maxInFlight;
+    snapshot.maxQueued = config_.maxQueued;
+    snapshot.admitted = admitted_;
+    snapshot.shedOverloaded = shedOverloaded_;
+    snapshot.shedGatewayLimited = shedGatewayLimited_;
+
+    snapshot.queuedByGateway.reserve(gateways_.size());
+    for (const auto& [name, gateway] : gateways_) {
+        snapshot.queuedByGateway.emplace_back(name, gateway.queue.size());
+    }
+    std::sort(snapshot.queuedByGateway.begin(), snapshot.queuedByGateway.end(),
+              [](const auto& left, const auto& right) {
+                  return left.second != right.second ? left.second > right.second : left.first < right.first;
+              });
+    if (snapshot.queuedByGateway.size() > maxGateways) {
+        snapshot.queuedByGateway.resize(maxGateways);
+    }
+    return snapshot;
+}
+
+void AdmissionController::Dispatch(Task task) {
+    dispatcher_([this, task = std::move(task)]() {
+        try {
+            task();
+        } catch (...) {
+            Finish();
+            throw;
+        }
+        Finish();
+    });
+}
+
+void AdmissionController::Finish() {
+    Task next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!PopNextLocked(&next)) {
+            --inFlight_;
+            return;
+        }
+        ++admitted_;
+    }
+    Dispatch(std::move(next));
+}
+
+bool AdmissionController::PopNextLocked(Task* task) {
+    while (!active_.empty()) {
+        const auto it = gateways_.find(active_.front());
+        Gateway& gateway = it->second;
+        if (!gateway.turnStarted) {
+            gateway.deficit += config_.quantumBytes;
+            gateway.turnStarted = true;
+        }
+
+        QueuedTask& head = gateway.queue.front();
+        if (head.cost <= gateway.deficit) {
+            gateway.deficit -= head.cost;
+            *task = std::move(head.task);
+            gateway.queue.pop_front();
+            --queued_;
+            if (gateway.queue.empty()) {
+                gateways_.erase(it);
+                active_.pop_front();
+            }
+            return true;
+        }
+
+        gateway.turnStarted = false;
+        std::string key = std::move(active_.front());
+        active_.pop_front();
+        active_.push_back(std::move(key));
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,520 @@
+#include "api/frame_ingest_listener.h"
+
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "transport/cbor_parser.h"
+#include "transport/json_parser.h"
+
+namespace agri {
+
+namespace {
+
+constexpr int kListenBacklog = 256;
+constexpr int kMaxEvents = 64;
+constexpr std::size_t kReadChunkBytes = 16 * 1024;
+constexpr std::size_t kSequenceBytes = 4;
+constexpr std::size_t kLengthBytes = 4;
+
+std::uint32_t ReadBigEndian32(const char* bytes) {
+    return (static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[0])) << 24) |
+           (static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[1])) << 16) |
+           (static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[2])) << 8) |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[3]));
+}
+
+void AppendBigEndian(std::uint64_t value, std::size_t width, std::string* out) {
+    for (std::size_t i = width; i > 0; --i) {
+        out->push_back(static_cast<char>((value >> (8 * (i - 1))) & 0xFF));
+    }
+}
+
+int OpenSocket(int type, std::uint16_t port) {
+    const int fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("failed to create frame ingest socket");
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        throw std::runtime_error("failed to bind frame ingest port " + std::to_string(port));
+    }
+    if (type == SOCK_STREAM && listen(fd, kListenBacklog) < 0) {
+        close(fd);
+        throw std::runtime_error("failed to listen on frame ingest port " + std::to_string(port));
+    }
+    return fd;
+}
+
+bool LooksLikeJson(std::string_view payload) {
+    const std::size_t first = payload.find_first_not_of(" \t\r\n");
+    return first != std::string_view::npos && payload[first] == '{';
+}
+
+}
+
+std::string EncodeFrameAck(std::uint32_t sequence, FrameAckStatus status, std::uint64_t recordId, std::string_view message) {
+    std::string ack;
+    ack.reserve(kSequenceBytes + 1 + 8 + message.size());
+    AppendBigEndian(sequence, kSequenceBytes, &ack);
+    ack.push_back(static_cast<char>(status));
+    AppendBigEndian(recordId, 8, &ack);
+    ack.append(message);
+    return ack;
+}
+
+FrameIngestListener::FrameIngestListener(FrameIngestConfig config, IngestService& ingestService, IngestObserver observer)
+    : config_(config), ingestService_(ingestService), observer_(std::move(observer)) {
+    workerPool_ = std::make_unique<WorkStealingPool>(std::max<std::size_t>(1, config_.workerThreads));
+    config_.udpBatchSize = std::max<std::size_t>(1, config_.udpBatchSize);
+    config_.maxUdpBatchesInFlight = std::max<std::size_t>(1, config_.maxUdpBatchesInFlight);
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        CloseSockets();
+        throw std::runtime_error("failed to create frame ingest event loop");
+    }
+}
+
+FrameIngestListener::~FrameIngestListener() {
+    CloseSockets();
+}
+
+void FrameIngestListener::Start() {
+    OpenSockets();
+
+    epoll_event events[kMaxEvents];
+    while (running_) {
+        const int ready = epoll_wait(epollFd_, events, kMaxEvents, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                std::uint64_t value = 0;
+                [[maybe_unused]] const ssize_t drained = read(wakeFd_, &value, sizeof(value));
+                DrainCompletions();
+            } else if (fd == tcpFd_) {
+                AcceptConnections();
+            } else if (fd == udpFd_) {
+                ReadDatagrams();
+            } else {
+                HandleConnectionEvent(fd, events[i].events);
+            }
+        }
+    }
+
+    workerPool_->WaitIdle();
+    CloseSockets();
+}
+
+void FrameIngestListener::Stop() {
+    running_ = false;
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written = write(wakeFd_, &one, sizeof(one));
+}
+
+FrameIngestStats FrameIngestListener::Stats() const {
+    FrameIngestStats stats;
+    stats.tcpConnections = tcpConnections_.load();
+    stats.tcpFrames = tcpFrames_.load();
+    stats.udpDatagrams = udpDatagrams_.load();
+    stats.malformedFrames = malformedFrames_.load();
+    stats.ingestBatches = ingestBatches_.load();
+    return stats;
+}
+
+void FrameIngestListener::OpenSockets() {
+    if (config_.tcpPort != 0) {
+        tcpFd_ = OpenSocket(SOCK_STREAM, config_.tcpPort);
+    }
+    if (config_.udpPort != 0) {
+        udpFd_ = OpenSocket(SOCK_DGRAM, config_.udpPort);
+        datagramBuffer_.resize(config_.udpBatchSize * config_.maxDatagramBytes);
+    }
+
+    for (const int fd : {wakeFd_, tcpFd_, udpFd_}) {
+        if (fd < 0) {
+            continue;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            throw std::runtime_error("failed to register frame ingest socket");
+        }
+    }
+}
+
+void FrameIngestListener::CloseSockets() {
+    for (auto& entry : connections_) {
+        close(entry.first);
+    }
+    connections_.clear();
+    for (int* fd : {&tcpFd_, &udpFd_, &wakeFd_, &epollFd_}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void FrameIngestListener::AcceptConnections() {
+    while (true) {
+        const int clientFd = accept4(tcpFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            return;
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->fd = clientFd;
+        connection->id = nextConnectionId_++;
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = clientFd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, clientFd, &event) < 0) {
+            close(clientFd);
+            continue;
+        }
+        connections_[clientFd] = std::move(connection);
+        ++tcpConnections_;
+    }
+}
+
+void FrameIngestListener::HandleConnectionEvent(int fd, std::uint32_t events) {
+    const auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+        return;
+    }
+    Connection* connection = it->second.get();
+
+    if ((events & EPOLLOUT) != 0 && !FlushConnection(connection)) {
+        CloseConnection(fd);
+        return;
+    }
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0 && !connection->peerClosed) {
+        char buffer[kReadChunkBytes];
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection->readBuffer.append(buffer, static_cast<std::size_t>(received));
+        } else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            connection->peerClosed = true;
+        }
+    }
+
+    DispatchFrames(connection);
+    if (connections_.count(fd) == 0) {
+        return;
+    }
+    if (connection->peerClosed && !connection->batchInFlight && connection->writeBuffer.empty()) {
+        CloseConnection(fd);
+        return;
+    }
+    UpdateInterest(connection);
+}
+
+void FrameIngestListener::DispatchFrames(Connection* connection) {
+    if (connection->batchInFlight) {
+        return;
+    }
+
+    std::vector<Frame> frames;
+    std::size_t offset = 0;
+    const std::string& buffer = connection->readBuffer;
+    while (buffer.size() - offset >= kLengthBytes) {
+        const std::size_t length = ReadBigEndian32(buffer.data() + offset);
+        if (length < kSequenceBytes || length > config_.maxFrameBytes) {
+            ++malformedFrames_;
+            CloseConnection(connection->fd);
+            return;
+        }
+        if (buffer.size() - offset - kLengthBytes < length) {
+            break;
+        }
+        const char* body = buffer.data() + offset + kLengthBytes;
+        Frame frame;
+        frame.sequence = ReadBigEndian32(body);
+        frame.payload.assign(body + kSequenceBytes, length - kSequenceBytes);
+        frames.push_back(std::move(frame));
+        offset += kLengthBytes + length;
+    }
+    connection->readBuffer.erase(0, offset);
+    if (frames.empty()) {
+        return;
+    }
+
+    tcpFrames_ += frames.size();
+    connection->batchInFlight = true;
+    const int fd = connection->fd;
+    const std::uint64_t connectionId = connection->id;
+    workerPool_->Submit([this, fd, connectionId, frames = std::move(frames)]() {
+        Completion completion{fd, connectionId, {}};
+        for (const std::string& ack : IngestFrames(frames)) {
+            AppendBigEndian(ack.size(), kLengthBytes, &completion.acks);
+            completion.acks.append(ack);
+        }
+        PostCompletion(std::move(completion));
+    });
+}
+
+bool FrameIngestListener::FlushConnection(Connection* connection) {
+    std::size_t sent = 0;
+    while (sent < connection->writeBuffer.size()) {
+        const ssize_t written = send(connection->fd,
+                                     connection->writeBuffer.data() + sent,
+                                     connection->writeBuffer.size() - sent,
+                                     MSG_NOSIGNAL);
+        if (written > 0) {
+            sent += static_cast<std::size_t>(written);
+            continue;
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            break;
+        }
+        return false;
+    }
+    connection->writeBuffer.erase(0, sent);
+    return true;
+}
+
+void FrameIngestListener::UpdateInterest(Connection* connection) {
+    if (connection->peerClosed && connection->writeBuffer.empty()) {
+        if (connection->watched) {
+            epoll_ctl(epollFd_, EPOLL_CTL_DEL, connection->fd, nullptr);
+            connection->watched = false;
+        }
+        return;
+    }
+    const bool backlogged = connection->batchInFlight && connection->readBuffer.size() > config_.maxFrameBytes;
+    epoll_event event{};
+    event.events = ((connection->peerClosed || backlogged) ? 0U : static_cast<std::uint32_t>(EPOLLIN)) |
+                   (connection->writeBuffer.empty() ? 0U : static_cast<std::uint32_t>(EPOLLOUT));
+    event.data.fd = connection->fd;
+    epoll_ctl(epollFd_, connection->watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, connection->fd, &event);
+    connection->watched = true;
+}
+
+void FrameIngestListener::CloseConnection(int fd) {
+    const auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+        return;
+    }
+    if (it->second->watched) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    close(fd);
+    connections_.erase(it);
+}
+
+void FrameIngestListener::ReadDatagrams() {
+    if (udpBatchesInFlight_.load() >= config_.maxUdpBatchesInFlight) {
+        SetUdpInterest(false);
+        return;
+    }
+
+    const std::size_t batch = config_.udpBatchSize;
+    std::vector<mmsghdr> messages(batch);
+    std::vector<iovec> iovecs(batch);
+    std::vector<sockaddr_in> peers(batch);
+    for (std::size_t i = 0; i < batch; ++i) {
+        iovecs[i].iov_base = datagramBuffer_.data() + i * config_.maxDatagramBytes;
+        iovecs[i].iov_len = config_.maxDatagramBytes;
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &peers[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+
+    const int received = recvmmsg(udpFd_, messages.data(), static_cast<unsigned int>(batch), MSG_DONTWAIT, nullptr);
+    if (received <= 0) {
+        return;
+    }
+
+    std::vector<Frame> frames;
+    frames.reserve(static_cast<std::size_t>(received));
+    for (int i = 0; i < received; ++i) {
+        const char* data = static_cast<const char*>(iovecs[i].iov_base);
+        const std::size_t length = messages[i].msg_len;
+        if (length < kSequenceBytes) {
+            ++malformedFrames_;
+            continue;
+        }
+        Frame frame;
+        frame.sequence = ReadBigEndian32(data);
+        frame.payload.assign(data + kSequenceBytes, length - kSequenceBytes);
+        frame.truncated = (messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+        frame.peer = peers[i];
+        frames.push_back(std::move(frame));
+    }
+    udpDatagrams_ += static_cast<std::uint64_t>(received);
+    if (frames.empty()) {
+        return;
+    }
+
+    ++udpBatchesInFlight_;
+    workerPool_->Submit([this, frames = std::move(frames)]() mutable {
+        std::vector<std::string> acks = IngestFrames(frames);
+        std::vector<mmsghdr> replies(acks.size());
+        std::vector<iovec> replyIovecs(acks.size());
+        for (std::size_t i = 0; i < acks.size(); ++i) {
+            replyIovecs[i].iov_base = acks[i].data();
+            replyIovecs[i].iov_len = acks[i].size();
+            replies[i].msg_hdr.msg_iov = &replyIovecs[i];
+            replies[i].msg_hdr.msg_iovlen = 1;
+            replies[i].msg_hdr.msg_name = &frames[i].peer;
+            replies[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+        std::size_t sent = 0;
+        while (sent < replies.size()) {
+            const int result = sendmmsg(udpFd_, replies.data() + sent, static_cast<unsigned int>(replies.size() - sent), 0);
+            if (result <= 0) {
+                break;
+            }
+            sent += static_cast<std::size_t>(result);
+        }
+        --udpBatchesInFlight_;
+        PostCompletion(Completion{});
+    });
+}
+
+void FrameIngestListener::SetUdpInterest(bool enabled) {
+    if (udpPaused_ == !enabled) {
+        return;
+    }
+    epoll_event event{};
+    event.events = enabled ? static_cast<std::uint32_t>(EPOLLIN) : 0U;
+    event.data.fd = udpFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, udpFd_, &event);
+    udpPaused_ = !enabled;
+}
+
+void FrameIngestListener::PostCompletion(Completion completion) {
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        completions_.push_back(std::move(completion));
+    }
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written = write(wakeFd_, &one, sizeof(one));
+}
+
+void FrameIngestListener::DrainCompletions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        ready.swap(completions_);
+    }
+
+    for (Completion& completion : ready) {
+        if (completion.fd < 0) {
+            if (udpPaused_ && udpBatchesInFlight_.load() < config_.maxUdpBatchesInFlight) {
+                SetUdpInterest(true);
+            }
+            continue;
+        }
+        const auto it = connections_.find(completion.fd);
+        if (it == connections_.end() || it->second->id != completion.connectionId) {
+            continue;
+        }
+        Connection* connection = it->second.get();
+        connection->batchInFlight = false;
+        connection->writeBuffer.append(completion.acks);
+        if (!FlushConnection(connection)) {
+            CloseConnection(completion.fd);
+            continue;
+        }
+        HandleConnectionEvent(completion.fd, 0);
+    }
+}
+
+std::vector<std::string> FrameIngestListener::IngestFrames(const std::vector<Frame>& frames) {
+    // Both callers hold flow control (batchInFlight, udpBatchesInFlight_) until the batch answers, so a throwing
+    // repository or observer must still produce an ack for every frame instead of escaping into the pool.
+    try {
+        return ParseAndIngest(frames);
+    } catch (const std::exception& ex) {
+        std::cerr << "frame batch of " << frames.size() << " failed: " << ex.what() << std::endl;
+        return RejectFrames(frames, std::string("ingest failed: ") + ex.what());
+    } catch (...) {
+        std::cerr << "frame batch of " << frames.size() << " failed" << std::endl;
+        return RejectFrames(frames, "ingest failed: unknown error");
+    }
+}
+
+std::vector<std::string> FrameIngestListener::RejectFrames(const std::vector<Frame>& frames, std::string_view message) {
+    std::vector<std::string> acks;
+    acks.reserve(frames.size());
+    for (const Frame& frame : frames) {
+        acks.push_back(EncodeFrameAck(frame.sequence, FrameAckStatus::kRejected, 0, message));
+    }
+    return acks;
+}
+
+std::vector<std::string> FrameIngestListener::ParseAndIngest(const std::vector<Frame>& frames) {
+    std::vector<ParseTelemetryResult> parsed;
+    parsed.reserve(frames.size());
+    std::vector<TelemetryPacketView> packets;
+    packets.reserve(frames.size());
+    for (const Frame& frame : frames) {
+        if (frame.truncated) {
+            ParseTelemetryResult truncated;
+            truncated.error = "datagram exceeds " + std::to_string(config_.maxDatagramBytes) + " bytes";
+            parsed.push_back(std::move(truncated));
+        } else {
+            parsed.push_back(LooksLikeJson(frame.payload) ? ParseTelemetryPacketJson(frame.payload)
+                                                          : ParseTelemetryPacketCbor(frame.payload));
+        }
+        if (parsed.back().ok) {
+            packets.push_back(parsed.back().packet);
+        } else {
+            ++malformedFrames_;
+        }
+    }
+
+    BatchIngestResult batch;
+    if (!packets.empty()) {
+        batch = ingestService_.IngestBatch(packets, workerPool_.get());
+        ++ingestBatches_;
+    }
+
+    std::vector<std::string> acks;
+    acks.reserve(frames.size());
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        if (!parsed[i].ok) {
+            acks.push_back(EncodeFrameAck(frames[i].sequence, FrameAckStatus::kMalformed, 0, parsed[i].error));
+            continue;
+        }
+        const IngestResult& result = batch.results[next];
+        if (observer_) {
+            observer_(packets[next], result);
+        }
+        ++next;
+        acks.push_back(EncodeFrameAck(frames[i].sequence,
+                                      result.accepted ? FrameAckStatus::kAccepted : FrameAckStatus::kRejected,
+                                      result.recordId,
+                                      result.accepted ? std::string_view() : std::string_view(result.message)));
+    }
+    return acks;
+}
+
+}
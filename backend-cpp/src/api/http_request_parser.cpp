@@ -0,0 +1,316 @@
+#include "api/http_request_parser.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace agri {
+
+namespace {
+
+constexpr char ToLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool IsOptionalWhitespace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+std::string_view TrimOptionalWhitespace(std::string_view text) {
+    while (!text.empty() && IsOptionalWhitespace(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && IsOptionalWhitespace(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+HttpHeaderId LookupHeaderId(std::string_view name) {
+    switch (name.size()) {
+        case 4:
+            return EqualsIgnoreCase(name, "host") ? HttpHeaderId::kHost : HttpHeaderId::kOther;
+        case 7:
+            return EqualsIgnoreCase(name, "upgrade") ? HttpHeaderId::kUpgrade : HttpHeaderId::kOther;
+        case 10:
+            return EqualsIgnoreCase(name, "connection") ? HttpHeaderId::kConnection : HttpHeaderId::kOther;
+        case 12:
+            return EqualsIgnoreCase(name, "content-type") ? HttpHeaderId::kContentType : HttpHeaderId::kOther;
+        case 14:
+            return EqualsIgnoreCase(name, "content-length") ? HttpHeaderId::kContentLength : HttpHeaderId::kOther;
+        case 17:
+            if (EqualsIgnoreCase(name, "sec-websocket-key")) {
+                return HttpHeaderId::kSecWebSocketKey;
+            }
+            return EqualsIgnoreCase(name, "transfer-encoding") ? HttpHeaderId::kTransferEncoding
+                                                               : HttpHeaderId::kOther;
+        case 24:
+            return EqualsIgnoreCase(name, "sec-websocket-extensions") ? HttpHeaderId::kSecWebSocketExtensions
+                                                                      : HttpHeaderId::kOther;
+        default:
+            return HttpHeaderId::kOther;
+    }
+}
+
+std::string_view Shift(std::string_view view, const char* from, const char* to) {
+    if (view.data() == nullptr) {
+        return view;
+    }
+    return std::string_view(to + (view.data() - from), view.size());
+}
+
+}
+
+bool EqualsIgnoreCase(std::string_view left, std::string_view right) {
+    if (left.size() != right.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        if (ToLowerAscii(left[i]) != ToLowerAscii(right[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HeaderHasToken(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        const std::size_t comma = value.find(',');
+        const std::string_view item = TrimOptionalWhitespace(value.substr(0, comma));
+        if (EqualsIgnoreCase(item, token)) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool HasMediaType(std::string_view contentType, std::string_view mediaType) {
+    return EqualsIgnoreCase(TrimOptionalWhitespace(contentType.substr(0, contentType.find(';'))), mediaType);
+}
+
+bool HttpHeaderTable::Add(std::string_view name, std::string_view value, HttpHeaderId id) {
+    if (size_ == kMaxHeaders) {
+        return false;
+    }
+    fields_[size_] = HttpHeaderField{name, value, id};
+    const auto slot = static_cast<std::size_t>(id);
+    if (id != HttpHeaderId::kOther && slotById_[slot] == 0) {
+        slotById_[slot] = static_cast<std::uint8_t>(size_ + 1);
+    }
+    ++size_;
+    return true;
+}
+
+std::string_view HttpHeaderTable::Get(HttpHeaderId id) const {
+    const std::uint8_t slot = slotById_[static_cast<std::size_t>(id)];
+    return (slot == 0) ? std::string_view() : fields_[slot - 1].value;
+}
+
+std::string_view HttpHeaderTable::Get(std::string_view name) const {
+    for (std::size_t i = 0; i < size_; ++i) {
+        if (EqualsIgnoreCase(fields_[i].name, name)) {
+            return fields_[i].value;
+        }
+    }
+    return std::string_view();
+}
+
+void HttpHeaderTable::Clear() {
+    size_ = 0;
+    slotById_.fill(0);
+}
+
+void HttpHeaderTable::Rebase(const char* from, const char* to) {
+    for (std::size_t i = 0; i < size_; ++i) {
+        fields_[i].name = Shift(fields_[i].name, from, to);
+        fields_[i].value = Shift(fields_[i].value, from, to);
+    }
+}
+
+void HttpRequest::Rebase(const char* from, const char* to) {
+    method = Shift(method, from, to);
+    target = Shift(target, from, to);
+    path = Shift(path, from, to);
+    query = Shift(query, from, to);
+    version = Shift(version, from, to);
+    body = Shift(body, from, to);
+    headers.Rebase(from, to);
+}
+
+HttpRequestParser::HttpRequestParser(std::size_t maxBodyBytes) : maxBodyBytes_(maxBodyBytes) {}
+
+HttpRequestParser::Status HttpRequestParser::Parse(std::string_view buffer) {
+    if (state_ == State::kDone) {
+        return Status::kComplete;
+    }
+    if (state_ == State::kFailed) {
+        return Status::kError;
+    }
+
+    while (state_ == State::kRequestLine || state_ == State::kHeaders) {
+        const void* newline = (scanOffset_ < buffer.size())
+                                  ? std::memchr(buffer.data() + scanOffset_, '\n', buffer.size() - scanOffset_)
+                                  : nullptr;
+        if (newline == nullptr) {
+            scanOffset_ = buffer.size();
+            if (scanOffset_ > kMaxHeaderBytes) {
+                return Fail(431, "request header too large");
+            }
+            return Status::kIncomplete;
+        }
+
+        const std::size_t lineEnd = static_cast<std::size_t>(static_cast<const char*>(newline) - buffer.data());
+        scanOffset_ = lineEnd + 1;
+        if (scanOffset_ > kMaxHeaderBytes) {
+            return Fail(431, "request header too large");
+        }
+
+        std::size_t contentEnd = lineEnd;
+        if (contentEnd > lineStart_ && buffer[contentEnd - 1] == '\r') {
+            --contentEnd;
+        }
+        const std::string_view line = buffer.substr(lineStart_, contentEnd - lineStart_);
+
+        if (state_ == State::kRequestLine) {
+            if (!line.empty()) {
+                if (!ParseRequestLine(line)) {
+                    return Status::kError;
+                }
+                state_ = State::kHeaders;
+            }
+        } else if (line.empty()) {
+            bodyStart_ = scanOffset_;
+            state_ = State::kBody;
+        } else if (!ParseHeaderLine(line, lineStart_)) {
+            return Status::kError;
+        }
+        lineStart_ = scanOffset_;
+    }
+
+    if (buffer.size() - bodyStart_ < contentLength_) {
+        return Status::kIncomplete;
+    }
+    return Finish(buffer);
+}
+
+void HttpRequestParser::Reset() {
+    state_ = State::kRequestLine;
+    scanOffset_ = 0;
+    lineStart_ = 0;
+    bodyStart_ = 0;
+    contentLength_ = 0;
+    haveContentLength_ = false;
+    consumed_ = 0;
+    headerCount_ = 0;
+    errorStatus_ = 0;
+    errorMessage_ = std::string_view();
+}
+
+HttpRequestParser::Status HttpRequestParser::Fail(int status, std::string_view message) {
+    state_ = State::kFailed;
+    errorStatus_ = status;
+    errorMessage_ = message;
+    return Status::kError;
+}
+
+bool HttpRequestParser::ParseRequestLine(std::string_view line) {
+    const std::size_t methodEnd = line.find(' ');
+    if (methodEnd == std::string_view::npos || methodEnd == 0) {
+        Fail(400, "invalid HTTP request");
+        return false;
+    }
+    const std::size_t targetEnd = line.find(' ', methodEnd + 1);
+    if (targetEnd == std::string_view::npos || targetEnd == methodEnd + 1) {
+        Fail(400, "invalid HTTP request");
+        return false;
+    }
+
+    const std::string_view version = line.substr(targetEnd + 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        Fail(400, "unsupported HTTP version");
+        return false;
+    }
+
+    const auto base = static_cast<std::uint32_t>(lineStart_);
+    method_ = Span{base, static_cast<std::uint32_t>(methodEnd)};
+    target_ = Span{base + static_cast<std::uint32_t>(methodEnd + 1),
+                   static_cast<std::uint32_t>(targetEnd - methodEnd - 1)};
+    version_ = Span{base + static_cast<std::uint32_t>(targetEnd + 1), static_cast<std::uint32_t>(version.size())};
+    return true;
+}
+
+bool HttpRequestParser::ParseHeaderLine(std::string_view line, std::size_t lineOffset) {
+    const std::size_t colon = line.find(':');
+    if (colon == std::string_view::npos || colon == 0 || IsOptionalWhitespace(line.front()) ||
+        IsOptionalWhitespace(line[colon - 1])) {
+        Fail(400, "invalid HTTP header");
+        return false;
+    }
+    if (headerCount_ == headers_.size()) {
+        Fail(431, "too many request headers");
+        return false;
+    }
+
+    const std::string_view name = line.substr(0, colon);
+    const std::string_view value = TrimOptionalWhitespace(line.substr(colon + 1));
+    const HttpHeaderId id = LookupHeaderId(name);
+
+    if (id == HttpHeaderId::kTransferEncoding) {
+        Fail(501, "transfer-encoding request bodies are not supported");
+        return false;
+    }
+    if (id == HttpHeaderId::kContentLength) {
+        std::size_t length = 0;
+        const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+        if (ec != std::errc() || end != value.data() + value.size() || value.empty() ||
+            (haveContentLength_ && length != contentLength_)) {
+            Fail(400, "invalid Content-Length");
+            return false;
+        }
+        if (length > maxBodyBytes_) {
+            Fail(413, "request too large");
+            return false;
+        }
+        contentLength_ = length;
+        haveContentLength_ = true;
+    }
+
+    const auto lineBase = static_cast<std::uint32_t>(lineOffset);
+    HeaderSpan& header = headers_[headerCount_++];
+    header.name = Span{lineBase, static_cast<std::uint32_t>(name.size())};
+    header.value = Span{lineBase + static_cast<std::uint32_t>(value.data() - line.data()),
+                        static_cast<std::uint32_t>(value.size())};
+    header.id = id;
+    return true;
+}
+
+HttpRequestParser::Status HttpRequestParser::Finish(std::string_view buffer) {
+    auto view = [&buffer](Span span) { return buffer.substr(span.offset, span.length); };
+
+    request_.method = view(method_);
+    request_.target = view(target_);
+    request_.version = view(version_);
+    request_.body = buffer.substr(bodyStart_, contentLength_);
+
+    const std::size_t queryPos = request_.target.find('?');
+    request_.path = request_.target.substr(0, queryPos);
+    request_.query = (queryPos == std::string_view::npos) ? std::string_view() : request_.target.substr(queryPos + 1);
+
+    request_.headers.Clear();
+    for (std::size_t i = 0; i < headerCount_; ++i) {
+        request_.headers.Add(view(headers_[i].name), view(headers_[i].value), headers_[i].id);
+    }
+
+    const std::string_view connection = request_.headers.Get(HttpHeaderId::kConnection);
+    request_.keepAlive = (request_.version == "HTTP/1.1") ? !HeaderHasToken(connection, "close")
+                                                           : HeaderHasToken(connection, "keep-alive");
+
+    consumed_ = bodyStart_ + contentLength_;
+    state_ = State::kDone;
+    return Status::kComplete;
+}
+
+}
@@ -0,0 +1,402 @@
+#include "api/http_response_writer.h"
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <utility>
+
+namespace agri {
+
+namespace {
+
+constexpr std::size_t kMaxIovecs = 64;
+
+struct StatusEntry {
+    int code;
+    std::string_view text;
+    std::string_view line;
+};
+
+constexpr StatusEntry kStatusEntries[] = {
+    {200, "OK", "HTTP/1.1 200 OK\r\n"},
+    {202, "Accepted", "HTTP/1.1 202 Accepted\r\n"},
+    {400, "Bad Request", "HTTP/1.1 400 Bad Request\r\n"},
+    {404, "Not Found", "HTTP/1.1 404 Not Found\r\n"},
+    {413, "Payload Too Large", "HTTP/1.1 413 Payload Too Large\r\n"},
+    {429, "Too Many Requests", "HTTP/1.1 429 Too Many Requests\r\n"},
+    {431, "Request Header Fields Too Large", "HTTP/1.1 431 Request Header Fields Too Large\r\n"},
+    {500, "Internal Server Error", "HTTP/1.1 500 Internal Server Error\r\n"},
+    {501, "Not Implemented", "HTTP/1.1 501 Not Implemented\r\n"},
+    {503, "Service Unavailable", "HTTP/1.1 503 Service Unavailable\r\n"},
+};
+
+constexpr std::string_view kJsonContentTypeHeader = "Content-Type: application/json\r\n";
+constexpr std::string_view kKeepAliveTail = "\r\nConnection: keep-alive\r\n\r\n";
+constexpr std::string_view kCloseTail = "\r\nConnection: close\r\n\r\n";
+
+const StatusEntry* FindStatus(int statusCode) {
+    for (const StatusEntry& entry : kStatusEntries) {
+        if (entry.code == statusCode) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool IsZeroCopyNotification(const cmsghdr* cmsg) {
+    return (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+           (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+}
+
+}
+
+std::string_view StatusText(int statusCode) {
+    const StatusEntry* entry = FindStatus(statusCode);
+    return (entry != nullptr) ? entry->text : std::string_view("Internal Server Error");
+}
+
+void ResponseHeaderBlock::Render(
+    int statusCode,
+    std::string_view contentType,
+    std::size_t contentLength,
+    bool keepAlive,
+    std::uint32_t retryAfterSeconds) {
+    size_ = 0;
+    AppendStatusLine(statusCode);
+    AppendContentType(contentType);
+    Append("Content-Length: ");
+
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), contentLength);
+    Append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+    if (retryAfterSeconds > 0) {
+        result = std::to_chars(digits, digits + sizeof(digits), retryAfterSeconds);
+        Append("\r\nRetry-After: ");
+        Append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+    }
+    Append(keepAlive ? kKeepAliveTail : kCloseTail);
+}
+
+void ResponseHeaderBlock::RenderChunked(int statusCode, std::string_view contentType, bool keepAlive) {
+    size_ = 0;
+    AppendStatusLine(statusCode);
+    AppendContentType(contentType);
+    Append("Transfer-Encoding: chunked");
+    Append(keepAlive ? kKeepAliveTail : kCloseTail);
+}
+
+void ResponseHeaderBlock::RenderCloseDelimited(int statusCode, std::string_view contentType) {
+    size_ = 0;
+    AppendStatusLine(statusCode);
+    AppendContentType(contentType);
+    Append("Connection: close\r\n\r\n");
+}
+
+void ResponseHeaderBlock::RenderChunkSize(std::size_t size, bool afterChunk) {
+    size_ = 0;
+    if (afterChunk) {
+        Append("\r\n");
+    }
+    AppendHex(size);
+    Append(size == 0 ? "\r\n\r\n" : "\r\n");
+}
+
+void ResponseHeaderBlock::AppendStatusLine(int statusCode) {
+    if (const StatusEntry* entry = FindStatus(statusCode); entry != nullptr) {
+        Append(entry->line);
+        return;
+    }
+    char code[16];
+    const auto result = std::to_chars(code, code + sizeof(code), statusCode);
+    Append("HTTP/1.1 ");
+    Append(std::string_view(code, static_cast<std::size_t>(result.ptr - code)));
+    Append(" Internal Server Error\r\n");
+}
+
+void ResponseHeaderBlock::AppendContentType(std::string_view contentType) {
+    if (contentType == "application/json") {
+        Append(kJsonContentTypeHeader);
+        return;
+    }
+    Append("Content-Type: ");
+    Append(contentType);
+    Append("\r\n");
+}
+
+void ResponseHeaderBlock::AppendHex(std::size_t value) {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value, 16);
+    Append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+}
+
+void ResponseHeaderBlock::Append(std::string_view text) {
+    const std::size_t length = std::min(text.size(), kCapacity - size_);
+    std::memcpy(bytes_.data() + size_, text.data(), length);
+    size_ += length;
+}
+
+void OutboundQueue::EnableZeroCopy(int fd, std::size_t thresholdBytes) {
+#ifdef SO_ZEROCOPY
+    if (thresholdBytes == 0) {
+        return;
+    }
+    int enabled = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enabled, sizeof(enabled)) == 0) {
+        zeroCopyThreshold_ = thresholdBytes;
+    }
+#else
+    (void)fd;
+    (void)thresholdBytes;
+#endif
+}
+
+void OutboundQueue::PushResponse(
+    int statusCode,
+    std::string_view contentType,
+    std::string body,
+    bool keepAlive,
+    std::uint32_t retryAfterSeconds) {
+    Entry& entry = entries_.emplace_back();
+    entry.head.Render(statusCode, contentType, body.size(), keepAlive, retryAfterSeconds);
+    entry.hasHead = true;
+    entry.zeroCopy = zeroCopyThreshold_ > 0 && body.size() >= zeroCopyThreshold_;
+    entry.body = std::move(body);
+    pendingBytes_ += entry.head.View().size() + entry.body.size();
+}
+
+void OutboundQueue::PushChunkedHead(int statusCode, std::string_view contentType, bool keepAlive) {
+    Entry& entry = entries_.emplace_back();
+    entry.head.RenderChunked(statusCode, contentType, keepAlive);
+    entry.hasHead = true;
+    pendingBytes_ += entry.head.View().size();
+    chunkOpen_ = false;
+    chunked_ = true;
+}
+
+void OutboundQueue::PushCloseDelimitedHead(int statusCode, std::string_view contentType) {
+    Entry& entry = entries_.emplace_back();
+    entry.head.RenderCloseDelimited(statusCode, contentType);
+    entry.hasHead = true;
+    pendingBytes_ += entry.head.View().size();
+    chunkOpen_ = false;
+    chunked_ = false;
+}
+
+void OutboundQueue::PushChunk(std::string data) {
+    if (data.empty()) {
+        return;
+    }
+    Entry& entry = entries_.emplace_back();
+    if (!chunked_) {
+        entry.zeroCopy = zeroCopyThreshold_ > 0 && data.size() >= zeroCopyThreshold_;
+        entry.body = std::move(data);
+        pendingBytes_ += entry.body.size();
+        return;
+    }
+    entry.head.RenderChunkSize(data.size(), chunkOpen_);
+    entry.hasHead = true;
+    entry.zeroCopy = zeroCopyThreshold_ > 0 && data.size() >= zeroCopyThreshold_;
+    entry.body = std::move(data);
+    pendingBytes_ += entry.head.View().size() + entry.body.size();
+    chunkOpen_ = true;
+}
+
+void OutboundQueue::PushLastChunk() {
+    if (!chunked_) {
+        return;
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.head.RenderChunkSize(0, chunkOpen_);
+    entry.hasHead = true;
+    pendingBytes_ += entry.head.View().size();
+    chunkOpen_ = false;
+}
+
+void OutboundQueue::PushRaw(std::string bytes) {
+    Entry& entry = entries_.emplace_back();
+    entry.body = std::move(bytes);
+    pendingBytes_ += entry.body.size();
+}
+
+OutboundQueue::FlushStatus OutboundQueue::Flush(int fd) {
+    while (!entries_.empty()) {
+        Entry& front = entries_.front();
+        const std::size_t frontHeadSize = front.hasHead ? front.head.View().size() : 0;
+        if (front.zeroCopy && front.headSent == frontHeadSize) {
+            const FlushStatus status = FlushZeroCopyBody(fd, &front);
+            if (status != FlushStatus::kDrained) {
+                return status;
+            }
+            continue;
+        }
+
+        std::array<iovec, kMaxIovecs> iov{};
+        const std::size_t count = GatherIovecs(iov.data(), iov.size());
+        if (count == 0) {
+            entries_.pop_front();
+            continue;
+        }
+
+        msghdr message{};
+        message.msg_iov = iov.data();
+        message.msg_iovlen = count;
+        const ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return FlushStatus::kBlocked;
+            }
+            return FlushStatus::kError;
+        }
+        Advance(static_cast<std::size_t>(sent));
+    }
+    return FlushStatus::kDrained;
+}
+
+std::size_t OutboundQueue::GatherIovecs(iovec* iov, std::size_t maxIovecs) const {
+    std::size_t count = 0;
+    for (const Entry& entry : entries_) {
+        if (count + 2 > maxIovecs) {
+            break;
+        }
+        const std::string_view head = entry.hasHead ? entry.head.View() : std::string_view();
+        if (entry.headSent < head.size()) {
+            iov[count].iov_base = const_cast<char*>(head.data() + entry.headSent);
+            iov[count].iov_len = head.size() - entry.headSent;
+            ++count;
+        }
+        if (entry.zeroCopy) {
+            break;
+        }
+        if (entry.bodySent < entry.body.size()) {
+            iov[count].iov_base = const_cast<char*>(entry.body.data() + entry.bodySent);
+            iov[count].iov_len = entry.body.size() - entry.bodySent;
+            ++count;
+        }
+    }
+    return count;
+}
+
+void OutboundQueue::CompleteSend(std::size_t sent) {
+    Advance(sent);
+    while (!entries_.empty()) {
+        const Entry& front = entries_.front();
+        const std::size_t headSize = front.hasHead ? front.head.View().size() : 0;
+        if (front.zeroCopy || front.headSent < headSize || front.bodySent < front.body.size()) {
+            break;
+        }
+        entries_.pop_front();
+    }
+}
+
+void OutboundQueue::ReapZeroCopyCompletions(int fd) {
+#ifdef SO_EE_ORIGIN_ZEROCOPY
+    while (!zeroCopyInFlight_.empty()) {
+        alignas(cmsghdr) char control[128];
+        msghdr message{};
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &message, MSG_ERRQUEUE) < 0) {
+            return;
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (!IsZeroCopyNotification(cmsg)) {
+                continue;
+            }
+            sock_extended_err error{};
+            std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+            if (error.ee_errno != 0 || error.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+            const std::uint32_t completedThrough = error.ee_data;
+            while (!zeroCopyInFlight_.empty() &&
+                   static_cast<std::int32_t>(completedThrough - zeroCopyInFlight_.front().seq) >= 0) {
+                zeroCopyInFlight_.pop_front();
+            }
+        }
+    }
+#else
+    (void)fd;
+    zeroCopyInFlight_.clear();
+#endif
+}
+
+OutboundQueue::FlushStatus OutboundQueue::FlushZeroCopyBody(int fd, Entry* entry) {
+#ifdef MSG_ZEROCOPY
+    while (entry->bodySent < entry->body.size()) {
+        iovec iov{};
+        iov.iov_base = entry->body.data() + entry->bodySent;
+        iov.iov_len = entry->body.size() - entry->bodySent;
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+
+        ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL | MSG_ZEROCOPY);
+        bool zeroCopySend = true;
+        if (sent < 0 && errno == ENOBUFS) {
+            sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+            zeroCopySend = false;
+        }
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return FlushStatus::kBlocked;
+            }
+            return FlushStatus::kError;
+        }
+
+        if (zeroCopySend) {
+            entry->lastZeroCopySeq = nextZeroCopySeq_++;
+            entry->zeroCopyUsed = true;
+        }
+        entry->bodySent += static_cast<std::size_t>(sent);
+        pendingBytes_ -= static_cast<std::size_t>(sent);
+    }
+
+    if (entry->zeroCopyUsed) {
+        zeroCopyInFlight_.push_back(InFlightBody{entry->lastZeroCopySeq, std::move(entry->body)});
+    }
+    entries_.pop_front();
+    return FlushStatus::kDrained;
+#else
+    entry->zeroCopy = false;
+    (void)fd;
+    return FlushStatus::kDrained;
+#endif
+}
+
+void OutboundQueue::Advance(std::size_t sent) {
+    pendingBytes_ -= sent;
+    while (sent > 0 && !entries_.empty()) {
+        Entry& front = entries_.front();
+        const std::size_t headSize = front.hasHead ? front.head.View().size() : 0;
+
+        const std::size_t headTake = std::min(sent, headSize - front.headSent);
+        front.headSent += headTake;
+        sent -= headTake;
+        if (front.zeroCopy) {
+            return;
+        }
+
+        const std::size_t bodyTake = std::min(sent, front.body.size() - front.bodySent);
+        front.bodySent += bodyTake;
+        sent -= bodyTake;
+
+        if (front.headSent == headSize && front.bodySent == front.body.size()) {
+            entries_.pop_front();
+        }
+    }
+}
+
+}
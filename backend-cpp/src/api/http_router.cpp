@@ -0,0 +1,196 @@
+#include "api/http_router.h"
+
+namespace agri {
+
+namespace {
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return 10 + (c - 'a');
+    }
+    if (c >= 'A' && c <= 'F') {
+        return 10 + (c - 'A');
+    }
+    return -1;
+}
+
+bool IsParamSegment(std::string_view segment) {
+    return segment.size() > 2 && segment.front() == '{' && segment.back() == '}';
+}
+
+}
+
+bool RouteParams::Add(std::string_view name, std::string_view value) {
+    if (size_ == kMaxParams) {
+        return false;
+    }
+    names_[size_] = name;
+    values_[size_] = value;
+    ++size_;
+    return true;
+}
+
+std::string_view RouteParams::Get(std::string_view name) const {
+    for (std::size_t i = 0; i < size_; ++i) {
+        if (names_[i] == name) {
+            return values_[i];
+        }
+    }
+    return std::string_view();
+}
+
+void QueryParams::Parse(std::string_view query) {
+    size_ = 0;
+    while (!query.empty() && size_ < kMaxParams) {
+        const std::size_t amp = query.find('&');
+        const std::string_view pair = query.substr(0, amp);
+        if (!pair.empty()) {
+            const std::size_t eq = pair.find('=');
+            keys_[size_] = pair.substr(0, eq);
+            values_[size_] = (eq == std::string_view::npos) ? std::string_view() : pair.substr(eq + 1);
+            ++size_;
+        }
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(amp + 1);
+    }
+}
+
+std::optional<std::string_view> QueryParams::Get(std::string_view key) const {
+    for (std::size_t i = 0; i < size_; ++i) {
+        if (keys_[i] == key) {
+            return values_[i];
+        }
+    }
+    return std::nullopt;
+}
+
+std::string QueryParams::Decode(std::string_view raw) {
+    std::string decoded;
+    decoded.reserve(raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        const char c = raw[i];
+        if (c == '+') {
+            decoded.push_back(' ');
+        } else if (c == '%' && i + 2 < raw.size() && HexValue(raw[i + 1]) >= 0 && HexValue(raw[i + 2]) >= 0) {
+            decoded.push_back(static_cast<char>((HexValue(raw[i + 1]) << 4) | HexValue(raw[i + 2])));
+            i += 2;
+        } else {
+            decoded.push_back(c);
+        }
+    }
+    return decoded;
+}
+
+void HttpRouter::Add(std::string_view method, std::string_view pattern, std::size_t routeId) {
+    std::uint32_t node = kNoNode;
+    for (const MethodRoot& root : roots_) {
+        if (root.method == method) {
+            node = root.root;
+            break;
+        }
+    }
+    if (node == kNoNode) {
+        node = NewNode();
+        roots_.push_back(MethodRoot{std::string(method), node});
+    }
+
+    std::string_view rest = pattern;
+    while (!rest.empty()) {
+        const std::size_t next = rest.find('/', 1);
+        const std::string_view segment = rest.substr(1, (next == std::string_view::npos) ? next : next - 1);
+        rest = (next == std::string_view::npos) ? std::string_view() : rest.substr(next);
+
+        if (IsParamSegment(segment)) {
+            if (nodes_[node].paramChild == kNoNode) {
+                const std::uint32_t child = NewNode();
+                nodes_[node].paramChild = child;
+                nodes_[node].paramName = std::string(segment.substr(1, segment.size() - 2));
+            }
+            node = nodes_[node].paramChild;
+            continue;
+        }
+
+        std::uint32_t child = kNoNode;
+        for (const LiteralEdge& edge : nodes_[node].literals) {
+            if (edge.segment == segment) {
+                child = edge.child;
+                break;
+            }
+        }
+        if (child == kNoNode) {
+            child = NewNode();
+            nodes_[node].literals.push_back(LiteralEdge{std::string(segment), child});
+        }
+        node = child;
+    }
+
+    nodes_[node].routeId = routeId;
+}
+
+std::optional<std::size_t> HttpRouter::Match(
+    std::string_view method,
+    std::string_view path,
+    RouteParams* params) const {
+    params->Clear();
+    if (path.empty() || path.front() != '/') {
+        return std::nullopt;
+    }
+
+    for (const MethodRoot& root : roots_) {
+        if (root.method != method) {
+            continue;
+        }
+        std::size_t routeId = kNoRoute;
+        if (MatchFrom(root.root, path, params, &routeId)) {
+            return routeId;
+        }
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+std::uint32_t HttpRouter::NewNode() {
+    nodes_.emplace_back();
+    return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+bool HttpRouter::MatchFrom(
+    std::uint32_t node,
+    std::string_view rest,
+    RouteParams* params,
+    std::size_t* routeId) const {
+    const Node& current = nodes_[node];
+    if (rest.empty()) {
+        if (current.routeId == kNoRoute) {
+            return false;
+        }
+        *routeId = current.routeId;
+        return true;
+    }
+
+    const std::size_t next = rest.find('/', 1);
+    const std::string_view segment = rest.substr(1, (next == std::string_view::npos) ? next : next - 1);
+    const std::string_view remaining = (next == std::string_view::npos) ? std::string_view() : rest.substr(next);
+
+    for (const LiteralEdge& edge : current.literals) {
+        if (edge.segment == segment && MatchFrom(edge.child, remaining, params, routeId)) {
+            return true;
+        }
+    }
+
+    if (current.paramChild != kNoNode && !segment.empty()) {
+        const std::size_t mark = params->Size();
+        if (params->Add(current.paramName, segment) && MatchFrom(current.paramChild, remaining, params, routeId)) {
+            return true;
+        }
+        params->Truncate(mark);
+    }
+    return false;
+}
+
+}
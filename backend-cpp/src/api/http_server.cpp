@@ -2,205 +2,140 @@
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <array>
-#include <cctype>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <cerrno>
+#include <iostream>
 #include <optional>
-#include <regex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "transport/cbor_parser.h"
 #include "transport/json_parser.h"
+#include "transport/json_writer.h"
 
 namespace agri {
 
 namespace {
 
-std::string StatusText(int statusCode) {
-    switch (statusCode) {
-        case 200:
-            return "OK";
-        case 202:
-            return "Accepted";
-        case 400:
-            return "Bad Request";
-        case 404:
-            return "Not Found";
-        default:
-            return "Internal Server Error";
-    }
-}
-
-std::string ToLower(std::string text) {
-    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {
-        return static_cast<char>(std::tolower(c));
-    });
-    return text;
+constexpr std::size_t kMaxRequestBytes = 1024 * 1024;
+constexpr std::size_t kReadChunkBytes = 16 * 1024;
+constexpr std::size_t kMaxPendingWriteBytes = 4 * 1024 * 1024;
+constexpr std::size_t kStreamLowWatermarkBytes = 64 * 1024;
+constexpr std::size_t kTracePageRecords = 128;
+constexpr int kListenBacklog = SOMAXCONN;
+constexpr int kMaxEpollEvents = 256;
+constexpr unsigned kRingEntries = 1024;
+constexpr std::uint16_t kRingBufferGroup = 0;
+constexpr std::size_t kRingBufferCount = 256;
+
+enum RingOp : std::uint64_t {
+    kRingAccept = 1,
+    kRingWake = 2,
+    kRingRecv = 3,
+    kRingSend = 4,
+    kRingCancel = 5,
+};
+
+std::uint64_t RingUserData(RingOp op, std::uint64_t connectionId, int fd) {
+    return (static_cast<std::uint64_t>(op) << 56) | ((connectionId & 0xFFFFFF) << 32) | static_cast<std::uint32_t>(fd);
 }
 
-std::string Trim(std::string_view text) {
-    std::size_t begin = 0;
-    while (begin < text.size() && std::isspace(static_cast<unsigned char>(text[begin])) != 0) {
-        ++begin;
-    }
-
-    std::size_t end = text.size();
-    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1])) != 0) {
-        --end;
-    }
-
-    return std::string(text.substr(begin, end - begin));
-}
-
-std::size_t ParseContentLength(const std::string& headers) {
-    const std::regex pattern("Content-Length:\\s*([0-9]+)", std::regex_constants::icase);
-    std::smatch match;
-    if (!std::regex_search(headers, match, pattern)) {
-        return 0;
-    }
-    try {
-        return static_cast<std::size_t>(std::stoull(match[1].str()));
-    } catch (...) {
-        return 0;
+void PinCurrentThreadToCpu(std::size_t index) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return;
     }
-}
-
-std::string ReadHttpRequest(int fd) {
-    constexpr std::size_t kMaxRequestBytes = 1024 * 1024;
-
-    std::string raw;
-    raw.reserve(4096);
 
-    std::size_t expectedTotalSize = 0;
-    bool haveExpectedSize = false;
-
-    while (raw.size() < kMaxRequestBytes) {
-        char buffer[4096];
-        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
-        if (received <= 0) {
-            break;
-        }
-        raw.append(buffer, static_cast<std::size_t>(received));
-
-        const std::size_t headerEnd = raw.find("\r\n\r\n");
-        if (headerEnd == std::string::npos) {
+    std::size_t remaining = index % static_cast<std::size_t>(CPU_COUNT(&allowed));
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
             continue;
         }
-
-        if (!haveExpectedSize) {
-            const std::string headers = raw.substr(0, headerEnd);
-            const std::size_t contentLength = ParseContentLength(headers);
-            expectedTotalSize = headerEnd + 4 + contentLength;
-            haveExpectedSize = true;
-            if (contentLength == 0) {
-                break;
-            }
-        }
-
-        if (haveExpectedSize && raw.size() >= expectedTotalSize) {
-            break;
+        if (remaining-- == 0) {
+            cpu_set_t target;
+            CPU_ZERO(&target);
+            CPU_SET(cpu, &target);
+            pthread_setaffinity_np(pthread_self(), sizeof(target), &target);
+            return;
         }
     }
-
-    return raw;
 }
 
-bool SendAll(int fd, const std::string& payload) {
-    std::size_t offset = 0;
-    int sendFlags = 0;
-#ifdef MSG_NOSIGNAL
-    sendFlags |= MSG_NOSIGNAL;
-#endif
-
-    while (offset < payload.size()) {
-        const ssize_t sent = send(fd, payload.data() + offset, payload.size() - offset, sendFlags);
-        if (sent < 0 && errno == EINTR) {
-            continue;
-        }
-        if (sent <= 0) {
-            return false;
-        }
-        offset += static_cast<std::size_t>(sent);
-    }
-    return true;
+// MSG_ZEROCOPY bodies stay referenced by the socket until the kernel reports them sent. A graceful close would
+// keep transmitting from that memory after the queue frees it, so such sockets are reset, which drops the data.
+void ResetOnClose(int fd) {
+    const linger reset{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
 }
 
-std::optional<HttpServer::HttpRequest> ParseHttpRequest(const std::string& raw) {
-    const std::size_t headerEnd = raw.find("\r\n\r\n");
-    if (headerEnd == std::string::npos) {
-        return std::nullopt;
-    }
-
-    const std::string headers = raw.substr(0, headerEnd);
-    const std::string body = raw.substr(headerEnd + 4);
-
-    const std::size_t firstLineEnd = headers.find("\r\n");
-    if (firstLineEnd == std::string::npos) {
-        return std::nullopt;
-    }
-
-    const std::string firstLine = headers.substr(0, firstLineEnd);
-    std::istringstream lineStream(firstLine);
-
-    HttpServer::HttpRequest request;
-    std::string httpVersion;
-    if (!(lineStream >> request.method >> request.path >> httpVersion)) {
-        return std::nullopt;
-    }
-
-    request.headers = headers.substr(firstLineEnd + 2);
-    request.body = body;
-    return request;
+std::string RecordToJson(const TelemetryRecord& record) {
+    std::string json;
+    JsonWriter writer(&json);
+    WriteTelemetryRecordJson(record, &writer);
+    return json;
 }
 
-std::string BoolAsJson(bool value) {
-    return value ? "true" : "false";
+std::string ErrorToJson(std::string_view error) {
+    std::string json;
+    JsonWriter(&json).BeginObject().Key("error").String(error).EndObject();
+    return json;
 }
 
-std::string ReceiptToJson(const std::optional<BlockchainReceipt>& receipt) {
-    if (!receipt.has_value()) {
-        return "null";
+class BatchTraceStream final : public HttpBodyStream {
+   public:
+    BatchTraceStream(const TelemetryRepository& repository, std::string_view batchCode) : repository_(repository) {
+        cursor_.batchCode = std::string(batchCode);
     }
 
-    const BlockchainReceipt& r = *receipt;
-    std::ostringstream out;
-    out << "{"
-        << "\"txHash\":\"" << JsonEscape(r.txHash) << "\","
-        << "\"blockHeight\":" << r.blockHeight << ","
-        << "\"submittedAt\":\"" << JsonEscape(r.submittedAtIso8601) << "\""
-        << "}";
-    return out.str();
-}
+    bool Next(std::string* chunk) override {
+        chunk->clear();
+        if (!opened_) {
+            opened_ = true;
+            JsonWriter(chunk).BeginObject().Key("batchCode").String(cursor_.batchCode).Key("records").BeginArray();
+        }
 
-std::string RecordToJson(const TelemetryRecord& record) {
-    std::ostringstream out;
-    out << "{"
-        << "\"recordId\":" << record.recordId << ","
-        << "\"deviceId\":\"" << JsonEscape(record.packet.deviceId) << "\","
-        << "\"timestamp\":" << record.packet.timestamp << ","
-        << "\"telemetry\":" << record.packet.telemetryJson << ","
-        << "\"hash\":\"" << JsonEscape(record.packet.hashHex) << "\","
-        << "\"signature\":\"" << JsonEscape(record.packet.signature) << "\","
-        << "\"pubKeyId\":\"" << JsonEscape(record.packet.pubKeyId) << "\","
-        << "\"transport\":\"" << JsonEscape(record.packet.transport) << "\"";
+        repository_.ReadBatchPage(&cursor_, kTracePageRecords, &page_);
+        for (const TelemetryRecord& record : page_) {
+            if (count_++ != 0) {
+                chunk->push_back(',');
+            }
+            JsonWriter writer(chunk);
+            WriteTelemetryRecordJson(record, &writer);
+        }
 
-    if (!record.packet.batchCode.empty()) {
-        out << ",\"batchCode\":\"" << JsonEscape(record.packet.batchCode) << "\"";
+        if (!cursor_.exhausted) {
+            return true;
+        }
+        JsonWriter(chunk).EndArray().Key("count").Uint(count_).EndObject();
+        return false;
     }
 
-    out << ",\"receipt\":" << ReceiptToJson(record.receipt) << "}";
-    return out.str();
-}
+   private:
+    const TelemetryRepository& repository_;
+    TelemetryBatchCursor cursor_;
+    std::vector<TelemetryRecord> page_;
+    std::size_t count_{0};
+    bool opened_{false};
+};
 
 std::array<unsigned char, 20> Sha1Digest(std::string_view input) {
     std::vector<unsigned char> message(input.begin(), input.end());
@@ -326,44 +261,191 @@ std::string Base64Encode(const unsigned char* bytes, std::size_t length) {
 
 } 
 
+HttpIoBackend ParseHttpIoBackend(std::string_view name) {
+    if (name == "epoll") {
+        return HttpIoBackend::kEpoll;
+    }
+    if (name == "io_uring") {
+        return HttpIoBackend::kIoUring;
+    }
+    throw std::runtime_error("unknown http io backend: " + std::string(name));
+}
+
 HttpServer::HttpServer(
     std::uint16_t port,
     IngestService& ingestService,
-    const TelemetryRepository& repository)
-    : port_(port), ingestService_(ingestService), repository_(repository) {}
+    const TelemetryRepository& repository,
+    HttpServerConfig config)
+    : port_(port),
+      config_(config),
+      ingestService_(ingestService),
+      repository_(repository),
+      broadcaster_(WebSocketBroadcasterConfig{config.wsMaxQueuedFrames, config.wsSlowClientPolicy, config.wsPingIntervalMs}) {
+    std::size_t workerThreads = config_.workerThreads;
+    if (workerThreads == 0) {
+        workerThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    workerPool_ = std::make_unique<WorkStealingPool>(workerThreads);
+
+    AdmissionConfig admission;
+    admission.maxInFlight = (config_.ingestMaxInFlight == 0) ? workerThreads : config_.ingestMaxInFlight;
+    admission.maxQueued = config_.ingestMaxQueued;
+    admission.maxQueuedPerGateway = config_.ingestMaxQueuedPerGateway;
+    ingestAdmission_ = std::make_unique<AdmissionController>(
+        admission, [this](AdmissionController::Task task) { workerPool_->Submit(std::move(task)); });
+
+    std::size_t reactorThreads = config_.reactorThreads;
+    if (reactorThreads == 0) {
+        reactorThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < reactorThreads; ++i) {
+        reactors_.push_back(std::make_unique<Reactor>());
+        reactors_.back()->index = i;
+    }
+    RegisterRoutes();
+}
 
 void HttpServer::Start() {
-    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (listenFd_ < 0) {
+    running_ = true;
+    for (const auto& reactor : reactors_) {
+        OpenReactor(reactor.get());
+    }
+
+    broadcaster_.Start();
+    if (reactors_.size() == 1) {
+        RunEventLoop(reactors_.front().get());
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(reactors_.size());
+        for (const auto& reactor : reactors_) {
+            threads.emplace_back([this, reactor = reactor.get()] { RunReactor(reactor); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    workerPool_->WaitIdle();
+    broadcaster_.Stop();
+    for (const auto& reactor : reactors_) {
+        CloseAllConnections(reactor.get());
+    }
+}
+
+void HttpServer::Stop() {
+    running_ = false;
+    for (const auto& reactor : reactors_) {
+        if (reactor->wakeFd >= 0) {
+            const std::uint64_t one = 1;
+            [[maybe_unused]] const ssize_t written = write(reactor->wakeFd, &one, sizeof(one));
+        }
+    }
+}
+
+bool HttpServer::IoUringAvailable() {
+    IoUring probe;
+    return IoUring::Available() && probe.Init(8);
+}
+
+void HttpServer::OpenReactor(Reactor* reactor) {
+    reactor->listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (reactor->listenFd < 0) {
         throw std::runtime_error("failed to create socket");
     }
 
     int reuse = 1;
-    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    setsockopt(reactor->listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (reactors_.size() > 1 &&
+        setsockopt(reactor->listenFd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+        throw std::runtime_error("failed to enable SO_REUSEPORT");
+    }
 
     sockaddr_in address{};
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = htonl(INADDR_ANY);
     address.sin_port = htons(port_);
 
-    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    if (bind(reactor->listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
         throw std::runtime_error("failed to bind socket");
     }
 
-    if (listen(listenFd_, 16) < 0) {
+    if (listen(reactor->listenFd, kListenBacklog) < 0) {
         throw std::runtime_error("failed to listen");
     }
 
-    running_ = true;
+    reactor->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epollFd < 0) {
+        throw std::runtime_error("failed to create epoll instance");
+    }
+
+    reactor->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reactor->wakeFd < 0) {
+        throw std::runtime_error("failed to create wake eventfd");
+    }
+
+    epoll_event listenEvent{};
+    listenEvent.events = EPOLLIN | EPOLLET;
+    listenEvent.data.fd = reactor->listenFd;
+    epoll_event wakeEvent{};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = reactor->wakeFd;
+    if (epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, reactor->listenFd, &listenEvent) < 0 ||
+        epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, reactor->wakeFd, &wakeEvent) < 0) {
+        throw std::runtime_error("failed to register listener with epoll");
+    }
+}
+
+void HttpServer::RunReactor(Reactor* reactor) {
+    if (config_.pinReactorThreads) {
+        PinCurrentThreadToCpu(reactor->index);
+    }
+    RunEventLoop(reactor);
+}
+
+void HttpServer::RunEventLoop(Reactor* reactor) {
+    if (config_.ioBackend == HttpIoBackend::kIoUring && OpenRing(reactor)) {
+        RunRingLoop(reactor);
+        return;
+    }
+
+    std::array<epoll_event, kMaxEpollEvents> events{};
     while (running_) {
+        const int timeoutMs = reactor->timers.MillisecondsUntilNextExpiry(std::chrono::steady_clock::now());
+        const int count = epoll_wait(reactor->epollFd, events.data(), kMaxEpollEvents, timeoutMs);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == reactor->listenFd) {
+                AcceptConnections(reactor);
+            } else if (fd == reactor->wakeFd) {
+                std::uint64_t value = 0;
+                [[maybe_unused]] const ssize_t drained = read(reactor->wakeFd, &value, sizeof(value));
+                DrainCompletions(reactor);
+            } else {
+                HandleConnectionEvent(reactor, fd, events[i].events);
+            }
+        }
+
+        ExpireConnections(reactor);
+    }
+}
+
+void HttpServer::AcceptConnections(Reactor* reactor) {
+    while (true) {
         sockaddr_in clientAddr{};
         socklen_t clientLen = sizeof(clientAddr);
-        const int clientFd = accept(listenFd_, reinterpret_cast<sockaddr*>(&clientAddr), &clientLen);
+        const int clientFd = accept4(
+            reactor->listenFd, reinterpret_cast<sockaddr*>(&clientAddr), &clientLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (clientFd < 0) {
-            if (running_) {
+            if (errno == EINTR || errno == ECONNABORTED) {
                 continue;
             }
-            break;
+            return;
         }
 
 #ifdef SO_NOSIGPIPE
@@ -371,311 +453,998 @@ void HttpServer::Start() {
         setsockopt(clientFd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
 #endif
 
-        const bool keepOpen = HandleClient(clientFd);
-        if (!keepOpen) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = clientFd;
+        if (epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, clientFd, &event) < 0) {
             close(clientFd);
+            continue;
         }
+
+        RegisterConnection(reactor, clientFd, clientAddr);
     }
 }
 
-void HttpServer::Stop() {
-    running_ = false;
-    if (listenFd_ >= 0) {
-        shutdown(listenFd_, SHUT_RDWR);
-        close(listenFd_);
-        listenFd_ = -1;
+void HttpServer::RegisterConnection(Reactor* reactor, int clientFd, const sockaddr_in& clientAddr) {
+    char peer[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &clientAddr.sin_addr, peer, sizeof(peer));
+
+    Connection& connection = reactor->connections[clientFd];
+    connection.reactor = reactor;
+    connection.fd = clientFd;
+    connection.id = reactor->nextConnectionId++;
+    connection.peerAddress = peer;
+    connection.readBuffer.reserve(kReadChunkBytes);
+    connection.lastActivity = std::chrono::steady_clock::now();
+    connection.timer = reactor->timers.Create(static_cast<std::uint64_t>(clientFd));
+    connection.armedDeadline = std::chrono::steady_clock::time_point::max();
+    if (reactor->ring != nullptr) {
+        connection.ring = std::make_unique<RingConnection>();
+        ArmRingRecv(&connection);
+    } else {
+        connection.output.EnableZeroCopy(clientFd, config_.zeroCopyThresholdBytes);
     }
+    ArmConnectionTimer(&connection);
+}
 
-    std::lock_guard<std::mutex> lock(wsMutex_);
-    for (const int fd : telemetryWsClients_) {
-        close(fd);
+void HttpServer::HandleConnectionEvent(Reactor* reactor, int fd, std::uint32_t events) {
+    const auto it = reactor->connections.find(fd);
+    if (it == reactor->connections.end()) {
+        return;
     }
-    for (const int fd : alertWsClients_) {
-        close(fd);
+    Connection* connection = &it->second;
+
+    if ((events & EPOLLERR) != 0) {
+        if (!connection->output.HasZeroCopyInFlight()) {
+            CloseConnection(reactor, fd, true);
+            return;
+        }
+        connection->output.ReapZeroCopyCompletions(fd);
+        int socketError = 0;
+        socklen_t length = sizeof(socketError);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length) < 0 || socketError != 0) {
+            CloseConnection(reactor, fd, true);
+            return;
+        }
+    }
+
+    bool keepOpen = true;
+    if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0) {
+        keepOpen = HandleReadable(connection);
+    }
+    if (keepOpen && connection->state != ConnectionState::kUpgraded) {
+        keepOpen = ServiceConnection(connection);
+    }
+
+    if (connection->state == ConnectionState::kUpgraded) {
+        CloseConnection(reactor, fd, false);
+    } else if (!keepOpen) {
+        CloseConnection(reactor, fd, true);
+    } else {
+        ArmConnectionTimer(connection);
     }
-    telemetryWsClients_.clear();
-    alertWsClients_.clear();
 }
 
-bool HttpServer::HandleClient(int clientFd) {
-    const std::string rawRequest = ReadHttpRequest(clientFd);
-    if (rawRequest.empty()) {
+bool HttpServer::HandleReadable(Connection* connection) {
+    char buffer[kReadChunkBytes];
+
+    while (true) {
+        const ssize_t received = recv(connection->fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection->lastActivity = std::chrono::steady_clock::now();
+            if (connection->state == ConnectionState::kOpen || connection->state == ConnectionState::kUpgrading) {
+                if (connection->readBuffer.empty()) {
+                    connection->readStarted = connection->lastActivity;
+                }
+                connection->readBuffer.append(buffer, static_cast<std::size_t>(received));
+            }
+            continue;
+        }
+        if (received == 0) {
+            connection->peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
         return false;
     }
+    return true;
+}
 
-    const auto request = ParseHttpRequest(rawRequest);
-    if (!request.has_value()) {
-        const HttpResponse response{400, "{\"error\":\"invalid HTTP request\"}", "application/json"};
-        const std::string rawResponse = BuildRawResponse(response);
-        SendAll(clientFd, rawResponse);
-        return false;
+bool HttpServer::ServiceConnection(Connection* connection) {
+    while (true) {
+        bool stalledOnOutput = false;
+        if (!ProcessBufferedRequests(connection, &stalledOnOutput)) {
+            return false;
+        }
+        if (connection->state == ConnectionState::kUpgraded) {
+            return true;
+        }
+        if (connection->state == ConnectionState::kUpgrading) {
+            if (connection->ring != nullptr) {
+                return true;
+            }
+            if (!FlushWriteBuffer(connection)) {
+                return false;
+            }
+            if (connection->output.Empty() && !connection->output.HasZeroCopyInFlight()) {
+                HandOffWebSocket(connection);
+            }
+            return true;
+        }
+        if (!FlushWriteBuffer(connection)) {
+            return false;
+        }
+        if (!stalledOnOutput || !connection->output.Empty()) {
+            break;
+        }
     }
 
-    const std::string path = StripQuery(request->path);
-    if (path == "/ws/telemetry" || path == "/ws/alerts") {
-        return TryUpgradeWebSocket(clientFd, *request, path);
+    if (connection->stream != nullptr && !connection->chunkPending &&
+        connection->output.PendingBytes() < kStreamLowWatermarkBytes) {
+        ScheduleStreamChunk(connection);
     }
 
-    const HttpResponse response = Route(*request);
-    const std::string rawResponse = BuildRawResponse(response);
-    SendAll(clientFd, rawResponse);
-    return false;
+    if (connection->output.Empty() && !connection->requestInFlight) {
+        if (connection->state == ConnectionState::kOpen && !connection->peerClosed) {
+            return true;
+        }
+        return LingerForZeroCopy(connection);
+    }
+    return true;
 }
 
-bool HttpServer::TryUpgradeWebSocket(int clientFd, const HttpRequest& request, const std::string& path) {
-    if (request.method != "GET") {
+bool HttpServer::LingerForZeroCopy(Connection* connection) {
+    connection->output.ReapZeroCopyCompletions(connection->fd);
+    if (!connection->output.HasZeroCopyInFlight()) {
         return false;
     }
+    if (connection->state != ConnectionState::kLingering) {
+        connection->state = ConnectionState::kLingering;
+        connection->readBuffer.clear();
+        shutdown(connection->fd, SHUT_WR);
+    }
+    return true;
+}
 
-    const std::string upgrade = ToLower(GetHeaderValue(request.headers, "Upgrade"));
-    const std::string connection = ToLower(GetHeaderValue(request.headers, "Connection"));
-    const std::string key = Trim(GetHeaderValue(request.headers, "Sec-WebSocket-Key"));
+bool HttpServer::ProcessBufferedRequests(Connection* connection, bool* stalledOnOutput) {
+    while (connection->state == ConnectionState::kOpen && !connection->requestInFlight) {
+        if (connection->output.PendingBytes() >= kMaxPendingWriteBytes) {
+            *stalledOnOutput = true;
+            return true;
+        }
 
-    if (upgrade != "websocket" || connection.find("upgrade") == std::string::npos || key.empty()) {
-        const HttpResponse response{400, "{\"error\":\"invalid websocket upgrade\"}", "application/json"};
-        SendAll(clientFd, BuildRawResponse(response));
-        return false;
+        const HttpRequestParser::Status status = connection->parser.Parse(connection->readBuffer);
+        if (status == HttpRequestParser::Status::kIncomplete) {
+            return true;
+        }
+        if (status == HttpRequestParser::Status::kError) {
+            const HttpResponse response{
+                connection->parser.ErrorStatus(),
+                std::string("{\"error\":\"") + std::string(connection->parser.ErrorMessage()) + "\"}",
+                "application/json"};
+            QueueResponse(connection, response, false);
+            return true;
+        }
+
+        HandleRequest(connection);
     }
+    return true;
+}
 
-    std::ostringstream response;
-    response << "HTTP/1.1 101 Switching Protocols\r\n"
-             << "Upgrade: websocket\r\n"
-             << "Connection: Upgrade\r\n"
-             << "Sec-WebSocket-Accept: " << BuildWebSocketAccept(key) << "\r\n"
-             << "\r\n";
+void HttpServer::HandleRequest(Connection* connection) {
+    const HttpRequest& request = connection->parser.Request();
+    ++connection->requestsServed;
 
-    if (!SendAll(clientFd, response.str())) {
-        return false;
+    if (request.path == "/ws/telemetry" || request.path == "/ws/alerts") {
+        auto upgrade = std::make_unique<WebSocketUpgrade>();
+        HttpResponse rejection;
+        if (!PrepareWebSocketUpgrade(request, upgrade.get(), &rejection)) {
+            QueueResponse(connection, std::move(rejection), false);
+            return;
+        }
+
+        // Earlier pipelined responses drain through the normal flush and timer path; whatever the client sent
+        // after the handshake stays in readBuffer and is handed to the broadcaster with the socket.
+        connection->readBuffer.erase(0, connection->parser.ConsumedBytes());
+        connection->parser.Reset();
+        connection->upgrade = std::move(upgrade);
+        connection->state = ConnectionState::kUpgrading;
+        if (connection->ring != nullptr && connection->ring->recvArmed) {
+            connection->reactor->ring->PrepareCancel(
+                RingUserData(kRingRecv, connection->id, connection->fd), RingUserData(kRingCancel, 0, -1));
+        }
+        return;
     }
 
-    std::lock_guard<std::mutex> lock(wsMutex_);
-    if (path == "/ws/telemetry") {
-        telemetryWsClients_.push_back(clientFd);
+    const bool keepAlive = request.keepAlive && connection->requestsServed < config_.maxRequestsPerConnection;
+    DispatchRequest(connection, keepAlive);
+}
+
+void HttpServer::HandOffWebSocket(Connection* connection) {
+    if (connection->ring == nullptr) {
+        epoll_ctl(connection->reactor->epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+    }
+    connection->state = ConnectionState::kUpgraded;
+    WebSocketUpgrade& upgrade = *connection->upgrade;
+    broadcaster_.AddClient(connection->fd, upgrade.channel, std::move(upgrade.subscription),
+                           std::move(upgrade.handshake), upgrade.deflate, std::move(connection->readBuffer));
+}
+
+void HttpServer::DispatchRequest(Connection* connection, bool keepAlive) {
+    auto pending = std::make_shared<PendingRequest>();
+    const std::size_t consumed = connection->parser.ConsumedBytes();
+    const char* base = connection->readBuffer.data();
+    if (consumed == connection->readBuffer.size()) {
+        pending->buffer = std::move(connection->readBuffer);
+        connection->readBuffer.clear();
     } else {
-        alertWsClients_.push_back(clientFd);
+        pending->buffer.assign(connection->readBuffer, 0, consumed);
+        connection->readBuffer.erase(0, consumed);
+    }
+    pending->request = connection->parser.Request();
+    pending->request.Rebase(base, pending->buffer.data());
+    connection->parser.Reset();
+
+    connection->requestInFlight = true;
+    connection->http10Request = pending->request.version == "HTTP/1.0";
+    if (!keepAlive) {
+        connection->state = ConnectionState::kDraining;
+        connection->readBuffer.clear();
+    }
+
+    Reactor* reactor = connection->reactor;
+    const int fd = connection->fd;
+    const std::uint64_t connectionId = connection->id;
+    auto task = [this, reactor, fd, connectionId, keepAlive, pending]() {
+        // The connection stays requestInFlight with no deadline until this completion arrives, so a throwing
+        // handler must still answer rather than leave the socket wedged.
+        HttpResponse response;
+        try {
+            response = Route(pending->request);
+        } catch (const std::exception& ex) {
+            std::cerr << "request " << pending->request.method << " " << pending->request.path
+                      << " failed: " << ex.what() << std::endl;
+            response = HttpResponse{500, "{\"error\":\"internal server error\"}", "application/json"};
+        } catch (...) {
+            std::cerr << "request " << pending->request.method << " " << pending->request.path << " failed"
+                      << std::endl;
+            response = HttpResponse{500, "{\"error\":\"internal server error\"}", "application/json"};
+        }
+        PostCompletion(reactor, Completion{fd, connectionId, std::move(response), keepAlive});
+    };
+
+    const HttpRequest& request = pending->request;
+    if (request.method != "POST" || (request.path != "/api/v1/ingest" && request.path != "/api/v1/ingest/batch")) {
+        workerPool_->Submit(std::move(task));
+        return;
+    }
+
+    std::string_view gateway = request.headers.Get("X-Gateway-Id");
+    if (gateway.empty()) {
+        gateway = connection->peerAddress;
+    }
+    const AdmissionDecision decision = ingestAdmission_->Submit(gateway, request.body.size(), std::move(task));
+    if (decision == AdmissionDecision::kOverloaded || decision == AdmissionDecision::kGatewayLimited) {
+        connection->requestInFlight = false;
+        const bool overloaded = decision == AdmissionDecision::kOverloaded;
+        HttpResponse response{
+            overloaded ? 503 : 429,
+            overloaded ? "{\"error\":\"ingest queue full\"}" : "{\"error\":\"gateway ingest queue full\"}",
+            "application/json",
+            config_.ingestRetryAfterSeconds};
+        QueueResponse(connection, std::move(response), keepAlive);
     }
-    return true;
 }
 
-void HttpServer::BroadcastIngestEvent(const TelemetryPacket& packet, const IngestResult& result) {
-    std::lock_guard<std::mutex> lock(wsMutex_);
+void HttpServer::PostCompletion(Reactor* reactor, Completion completion) {
+    {
+        std::lock_guard<std::mutex> lock(reactor->completionMutex);
+        reactor->completions.push_back(std::move(completion));
+    }
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written = write(reactor->wakeFd, &one, sizeof(one));
+}
 
-    if (result.accepted) {
-        std::ostringstream body;
-        body << "{"
-             << "\"type\":\"telemetry.ingested\"," 
-             << "\"deviceId\":\"" << JsonEscape(packet.deviceId) << "\"," 
-             << "\"recordId\":" << result.recordId << ","
-             << "\"timestamp\":" << packet.timestamp << ","
-             << "\"transport\":\"" << JsonEscape(packet.transport) << "\"," 
-             << "\"txHash\":\""
-             << JsonEscape(result.receipt.has_value() ? result.receipt->txHash : std::string(""))
-             << "\""
-             << "}";
-        BroadcastMessage(body.str(), &telemetryWsClients_);
+void HttpServer::DrainCompletions(Reactor* reactor) {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(reactor->completionMutex);
+        ready.swap(reactor->completions);
+    }
+
+    for (Completion& completion : ready) {
+        const auto it = reactor->connections.find(completion.fd);
+        if (it == reactor->connections.end() || it->second.id != completion.connectionId ||
+            (it->second.ring != nullptr && it->second.ring->closePending)) {
+            continue;
+        }
+
+        Connection* connection = &it->second;
+        if (completion.streamChunk) {
+            if (!AppendStreamChunk(connection, &completion)) {
+                CloseConnection(reactor, completion.fd, true);
+                continue;
+            }
+        } else {
+            connection->requestInFlight = false;
+            QueueResponse(connection, std::move(completion.response), completion.keepAlive);
+        }
+
+        if (connection->ring != nullptr) {
+            SettleRingConnection(connection);
+            continue;
+        }
+        const bool keepOpen = ServiceConnection(connection);
+        if (connection->state == ConnectionState::kUpgraded) {
+            CloseConnection(reactor, completion.fd, false);
+        } else if (!keepOpen) {
+            CloseConnection(reactor, completion.fd, true);
+        } else {
+            ArmConnectionTimer(connection);
+        }
+    }
+}
+
+void HttpServer::QueueResponse(Connection* connection, HttpResponse response, bool keepAlive) {
+    connection->lastWriteProgress = std::chrono::steady_clock::now();
+    connection->readStarted = connection->lastWriteProgress;
+    if (response.stream != nullptr) {
+        if (connection->http10Request) {
+            keepAlive = false;
+            connection->output.PushCloseDelimitedHead(response.statusCode, response.contentType);
+        } else {
+            connection->output.PushChunkedHead(response.statusCode, response.contentType, keepAlive);
+        }
+        connection->output.PushChunk(std::move(response.body));
+        connection->stream = std::move(response.stream);
+        connection->requestInFlight = true;
     } else {
-        std::ostringstream body;
-        body << "{"
-             << "\"type\":\"ingest.rejected\"," 
-             << "\"deviceId\":\"" << JsonEscape(packet.deviceId) << "\"," 
-             << "\"message\":\"" << JsonEscape(result.message) << "\""
-             << "}";
-        BroadcastMessage(body.str(), &alertWsClients_);
+        connection->output.PushResponse(
+            response.statusCode, response.contentType, std::move(response.body), keepAlive,
+            response.retryAfterSeconds);
+    }
+    if (!keepAlive) {
+        connection->state = ConnectionState::kDraining;
+        connection->readBuffer.clear();
     }
 }
 
-void HttpServer::BroadcastMessage(const std::string& payload, std::vector<int>* clients) {
-    std::vector<int> active;
-    active.reserve(clients->size());
+void HttpServer::ScheduleStreamChunk(Connection* connection) {
+    connection->chunkPending = true;
+    Reactor* reactor = connection->reactor;
+    const int fd = connection->fd;
+    const std::uint64_t connectionId = connection->id;
+    workerPool_->Submit([this, reactor, fd, connectionId, stream = connection->stream]() {
+        Completion completion;
+        completion.fd = fd;
+        completion.connectionId = connectionId;
+        completion.streamChunk = true;
+        try {
+            completion.streamDone = !stream->Next(&completion.response.body);
+        } catch (const std::exception& ex) {
+            std::cerr << "response stream failed: " << ex.what() << std::endl;
+            completion.streamFailed = true;
+        } catch (...) {
+            std::cerr << "response stream failed" << std::endl;
+            completion.streamFailed = true;
+        }
+        PostCompletion(reactor, std::move(completion));
+    });
+}
 
-    const std::string frame = BuildWebSocketFrame(payload);
-    for (const int fd : *clients) {
-        if (SendAll(fd, frame)) {
-            active.push_back(fd);
-        } else {
-            close(fd);
+bool HttpServer::AppendStreamChunk(Connection* connection, Completion* completion) {
+    connection->chunkPending = false;
+    if (completion->streamFailed) {
+        return false;
+    }
+    connection->lastActivity = std::chrono::steady_clock::now();
+    connection->output.PushChunk(std::move(completion->response.body));
+    if (completion->streamDone) {
+        connection->output.PushLastChunk();
+        connection->stream.reset();
+        connection->requestInFlight = false;
+    }
+    return true;
+}
+
+bool HttpServer::FlushWriteBuffer(Connection* connection) {
+    if (connection->ring != nullptr) {
+        SubmitRingSend(connection);
+        return true;
+    }
+    const std::size_t pendingBefore = connection->output.PendingBytes();
+    const OutboundQueue::FlushStatus status = connection->output.Flush(connection->fd);
+    if (connection->output.PendingBytes() != pendingBefore) {
+        connection->lastActivity = std::chrono::steady_clock::now();
+        connection->lastWriteProgress = connection->lastActivity;
+    }
+    return status != OutboundQueue::FlushStatus::kError;
+}
+
+std::chrono::steady_clock::time_point HttpServer::ConnectionDeadline(const Connection& connection) const {
+    if (!connection.output.Empty() ||
+        (connection.state != ConnectionState::kOpen && connection.output.HasZeroCopyInFlight())) {
+        return connection.lastWriteProgress + std::chrono::milliseconds(config_.writeTimeoutMs);
+    }
+    if (connection.stream != nullptr) {
+        return connection.lastActivity + std::chrono::milliseconds(config_.idleTimeoutMs);
+    }
+    if (connection.requestInFlight) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    if (!connection.readBuffer.empty()) {
+        return connection.readStarted + std::chrono::milliseconds(config_.readTimeoutMs);
+    }
+    return connection.lastActivity + std::chrono::milliseconds(config_.idleTimeoutMs);
+}
+
+void HttpServer::ArmConnectionTimer(Connection* connection) {
+    const auto deadline = ConnectionDeadline(*connection);
+    if (deadline < connection->armedDeadline) {
+        connection->armedDeadline = deadline;
+        connection->reactor->timers.Schedule(connection->timer, deadline);
+    }
+}
+
+void HttpServer::ExpireConnections(Reactor* reactor) {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::uint64_t> expired;
+    reactor->timers.Advance(now, &expired);
+
+    for (const std::uint64_t payload : expired) {
+        const int fd = static_cast<int>(payload);
+        const auto it = reactor->connections.find(fd);
+        if (it == reactor->connections.end()) {
+            continue;
+        }
+
+        Connection* connection = &it->second;
+        auto deadline = ConnectionDeadline(*connection);
+        if (deadline <= now) {
+            CloseConnection(reactor, fd, true);
+            continue;
+        }
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            deadline = now + std::chrono::milliseconds(config_.idleTimeoutMs);
         }
+        connection->armedDeadline = deadline;
+        reactor->timers.Schedule(connection->timer, deadline);
     }
-    clients->swap(active);
 }
 
-HttpServer::HttpResponse HttpServer::Route(const HttpRequest& request) {
-    const std::string path = StripQuery(request.path);
+bool HttpServer::OpenRing(Reactor* reactor) {
+    auto ring = std::make_unique<IoUring>();
+    if (!IoUring::Available() || !ring->Init(kRingEntries) ||
+        !ring->RegisterBufferRing(kRingBufferGroup, kRingBufferCount, kReadChunkBytes)) {
+        std::cerr << "io_uring unavailable, reactor " << reactor->index << " falls back to epoll" << std::endl;
+        return false;
+    }
 
-    if (request.method == "GET" && path == "/health") {
-        return HttpResponse{200, "{\"status\":\"ok\"}", "application/json"};
+    ring->PrepareMultishotAccept(reactor->listenFd, SOCK_NONBLOCK | SOCK_CLOEXEC, RingUserData(kRingAccept, 0, -1));
+    ring->PrepareMultishotPoll(reactor->wakeFd, POLLIN, RingUserData(kRingWake, 0, -1));
+    reactor->ring = std::move(ring);
+    return true;
+}
+
+void HttpServer::RunRingLoop(Reactor* reactor) {
+    while (running_) {
+        const int timeoutMs = reactor->timers.MillisecondsUntilNextExpiry(std::chrono::steady_clock::now());
+        if (!reactor->ring->SubmitAndWait(timeoutMs)) {
+            break;
+        }
+
+        reactor->ringCompletions.clear();
+        reactor->ring->ReapCompletions(&reactor->ringCompletions);
+        for (const IoUringCompletion& completion : reactor->ringCompletions) {
+            HandleRingCompletion(reactor, completion);
+        }
+        ExpireConnections(reactor);
     }
+}
 
-    if (request.method == "POST" && path == "/api/v1/ingest") {
-        const ParseTelemetryResult parsed = ParseTelemetryPacketJson(request.body);
-        if (!parsed.ok) {
-            return HttpResponse{
-                400,
-                std::string("{\"error\":\"") + JsonEscape(parsed.error) + "\"}",
-                "application/json"};
+void HttpServer::HandleRingCompletion(Reactor* reactor, const IoUringCompletion& completion) {
+    const auto op = static_cast<RingOp>(completion.userData >> 56);
+    if (op == kRingAccept) {
+        if (completion.result >= 0) {
+            sockaddr_in clientAddr{};
+            socklen_t clientLen = sizeof(clientAddr);
+            getpeername(completion.result, reinterpret_cast<sockaddr*>(&clientAddr), &clientLen);
+            RegisterConnection(reactor, completion.result, clientAddr);
+        }
+        if (!completion.More() && running_) {
+            reactor->ring->PrepareMultishotAccept(
+                reactor->listenFd, SOCK_NONBLOCK | SOCK_CLOEXEC, RingUserData(kRingAccept, 0, -1));
         }
+        return;
+    }
+    if (op == kRingWake) {
+        std::uint64_t value = 0;
+        [[maybe_unused]] const ssize_t drained = read(reactor->wakeFd, &value, sizeof(value));
+        DrainCompletions(reactor);
+        if (!completion.More() && running_) {
+            reactor->ring->PrepareMultishotPoll(reactor->wakeFd, POLLIN, RingUserData(kRingWake, 0, -1));
+        }
+        return;
+    }
+    if (op != kRingRecv && op != kRingSend) {
+        return;
+    }
 
-        const IngestResult result = ingestService_.Ingest(parsed.packet);
-        BroadcastIngestEvent(parsed.packet, result);
-
-        std::ostringstream body;
-        body << "{"
-             << "\"accepted\":" << BoolAsJson(result.accepted) << ","
-             << "\"message\":\"" << JsonEscape(result.message) << "\","
-             << "\"recordId\":" << result.recordId << ","
-             << "\"processingMs\":" << result.processingMs << ","
-             << "\"receipt\":" << ReceiptToJson(result.receipt)
-             << "}";
-
-        return HttpResponse{result.accepted ? 202 : 400, body.str(), "application/json"};
-    }
-
-    if (request.method == "GET" && path == "/api/v1/metrics/overview") {
-        const MetricsSnapshot metrics = ingestService_.GetMetricsSnapshot();
-        std::ostringstream body;
-        body << "{"
-             << "\"totalRequests\":" << metrics.totalRequests << ","
-             << "\"acceptedRequests\":" << metrics.acceptedRequests << ","
-             << "\"rejectedRequests\":" << metrics.rejectedRequests << ","
-             << "\"averageProcessingMs\":" << metrics.averageProcessingMs << ","
-             << "\"repositorySize\":" << metrics.repositorySize
-             << "}";
-        return HttpResponse{200, body.str(), "application/json"};
-    }
-
-    std::string param;
-    if (request.method == "GET" && ExtractPathParam(path, "/api/v1/devices/", "/latest", &param)) {
-        const auto record = repository_.LatestByDevice(param);
-        if (!record.has_value()) {
-            return HttpResponse{404, "{\"error\":\"device not found\"}", "application/json"};
-        }
-        return HttpResponse{200, RecordToJson(*record), "application/json"};
-    }
-
-    if (request.method == "GET" && ExtractPathParam(path, "/api/v1/batches/", "/trace", &param)) {
-        const auto records = repository_.FindByBatch(param);
-        std::ostringstream body;
-        body << "{"
-             << "\"batchCode\":\"" << JsonEscape(param) << "\","
-             << "\"count\":" << records.size() << ","
-             << "\"records\":[";
-        for (std::size_t i = 0; i < records.size(); ++i) {
-            if (i != 0) {
-                body << ",";
-            }
-            body << RecordToJson(records[i]);
+    const int fd = static_cast<int>(completion.userData & 0xFFFFFFFF);
+    const auto it = reactor->connections.find(fd);
+    if (it == reactor->connections.end() || (it->second.id & 0xFFFFFF) != ((completion.userData >> 32) & 0xFFFFFF)) {
+        if (completion.HasBuffer()) {
+            reactor->ring->RecycleBuffer(completion.BufferId());
         }
-        body << "]}";
-        return HttpResponse{200, body.str(), "application/json"};
+        return;
     }
+    if (op == kRingRecv) {
+        HandleRingRecv(&it->second, completion);
+    } else {
+        HandleRingSend(&it->second, completion);
+    }
+}
 
-    if (request.method == "GET" && ExtractPathParam(path, "/api/v1/transactions/", "", &param)) {
-        const auto record = repository_.FindByTransaction(param);
-        if (!record.has_value()) {
-            return HttpResponse{404, "{\"error\":\"transaction not found\"}", "application/json"};
+void HttpServer::HandleRingRecv(Connection* connection, const IoUringCompletion& completion) {
+    RingConnection& ring = *connection->ring;
+    IoUring& uring = *connection->reactor->ring;
+    if (completion.HasBuffer()) {
+        if (completion.result > 0 && !ring.closePending &&
+            (connection->state == ConnectionState::kOpen || connection->state == ConnectionState::kUpgrading)) {
+            if (connection->readBuffer.empty()) {
+                connection->readStarted = std::chrono::steady_clock::now();
+            }
+            const std::string_view data =
+                uring.Buffer(completion.BufferId(), static_cast<std::size_t>(completion.result));
+            connection->readBuffer.append(data.data(), data.size());
         }
-        return HttpResponse{200, RecordToJson(*record), "application/json"};
+        uring.RecycleBuffer(completion.BufferId());
+    }
+
+    if (completion.result > 0) {
+        connection->lastActivity = std::chrono::steady_clock::now();
+    } else if (completion.result == 0) {
+        connection->peerClosed = true;
+    } else if (completion.result != -ENOBUFS && completion.result != -ECANCELED) {
+        ring.failed = true;
     }
 
-    return HttpResponse{404, "{\"error\":\"route not found\"}", "application/json"};
+    if (!completion.More()) {
+        ring.recvArmed = false;
+        if ((completion.result > 0 || completion.result == -ENOBUFS) && connection->state == ConnectionState::kOpen &&
+            !ring.closePending && !connection->peerClosed) {
+            ArmRingRecv(connection);
+        }
+    }
+    SettleRingConnection(connection);
 }
 
-std::string HttpServer::BuildRawResponse(const HttpResponse& response) const {
-    std::ostringstream out;
-    out << "HTTP/1.1 " << response.statusCode << " " << StatusText(response.statusCode) << "\r\n"
-        << "Content-Type: " << response.contentType << "\r\n"
-        << "Content-Length: " << response.body.size() << "\r\n"
-        << "Connection: close\r\n"
-        << "\r\n"
-        << response.body;
-    return out.str();
+void HttpServer::HandleRingSend(Connection* connection, const IoUringCompletion& completion) {
+    RingConnection& ring = *connection->ring;
+    --ring.sendsInFlight;
+    if (completion.result > 0) {
+        connection->output.CompleteSend(static_cast<std::size_t>(completion.result));
+        connection->lastActivity = std::chrono::steady_clock::now();
+        connection->lastWriteProgress = connection->lastActivity;
+    } else if (completion.result != -ECANCELED) {
+        ring.failed = true;
+    }
+    SettleRingConnection(connection);
 }
 
-std::string HttpServer::BuildWebSocketAccept(const std::string& key) {
-    const std::string source = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
-    const std::array<unsigned char, 20> digest = Sha1Digest(source);
-    return Base64Encode(digest.data(), digest.size());
+void HttpServer::ArmRingRecv(Connection* connection) {
+    connection->reactor->ring->PrepareMultishotRecv(
+        connection->fd, kRingBufferGroup, RingUserData(kRingRecv, connection->id, connection->fd));
+    connection->ring->recvArmed = true;
 }
 
-std::string HttpServer::BuildWebSocketFrame(const std::string& payload) {
-    std::string frame;
-    frame.reserve(payload.size() + 10);
-    frame.push_back(static_cast<char>(0x81));
+void HttpServer::SubmitRingSend(Connection* connection) {
+    RingConnection& ring = *connection->ring;
+    if (ring.sendsInFlight > 0 || ring.closePending) {
+        return;
+    }
 
-    const std::size_t size = payload.size();
-    if (size <= 125) {
-        frame.push_back(static_cast<char>(size));
-    } else if (size <= 0xFFFF) {
-        frame.push_back(static_cast<char>(126));
-        frame.push_back(static_cast<char>((size >> 8) & 0xFF));
-        frame.push_back(static_cast<char>(size & 0xFF));
-    } else {
-        frame.push_back(static_cast<char>(127));
-        for (int shift = 56; shift >= 0; shift -= 8) {
-            frame.push_back(static_cast<char>((size >> shift) & 0xFF));
+    std::size_t count = 0;
+    while (!connection->output.Empty()) {
+        count = connection->output.GatherIovecs(ring.iov.data(), ring.iov.size());
+        if (count > 0) {
+            break;
         }
+        connection->output.CompleteSend(0);
     }
 
-    frame.append(payload);
-    return frame;
+    for (std::size_t offset = 0, index = 0; offset < count; offset += kRingIovecsPerSend, ++index) {
+        msghdr& message = ring.messages[index];
+        message = msghdr{};
+        message.msg_iov = &ring.iov[offset];
+        message.msg_iovlen = std::min(kRingIovecsPerSend, count - offset);
+        const bool linkNext = offset + kRingIovecsPerSend < count;
+        connection->reactor->ring->PrepareSendMsg(connection->fd, &message, MSG_NOSIGNAL | MSG_WAITALL, linkNext,
+                                                  RingUserData(kRingSend, connection->id, connection->fd));
+        ++ring.sendsInFlight;
+    }
 }
 
-std::string HttpServer::GetHeaderValue(const std::string& headers, const std::string& key) {
-    std::istringstream stream(headers);
-    std::string line;
-    const std::string target = ToLower(key);
+void HttpServer::SettleRingConnection(Connection* connection) {
+    Reactor* reactor = connection->reactor;
+    const int fd = connection->fd;
+    RingConnection& ring = *connection->ring;
+    const bool idle = !ring.recvArmed && ring.sendsInFlight == 0;
 
-    while (std::getline(stream, line)) {
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+    if (ring.closePending) {
+        if (idle) {
+            close(fd);
+            reactor->connections.erase(fd);
         }
-        const std::size_t colon = line.find(':');
-        if (colon == std::string::npos) {
-            continue;
+        return;
+    }
+    if (connection->state == ConnectionState::kUpgrading) {
+        if (ring.failed) {
+            CloseConnection(reactor, fd, true);
+            return;
         }
-        const std::string lineKey = ToLower(Trim(line.substr(0, colon)));
-        if (lineKey == target) {
-            return Trim(line.substr(colon + 1));
+        if (!connection->output.Empty()) {
+            SubmitRingSend(connection);
+            ArmConnectionTimer(connection);
+        } else if (idle) {
+            HandOffWebSocket(connection);
+            CloseConnection(reactor, fd, false);
         }
+        return;
     }
-    return "";
-}
 
-std::string HttpServer::StripQuery(std::string path) {
-    const std::size_t queryPos = path.find('?');
-    if (queryPos != std::string::npos) {
-        path.erase(queryPos);
+    const bool keepOpen = !ring.failed && ServiceConnection(connection);
+    if (connection->state == ConnectionState::kUpgrading) {
+        SettleRingConnection(connection);
+    } else if (!keepOpen) {
+        CloseConnection(reactor, fd, true);
+    } else {
+        ArmConnectionTimer(connection);
     }
-    return path;
 }
 
-bool HttpServer::ExtractPathParam(
-    const std::string& path,
-    const std::string& prefix,
-    const std::string& suffix,
-    std::string* value) {
-    if (path.rfind(prefix, 0) != 0) {
-        return false;
+void HttpServer::CloseConnection(Reactor* reactor, int fd, bool closeSocket) {
+    const auto it = reactor->connections.find(fd);
+    if (it != reactor->connections.end() && it->second.ring != nullptr && closeSocket) {
+        RingConnection& ring = *it->second.ring;
+        if (ring.recvArmed || ring.sendsInFlight > 0) {
+            if (!ring.closePending) {
+                ring.closePending = true;
+                shutdown(fd, SHUT_RDWR);
+                reactor->timers.Destroy(it->second.timer);
+            }
+            return;
+        }
     }
 
-    const std::size_t begin = prefix.size();
-    if (suffix.empty()) {
-        if (begin >= path.size()) {
-            return false;
+    if (closeSocket) {
+        epoll_ctl(reactor->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        if (it != reactor->connections.end() && it->second.output.HasZeroCopyInFlight()) {
+            ResetOnClose(fd);
         }
-        *value = path.substr(begin);
-        return !value->empty();
+        close(fd);
+    }
+    if (it != reactor->connections.end()) {
+        reactor->timers.Destroy(it->second.timer);
+        reactor->connections.erase(it);
+    }
+}
+
+void HttpServer::CloseAllConnections(Reactor* reactor) {
+    for (const auto& entry : reactor->connections) {
+        if (entry.second.output.HasZeroCopyInFlight()) {
+            ResetOnClose(entry.first);
+        }
+        close(entry.first);
+    }
+    reactor->connections.clear();
+
+    if (reactor->listenFd >= 0) {
+        close(reactor->listenFd);
+        reactor->listenFd = -1;
+    }
+    if (reactor->epollFd >= 0) {
+        close(reactor->epollFd);
+        reactor->epollFd = -1;
+    }
+    if (reactor->wakeFd >= 0) {
+        close(reactor->wakeFd);
+        reactor->wakeFd = -1;
     }
+}
 
-    if (path.size() <= begin + suffix.size()) {
+bool HttpServer::PrepareWebSocketUpgrade(
+    const HttpRequest& request,
+    WebSocketUpgrade* upgrade,
+    HttpResponse* rejection) {
+    const std::string_view upgradeHeader = request.headers.Get(HttpHeaderId::kUpgrade);
+    const std::string_view connection = request.headers.Get(HttpHeaderId::kConnection);
+    const std::string_view key = request.headers.Get(HttpHeaderId::kSecWebSocketKey);
+
+    if (request.method != "GET" || !EqualsIgnoreCase(upgradeHeader, "websocket") ||
+        !HeaderHasToken(connection, "upgrade") || key.empty()) {
+        *rejection = HttpResponse{400, "{\"error\":\"invalid websocket upgrade\"}", "application/json"};
         return false;
     }
-    if (!path.ends_with(suffix)) {
+
+    std::string subscriptionError;
+    if (!ParseWebSocketSubscription(request.query, &upgrade->subscription, &subscriptionError)) {
+        *rejection = HttpResponse{400, ErrorToJson(subscriptionError), "application/json"};
         return false;
     }
 
-    *value = path.substr(begin, path.size() - begin - suffix.size());
-    return !value->empty();
+    const std::optional<std::string> extensions =
+        NegotiatePerMessageDeflate(request.headers.Get(HttpHeaderId::kSecWebSocketExtensions));
+
+    std::ostringstream response;
+    response << "HTTP/1.1 101 Switching Protocols\r\n"
+             << "Upgrade: websocket\r\n"
+             << "Connection: Upgrade\r\n"
+             << "Sec-WebSocket-Accept: " << BuildWebSocketAccept(std::string(key)) << "\r\n";
+    if (extensions.has_value()) {
+        response << "Sec-WebSocket-Extensions: " << *extensions << "\r\n";
+    }
+    response << "\r\n";
+
+    upgrade->channel = (request.path == "/ws/telemetry") ? WebSocketChannel::kTelemetry : WebSocketChannel::kAlerts;
+    upgrade->handshake = response.str();
+    upgrade->deflate = extensions.has_value();
+    return true;
+}
+
+void HttpServer::BroadcastIngestEvent(const TelemetryPacketView& packet, const IngestResult& result) {
+    const WebSocketEventKeys keys{packet.deviceId, packet.batchCode, packet.transport};
+    thread_local std::string body;
+    body.clear();
+    JsonWriter writer(&body);
+    if (result.accepted) {
+        writer.BeginObject()
+            .Key("type")
+            .String("telemetry.ingested")
+            .Key("deviceId")
+            .String(packet.deviceId)
+            .Key("recordId")
+            .Uint(result.recordId)
+            .Key("timestamp")
+            .Uint(packet.timestamp)
+            .Key("transport")
+            .String(packet.transport)
+            .Key("txHash")
+            .String(result.receipt.has_value() ? std::string_view(result.receipt->txHash) : std::string_view())
+            .EndObject();
+        broadcaster_.Publish(WebSocketChannel::kTelemetry, body, keys);
+    } else {
+        writer.BeginObject()
+            .Key("type")
+            .String("ingest.rejected")
+            .Key("deviceId")
+            .String(packet.deviceId)
+            .Key("message")
+            .String(result.message)
+            .EndObject();
+        broadcaster_.Publish(WebSocketChannel::kAlerts, body, keys);
+    }
+}
+
+void HttpServer::RegisterRoutes() {
+    auto add = [this](std::string_view method, std::string_view pattern, RouteHandler handler) {
+        router_.Add(method, pattern, routeHandlers_.size());
+        routeHandlers_.push_back(handler);
+    };
+
+    add("GET", "/health", &HttpServer::HandleHealth);
+    add("POST", "/api/v1/ingest", &HttpServer::HandleIngest);
+    add("POST", "/api/v1/ingest/batch", &HttpServer::HandleIngestBatch);
+    add("GET", "/api/v1/metrics/overview", &HttpServer::HandleMetricsOverview);
+    add("GET", "/api/v1/devices/{deviceId}/latest", &HttpServer::HandleDeviceLatest);
+    add("GET", "/api/v1/batches/{batchCode}/trace", &HttpServer::HandleBatchTrace);
+    add("GET", "/api/v1/transactions/{txHash}", &HttpServer::HandleTransaction);
+}
+
+HttpServer::HttpResponse HttpServer::Route(const HttpRequest& request) {
+    RouteParams params;
+    const std::optional<std::size_t> routeId = router_.Match(request.method, request.path, &params);
+    if (!routeId.has_value()) {
+        return HttpResponse{404, "{\"error\":\"route not found\"}", "application/json"};
+    }
+    return (this->*routeHandlers_[*routeId])(request, params);
+}
+
+HttpServer::HttpResponse HttpServer::HandleHealth(const HttpRequest&, const RouteParams&) {
+    return HttpResponse{200, "{\"status\":\"ok\"}", "application/json"};
+}
+
+HttpServer::HttpResponse HttpServer::HandleIngest(const HttpRequest& request, const RouteParams&) {
+    const ParseTelemetryResult parsed =
+        HasMediaType(request.headers.Get(HttpHeaderId::kContentType), "application/cbor")
+            ? ParseTelemetryPacketCbor(request.body)
+            : ParseTelemetryPacketJson(request.body);
+    if (!parsed.ok) {
+        return HttpResponse{400, ErrorToJson(parsed.error), "application/json"};
+    }
+
+    const IngestResult result = ingestService_.Ingest(parsed.packet);
+    BroadcastIngestEvent(parsed.packet, result);
+
+    std::string body;
+    JsonWriter writer(&body);
+    writer.BeginObject()
+        .Key("accepted")
+        .Bool(result.accepted)
+        .Key("message")
+        .String(result.message)
+        .Key("recordId")
+        .Uint(result.recordId)
+        .Key("processingMs")
+        .Uint(result.processingMs)
+        .Key("receipt");
+    WriteBlockchainReceiptJson(result.receipt, &writer);
+    writer.EndObject();
+
+    return HttpResponse{result.accepted ? 202 : 400, std::move(body), "application/json"};
+}
+
+HttpServer::HttpResponse HttpServer::HandleIngestBatch(const HttpRequest& request, const RouteParams&) {
+    std::vector<ParseTelemetryResult> parsed;
+    std::vector<std::string_view> items;
+    std::string error;
+    const bool cbor = HasMediaType(request.headers.Get(HttpHeaderId::kContentType), "application/cbor-seq");
+    const bool split = cbor ? ParseTelemetryBatchCbor(request.body, &parsed, &error)
+                            : SplitTelemetryBatchJson(request.body, &items, &error);
+    if (!split) {
+        return HttpResponse{400, ErrorToJson(error), "application/json"};
+    }
+    const std::size_t count = cbor ? parsed.size() : items.size();
+    if (count == 0) {
+        return HttpResponse{400, "{\"error\":\"batch contains no packets\"}", "application/json"};
+    }
+    if (count > config_.ingestMaxBatchPackets) {
+        return HttpResponse{
+            413,
+            "{\"error\":\"batch exceeds " + std::to_string(config_.ingestMaxBatchPackets) + " packets\"}",
+            "application/json"};
+    }
+
+    if (!cbor) {
+        parsed.reserve(count);
+        for (const std::string_view item : items) {
+            parsed.push_back(ParseTelemetryPacketJson(item));
+        }
+    }
+    std::vector<TelemetryPacketView> packets;
+    packets.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (parsed[i].ok) {
+            packets.push_back(parsed[i].packet);
+        }
+    }
+
+    const BatchIngestResult batch = ingestService_.IngestBatch(packets, workerPool_.get());
+
+    std::string body;
+    body.reserve(128 + count * 64);
+    JsonWriter writer(&body);
+    writer.BeginObject()
+        .Key("accepted")
+        .Uint(batch.acceptedCount)
+        .Key("rejected")
+        .Uint(count - batch.acceptedCount)
+        .Key("merkleRoot")
+        .String(batch.merkleRoot)
+        .Key("processingMs")
+        .Uint(batch.processingMs)
+        .Key("receipt");
+    WriteBlockchainReceiptJson(batch.receipt, &writer);
+    writer.Key("results").BeginArray();
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        writer.BeginObject().Key("index").Uint(i);
+        if (!parsed[i].ok) {
+            writer.Key("accepted").Bool(false).Key("message").String(parsed[i].error).Key("recordId").Uint(0).EndObject();
+            continue;
+        }
+        const IngestResult& result = batch.results[next];
+        BroadcastIngestEvent(packets[next], result);
+        ++next;
+        writer.Key("accepted")
+            .Bool(result.accepted)
+            .Key("message")
+            .String(result.message)
+            .Key("recordId")
+            .Uint(result.recordId)
+            .EndObject();
+    }
+    writer.EndArray().EndObject();
+
+    return HttpResponse{batch.acceptedCount > 0 ? 202 : 400, std::move(body), "application/json"};
+}
+
+HttpServer::HttpResponse HttpServer::HandleMetricsOverview(const HttpRequest&, const RouteParams&) {
+    const MetricsSnapshot metrics = ingestService_.GetMetricsSnapshot();
+    const AdmissionSnapshot admission = ingestAdmission_->Snapshot();
+    std::string body;
+    JsonWriter writer(&body);
+    writer.BeginObject()
+        .Key("totalRequests")
+        .Uint(metrics.totalRequests)
+        .Key("acceptedRequests")
+        .Uint(metrics.acceptedRequests)
+        .Key("rejectedRequests")
+        .Uint(metrics.rejectedRequests)
+        .Key("averageProcessingMs")
+        .Uint(metrics.averageProcessingMs)
+        .Key("repositorySize")
+        .Uint(metrics.repositorySize)
+        .Key("telemetryStrings")
+        .BeginObject()
+        .Key("keys")
+        .Uint(TelemetryKeyTable().Size())
+        .Key("keyOverflows")
+        .Uint(TelemetryKeyTable().Overflows())
+        .Key("values")
+        .Uint(TelemetryValueTable().Size())
+        .Key("valueOverflows")
+        .Uint(TelemetryValueTable().Overflows())
+        .EndObject()
+        .Key("admission")
+        .BeginObject()
+        .Key("inFlight")
+        .Uint(admission.inFlight)
+        .Key("maxInFlight")
+        .Uint(admission.maxInFlight)
+        .Key("queued")
+        .Uint(admission.queued)
+        .Key("maxQueued")
+        .Uint(admission.maxQueued)
+        .Key("admitted")
+        .Uint(admission.admitted)
+        .Key("shedOverloaded")
+        .Uint(admission.shedOverloaded)
+        .Key("shedGatewayLimited")
+        .Uint(admission.shedGatewayLimited)
+        .Key("queuedByGateway")
+        .BeginObject();
+    for (const auto& [gateway, queued] : admission.queuedByGateway) {
+        writer.Key(gateway).Uint(queued);
+    }
+    writer.EndObject().EndObject().EndObject();
+    return HttpResponse{200, std::move(body), "application/json"};
+}
+
+HttpServer::HttpResponse HttpServer::HandleDeviceLatest(const HttpRequest&, const RouteParams& params) {
+    const auto record = repository_.LatestByDevice(std::string(params.Get("deviceId")));
+    if (!record.has_value()) {
+        return HttpResponse{404, "{\"error\":\"device not found\"}", "application/json"};
+    }
+    return HttpResponse{200, RecordToJson(*record), "application/json"};
+}
+
+HttpServer::HttpResponse HttpServer::HandleBatchTrace(const HttpRequest&, const RouteParams& params) {
+    auto stream = std::make_shared<BatchTraceStream>(repository_, params.Get("batchCode"));
+    HttpResponse response{200, std::string(), "application/json"};
+    if (stream->Next(&response.body)) {
+        response.stream = std::move(stream);
+    }
+    return response;
+}
+
+HttpServer::HttpResponse HttpServer::HandleTransaction(const HttpRequest&, const RouteParams& params) {
+    const auto record = repository_.FindByTransaction(std::string(params.Get("txHash")));
+    if (!record.has_value()) {
+        return HttpResponse{404, "{\"error\":\"transaction not found\"}", "application/json"};
+    }
+    return HttpResponse{200, RecordToJson(*record), "application/json"};
+}
+
+std::string HttpServer::BuildWebSocketAccept(const std::string& key) {
+    const std::string source = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    const std::array<unsigned char, 20> digest = Sha1Digest(source);
+    return Base64Encode(digest.data(), digest.size());
 }
 
 }
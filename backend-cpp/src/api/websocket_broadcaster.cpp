@@ -0,0 +1,618 @@
+#include "api/websocket_broadcaster.h"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+#include "transport/json_parser.h"
+
+namespace agri {
+
+namespace {
+
+constexpr int kMaxEpollEvents = 128;
+constexpr std::size_t kMaxIovecs = 64;
+constexpr std::size_t kReadChunkBytes = 4096;
+constexpr std::size_t kMaxInboundMessageBytes = 64 * 1024;
+constexpr std::size_t kMinCompressBytes = 128;
+
+bool SetNonBlocking(int fd) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+}
+
+SlowClientPolicy ParseSlowClientPolicy(std::string_view name) {
+    if (name == "drop") {
+        return SlowClientPolicy::kDrop;
+    }
+    if (name == "coalesce") {
+        return SlowClientPolicy::kCoalesce;
+    }
+    if (name == "disconnect") {
+        return SlowClientPolicy::kDisconnect;
+    }
+    throw std::runtime_error("unknown websocket slow client policy: " + std::string(name));
+}
+
+WebSocketBroadcaster::WebSocketBroadcaster(WebSocketBroadcasterConfig config) : config_(config) {
+    config_.maxQueuedFrames = std::max<std::size_t>(1, config_.maxQueuedFrames);
+}
+
+WebSocketBroadcaster::~WebSocketBroadcaster() {
+    Stop();
+}
+
+void WebSocketBroadcaster::Start() {
+    if (running_) {
+        return;
+    }
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        throw std::runtime_error("failed to create websocket epoll instance");
+    }
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        throw std::runtime_error("failed to create websocket wake eventfd");
+    }
+
+    epoll_event wakeEvent{};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = wakeFd_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent) < 0) {
+        throw std::runtime_error("failed to register websocket wake eventfd");
+    }
+
+    running_ = true;
+    thread_ = std::thread([this] { RunLoop(); });
+}
+
+void WebSocketBroadcaster::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    Wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    CloseAllClients();
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        for (const PendingClient& pending : pendingClients_) {
+            close(pending.fd);
+        }
+        pendingClients_.clear();
+        publications_.clear();
+        clientCount_ = 0;
+    }
+
+    close(wakeFd_);
+    wakeFd_ = -1;
+    close(epollFd_);
+    epollFd_ = -1;
+}
+
+void WebSocketBroadcaster::AddClient(
+    int fd,
+    WebSocketChannel channel,
+    WebSocketSubscription subscription,
+    std::string handshake,
+    bool deflate,
+    std::string inbound) {
+    if (!running_ || !SetNonBlocking(fd)) {
+        close(fd);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        pendingClients_.push_back(PendingClient{
+            fd, channel, std::move(subscription), std::move(handshake), deflate, std::move(inbound)});
+    }
+    Wake();
+}
+
+void WebSocketBroadcaster::Publish(WebSocketChannel channel, std::string_view payload, const WebSocketEventKeys& keys) {
+    if (!running_) {
+        return;
+    }
+    Publication publication;
+    publication.channel = channel;
+    publication.payload = payload;
+    publication.deviceId = keys.deviceId;
+    publication.batchCode = keys.batchCode;
+    publication.transport = keys.transport;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        if (clientCount_ == 0 && pendingClients_.empty()) {
+            return;
+        }
+        publications_.push_back(std::move(publication));
+    }
+    Wake();
+}
+
+std::size_t WebSocketBroadcaster::ClientCount() const {
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    return clientCount_;
+}
+
+WebSocketBroadcasterStats WebSocketBroadcaster::Stats() const {
+    WebSocketBroadcasterStats stats;
+    stats.publishedMessages = publishedMessages_.load();
+    stats.sentFrames = sentFrames_.load();
+    stats.droppedFrames = droppedFrames_.load();
+    stats.coalescedFrames = coalescedFrames_.load();
+    stats.disconnectedClients = disconnectedClients_.load();
+    stats.compressedMessages = compressedMessages_.load();
+    stats.subscriptionUpdates = subscriptionUpdates_.load();
+    stats.pingTimeouts = pingTimeouts_.load();
+    return stats;
+}
+
+void WebSocketBroadcaster::RunLoop() {
+    std::array<epoll_event, kMaxEpollEvents> events{};
+    while (running_) {
+        const int timeoutMs = timers_.MillisecondsUntilNextExpiry(std::chrono::steady_clock::now());
+        const int count = epoll_wait(epollFd_, events.data(), kMaxEpollEvents, timeoutMs);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                std::uint64_t value = 0;
+                [[maybe_unused]] const ssize_t drained = read(wakeFd_, &value, sizeof(value));
+                DrainInbox();
+                continue;
+            }
+
+            const auto it = clients_.find(fd);
+            if (it == clients_.end()) {
+                continue;
+            }
+            Client* client = &it->second;
+            const std::uint32_t flags = events[i].events;
+            const bool healthy = (flags & (EPOLLERR | EPOLLHUP)) == 0 &&
+                                 ((flags & (EPOLLIN | EPOLLRDHUP)) == 0 || ReadInbound(client)) &&
+                                 ((flags & EPOLLOUT) == 0 || FlushClient(client));
+            if (!healthy) {
+                CloseClient(fd);
+            }
+        }
+        ExpireTimers();
+    }
+}
+
+void WebSocketBroadcaster::Wake() {
+    if (wakeFd_ >= 0) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(wakeFd_, &one, sizeof(one));
+    }
+}
+
+void WebSocketBroadcaster::DrainInbox() {
+    std::vector<PendingClient> pendingClients;
+    std::vector<Publication> publications;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        pendingClients.swap(pendingClients_);
+        publications.swap(publications_);
+    }
+
+    for (PendingClient& pending : pendingClients) {
+        RegisterClient(std::move(pending));
+    }
+
+    std::vector<int> doomed;
+    for (const Publication& publication : publications) {
+        ++publishedMessages_;
+        DeliverPublication(publication, &doomed);
+    }
+    for (const int fd : doomed) {
+        if (CloseClient(fd)) {
+            ++disconnectedClients_;
+        }
+    }
+
+    doomed.clear();
+    for (auto& [fd, client] : clients_) {
+        if (!client.queue.empty() && !FlushClient(&client)) {
+            doomed.push_back(fd);
+        }
+    }
+    for (const int fd : doomed) {
+        CloseClient(fd);
+    }
+}
+
+void WebSocketBroadcaster::DeliverPublication(const Publication& publication, std::vector<int>* doomed) {
+    const auto channel = static_cast<std::size_t>(publication.channel);
+    const WebSocketEventKeys keys{publication.deviceId, publication.batchCode, publication.transport};
+    SharedMessage plain;
+    SharedMessage compressed;
+    bool compressionTried = false;
+
+    auto messageFor = [&](const Client& client) -> const SharedMessage& {
+        if (client.deflate && publication.payload.size() >= kMinCompressBytes) {
+            if (!compressionTried) {
+                compressionTried = true;
+                std::string deflated;
+                if (deflaters_[channel].Compress(publication.payload, &deflated) &&
+                    deflated.size() < publication.payload.size()) {
+                    compressed = std::make_shared<const Message>(
+                        Message{EncodeWebSocketFrame(WebSocketOpcode::kText, deflated, true), publication.deviceId});
+                    ++compressedMessages_;
+                }
+            }
+            if (compressed) {
+                return compressed;
+            }
+        }
+        if (!plain) {
+            plain = std::make_shared<const Message>(
+                Message{EncodeWebSocketFrame(WebSocketOpcode::kText, publication.payload), publication.deviceId});
+        }
+        return plain;
+    };
+
+    indexes_[channel].ForEachCandidate(keys, [&](int fd) {
+        Client& client = clients_.at(fd);
+        if (!client.closing && client.subscription.Matches(keys) && !Enqueue(&client, messageFor(client))) {
+            doomed->push_back(fd);
+        }
+    });
+}
+
+void WebSocketBroadcaster::RegisterClient(PendingClient pending) {
+    Client client;
+    client.fd = pending.fd;
+    client.channel = pending.channel;
+    client.subscription = std::move(pending.subscription);
+    client.handshake = std::move(pending.handshake);
+    client.deflate = pending.deflate;
+    client.reader = WebSocketReader(kMaxInboundMessageBytes, pending.deflate);
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = pending.fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, pending.fd, &event) < 0) {
+        close(pending.fd);
+        return;
+    }
+
+    Client& registered = clients_[pending.fd] = std::move(client);
+    indexes_[static_cast<std::size_t>(registered.channel)].Add(registered.fd, registered.subscription);
+    registered.timer = timers_.Create(static_cast<std::uint64_t>(registered.fd));
+    if (config_.pingIntervalMs > 0) {
+        timers_.Schedule(registered.timer,
+                         std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.pingIntervalMs));
+    }
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        ++clientCount_;
+    }
+    if (!pending.inbound.empty()) {
+        registered.reader.Append(pending.inbound.data(), pending.inbound.size());
+        ProcessInbound(&registered);
+    }
+    if (!FlushClient(&registered)) {
+        CloseClient(pending.fd);
+    }
+}
+
+bool WebSocketBroadcaster::Enqueue(Client* client, const SharedMessage& message) {
+    std::deque<SharedMessage>& queue = client->queue;
+    if (queue.size() >= config_.maxQueuedFrames && !FlushClient(client)) {
+        return false;
+    }
+    if (queue.size() < config_.maxQueuedFrames) {
+        queue.push_back(message);
+        return true;
+    }
+
+    switch (config_.slowClientPolicy) {
+        case SlowClientPolicy::kDrop:
+            ++droppedFrames_;
+            return true;
+        case SlowClientPolicy::kDisconnect:
+            return false;
+        case SlowClientPolicy::kCoalesce:
+            break;
+    }
+
+    const auto firstUnsent = queue.begin() + ((client->frontSent > 0) ? 1 : 0);
+    auto victim = queue.end();
+    if (!message->coalesceKey.empty()) {
+        victim = std::find_if(firstUnsent, queue.end(), [&message](const SharedMessage& queued) {
+            return !queued->control && queued->coalesceKey == message->coalesceKey;
+        });
+    }
+    if (victim != queue.end()) {
+        ++coalescedFrames_;
+    } else if (victim = std::find_if(firstUnsent, queue.end(),
+                                     [](const SharedMessage& queued) { return !queued->control; });
+               victim != queue.end()) {
+        ++droppedFrames_;
+    } else {
+        ++droppedFrames_;
+        return true;
+    }
+    queue.erase(victim);
+    queue.push_back(message);
+    return true;
+}
+
+void WebSocketBroadcaster::EnqueueControl(Client* client, std::string frame, bool reply) {
+    auto position = client->queue.begin() + ((client->frontSent > 0) ? 1 : 0);
+    while (position != client->queue.end() && (*position)->control) {
+        ++position;
+    }
+    client->queue.insert(position,
+                         std::make_shared<const Message>(Message{std::move(frame), std::string(), true, reply}));
+    client->queuedReplies += reply ? 1 : 0;
+}
+
+void WebSocketBroadcaster::EnqueueReply(Client* client, std::string_view payload) {
+    client->queue.push_back(std::make_shared<const Message>(
+        Message{EncodeWebSocketFrame(WebSocketOpcode::kText, payload), std::string(), true, true}));
+    ++client->queuedReplies;
+}
+
+// Pongs and subscribe replies are produced by the peer's own messages, so they bypass the slow client policy; a
+// peer that keeps sending without reading is closed with 1008 once maxQueuedFrames replies are waiting.
+bool WebSocketBroadcaster::ReserveReply(Client* client) {
+    if (client->queuedReplies < config_.maxQueuedFrames ||
+        (FlushClient(client) && client->queuedReplies < config_.maxQueuedFrames)) {
+        return true;
+    }
+    ++disconnectedClients_;
+    StartClose(client, kWebSocketClosePolicyViolation);
+    return false;
+}
+
+void WebSocketBroadcaster::StartClose(Client* client, std::uint16_t code) {
+    if (client->closing) {
+        return;
+    }
+    client->closing = true;
+    const std::size_t keep = (client->frontSent > 0) ? 1 : 0;
+    client->queue.erase(client->queue.begin() + static_cast<std::ptrdiff_t>(keep), client->queue.end());
+    client->queuedReplies = (keep == 1 && client->queue.front()->reply) ? 1 : 0;
+    client->queue.push_back(std::make_shared<const Message>(
+        Message{(code == 0) ? EncodeWebSocketFrame(WebSocketOpcode::kClose, {}) : EncodeWebSocketClose(code),
+                std::string(), true}));
+}
+
+bool WebSocketBroadcaster::FlushClient(Client* client) {
+    while (client->handshakeSent < client->handshake.size() || !client->queue.empty()) {
+        std::array<iovec, kMaxIovecs> iov{};
+        std::size_t count = 0;
+        if (client->handshakeSent < client->handshake.size()) {
+            iov[count].iov_base = client->handshake.data() + client->handshakeSent;
+            iov[count].iov_len = client->handshake.size() - client->handshakeSent;
+            ++count;
+        }
+        for (std::size_t i = 0; i < client->queue.size() && count < kMaxIovecs; ++i) {
+            const std::string& frame = client->queue[i]->frame;
+            const std::size_t offset = (i == 0) ? client->frontSent : 0;
+            iov[count].iov_base = const_cast<char*>(frame.data() + offset);
+            iov[count].iov_len = frame.size() - offset;
+            ++count;
+        }
+
+        msghdr message{};
+        message.msg_iov = iov.data();
+        message.msg_iovlen = count;
+        const ssize_t sent = sendmsg(client->fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        auto remaining = static_cast<std::size_t>(sent);
+        const std::size_t handshakeTake = std::min(remaining, client->handshake.size() - client->handshakeSent);
+        client->handshakeSent += handshakeTake;
+        remaining -= handshakeTake;
+        while (remaining > 0 && !client->queue.empty()) {
+            const std::size_t frontLeft = client->queue.front()->frame.size() - client->frontSent;
+            if (remaining < frontLeft) {
+                client->frontSent += remaining;
+                break;
+            }
+            remaining -= frontLeft;
+            client->queuedReplies -= client->queue.front()->reply ? 1 : 0;
+            client->queue.pop_front();
+            client->frontSent = 0;
+            ++sentFrames_;
+        }
+    }
+    return !client->closing;
+}
+
+bool WebSocketBroadcaster::ReadInbound(Client* client) {
+    char buffer[kReadChunkBytes];
+    while (true) {
+        const ssize_t received = recv(client->fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            if (!client->closing) {
+                client->reader.Append(buffer, static_cast<std::size_t>(received));
+                ProcessInbound(client);
+            }
+            continue;
+        }
+        if (received == 0) {
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+        }
+        return FlushClient(client);
+    }
+}
+
+void WebSocketBroadcaster::ProcessInbound(Client* client) {
+    WebSocketInbound inbound;
+    while (!client->closing) {
+        const WebSocketReader::Status status = client->reader.Next(&inbound);
+        if (status == WebSocketReader::Status::kIncomplete) {
+            return;
+        }
+        if (status == WebSocketReader::Status::kError) {
+            StartClose(client, client->reader.ErrorCode());
+            return;
+        }
+
+        switch (inbound.opcode) {
+            case WebSocketOpcode::kPing:
+                if (ReserveReply(client)) {
+                    EnqueueControl(client, EncodeWebSocketFrame(WebSocketOpcode::kPong, inbound.payload), true);
+                }
+                break;
+            case WebSocketOpcode::kPong:
+                client->awaitingPong = false;
+                break;
+            case WebSocketOpcode::kClose: {
+                if (inbound.payload.empty()) {
+                    StartClose(client, 0);
+                    break;
+                }
+                const std::uint16_t code =
+                    (inbound.payload.size() < 2)
+                        ? 0
+                        : static_cast<std::uint16_t>((static_cast<unsigned char>(inbound.payload[0]) << 8) |
+                                                     static_cast<unsigned char>(inbound.payload[1]));
+                if (!IsValidWebSocketCloseCode(code)) {
+                    StartClose(client, kWebSocketCloseProtocolError);
+                } else if (!IsValidUtf8(std::string_view(inbound.payload).substr(2))) {
+                    StartClose(client, kWebSocketCloseInvalidPayload);
+                } else {
+                    StartClose(client, code);
+                }
+                break;
+            }
+            case WebSocketOpcode::kText:
+                if (ReserveReply(client)) {
+                    HandleTextMessage(client, &inbound);
+                }
+                break;
+            default:
+                StartClose(client, kWebSocketCloseUnsupportedData);
+                break;
+        }
+    }
+}
+
+void WebSocketBroadcaster::HandleTextMessage(Client* client, WebSocketInbound* inbound) {
+    std::string text;
+    if (inbound->compressed) {
+        if (!inflater_.Decompress(inbound->payload, kMaxInboundMessageBytes, &text)) {
+            StartClose(client, kWebSocketCloseInvalidPayload);
+            return;
+        }
+    } else {
+        text = std::move(inbound->payload);
+    }
+    if (!IsValidUtf8(text)) {
+        StartClose(client, kWebSocketCloseInvalidPayload);
+        return;
+    }
+
+    WebSocketSubscription subscription;
+    std::string error;
+    if (!ParseWebSocketSubscribeMessage(text, &subscription, &error)) {
+        EnqueueReply(client, "{\"type\":\"error\",\"message\":\"" + JsonEscape(error) + "\"}");
+        return;
+    }
+
+    WebSocketSubscriptionIndex& index = indexes_[static_cast<std::size_t>(client->channel)];
+    index.Remove(client->fd, client->subscription);
+    client->subscription = std::move(subscription);
+    index.Add(client->fd, client->subscription);
+    ++subscriptionUpdates_;
+    EnqueueReply(client, "{\"type\":\"subscribed\"}");
+}
+
+void WebSocketBroadcaster::ExpireTimers() {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::uint64_t> expired;
+    timers_.Advance(now, &expired);
+
+    for (const std::uint64_t payload : expired) {
+        const int fd = static_cast<int>(payload);
+        const auto it = clients_.find(fd);
+        if (it == clients_.end()) {
+            continue;
+        }
+
+        Client* client = &it->second;
+        if (client->closing || client->awaitingPong) {
+            if (!client->closing) {
+                ++pingTimeouts_;
+            }
+            if (CloseClient(fd)) {
+                ++disconnectedClients_;
+            }
+            continue;
+        }
+
+        client->awaitingPong = true;
+        EnqueueControl(client, EncodeWebSocketFrame(WebSocketOpcode::kPing, {}));
+        if (!FlushClient(client)) {
+            CloseClient(fd);
+            continue;
+        }
+        timers_.Schedule(client->timer, now + std::chrono::milliseconds(config_.pingIntervalMs));
+    }
+}
+
+bool WebSocketBroadcaster::CloseClient(int fd) {
+    const auto it = clients_.find(fd);
+    if (it == clients_.end()) {
+        return false;
+    }
+    timers_.Destroy(it->second.timer);
+    indexes_[static_cast<std::size_t>(it->second.channel)].Remove(fd, it->second.subscription);
+    clients_.erase(it);
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    --clientCount_;
+    return true;
+}
+
+void WebSocketBroadcaster::CloseAllClients() {
+    const std::string goingAway = EncodeWebSocketClose(kWebSocketCloseGoingAway);
+    for (const auto& [fd, client] : clients_) {
+        if (client.frontSent == 0 && client.handshakeSent == client.handshake.size() && !client.closing) {
+            [[maybe_unused]] const ssize_t sent = send(fd, goingAway.data(), goingAway.size(), MSG_NOSIGNAL);
+        }
+        timers_.Destroy(client.timer);
+        close(fd);
+    }
+    clients_.clear();
+    indexes_ = {};
+}
+
+}
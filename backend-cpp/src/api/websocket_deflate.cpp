@@ -0,0 +1,212 @@
+#include "api/websocket_deflate.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#ifndef AGRI_USE_ZLIB
+#define AGRI_USE_ZLIB 0
+#endif
+
+#if AGRI_USE_ZLIB && __has_include(<zlib.h>)
+#include <zlib.h>
+#define AGRI_DEFLATE_ENABLED 1
+#else
+#define AGRI_DEFLATE_ENABLED 0
+#endif
+
+#include "api/http_request_parser.h"
+
+namespace agri {
+
+namespace {
+
+constexpr char kDeflateTail[] = {'\x00', '\x00', '\xff', '\xff'};
+constexpr std::size_t kDeflateTailBytes = sizeof(kDeflateTail);
+constexpr std::size_t kChunkBytes = 16 * 1024;
+
+std::string_view Trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool AcceptOfferParameter(std::string_view parameter) {
+    const std::size_t eq = parameter.find('=');
+    const std::string_view name = Trim(parameter.substr(0, eq));
+    std::string_view value = (eq == std::string_view::npos) ? std::string_view() : Trim(parameter.substr(eq + 1));
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+    }
+
+    if (EqualsIgnoreCase(name, "server_no_context_takeover") ||
+        EqualsIgnoreCase(name, "client_no_context_takeover") ||
+        EqualsIgnoreCase(name, "client_max_window_bits")) {
+        return true;
+    }
+    if (EqualsIgnoreCase(name, "server_max_window_bits")) {
+        return value == "15";
+    }
+    return false;
+}
+
+bool AcceptOffer(std::string_view offer) {
+    std::size_t semicolon = offer.find(';');
+    if (!EqualsIgnoreCase(Trim(offer.substr(0, semicolon)), "permessage-deflate")) {
+        return false;
+    }
+    while (semicolon != std::string_view::npos) {
+        offer.remove_prefix(semicolon + 1);
+        semicolon = offer.find(';');
+        if (!AcceptOfferParameter(offer.substr(0, semicolon))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+bool PerMessageDeflateAvailable() {
+    return AGRI_DEFLATE_ENABLED != 0;
+}
+
+std::optional<std::string> NegotiatePerMessageDeflate(std::string_view extensionsHeader) {
+    if (!PerMessageDeflateAvailable()) {
+        return std::nullopt;
+    }
+    while (!extensionsHeader.empty()) {
+        const std::size_t comma = extensionsHeader.find(',');
+        if (AcceptOffer(extensionsHeader.substr(0, comma))) {
+            return std::string("permessage-deflate; server_no_context_takeover; client_no_context_takeover");
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        extensionsHeader.remove_prefix(comma + 1);
+    }
+    return std::nullopt;
+}
+
+#if AGRI_DEFLATE_ENABLED
+
+MessageDeflater::MessageDeflater() {
+    auto* stream = new z_stream{};
+    if (deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        delete stream;
+        return;
+    }
+    stream_ = stream;
+}
+
+MessageDeflater::~MessageDeflater() {
+    if (stream_ != nullptr) {
+        auto* stream = static_cast<z_stream*>(stream_);
+        deflateEnd(stream);
+        delete stream;
+    }
+}
+
+bool MessageDeflater::Compress(std::string_view payload, std::string* compressed) {
+    if (stream_ == nullptr) {
+        return false;
+    }
+    auto* stream = static_cast<z_stream*>(stream_);
+    deflateReset(stream);
+
+    compressed->clear();
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(payload.data()));
+    stream->avail_in = static_cast<uInt>(payload.size());
+    do {
+        const std::size_t used = compressed->size();
+        compressed->resize(used + kChunkBytes);
+        stream->next_out = reinterpret_cast<Bytef*>(compressed->data() + used);
+        stream->avail_out = static_cast<uInt>(kChunkBytes);
+        if (deflate(stream, Z_SYNC_FLUSH) == Z_STREAM_ERROR) {
+            return false;
+        }
+        compressed->resize(used + kChunkBytes - stream->avail_out);
+    } while (stream->avail_out == 0 || stream->avail_in > 0);
+
+    if (compressed->size() < kDeflateTailBytes ||
+        compressed->compare(compressed->size() - kDeflateTailBytes, kDeflateTailBytes, kDeflateTail,
+                            kDeflateTailBytes) != 0) {
+        return false;
+    }
+    compressed->resize(compressed->size() - kDeflateTailBytes);
+    return true;
+}
+
+MessageInflater::MessageInflater() {
+    auto* stream = new z_stream{};
+    if (inflateInit2(stream, -MAX_WBITS) != Z_OK) {
+        delete stream;
+        return;
+    }
+    stream_ = stream;
+}
+
+MessageInflater::~MessageInflater() {
+    if (stream_ != nullptr) {
+        auto* stream = static_cast<z_stream*>(stream_);
+        inflateEnd(stream);
+        delete stream;
+    }
+}
+
+bool MessageInflater::Decompress(std::string_view payload, std::size_t maxBytes, std::string* decompressed) {
+    if (stream_ == nullptr) {
+        return false;
+    }
+    auto* stream = static_cast<z_stream*>(stream_);
+    inflateReset(stream);
+
+    decompressed->clear();
+    const std::string_view parts[2] = {payload, std::string_view(kDeflateTail, kDeflateTailBytes)};
+    for (const std::string_view part : parts) {
+        stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(part.data()));
+        stream->avail_in = static_cast<uInt>(part.size());
+        while (stream->avail_in > 0) {
+            const std::size_t used = decompressed->size();
+            if (used > maxBytes) {
+                return false;
+            }
+            const std::size_t chunk = std::min(kChunkBytes, maxBytes + 1 - used);
+            decompressed->resize(used + chunk);
+            stream->next_out = reinterpret_cast<Bytef*>(decompressed->data() + used);
+            stream->avail_out = static_cast<uInt>(chunk);
+            const int status = inflate(stream, Z_SYNC_FLUSH);
+            decompressed->resize(used + chunk - stream->avail_out);
+            if (status == Z_STREAM_END) {
+                return decompressed->size() <= maxBytes;
+            }
+            if (status != Z_OK && (status != Z_BUF_ERROR || stream->avail_out != 0)) {
+                return false;
+            }
+        }
+    }
+    return decompressed->size() <= maxBytes;
+}
+
+#else
+
+MessageDeflater::MessageDeflater() = default;
+MessageDeflater::~MessageDeflater() = default;
+
+bool MessageDeflater::Compress(std::string_view, std::string*) {
+    return false;
+}
+
+MessageInflater::MessageInflater() = default;
+MessageInflater::~MessageInflater() = default;
+
+bool MessageInflater::Decompress(std::string_view, std::size_t, std::string*) {
+    return false;
+}
+
+#endif
+
+}
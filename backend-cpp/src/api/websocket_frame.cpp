@@ -0,0 +1,221 @@
+#include "api/websocket_frame.h"
+
+#include <cstring>
+
+namespace agri {
+
+namespace {
+
+bool IsKnownOpcode(std::uint8_t opcode) {
+    switch (static_cast<WebSocketOpcode>(opcode)) {
+        case WebSocketOpcode::kContinuation:
+        case WebSocketOpcode::kText:
+        case WebSocketOpcode::kBinary:
+        case WebSocketOpcode::kClose:
+        case WebSocketOpcode::kPing:
+        case WebSocketOpcode::kPong:
+            return true;
+    }
+    return false;
+}
+
+}
+
+std::string EncodeWebSocketFrame(WebSocketOpcode opcode, std::string_view payload, bool compressed) {
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    frame.push_back(static_cast<char>(0x80 | (compressed ? 0x40 : 0x00) | static_cast<std::uint8_t>(opcode)));
+
+    const std::size_t size = payload.size();
+    if (size <= 125) {
+        frame.push_back(static_cast<char>(size));
+    } else if (size <= 0xFFFF) {
+        frame.push_back(static_cast<char>(126));
+        frame.push_back(static_cast<char>((size >> 8) & 0xFF));
+        frame.push_back(static_cast<char>(size & 0xFF));
+    } else {
+        frame.push_back(static_cast<char>(127));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame.push_back(static_cast<char>((size >> shift) & 0xFF));
+        }
+    }
+
+    frame.append(payload);
+    return frame;
+}
+
+std::string EncodeWebSocketClose(std::uint16_t code, std::string_view reason) {
+    std::string payload;
+    payload.push_back(static_cast<char>((code >> 8) & 0xFF));
+    payload.push_back(static_cast<char>(code & 0xFF));
+    payload.append(reason.substr(0, 123));
+    return EncodeWebSocketFrame(WebSocketOpcode::kClose, payload);
+}
+
+bool IsValidUtf8(std::string_view text) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    const std::size_t size = text.size();
+    std::size_t i = 0;
+    while (i < size) {
+        if (i + 8 <= size) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            if ((word & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+
+        const unsigned char lead = bytes[i];
+        if (lead < 0x80) {
+            ++i;
+            continue;
+        }
+
+        std::size_t length = 0;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            low = (lead == 0xE0) ? 0xA0 : 0x80;
+            high = (lead == 0xED) ? 0x9F : 0xBF;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            low = (lead == 0xF0) ? 0x90 : 0x80;
+            high = (lead == 0xF4) ? 0x8F : 0xBF;
+        } else {
+            return false;
+        }
+        if (i + length > size || bytes[i + 1] < low || bytes[i + 1] > high) {
+            return false;
+        }
+        for (std::size_t k = 2; k < length; ++k) {
+            if ((bytes[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += length;
+    }
+    return true;
+}
+
+bool IsValidWebSocketCloseCode(std::uint16_t code) {
+    return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1014) || (code >= 3000 && code <= 4999);
+}
+
+WebSocketReader::WebSocketReader(std::size_t maxMessageBytes, bool compressionNegotiated)
+    : maxMessageBytes_(maxMessageBytes), compressionNegotiated_(compressionNegotiated) {}
+
+void WebSocketReader::Append(const char* data, std::size_t size) {
+    buffer_.append(data, size);
+}
+
+WebSocketReader::Status WebSocketReader::Next(WebSocketInbound* inbound) {
+    if (errorCode_ != 0) {
+        return Status::kError;
+    }
+
+    while (true) {
+        const std::size_t available = buffer_.size() - offset_;
+        if (available < 2) {
+            break;
+        }
+
+        const auto* bytes = reinterpret_cast<const unsigned char*>(buffer_.data() + offset_);
+        const bool fin = (bytes[0] & 0x80) != 0;
+        const bool rsv1 = (bytes[0] & 0x40) != 0;
+        const std::uint8_t opcodeBits = bytes[0] & 0x0F;
+        const std::uint8_t lengthBits = bytes[1] & 0x7F;
+
+        if ((bytes[0] & 0x30) != 0 || (bytes[1] & 0x80) == 0 || !IsKnownOpcode(opcodeBits)) {
+            return Fail(kWebSocketCloseProtocolError);
+        }
+
+        const std::size_t extendedBytes = (lengthBits == 126) ? 2 : (lengthBits == 127) ? 8 : 0;
+        const std::size_t headerBytes = 2 + extendedBytes + 4;
+        if (available < headerBytes) {
+            break;
+        }
+
+        std::uint64_t length = lengthBits;
+        if (extendedBytes > 0) {
+            length = 0;
+            for (std::size_t i = 0; i < extendedBytes; ++i) {
+                length = (length << 8) | bytes[2 + i];
+            }
+        }
+
+        const auto opcode = static_cast<WebSocketOpcode>(opcodeBits);
+        const bool control = (opcodeBits & 0x08) != 0;
+        if (control) {
+            if (!fin || rsv1 || length > 125) {
+                return Fail(kWebSocketCloseProtocolError);
+            }
+        } else {
+            const bool continuation = opcode == WebSocketOpcode::kContinuation;
+            if (continuation != inMessage_ || (rsv1 && (continuation || !compressionNegotiated_))) {
+                return Fail(kWebSocketCloseProtocolError);
+            }
+            if (length > maxMessageBytes_ || message_.size() + length > maxMessageBytes_) {
+                return Fail(kWebSocketCloseMessageTooBig);
+            }
+        }
+
+        if (available - headerBytes < length) {
+            break;
+        }
+
+        const unsigned char* mask = bytes + headerBytes - 4;
+        const unsigned char* payload = bytes + headerBytes;
+        std::string* target = control ? &inbound->payload : &message_;
+        if (control) {
+            target->clear();
+        } else if (!inMessage_) {
+            message_.clear();
+            messageOpcode_ = opcode;
+            messageCompressed_ = rsv1;
+            inMessage_ = true;
+        }
+
+        const std::size_t base = target->size();
+        target->resize(base + length);
+        for (std::size_t i = 0; i < length; ++i) {
+            (*target)[base + i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+        }
+        offset_ += headerBytes + length;
+
+        if (control) {
+            inbound->opcode = opcode;
+            inbound->compressed = false;
+            return Status::kReady;
+        }
+        if (fin) {
+            inMessage_ = false;
+            inbound->opcode = messageOpcode_;
+            inbound->compressed = messageCompressed_;
+            inbound->payload = std::move(message_);
+            message_.clear();
+            return Status::kReady;
+        }
+    }
+
+    if (offset_ == buffer_.size()) {
+        buffer_.clear();
+        offset_ = 0;
+    } else if (offset_ > 0) {
+        buffer_.erase(0, offset_);
+        offset_ = 0;
+    }
+    return Status::kIncomplete;
+}
+
+WebSocketReader::Status WebSocketReader::Fail(std::uint16_t code) {
+    errorCode_ = code;
+    buffer_.clear();
+    offset_ = 0;
+    return Status::kError;
+}
+
+}
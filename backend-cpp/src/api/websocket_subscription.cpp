@@ -0,0 +1,312 @@
+#include "api/websocket_subscription.h"
+
+#include <algorithm>
+
+#include "api/http_router.h"
+
+namespace agri {
+
+namespace {
+
+constexpr std::size_t kMaxFilterValues = 64;
+
+bool Contains(const std::vector<std::string>& values, std::string_view value) {
+    return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+bool AllowsAny(const std::vector<std::string>& values, std::string_view value) {
+    return values.empty() || Contains(values, value);
+}
+
+std::vector<std::string>* FilterValues(WebSocketSubscription* subscription, std::string_view key) {
+    if (key == "deviceId") {
+        return &subscription->deviceIds;
+    }
+    if (key == "batchCode") {
+        return &subscription->batchCodes;
+    }
+    if (key == "transport") {
+        return &subscription->transports;
+    }
+    if (key == "group") {
+        return &subscription->deviceGroups;
+    }
+    return nullptr;
+}
+
+bool AppendValues(std::string_view rest, std::vector<std::string>* values, bool trimGroupSeparator) {
+    while (true) {
+        const std::size_t comma = rest.find(',');
+        std::string_view value = rest.substr(0, comma);
+        while (trimGroupSeparator && !value.empty() && value.back() == '-') {
+            value.remove_suffix(1);
+        }
+        if (!value.empty() && !Contains(*values, value)) {
+            if (values->size() == kMaxFilterValues) {
+                return false;
+            }
+            values->emplace_back(value);
+        }
+        if (comma == std::string_view::npos) {
+            return true;
+        }
+        rest.remove_prefix(comma + 1);
+    }
+}
+
+class FlatJsonReader {
+   public:
+    explicit FlatJsonReader(std::string_view text) : text_(text) {}
+
+    bool Consume(char expected) {
+        SkipWhitespace();
+        if (position_ < text_.size() && text_[position_] == expected) {
+            ++position_;
+            return true;
+        }
+        return false;
+    }
+
+    bool Peek(char expected) {
+        SkipWhitespace();
+        return position_ < text_.size() && text_[position_] == expected;
+    }
+
+    bool AtEnd() {
+        SkipWhitespace();
+        return position_ == text_.size();
+    }
+
+    bool ReadString(std::string* out) {
+        out->clear();
+        if (!Consume('"')) {
+            return false;
+        }
+        while (position_ < text_.size()) {
+            const char c = text_[position_++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out->push_back(c);
+                continue;
+            }
+            if (position_ == text_.size()) {
+                return false;
+            }
+            switch (text_[position_++]) {
+                case '"':
+                    out->push_back('"');
+                    break;
+                case '\\':
+                    out->push_back('\\');
+                    break;
+                case '/':
+                    out->push_back('/');
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+   private:
+    void SkipWhitespace() {
+        while (position_ < text_.size() &&
+               (text_[position_] == ' ' || text_[position_] == '\t' || text_[position_] == '\n' ||
+                text_[position_] == '\r')) {
+            ++position_;
+        }
+    }
+
+    std::string_view text_;
+    std::size_t position_{0};
+};
+
+void RemoveFd(std::vector<int>* fds, int fd) {
+    const auto it = std::find(fds->begin(), fds->end(), fd);
+    if (it != fds->end()) {
+        *it = fds->back();
+        fds->pop_back();
+    }
+}
+
+}
+
+bool WebSocketSubscription::Empty() const {
+    return deviceIds.empty() && batchCodes.empty() && transports.empty() && deviceGroups.empty();
+}
+
+bool WebSocketSubscription::Matches(const WebSocketEventKeys& keys) const {
+    if (!AllowsAny(deviceIds, keys.deviceId) || !AllowsAny(batchCodes, keys.batchCode) ||
+        !AllowsAny(transports, keys.transport)) {
+        return false;
+    }
+    if (deviceGroups.empty()) {
+        return true;
+    }
+    return std::any_of(deviceGroups.begin(), deviceGroups.end(), [&keys](const std::string& group) {
+        return DeviceInGroup(keys.deviceId, group);
+    });
+}
+
+bool ParseWebSocketSubscription(std::string_view query, WebSocketSubscription* subscription, std::string* error) {
+    QueryParams params;
+    params.Parse(query);
+    for (std::size_t i = 0; i < params.Size(); ++i) {
+        const std::string_view key = params.KeyAt(i);
+        std::vector<std::string>* values = FilterValues(subscription, key);
+        if (values == nullptr) {
+            *error = "unknown subscription filter: " + std::string(key);
+            return false;
+        }
+        if (!AppendValues(QueryParams::Decode(params.ValueAt(i)), values, values == &subscription->deviceGroups)) {
+            *error = "too many values for subscription filter: " + std::string(key);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseWebSocketSubscribeMessage(std::string_view json, WebSocketSubscription* subscription, std::string* error) {
+    FlatJsonReader reader(json);
+    if (!reader.Consume('{')) {
+        *error = "control message must be a JSON object";
+        return false;
+    }
+
+    bool subscribe = false;
+    std::string key;
+    std::string value;
+    while (!reader.Consume('}')) {
+        if (!reader.ReadString(&key) || !reader.Consume(':')) {
+            *error = "invalid control message";
+            return false;
+        }
+        if (key == "type") {
+            if (!reader.ReadString(&value) || value != "subscribe") {
+                *error = "unsupported control message type";
+                return false;
+            }
+            subscribe = true;
+        } else {
+            std::vector<std::string>* values = FilterValues(subscription, key);
+            if (values == nullptr) {
+                *error = "unknown subscription filter: " + key;
+                return false;
+            }
+            const bool array = reader.Consume('[');
+            bool first = true;
+            while (!array || !reader.Consume(']')) {
+                if (array && !first && !reader.Consume(',')) {
+                    *error = "invalid control message";
+                    return false;
+                }
+                first = false;
+                if (!reader.ReadString(&value)) {
+                    *error = "subscription filter values must be strings";
+                    return false;
+                }
+                if (!AppendValues(value, values, values == &subscription->deviceGroups)) {
+                    *error = "too many values for subscription filter: " + key;
+                    return false;
+                }
+                if (!array) {
+                    break;
+                }
+            }
+        }
+        if (!reader.Peek('}') && !reader.Consume(',')) {
+            *error = "invalid control message";
+            return false;
+        }
+    }
+
+    if (!reader.AtEnd() || !subscribe) {
+        *error = subscribe ? "invalid control message" : "control message type is required";
+        return false;
+    }
+    return true;
+}
+
+bool DeviceInGroup(std::string_view deviceId, std::string_view group) {
+    return deviceId.size() >= group.size() && deviceId.compare(0, group.size(), group) == 0 &&
+           (deviceId.size() == group.size() || deviceId[group.size()] == '-');
+}
+
+void WebSocketSubscriptionIndex::Add(int fd, const WebSocketSubscription& subscription) {
+    ++size_;
+    const std::vector<std::string>* values = nullptr;
+    Postings* postings = SelectPostings(subscription, &values);
+    if (postings == nullptr) {
+        unfiltered_.push_back(fd);
+        return;
+    }
+    if (postings == &byGroup_) {
+        for (const std::string& group : IndexedGroups(*values)) {
+            byGroup_[group].push_back(fd);
+        }
+        return;
+    }
+    for (const std::string& value : *values) {
+        (*postings)[value].push_back(fd);
+    }
+}
+
+void WebSocketSubscriptionIndex::Remove(int fd, const WebSocketSubscription& subscription) {
+    --size_;
+    const std::vector<std::string>* values = nullptr;
+    Postings* postings = SelectPostings(subscription, &values);
+    if (postings == nullptr) {
+        RemoveFd(&unfiltered_, fd);
+        return;
+    }
+    for (const std::string& value : *values) {
+        const auto it = postings->find(value);
+        if (it == postings->end()) {
+            continue;
+        }
+        RemoveFd(&it->second, fd);
+        if (it->second.empty()) {
+            postings->erase(it);
+        }
+    }
+}
+
+WebSocketSubscriptionIndex::Postings* WebSocketSubscriptionIndex::SelectPostings(
+    const WebSocketSubscription& subscription,
+    const std::vector<std::string>** values) {
+    if (!subscription.deviceIds.empty()) {
+        *values = &subscription.deviceIds;
+        return &byDevice_;
+    }
+    if (!subscription.batchCodes.empty()) {
+        *values = &subscription.batchCodes;
+        return &byBatch_;
+    }
+    if (!subscription.deviceGroups.empty()) {
+        *values = &subscription.deviceGroups;
+        return &byGroup_;
+    }
+    if (!subscription.transports.empty()) {
+        *values = &subscription.transports;
+        return &byTransport_;
+    }
+    return nullptr;
+}
+
+std::vector<std::string> WebSocketSubscriptionIndex::IndexedGroups(const std::vector<std::string>& groups) {
+    std::vector<std::string> indexed;
+    for (const std::string& group : groups) {
+        const bool covered = std::any_of(groups.begin(), groups.end(), [&group](const std::string& other) {
+            return other.size() < group.size() && DeviceInGroup(group, other);
+        });
+        if (!covered) {
+            indexed.push_back(group);
+        }
+    }
+    return indexed;
+}
+
+}
@@ -1,13 +1,99 @@
 #include "services/ingest_service.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <chrono>
+#include <condition_variable>
 #include <exception>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
 
 #include "transport/json_parser.h"
-#include "utils/hash_utils.h"
 
 namespace agri {
 
+namespace {
+
+constexpr std::size_t kParallelChunk = 8;
+constexpr std::size_t kHashGroup = 64;
+
+using CanonicalPieces = std::array<std::string_view, 5>;
+using TimestampText = std::array<char, 20>;
+
+CanonicalPieces CanonicalPiecesOf(const TelemetryPacketView& packet, TimestampText* timestamp) {
+    char* begin = timestamp->data();
+    char* end = std::to_chars(begin, begin + timestamp->size(), packet.timestamp).ptr;
+    return {packet.deviceId, "|", std::string_view(begin, static_cast<std::size_t>(end - begin)), "|",
+            packet.telemetryJson};
+}
+
+void RunParallel(std::size_t count, WorkStealingPool* pool, const std::function<void(std::size_t)>& body) {
+    const std::size_t chunks = (count + kParallelChunk - 1) / kParallelChunk;
+    if (pool == nullptr || chunks < 2) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // body and everything it captures live on the caller's stack, so a throwing chunk still counts as finished and
+    // the first exception is rethrown only after every chunk is accounted for.
+    struct State {
+        std::atomic<std::size_t> nextChunk{0};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t finishedChunks{0};
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    auto drain = [state, count, chunks, work = &body]() {
+        std::size_t finished = 0;
+        for (std::size_t chunk = state->nextChunk.fetch_add(1); chunk < chunks; chunk = state->nextChunk.fetch_add(1)) {
+            if (!state->failed.load(std::memory_order_relaxed)) {
+                try {
+                    const std::size_t end = std::min(count, (chunk + 1) * kParallelChunk);
+                    for (std::size_t i = chunk * kParallelChunk; i < end; ++i) {
+                        (*work)(i);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                    state->failed.store(true, std::memory_order_relaxed);
+                }
+            }
+            ++finished;
+        }
+        if (finished > 0) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finishedChunks += finished;
+            if (state->finishedChunks == chunks) {
+                state->done.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min(pool->WorkerCount(), chunks - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        pool->Submit(drain);
+    }
+    drain();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state, chunks] { return state->finishedChunks == chunks; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+}
+
 IngestService::IngestService(
     TelemetryRepository& repository,
     const SignatureVerifier& signatureVerifier,
@@ -16,7 +102,7 @@ IngestService::IngestService(
       signatureVerifier_(signatureVerifier),
       blockchainClient_(blockchainClient) {}
 
-IngestResult IngestService::Ingest(const TelemetryPacket& packet) {
+IngestResult IngestService::Ingest(const TelemetryPacketView& packet) {
     const auto begin = std::chrono::steady_clock::now();
 
     IngestResult result;
@@ -34,33 +120,8 @@ IngestResult IngestService::Ingest(const TelemetryPacket& packet) {
         }
     };
 
-    if (packet.deviceId.empty()) {
-        finishWith(false, "deviceId is required");
-        return result;
-    }
-    if (packet.timestamp == 0) {
-        finishWith(false, "timestamp must be positive");
-        return result;
-    }
-    if (packet.telemetryJson.empty()) {
-        finishWith(false, "telemetry payload is required");
-        return result;
-    }
-    if (!IsHex64(packet.hashHex)) {
-        finishWith(false, "hash must be 64 hex characters");
-        return result;
-    }
-
-    const std::string canonical =
-        packet.deviceId + "|" + std::to_string(packet.timestamp) + "|" + packet.telemetryJson;
-    const std::string expectedHash = Sha256Hex(canonical);
-    if (packet.hashHex != expectedHash) {
-        finishWith(false, "hash mismatch with payload");
-        return result;
-    }
-
-    if (!signatureVerifier_.Verify(packet)) {
-        finishWith(false, "signature verification failed");
+    if (const std::optional<std::string> error = Validate(packet); error.has_value()) {
+        finishWith(false, *error);
         return result;
     }
 
@@ -81,7 +142,7 @@ IngestResult IngestService::Ingest(const TelemetryPacket& packet) {
 
     BlockchainReceipt receipt;
     try {
-        receipt = blockchainClient_.SubmitHash(packet.hashHex, packet.deviceId, packet.timestamp);
+        receipt = blockchainClient_.SubmitHash(std::string(packet.hashHex), std::string(packet.deviceId), packet.timestamp);
     } catch (const std::exception& ex) {
         std::string rollbackSuffix;
         rollbackBestEffort(&rollbackSuffix);
@@ -118,6 +179,137 @@ IngestResult IngestService::Ingest(const TelemetryPacket& packet) {
     return result;
 }
 
+BatchIngestResult IngestService::IngestBatch(const std::vector<TelemetryPacketView>& packets, WorkStealingPool* pool) {
+    const auto begin = std::chrono::steady_clock::now();
+
+    BatchIngestResult batch;
+    batch.results.resize(packets.size());
+    std::vector<TimestampText> timestamps(packets.size());
+    std::vector<CanonicalPieces> canonical(packets.size());
+    std::vector<Sha256Pieces> messages(packets.size());
+    for (std::size_t i = 0; i < packets.size(); ++i) {
+        canonical[i] = CanonicalPiecesOf(packets[i], &timestamps[i]);
+        messages[i] = canonical[i];
+    }
+    std::vector<Sha256Digest> digests(packets.size());
+    const std::size_t hashGroups = (packets.size() + kHashGroup - 1) / kHashGroup;
+    RunParallel(hashGroups, pool, [&](std::size_t group) {
+        const std::size_t first = group * kHashGroup;
+        const std::size_t count = std::min(kHashGroup, packets.size() - first);
+        Sha256Batch(std::span<const Sha256Pieces>(messages).subspan(first, count), digests.data() + first);
+    });
+
+    std::vector<std::optional<std::string>> errors(packets.size());
+    RunParallel(packets.size(), pool,
+                [&](std::size_t index) { errors[index] = Validate(packets[index], &digests[index]); });
+
+    std::vector<std::size_t> validIndexes;
+    std::vector<TelemetryPacketView> validPackets;
+    std::vector<std::string> leafHashes;
+    std::uint64_t latestTimestamp = 0;
+    for (std::size_t i = 0; i < packets.size(); ++i) {
+        if (errors[i].has_value()) {
+            batch.results[i].message = std::move(*errors[i]);
+            continue;
+        }
+        validIndexes.push_back(i);
+        validPackets.push_back(packets[i]);
+        leafHashes.emplace_back(packets[i].hashHex);
+        latestTimestamp = std::max(latestTimestamp, packets[i].timestamp);
+    }
+
+    if (!validPackets.empty()) {
+        batch.merkleRoot = MerkleRootHex(std::move(leafHashes));
+        const std::vector<std::uint64_t> recordIds = repository_.SaveBatch(validPackets);
+
+        std::string failure;
+        BlockchainReceipt receipt;
+        try {
+            receipt = blockchainClient_.SubmitHash(batch.merkleRoot, "batch", latestTimestamp);
+            if (!repository_.AttachReceiptBatch(recordIds, receipt)) {
+                failure = "receipt persistence failed after blockchain submit";
+            }
+        } catch (const std::exception& ex) {
+            failure = std::string("batch anchoring failed: ") + ex.what();
+        } catch (...) {
+            failure = "batch anchoring failed: unknown error";
+        }
+
+        if (!failure.empty()) {
+            for (const std::uint64_t recordId : recordIds) {
+                try {
+                    if (!repository_.Delete(recordId)) {
+                        failure += "; rollback delete did not remove record " + std::to_string(recordId);
+                        break;
+                    }
+                } catch (const std::exception& ex) {
+                    failure += std::string("; rollback delete failed: ") + ex.what();
+                    break;
+                } catch (...) {
+                    failure += "; rollback delete failed: unknown error";
+                    break;
+                }
+            }
+        }
+
+        for (std::size_t k = 0; k < validIndexes.size(); ++k) {
+            IngestResult& result = batch.results[validIndexes[k]];
+            if (failure.empty()) {
+                result.accepted = true;
+                result.message = "accepted";
+                result.recordId = recordIds[k];
+                result.receipt = receipt;
+            } else {
+                result.message = failure;
+            }
+        }
+        if (failure.empty()) {
+            batch.receipt = receipt;
+            batch.acceptedCount = validIndexes.size();
+        }
+    }
+
+    batch.processingMs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count());
+    for (IngestResult& result : batch.results) {
+        result.processingMs = batch.processingMs;
+    }
+    RecordBatch(batch.acceptedCount, packets.size() - batch.acceptedCount, batch.processingMs);
+    return batch;
+}
+
+std::optional<std::string> IngestService::Validate(const TelemetryPacketView& packet,
+                                                   const Sha256Digest* payloadDigest) const {
+    if (std::string error; !CheckTelemetryLengths(packet, &error)) {
+        return error;
+    }
+    if (packet.timestamp == 0) {
+        return "timestamp must be positive";
+    }
+    if (packet.telemetryJson.empty()) {
+        return "telemetry payload is required";
+    }
+    Sha256Digest expected;
+    if (!DecodeSha256Hex(packet.hashHex, &expected)) {
+        return "hash must be 64 hex characters";
+    }
+
+    if (payloadDigest == nullptr) {
+        TimestampText timestamp;
+        const CanonicalPieces pieces = CanonicalPiecesOf(packet, &timestamp);
+        if (Sha256({pieces[0], pieces[1], pieces[2], pieces[3], pieces[4]}) != expected) {
+            return "hash mismatch with payload";
+        }
+    } else if (*payloadDigest != expected) {
+        return "hash mismatch with payload";
+    }
+
+    if (!signatureVerifier_.Verify(packet)) {
+        return "signature verification failed";
+    }
+    return std::nullopt;
+}
+
 MetricsSnapshot IngestService::GetMetricsSnapshot() const {
     std::lock_guard<std::mutex> lock(metricsMutex_);
 
@@ -144,4 +336,12 @@ void IngestService::RecordRejected(std::uint64_t processingMs) {
     totalProcessingMs_ += processingMs;
 }
 
+void IngestService::RecordBatch(std::size_t accepted, std::size_t rejected, std::uint64_t processingMs) {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    totalRequests_ += accepted + rejected;
+    acceptedRequests_ += accepted;
+    rejectedRequests_ += rejected;
+    totalProcessingMs_ += processingMs * (accepted + rejected);
+}
+
 }
@@ -4,8 +4,10 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 
+#include "api/frame_ingest_listener.h"
 #include "api/http_server.h"
 #include "blockchain/blockchain_client.h"
 #include "security/signature_verifier.h"
@@ -15,11 +17,15 @@
 namespace {
 
 agri::HttpServer* gServer = nullptr;
+agri::FrameIngestListener* gFrameListener = nullptr;
 
 void HandleSignal(int) {
     if (gServer != nullptr) {
         gServer->Stop();
     }
+    if (gFrameListener != nullptr) {
+        gFrameListener->Stop();
+    }
 }
 
 }
@@ -68,10 +74,89 @@ int main() {
         blockchainClient = std::make_unique<agri::MockBlockchainClient>();
     }
 
+    agri::HttpServerConfig serverConfig;
+    if (const char* idleMs = std::getenv("AGRI_HTTP_IDLE_TIMEOUT_MS"); idleMs != nullptr) {
+        serverConfig.idleTimeoutMs = static_cast<std::uint32_t>(std::stoul(idleMs));
+    }
+    if (const char* ioBackend = std::getenv("AGRI_HTTP_IO_BACKEND"); ioBackend != nullptr) {
+        serverConfig.ioBackend = agri::ParseHttpIoBackend(ioBackend);
+    }
+    if (const char* readMs = std::getenv("AGRI_HTTP_READ_TIMEOUT_MS"); readMs != nullptr) {
+        serverConfig.readTimeoutMs = static_cast<std::uint32_t>(std::stoul(readMs));
+    }
+    if (const char* writeMs = std::getenv("AGRI_HTTP_WRITE_TIMEOUT_MS"); writeMs != nullptr) {
+        serverConfig.writeTimeoutMs = static_cast<std::uint32_t>(std::stoul(writeMs));
+    }
+    if (const char* maxRequests = std::getenv("AGRI_HTTP_MAX_REQUESTS_PER_CONNECTION"); maxRequests != nullptr) {
+        serverConfig.maxRequestsPerConnection = static_cast<std::uint32_t>(std::stoul(maxRequests));
+    }
+    if (const char* workers = std::getenv("AGRI_HTTP_WORKER_THREADS"); workers != nullptr) {
+        serverConfig.workerThreads = static_cast<std::uint32_t>(std::stoul(workers));
+    }
+    if (const char* reactors = std::getenv("AGRI_HTTP_REACTORS"); reactors != nullptr) {
+        serverConfig.reactorThreads = static_cast<std::uint32_t>(std::stoul(reactors));
+    }
+    if (const char* pin = std::getenv("AGRI_HTTP_PIN_REACTORS"); pin != nullptr) {
+        serverConfig.pinReactorThreads = std::string(pin) != "0";
+    }
+    if (const char* inFlight = std::getenv("AGRI_INGEST_MAX_IN_FLIGHT"); inFlight != nullptr) {
+        serverConfig.ingestMaxInFlight = static_cast<std::uint32_t>(std::stoul(inFlight));
+    }
+    if (const char* queued = std::getenv("AGRI_INGEST_MAX_QUEUED"); queued != nullptr) {
+        serverConfig.ingestMaxQueued = static_cast<std::size_t>(std::stoull(queued));
+    }
+    if (const char* perGateway = std::getenv("AGRI_INGEST_MAX_QUEUED_PER_GATEWAY"); perGateway != nullptr) {
+        serverConfig.ingestMaxQueuedPerGateway = static_cast<std::size_t>(std::stoull(perGateway));
+    }
+    if (const char* retryAfter = std::getenv("AGRI_INGEST_RETRY_AFTER_SECONDS"); retryAfter != nullptr) {
+        serverConfig.ingestRetryAfterSeconds = static_cast<std::uint32_t>(std::stoul(retryAfter));
+    }
+    if (const char* maxBatch = std::getenv("AGRI_INGEST_MAX_BATCH_PACKETS"); maxBatch != nullptr) {
+        serverConfig.ingestMaxBatchPackets = static_cast<std::size_t>(std::stoull(maxBatch));
+    }
+    if (const char* zeroCopy = std::getenv("AGRI_HTTP_ZEROCOPY_THRESHOLD_BYTES"); zeroCopy != nullptr) {
+        serverConfig.zeroCopyThresholdBytes = static_cast<std::size_t>(std::stoull(zeroCopy));
+    }
+    if (const char* wsQueue = std::getenv("AGRI_WS_MAX_QUEUED_FRAMES"); wsQueue != nullptr) {
+        serverConfig.wsMaxQueuedFrames = static_cast<std::size_t>(std::stoull(wsQueue));
+    }
+    if (const char* wsPolicy = std::getenv("AGRI_WS_SLOW_CLIENT_POLICY"); wsPolicy != nullptr) {
+        serverConfig.wsSlowClientPolicy = agri::ParseSlowClientPolicy(wsPolicy);
+    }
+    if (const char* wsPing = std::getenv("AGRI_WS_PING_INTERVAL_MS"); wsPing != nullptr) {
+        serverConfig.wsPingIntervalMs = static_cast<std::uint32_t>(std::stoul(wsPing));
+    }
+
+    agri::FrameIngestConfig frameConfig;
+    if (const char* tcpPort = std::getenv("AGRI_FRAME_TCP_PORT"); tcpPort != nullptr) {
+        frameConfig.tcpPort = static_cast<std::uint16_t>(std::stoul(tcpPort));
+    }
+    if (const char* udpPort = std::getenv("AGRI_FRAME_UDP_PORT"); udpPort != nullptr) {
+        frameConfig.udpPort = static_cast<std::uint16_t>(std::stoul(udpPort));
+    }
+    if (const char* maxFrame = std::getenv("AGRI_FRAME_MAX_BYTES"); maxFrame != nullptr) {
+        frameConfig.maxFrameBytes = static_cast<std::size_t>(std::stoull(maxFrame));
+    }
+    if (const char* udpBatch = std::getenv("AGRI_FRAME_UDP_BATCH"); udpBatch != nullptr) {
+        frameConfig.udpBatchSize = static_cast<std::size_t>(std::stoull(udpBatch));
+    }
+    if (const char* frameWorkers = std::getenv("AGRI_FRAME_WORKER_THREADS"); frameWorkers != nullptr) {
+        frameConfig.workerThreads = static_cast<std::uint32_t>(std::stoul(frameWorkers));
+    }
+
     agri::IngestService ingestService(repository, signatureVerifier, *blockchainClient);
-    agri::HttpServer server(kPort, ingestService, repository);
+    agri::HttpServer server(kPort, ingestService, repository, serverConfig);
+
+    std::unique_ptr<agri::FrameIngestListener> frameListener;
+    if (frameConfig.tcpPort != 0 || frameConfig.udpPort != 0) {
+        frameListener = std::make_unique<agri::FrameIngestListener>(
+            frameConfig, ingestService, [&server](const agri::TelemetryPacketView& packet, const agri::IngestResult& result) {
+                server.BroadcastIngestEvent(packet, result);
+            });
+    }
 
     gServer = &server;
+    gFrameListener = frameListener.get();
     std::signal(SIGINT, HandleSignal);
     std::signal(SIGTERM, HandleSignal);
 
@@ -82,12 +167,34 @@ int main() {
     std::cout << "chain mode: " << chainMode << std::endl;
     std::cout << "routes: /health, /api/v1/ingest, /api/v1/metrics/overview, /ws/telemetry, /ws/alerts"
               << std::endl;
+    if (frameListener) {
+        std::cout << "frame ingest: tcp=" << frameConfig.tcpPort << " udp=" << frameConfig.udpPort << std::endl;
+    }
 
+    std::thread frameThread;
+    int exitCode = 0;
     try {
+        if (frameListener) {
+            frameThread = std::thread([&frameListener] {
+                try {
+                    frameListener->Start();
+                } catch (const std::exception& ex) {
+                    std::cerr << "fatal frame listener error: " << ex.what() << std::endl;
+                }
+            });
+        }
         server.Start();
     } catch (const std::exception& ex) {
         std::cerr << "fatal server error: " << ex.what() << std::endl;
-        return 1;
+        exitCode = 1;
+    }
+
+    if (frameThread.joinable()) {
+        frameListener->Stop();
+        frameThread.join();
+    }
+    if (exitCode != 0) {
+        return exitCode;
     }
 
     std::cout << "agri_gateway stopped" << std::endl;
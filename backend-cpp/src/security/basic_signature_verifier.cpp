@@ -123,7 +123,7 @@ PublicKeyMap LoadPublicKeysFromDirectory(const std::string& directoryPath) {
 BasicSignatureVerifier::BasicSignatureVerifier(PublicKeyMap publicKeys)
     : publicKeys_(std::move(publicKeys)) {}
 
-bool BasicSignatureVerifier::Verify(const TelemetryPacket& packet) const {
+bool BasicSignatureVerifier::Verify(const TelemetryPacketView& packet) const {
     if (packet.deviceId.empty() || packet.pubKeyId.empty()) {
         return false;
     }
@@ -134,7 +134,7 @@ bool BasicSignatureVerifier::Verify(const TelemetryPacket& packet) const {
         return false;
     }
 
-    const auto keyIt = publicKeys_.find(packet.pubKeyId);
+    const auto keyIt = publicKeys_.find(std::string(packet.pubKeyId));
     if (keyIt == publicKeys_.end()) {
         return false;
     }
@@ -167,7 +167,10 @@ bool BasicSignatureVerifier::Verify(const TelemetryPacket& packet) const {
     EVP_PKEY_free(publicKey);
     return verifyOk == 1;
 #else
-    return packet.signature == packet.hashHex + ":" + packet.pubKeyId;
+    const std::string_view signature = packet.signature;
+    return signature.size() == packet.hashHex.size() + 1 + packet.pubKeyId.size() &&
+           signature.substr(0, packet.hashHex.size()) == packet.hashHex &&
+           signature[packet.hashHex.size()] == ':' && signature.substr(packet.hashHex.size() + 1) == packet.pubKeyId;
 #endif
 }
 
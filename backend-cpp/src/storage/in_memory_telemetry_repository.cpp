@@ -1,36 +1,77 @@
 #include "storage/in_memory_telemetry_repository.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace agri {
 
-std::uint64_t InMemoryTelemetryRepository::Save(const TelemetryPacket& packet) {
+std::uint64_t InMemoryTelemetryRepository::Save(const TelemetryPacketView& packet) {
     std::lock_guard<std::mutex> lock(mutex_);
+    return SaveLocked(packet);
+}
+
+std::vector<std::uint64_t> InMemoryTelemetryRepository::SaveBatch(const std::vector<TelemetryPacketView>& packets) {
+    std::vector<std::uint64_t> recordIds;
+    recordIds.reserve(packets.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.reserve(records_.size() + packets.size());
+    for (const TelemetryPacketView& packet : packets) {
+        recordIds.push_back(SaveLocked(packet));
+    }
+    return recordIds;
+}
 
+bool InMemoryTelemetryRepository::AttachReceipt(std::uint64_t recordId, const BlockchainReceipt& receipt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool attached = AttachReceiptLocked(recordId, receipt);
+    if (attached) {
+        recordIdByTxHash_[receipt.txHash] = recordId;
+    }
+    return attached;
+}
+
+bool InMemoryTelemetryRepository::AttachReceiptBatch(
+    const std::vector<std::uint64_t>& recordIds,
+    const BlockchainReceipt& receipt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::uint64_t recordId : recordIds) {
+        if (positionById_.find(recordId) == positionById_.end()) {
+            return false;
+        }
+    }
+    for (const std::uint64_t recordId : recordIds) {
+        AttachReceiptLocked(recordId, receipt);
+    }
+    if (!recordIds.empty()) {
+        recordIdByTxHash_[receipt.txHash] = recordIds.front();
+    }
+    return true;
+}
+
+std::uint64_t InMemoryTelemetryRepository::SaveLocked(const TelemetryPacketView& packet) {
     const std::uint64_t recordId = nextRecordId_++;
     TelemetryRecord record;
     record.recordId = recordId;
-    record.packet = packet;
+    record.packet = packet.Materialize();
 
-    records_.push_back(record);
+    records_.push_back(std::move(record));
+    const TelemetryPacket& saved = records_.back().packet;
     positionById_[recordId] = records_.size() - 1;
-    recordIdsByDevice_[packet.deviceId].push_back(recordId);
-    if (!packet.batchCode.empty()) {
-        recordIdsByBatch_[packet.batchCode].push_back(recordId);
+    recordIdsByDevice_[saved.deviceId].push_back(recordId);
+    if (!saved.batchCode.empty()) {
+        recordIdsByBatch_[saved.batchCode].push_back(recordId);
     }
 
     return recordId;
 }
 
-bool InMemoryTelemetryRepository::AttachReceipt(std::uint64_t recordId, const BlockchainReceipt& receipt) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool InMemoryTelemetryRepository::AttachReceiptLocked(std::uint64_t recordId, const BlockchainReceipt& receipt) {
     const auto positionIt = positionById_.find(recordId);
     if (positionIt == positionById_.end()) {
         return false;
     }
 
     records_[positionIt->second].receipt = receipt;
-    recordIdByTxHash_[receipt.txHash] = recordId;
     return true;
 }
 
@@ -115,6 +156,39 @@ std::vector<TelemetryRecord> InMemoryTelemetryRepository::FindByBatch(const std:
     return result;
 }
 
+void InMemoryTelemetryRepository::ReadBatchPage(
+    TelemetryBatchCursor* cursor,
+    std::size_t limit,
+    std::vector<TelemetryRecord>* page) const {
+    page->clear();
+    if (cursor->exhausted) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto batchIt = recordIdsByBatch_.find(cursor->batchCode);
+    if (batchIt == recordIdsByBatch_.end()) {
+        cursor->exhausted = true;
+        return;
+    }
+
+    const std::vector<std::uint64_t>& ids = batchIt->second;
+    auto it = cursor->started ? std::upper_bound(ids.begin(), ids.end(), cursor->lastRecordId) : ids.begin();
+    for (; it != ids.end() && page->size() < limit; ++it) {
+        const auto record = FindByIdLocked(*it);
+        if (record.has_value()) {
+            page->push_back(*record);
+        }
+    }
+
+    if (!page->empty()) {
+        cursor->started = true;
+        cursor->lastRecordId = page->back().recordId;
+        cursor->lastTimestamp = page->back().packet.timestamp;
+    }
+    cursor->exhausted = it == ids.end();
+}
+
 std::uint64_t InMemoryTelemetryRepository::Size() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return records_.size();
@@ -2,11 +2,15 @@
 
 #include <filesystem>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include <sqlite3.h>
 
+#include "transport/json_parser.h"
+
 namespace fs = std::filesystem;
 
 namespace agri {
@@ -69,8 +73,9 @@ std::optional<std::string> ReadNullableText(sqlite3_stmt* statement, int columnI
     return std::string(reinterpret_cast<const char*>(value));
 }
 
-void BindTextOrThrow(sqlite3* db, sqlite3_stmt* statement, int index, const std::string& value) {
-    const int code = sqlite3_bind_text(statement, index, value.c_str(), -1, SQLITE_TRANSIENT);
+void BindTextOrThrow(sqlite3* db, sqlite3_stmt* statement, int index, std::string_view value) {
+    const char* text = value.data() != nullptr ? value.data() : "";
+    const int code = sqlite3_bind_text(statement, index, text, static_cast<int>(value.size()), SQLITE_TRANSIENT);
     ThrowIfSqlError(code, db, "bind text failed");
 }
 
@@ -79,6 +84,125 @@ void BindInt64OrThrow(sqlite3* db, sqlite3_stmt* statement, int index, std::int6
     ThrowIfSqlError(code, db, "bind int64 failed");
 }
 
+class TransactionGuard {
+   public:
+    explicit TransactionGuard(sqlite3* db) : db_(db) { ExecOrThrow(db_, "BEGIN IMMEDIATE;"); }
+    ~TransactionGuard() {
+        if (!committed_) {
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+        }
+    }
+
+    TransactionGuard(const TransactionGuard&) = delete;
+    TransactionGuard& operator=(const TransactionGuard&) = delete;
+
+    void Commit() {
+        ExecOrThrow(db_, "COMMIT;");
+        committed_ = true;
+    }
+
+   private:
+    sqlite3* db_;
+    bool committed_{false};
+};
+
+constexpr const char* kInsertTelemetrySql =
+    "INSERT INTO telemetry_records "
+    "(device_id, timestamp, telemetry_json, hash_hex, signature, pub_key_id, transport, batch_code) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
+
+constexpr const char* kAttachReceiptSql =
+    "UPDATE telemetry_records SET tx_hash = ?, block_height = ?, submitted_at = ? WHERE record_id = ?;";
+
+void BindPacketOrThrow(sqlite3* db, sqlite3_stmt* statement, const TelemetryPacketView& packet) {
+    BindTextOrThrow(db, statement, 1, packet.deviceId);
+    BindInt64OrThrow(db, statement, 2, static_cast<std::int64_t>(packet.timestamp));
+    BindTextOrThrow(db, statement, 3, packet.telemetryJson);
+    BindTextOrThrow(db, statement, 4, packet.hashHex);
+    BindTextOrThrow(db, statement, 5, packet.signature);
+    BindTextOrThrow(db, statement, 6, packet.pubKeyId);
+    BindTextOrThrow(db, statement, 7, packet.transport);
+    if (packet.batchCode.empty()) {
+        ThrowIfSqlError(sqlite3_bind_null(statement, 8), db, "bind batch code failed");
+    } else {
+        BindTextOrThrow(db, statement, 8, packet.batchCode);
+    }
+}
+
+void BindReceiptOrThrow(sqlite3* db, sqlite3_stmt* statement, const BlockchainReceipt& receipt) {
+    BindTextOrThrow(db, statement, 1, receipt.txHash);
+    BindInt64OrThrow(db, statement, 2, static_cast<std::int64_t>(receipt.blockHeight));
+    BindTextOrThrow(db, statement, 3, receipt.submittedAtIso8601);
+}
+
+// Metrics are stored by key and value text because interned ids only mean something inside one process.
+constexpr const char* kInsertMetricSql =
+    "INSERT INTO telemetry_metrics (record_id, position, metric_key, num_value, bool_value, text_value) "
+    "VALUES (?, ?, ?, ?, ?, ?);";
+
+constexpr const char* kSelectMetricsSql =
+    "SELECT metric_key, num_value, bool_value, text_value FROM telemetry_metrics WHERE record_id = ? "
+    "ORDER BY position;";
+
+void InsertMetricsOrThrow(
+    sqlite3* db,
+    sqlite3_stmt* statement,
+    std::uint64_t recordId,
+    std::span<const TelemetryMetric> metrics) {
+    for (std::size_t position = 0; position < metrics.size(); ++position) {
+        const TelemetryMetric& metric = metrics[position];
+        BindInt64OrThrow(db, statement, 1, static_cast<std::int64_t>(recordId));
+        BindInt64OrThrow(db, statement, 2, static_cast<std::int64_t>(position));
+        BindTextOrThrow(db, statement, 3, TelemetryKeyTable().Lookup(metric.keyId));
+        for (int column = 4; column <= 6; ++column) {
+            ThrowIfSqlError(sqlite3_bind_null(statement, column), db, "bind metric value failed");
+        }
+        if (const double* number = std::get_if<double>(&metric.value)) {
+            ThrowIfSqlError(sqlite3_bind_double(statement, 4, *number), db, "bind metric value failed");
+        } else if (const bool* flag = std::get_if<bool>(&metric.value)) {
+            BindInt64OrThrow(db, statement, 5, *flag ? 1 : 0);
+        } else {
+            const TelemetryStringId& text = std::get<TelemetryStringId>(metric.value);
+            BindTextOrThrow(db, statement, 6, TelemetryValueTable().Lookup(text.id));
+        }
+        ThrowIfSqlError(sqlite3_step(statement), db, "insert telemetry metric failed");
+        sqlite3_reset(statement);
+    }
+}
+
+void ReadMetricsOrThrow(sqlite3* db, std::span<TelemetryRecord> records) {
+    if (records.empty()) {
+        return;
+    }
+    StatementGuard statement(PrepareOrThrow(db, kSelectMetricsSql));
+    for (TelemetryRecord& record : records) {
+        BindInt64OrThrow(db, statement.Get(), 1, static_cast<std::int64_t>(record.recordId));
+        int code = sqlite3_step(statement.Get());
+        while (code == SQLITE_ROW) {
+            const std::string_view key(reinterpret_cast<const char*>(sqlite3_column_text(statement.Get(), 0)),
+                                       static_cast<std::size_t>(sqlite3_column_bytes(statement.Get(), 0)));
+            TelemetryMetric metric;
+            bool typed = InternTelemetryKey(key, &metric.keyId);
+            if (sqlite3_column_type(statement.Get(), 1) != SQLITE_NULL) {
+                metric.value = sqlite3_column_double(statement.Get(), 1);
+            } else if (sqlite3_column_type(statement.Get(), 2) != SQLITE_NULL) {
+                metric.value = sqlite3_column_int64(statement.Get(), 2) != 0;
+            } else {
+                const std::string_view text(reinterpret_cast<const char*>(sqlite3_column_text(statement.Get(), 3)),
+                                            static_cast<std::size_t>(sqlite3_column_bytes(statement.Get(), 3)));
+                metric.value = TelemetryStringId{};
+                typed = typed && InternTelemetryValue(text, &std::get<TelemetryStringId>(metric.value).id);
+            }
+            if (typed) {
+                record.packet.metrics.push_back(metric);
+            }
+            code = sqlite3_step(statement.Get());
+        }
+        ThrowIfSqlError(code, db, "read telemetry metrics failed");
+        sqlite3_reset(statement.Get());
+    }
+}
+
 }  
 
 SQLiteTelemetryRepository::SQLiteTelemetryRepository(const std::string& databasePath) {
@@ -105,44 +229,47 @@ SQLiteTelemetryRepository::~SQLiteTelemetryRepository() {
     }
 }
 
-std::uint64_t SQLiteTelemetryRepository::Save(const TelemetryPacket& packet) {
+std::uint64_t SQLiteTelemetryRepository::Save(const TelemetryPacketView& packet) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    const std::string sql =
-        "INSERT INTO telemetry_records "
-        "(device_id, timestamp, telemetry_json, hash_hex, signature, pub_key_id, transport, batch_code) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
-    StatementGuard statement(PrepareOrThrow(db_, sql));
-
-    BindTextOrThrow(db_, statement.Get(), 1, packet.deviceId);
-    BindInt64OrThrow(db_, statement.Get(), 2, static_cast<std::int64_t>(packet.timestamp));
-    BindTextOrThrow(db_, statement.Get(), 3, packet.telemetryJson);
-    BindTextOrThrow(db_, statement.Get(), 4, packet.hashHex);
-    BindTextOrThrow(db_, statement.Get(), 5, packet.signature);
-    BindTextOrThrow(db_, statement.Get(), 6, packet.pubKeyId);
-    BindTextOrThrow(db_, statement.Get(), 7, packet.transport);
-    if (packet.batchCode.empty()) {
-        ThrowIfSqlError(sqlite3_bind_null(statement.Get(), 8), db_, "bind batch code failed");
-    } else {
-        BindTextOrThrow(db_, statement.Get(), 8, packet.batchCode);
-    }
+    TransactionGuard transaction(db_);
+    StatementGuard statement(PrepareOrThrow(db_, kInsertTelemetrySql));
+    BindPacketOrThrow(db_, statement.Get(), packet);
 
     const int code = sqlite3_step(statement.Get());
     ThrowIfSqlError(code, db_, "insert telemetry failed");
+    const auto recordId = static_cast<std::uint64_t>(sqlite3_last_insert_rowid(db_));
 
-    return static_cast<std::uint64_t>(sqlite3_last_insert_rowid(db_));
+    StatementGuard metricStatement(PrepareOrThrow(db_, kInsertMetricSql));
+    InsertMetricsOrThrow(db_, metricStatement.Get(), recordId, packet.metrics);
+    transaction.Commit();
+    return recordId;
 }
 
-bool SQLiteTelemetryRepository::AttachReceipt(std::uint64_t recordId, const BlockchainReceipt& receipt) {
+std::vector<std::uint64_t> SQLiteTelemetryRepository::SaveBatch(const std::vector<TelemetryPacketView>& packets) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    const std::string sql =
-        "UPDATE telemetry_records SET tx_hash = ?, block_height = ?, submitted_at = ? WHERE record_id = ?;";
-    StatementGuard statement(PrepareOrThrow(db_, sql));
+    std::vector<std::uint64_t> recordIds;
+    recordIds.reserve(packets.size());
+    TransactionGuard transaction(db_);
+    StatementGuard statement(PrepareOrThrow(db_, kInsertTelemetrySql));
+    StatementGuard metricStatement(PrepareOrThrow(db_, kInsertMetricSql));
+    for (const TelemetryPacketView& packet : packets) {
+        BindPacketOrThrow(db_, statement.Get(), packet);
+        ThrowIfSqlError(sqlite3_step(statement.Get()), db_, "insert telemetry failed");
+        recordIds.push_back(static_cast<std::uint64_t>(sqlite3_last_insert_rowid(db_)));
+        sqlite3_reset(statement.Get());
+        InsertMetricsOrThrow(db_, metricStatement.Get(), recordIds.back(), packet.metrics);
+    }
+    transaction.Commit();
+    return recordIds;
+}
 
-    BindTextOrThrow(db_, statement.Get(), 1, receipt.txHash);
-    BindInt64OrThrow(db_, statement.Get(), 2, static_cast<std::int64_t>(receipt.blockHeight));
-    BindTextOrThrow(db_, statement.Get(), 3, receipt.submittedAtIso8601);
+bool SQLiteTelemetryRepository::AttachReceipt(std::uint64_t recordId, const BlockchainReceipt& receipt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    StatementGuard statement(PrepareOrThrow(db_, kAttachReceiptSql));
+    BindReceiptOrThrow(db_, statement.Get(), receipt);
     BindInt64OrThrow(db_, statement.Get(), 4, static_cast<std::int64_t>(recordId));
 
     const int code = sqlite3_step(statement.Get());
@@ -151,9 +278,34 @@ bool SQLiteTelemetryRepository::AttachReceipt(std::uint64_t recordId, const Bloc
     return changes > 0;
 }
 
+bool SQLiteTelemetryRepository::AttachReceiptBatch(
+    const std::vector<std::uint64_t>& recordIds,
+    const BlockchainReceipt& receipt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    TransactionGuard transaction(db_);
+    StatementGuard statement(PrepareOrThrow(db_, kAttachReceiptSql));
+    BindReceiptOrThrow(db_, statement.Get(), receipt);
+    for (const std::uint64_t recordId : recordIds) {
+        BindInt64OrThrow(db_, statement.Get(), 4, static_cast<std::int64_t>(recordId));
+        ThrowIfSqlError(sqlite3_step(statement.Get()), db_, "attach receipt failed");
+        if (sqlite3_changes(db_) == 0) {
+            return false;
+        }
+        sqlite3_reset(statement.Get());
+    }
+    transaction.Commit();
+    return true;
+}
+
 bool SQLiteTelemetryRepository::Delete(std::uint64_t recordId) {
     std::lock_guard<std::mutex> lock(mutex_);
 
+    TransactionGuard transaction(db_);
+    StatementGuard metrics(PrepareOrThrow(db_, "DELETE FROM telemetry_metrics WHERE record_id = ?;"));
+    BindInt64OrThrow(db_, metrics.Get(), 1, static_cast<std::int64_t>(recordId));
+    ThrowIfSqlError(sqlite3_step(metrics.Get()), db_, "delete telemetry metrics failed");
+
     const std::string sql = "DELETE FROM telemetry_records WHERE record_id = ?;";
     StatementGuard statement(PrepareOrThrow(db_, sql));
     BindInt64OrThrow(db_, statement.Get(), 1, static_cast<std::int64_t>(recordId));
@@ -161,6 +313,7 @@ bool SQLiteTelemetryRepository::Delete(std::uint64_t recordId) {
     const int code = sqlite3_step(statement.Get());
     ThrowIfSqlError(code, db_, "delete telemetry failed");
     const int changes = sqlite3_changes(db_);
+    transaction.Commit();
     return changes > 0;
 }
 
@@ -176,7 +329,8 @@ std::optional<TelemetryRecord> SQLiteTelemetryRepository::LatestByDevice(const s
 
     const int code = sqlite3_step(statement.Get());
     if (code == SQLITE_ROW) {
-        const TelemetryRecord record = RowToRecord(statement.Get());
+        TelemetryRecord record = RowToRecord(statement.Get());
+        ReadMetricsOrThrow(db_, std::span<TelemetryRecord>(&record, 1));
         return record;
     }
     ThrowIfSqlError(code, db_, "latest by device query failed");
@@ -189,13 +343,14 @@ std::optional<TelemetryRecord> SQLiteTelemetryRepository::FindByTransaction(cons
     const std::string sql =
         "SELECT record_id, device_id, timestamp, telemetry_json, hash_hex, signature, pub_key_id, transport, "
         "batch_code, tx_hash, block_height, submitted_at "
-        "FROM telemetry_records WHERE tx_hash = ? LIMIT 1;";
+        "FROM telemetry_records WHERE tx_hash = ? ORDER BY record_id LIMIT 1;";
     StatementGuard statement(PrepareOrThrow(db_, sql));
     BindTextOrThrow(db_, statement.Get(), 1, txHash);
 
     const int code = sqlite3_step(statement.Get());
     if (code == SQLITE_ROW) {
-        const TelemetryRecord record = RowToRecord(statement.Get());
+        TelemetryRecord record = RowToRecord(statement.Get());
+        ReadMetricsOrThrow(db_, std::span<TelemetryRecord>(&record, 1));
         return record;
     }
     ThrowIfSqlError(code, db_, "find by transaction query failed");
@@ -219,9 +374,50 @@ std::vector<TelemetryRecord> SQLiteTelemetryRepository::FindByBatch(const std::s
         code = sqlite3_step(statement.Get());
     }
     ThrowIfSqlError(code, db_, "find by batch query failed");
+    ReadMetricsOrThrow(db_, result);
     return result;
 }
 
+void SQLiteTelemetryRepository::ReadBatchPage(
+    TelemetryBatchCursor* cursor,
+    std::size_t limit,
+    std::vector<TelemetryRecord>* page) const {
+    page->clear();
+    if (cursor->exhausted) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const std::string sql =
+        "SELECT record_id, device_id, timestamp, telemetry_json, hash_hex, signature, pub_key_id, transport, "
+        "batch_code, tx_hash, block_height, submitted_at "
+        "FROM telemetry_records WHERE batch_code = ? AND (? = 0 OR timestamp > ? OR "
+        "(timestamp = ? AND record_id > ?)) ORDER BY timestamp ASC, record_id ASC LIMIT ?;";
+    StatementGuard statement(PrepareOrThrow(db_, sql));
+    BindTextOrThrow(db_, statement.Get(), 1, cursor->batchCode);
+    BindInt64OrThrow(db_, statement.Get(), 2, cursor->started ? 1 : 0);
+    BindInt64OrThrow(db_, statement.Get(), 3, static_cast<std::int64_t>(cursor->lastTimestamp));
+    BindInt64OrThrow(db_, statement.Get(), 4, static_cast<std::int64_t>(cursor->lastTimestamp));
+    BindInt64OrThrow(db_, statement.Get(), 5, static_cast<std::int64_t>(cursor->lastRecordId));
+    BindInt64OrThrow(db_, statement.Get(), 6, static_cast<std::int64_t>(limit));
+
+    int code = sqlite3_step(statement.Get());
+    while (code == SQLITE_ROW) {
+        page->push_back(RowToRecord(statement.Get()));
+        code = sqlite3_step(statement.Get());
+    }
+    ThrowIfSqlError(code, db_, "read batch page query failed");
+    ReadMetricsOrThrow(db_, *page);
+
+    if (!page->empty()) {
+        cursor->started = true;
+        cursor->lastRecordId = page->back().recordId;
+        cursor->lastTimestamp = page->back().packet.timestamp;
+    }
+    cursor->exhausted = page->size() < limit;
+}
+
 std::uint64_t SQLiteTelemetryRepository::Size() const {
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -253,8 +449,44 @@ void SQLiteTelemetryRepository::EnsureSchema() {
         ");"
         "CREATE INDEX IF NOT EXISTS idx_telemetry_device_time ON telemetry_records(device_id, timestamp DESC);"
         "CREATE INDEX IF NOT EXISTS idx_telemetry_batch ON telemetry_records(batch_code);"
-        "CREATE UNIQUE INDEX IF NOT EXISTS idx_telemetry_tx_hash ON telemetry_records(tx_hash);";
+        "CREATE INDEX IF NOT EXISTS idx_telemetry_batch_time ON telemetry_records(batch_code, timestamp, record_id);"
+        "DROP INDEX IF EXISTS idx_telemetry_tx_hash;"
+        "CREATE INDEX IF NOT EXISTS idx_telemetry_tx_hash_lookup ON telemetry_records(tx_hash);";
     ExecOrThrow(db_, sql);
+
+    StatementGuard existing(
+        PrepareOrThrow(db_, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'telemetry_metrics';"));
+    const bool backfill = sqlite3_step(existing.Get()) != SQLITE_ROW;
+
+    TransactionGuard transaction(db_);
+    ExecOrThrow(db_,
+                "CREATE TABLE IF NOT EXISTS telemetry_metrics ("
+                "record_id INTEGER NOT NULL,"
+                "position INTEGER NOT NULL,"
+                "metric_key TEXT NOT NULL,"
+                "num_value REAL,"
+                "bool_value INTEGER,"
+                "text_value TEXT,"
+                "PRIMARY KEY (record_id, position)"
+                ") WITHOUT ROWID;");
+    if (backfill) {
+        // Databases written before metrics were persisted get them decoded once from the stored JSON.
+        StatementGuard rows(PrepareOrThrow(db_, "SELECT record_id, telemetry_json FROM telemetry_records;"));
+        StatementGuard insert(PrepareOrThrow(db_, kInsertMetricSql));
+        std::vector<TelemetryMetric> metrics;
+        int code = sqlite3_step(rows.Get());
+        while (code == SQLITE_ROW) {
+            const std::string_view json(reinterpret_cast<const char*>(sqlite3_column_text(rows.Get(), 1)),
+                                        static_cast<std::size_t>(sqlite3_column_bytes(rows.Get(), 1)));
+            if (DecodeTelemetryMetrics(json, &metrics)) {
+                InsertMetricsOrThrow(
+                    db_, insert.Get(), static_cast<std::uint64_t>(sqlite3_column_int64(rows.Get(), 0)), metrics);
+            }
+            code = sqlite3_step(rows.Get());
+        }
+        ThrowIfSqlError(code, db_, "metrics backfill failed");
+    }
+    transaction.Commit();
 }
 
 TelemetryRecord SQLiteTelemetryRepository::RowToRecord(::sqlite3_stmt* statement) {
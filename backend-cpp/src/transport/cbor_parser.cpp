@@ -0,0 +1,451 @@
+#include "transport/cbor_parser.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <optional>
+
+#include "transport/json_writer.h"
+#include "transport/telemetry_schema.h"
+
+namespace agri {
+
+namespace {
+
+constexpr std::uint8_t kMajorUnsigned = 0;
+constexpr std::uint8_t kMajorNegative = 1;
+constexpr std::uint8_t kMajorBytes = 2;
+constexpr std::uint8_t kMajorText = 3;
+constexpr std::uint8_t kMajorArray = 4;
+constexpr std::uint8_t kMajorMap = 5;
+constexpr std::uint8_t kMajorTag = 6;
+constexpr std::uint8_t kMajorSimple = 7;
+
+constexpr int kMaxNestingDepth = 16;
+constexpr std::size_t kHashBytes = 32;
+constexpr std::size_t kRawSignatureBytes = 64;
+
+constexpr TelemetryField kFieldsByIndex[] = {
+    TelemetryField::kDeviceId, TelemetryField::kTimestamp, TelemetryField::kTelemetry, TelemetryField::kHash,
+    TelemetryField::kSignature, TelemetryField::kPubKeyId, TelemetryField::kTransport, TelemetryField::kBatchCode};
+
+struct CborHead {
+    std::uint8_t major{0};
+    std::uint8_t info{0};
+    std::uint64_t value{0};
+};
+
+class CborReader {
+   public:
+    explicit CborReader(std::string_view data) : data_(data) {}
+
+    bool AtEnd() const { return offset_ == data_.size(); }
+
+    bool ReadHead(CborHead* head) {
+        if (offset_ >= data_.size()) {
+            return false;
+        }
+        const auto initial = static_cast<std::uint8_t>(data_[offset_++]);
+        head->major = static_cast<std::uint8_t>(initial >> 5);
+        head->info = static_cast<std::uint8_t>(initial & 0x1F);
+        if (head->info < 24) {
+            head->value = head->info;
+            return true;
+        }
+        if (head->info > 27) {
+            return false;
+        }
+        const std::size_t width = std::size_t{1} << (head->info - 24);
+        if (data_.size() - offset_ < width) {
+            return false;
+        }
+        head->value = 0;
+        for (std::size_t i = 0; i < width; ++i) {
+            head->value = (head->value << 8) | static_cast<std::uint8_t>(data_[offset_++]);
+        }
+        return true;
+    }
+
+    bool ReadPayload(std::uint64_t length, std::string_view* bytes) {
+        if (length > data_.size() - offset_) {
+            return false;
+        }
+        *bytes = data_.substr(offset_, static_cast<std::size_t>(length));
+        offset_ += static_cast<std::size_t>(length);
+        return true;
+    }
+
+    bool ReadString(std::uint8_t major, std::string_view* bytes) {
+        CborHead head;
+        return ReadHead(&head) && head.major == major && ReadPayload(head.value, bytes);
+    }
+
+    bool ReadUnsigned(std::uint64_t* value) {
+        CborHead head;
+        for (int depth = 0; depth <= kMaxNestingDepth; ++depth) {
+            if (!ReadHead(&head)) {
+                return false;
+            }
+            if (head.major != kMajorTag) {
+                *value = head.value;
+                return head.major == kMajorUnsigned;
+            }
+        }
+        return false;
+    }
+
+    bool Skip(int depth) {
+        CborHead head;
+        if (depth > kMaxNestingDepth || !ReadHead(&head)) {
+            return false;
+        }
+        std::string_view ignored;
+        switch (head.major) {
+            case kMajorBytes:
+            case kMajorText:
+                return ReadPayload(head.value, &ignored);
+            case kMajorArray:
+            case kMajorMap: {
+                const std::uint64_t items = (head.major == kMajorMap) ? head.value * 2 : head.value;
+                for (std::uint64_t i = 0; i < items; ++i) {
+                    if (!Skip(depth + 1)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            case kMajorTag:
+                return Skip(depth + 1);
+            default:
+                return true;
+        }
+    }
+
+    bool RenderJson(int depth, std::string* out);
+
+   private:
+    std::string_view data_;
+    std::size_t offset_{0};
+};
+
+float HalfToFloat(std::uint16_t half) {
+    const int exponent = (half >> 10) & 0x1F;
+    const int mantissa = half & 0x3FF;
+    float value = 0.0f;
+    if (exponent == 0) {
+        value = std::ldexp(static_cast<float>(mantissa), -24);
+    } else if (exponent == 31) {
+        value = (mantissa == 0) ? INFINITY : NAN;
+    } else {
+        value = std::ldexp(static_cast<float>(mantissa + 1024), exponent - 25);
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+template <typename T>
+void AppendNumber(T value, std::string* out) {
+    if (!std::isfinite(value)) {
+        out->append("null");
+        return;
+    }
+    char buffer[32];
+    const auto converted = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out->append(buffer, converted.ptr);
+}
+
+void AppendJsonString(std::string_view text, std::string* out) {
+    out->push_back('"');
+    AppendJsonEscaped(text, out);
+    out->push_back('"');
+}
+
+bool CborReader::RenderJson(int depth, std::string* out) {
+    CborHead head;
+    if (depth > kMaxNestingDepth || !ReadHead(&head)) {
+        return false;
+    }
+    std::string_view text;
+    switch (head.major) {
+        case kMajorUnsigned:
+            AppendNumber(head.value, out);
+            return true;
+        case kMajorNegative:
+            out->push_back('-');
+            if (head.value == UINT64_MAX) {
+                out->append("18446744073709551616");
+            } else {
+                AppendNumber(head.value + 1, out);
+            }
+            return true;
+        case kMajorText:
+            if (!ReadPayload(head.value, &text)) {
+                return false;
+            }
+            AppendJsonString(text, out);
+            return true;
+        case kMajorArray:
+            out->push_back('[');
+            for (std::uint64_t i = 0; i < head.value; ++i) {
+                if (i != 0) {
+                    out->push_back(',');
+                }
+                if (!RenderJson(depth + 1, out)) {
+                    return false;
+                }
+            }
+            out->push_back(']');
+            return true;
+        case kMajorMap:
+            out->push_back('{');
+            for (std::uint64_t i = 0; i < head.value; ++i) {
+                if (i != 0) {
+                    out->push_back(',');
+                }
+                if (!ReadString(kMajorText, &text)) {
+                    return false;
+                }
+                AppendJsonString(text, out);
+                out->push_back(':');
+                if (!RenderJson(depth + 1, out)) {
+                    return false;
+                }
+            }
+            out->push_back('}');
+            return true;
+        case kMajorTag:
+            return RenderJson(depth + 1, out);
+        case kMajorSimple:
+            break;
+        default:
+            return false;
+    }
+
+    switch (head.info) {
+        case 20:
+            out->append("false");
+            return true;
+        case 21:
+            out->append("true");
+            return true;
+        case 22:
+        case 23:
+            out->append("null");
+            return true;
+        case 25:
+            AppendNumber(HalfToFloat(static_cast<std::uint16_t>(head.value)), out);
+            return true;
+        case 26: {
+            const auto bits = static_cast<std::uint32_t>(head.value);
+            float value = 0.0f;
+            std::memcpy(&value, &bits, sizeof(value));
+            AppendNumber(value, out);
+            return true;
+        }
+        case 27: {
+            double value = 0.0;
+            std::memcpy(&value, &head.value, sizeof(value));
+            AppendNumber(value, out);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+std::string HexEncode(std::string_view bytes) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (const char c : bytes) {
+        const auto value = static_cast<unsigned char>(c);
+        out.push_back(kHex[value >> 4]);
+        out.push_back(kHex[value & 0x0F]);
+    }
+    return out;
+}
+
+TelemetryField FieldByIndex(std::uint64_t index) {
+    return (index < std::size(kFieldsByIndex)) ? kFieldsByIndex[index] : TelemetryField::kUnknown;
+}
+
+bool ReadTextOrBytes(CborReader* reader, bool* isBytes, std::string_view* value) {
+    CborHead head;
+    if (!reader->ReadHead(&head) || (head.major != kMajorText && head.major != kMajorBytes)) {
+        return false;
+    }
+    *isBytes = head.major == kMajorBytes;
+    return reader->ReadPayload(head.value, value);
+}
+
+bool ReadField(CborReader* reader, TelemetryField field, TelemetryPacket* packet, std::uint32_t* seen) {
+    std::string_view value;
+    bool isBytes = false;
+    switch (field) {
+        case TelemetryField::kTimestamp:
+            if (!reader->ReadUnsigned(&packet->timestamp)) {
+                return false;
+            }
+            break;
+        case TelemetryField::kTelemetry: {
+            CborReader probe = *reader;
+            CborHead head;
+            if (!probe.ReadHead(&head)) {
+                return false;
+            }
+            if (head.major == kMajorText) {
+                if (!reader->ReadString(kMajorText, &value)) {
+                    return false;
+                }
+                packet->telemetryJson.assign(value);
+            } else if (head.major == kMajorMap) {
+                packet->telemetryJson.clear();
+                if (!reader->RenderJson(1, &packet->telemetryJson)) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+            break;
+        }
+        case TelemetryField::kHash:
+            if (!ReadTextOrBytes(reader, &isBytes, &value) || (isBytes && value.size() != kHashBytes)) {
+                return false;
+            }
+            packet->*TelemetryStringMembersOf(field).owner = isBytes ? HexEncode(value) : std::string(value);
+            break;
+        case TelemetryField::kSignature: {
+            if (!ReadTextOrBytes(reader, &isBytes, &value)) {
+                return false;
+            }
+            std::string& signature = packet->*TelemetryStringMembersOf(field).owner;
+            if (!isBytes) {
+                signature.assign(value);
+            } else if (value.size() == kRawSignatureBytes) {
+                signature = RawEcdsaSignatureToDerHex(value);
+            } else {
+                signature = HexEncode(value);
+            }
+            break;
+        }
+        case TelemetryField::kUnknown:
+            return reader->Skip(1);
+        default: {
+            const TelemetryStringMembers members = TelemetryStringMembersOf(field);
+            if (members.owner == nullptr || !reader->ReadString(kMajorText, &value)) {
+                return false;
+            }
+            (packet->*members.owner).assign(value);
+            break;
+        }
+    }
+    *seen |= 1u << static_cast<unsigned>(field);
+    return true;
+}
+
+bool ReadPacket(CborReader* reader, ParseTelemetryResult* result) {
+    CborReader probe = *reader;
+    CborHead head;
+    if (!probe.ReadHead(&head)) {
+        return false;
+    }
+    if (head.major != kMajorMap) {
+        result->error = "telemetry packet must be a CBOR map";
+        return reader->Skip(0);
+    }
+    *reader = probe;
+
+    result->decoded = std::make_unique<TelemetryPacket>();
+    TelemetryPacket& packet = *result->decoded;
+    std::uint32_t seen = 0;
+    for (std::uint64_t i = 0; i < head.value; ++i) {
+        CborHead key;
+        if (!reader->ReadHead(&key)) {
+            return false;
+        }
+        TelemetryField field = TelemetryField::kUnknown;
+        if (key.major == kMajorUnsigned) {
+            field = FieldByIndex(key.value);
+        } else if (key.major == kMajorText) {
+            std::string_view name;
+            if (!reader->ReadPayload(key.value, &name)) {
+                return false;
+            }
+            field = ClassifyTelemetryField(name);
+        } else {
+            return false;
+        }
+        if (!ReadField(reader, field, &packet, &seen)) {
+            return false;
+        }
+    }
+
+    TelemetryPacketView view = packet;
+    if (!ApplyTelemetrySchema(seen, &view, &result->error)) {
+        return true;
+    }
+    if (!DecodeTelemetryMetrics(packet.telemetryJson, &packet.metrics)) {
+        result->error = "telemetry must be a JSON object";
+        return true;
+    }
+    view.metrics = packet.metrics;
+    result->packet = view;
+    result->ok = true;
+    return true;
+}
+
+}
+
+ParseTelemetryResult ParseTelemetryPacketCbor(std::string_view payload) {
+    ParseTelemetryResult result;
+    CborReader reader(payload);
+    if (!ReadPacket(&reader, &result) || !reader.AtEnd()) {
+        result = ParseTelemetryResult{};
+        result.error = "malformed CBOR packet";
+    }
+    return result;
+}
+
+bool ParseTelemetryBatchCbor(std::string_view payload, std::vector<ParseTelemetryResult>* packets, std::string* error) {
+    packets->clear();
+    CborReader reader(payload);
+    while (!reader.AtEnd()) {
+        ParseTelemetryResult result;
+        if (!ReadPacket(&reader, &result)) {
+            *error = "malformed CBOR sequence at item " + std::to_string(packets->size());
+            return false;
+        }
+        packets->push_back(std::move(result));
+    }
+    return true;
+}
+
+std::string RawEcdsaSignatureToDerHex(std::string_view raw) {
+    if (raw.empty() || raw.size() % 2 != 0 || raw.size() > 2 * 0x3C) {
+        return HexEncode(raw);
+    }
+    const auto encodeInteger = [](std::string_view bytes) {
+        while (bytes.size() > 1 && bytes.front() == '\0') {
+            bytes.remove_prefix(1);
+        }
+        std::string out(1, '\x02');
+        const bool pad = (static_cast<unsigned char>(bytes.front()) & 0x80) != 0;
+        out.push_back(static_cast<char>(bytes.size() + (pad ? 1 : 0)));
+        if (pad) {
+            out.push_back('\0');
+        }
+        out.append(bytes);
+        return out;
+    };
+
+    const std::size_t half = raw.size() / 2;
+    const std::string body = encodeInteger(raw.substr(0, half)) + encodeInteger(raw.substr(half));
+    std::string der(1, '\x30');
+    der.push_back(static_cast<char>(body.size()));
+    der.append(body);
+    return HexEncode(der);
+}
+
+}
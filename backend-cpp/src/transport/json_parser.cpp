@@ -1,66 +1,475 @@
 #include "transport/json_parser.h"
 
+#include <charconv>
 #include <cstdint>
 #include <cctype>
-#include <optional>
-#include <regex>
+#include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#include "transport/json_structural_index.h"
+#include "transport/json_writer.h"
+#include "transport/telemetry_schema.h"
 
 namespace agri {
 
 namespace {
 
-std::optional<std::string> ExtractStringValue(std::string_view json, const std::string& key) {
-    const std::regex pattern("\"" + key + "\"\\s*:\\s*\"([^\"]*)\"");
-    std::match_results<std::string_view::const_iterator> match;
-    if (!std::regex_search(json.begin(), json.end(), match, pattern)) {
-        return std::nullopt;
-    }
-    return std::string(match[1].first, match[1].second);
+constexpr int kMaxJsonDepth = 64;
+constexpr std::size_t kIndexedScanBytes = 512;
+constexpr std::size_t kMaxInternedKeyBytes = 64;
+constexpr std::size_t kMaxInternedValueBytes = 32;
+constexpr std::size_t kValueTableCapacity = 4096;
+constexpr std::size_t kMetricReserve = 8;
+
+bool IsJsonWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
-std::optional<std::uint64_t> ExtractUnsignedValue(std::string_view json, const std::string& key) {
-    const std::regex pattern("\"" + key + "\"\\s*:\\s*([0-9]+)");
-    std::match_results<std::string_view::const_iterator> match;
-    if (!std::regex_search(json.begin(), json.end(), match, pattern)) {
-        return std::nullopt;
+using InternCache = std::unordered_map<std::string_view, std::uint32_t>;
+
+// Neither table evicts: once one is full, new strings stay untyped, StringInterner::Overflows() counts each refusal
+// and the first one is logged.
+bool InternCached(StringInterner& table,
+                  InternCache& cache,
+                  std::once_flag& reported,
+                  const char* what,
+                  std::string_view value,
+                  std::uint32_t* id) {
+    if (const auto it = cache.find(value); it != cache.end()) {
+        *id = it->second;
+        return true;
     }
-    try {
-        return std::stoull(std::string(match[1].first, match[1].second));
-    } catch (...) {
-        return std::nullopt;
+    if (!table.Intern(value, id)) {
+        std::call_once(reported, [&] {
+            std::cerr << "telemetry " << what << " table is full at " << table.Size() << " entries; new " << what
+                      << "s are no longer typed" << std::endl;
+        });
+        return false;
     }
+    cache.emplace(table.Lookup(*id), *id);
+    return true;
 }
 
-std::optional<std::string> ExtractObjectValue(std::string_view json, const std::string& key) {
-    const std::string keyToken = "\"" + key + "\"";
-    const std::size_t keyPos = json.find(keyToken);
-    if (keyPos == std::string_view::npos) {
-        return std::nullopt;
+class JsonCursor {
+   public:
+    explicit JsonCursor(std::string_view json) : json_(json) {}
+
+    std::size_t Position() const { return pos_; }
+    bool AtEnd() const { return pos_ >= json_.size(); }
+
+    void SkipWhitespace() {
+        while (pos_ < json_.size() && IsJsonWhitespace(json_[pos_])) {
+            ++pos_;
+        }
+    }
+
+    bool Consume(char expected) {
+        SkipWhitespace();
+        if (pos_ < json_.size() && json_[pos_] == expected) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    char Peek() {
+        SkipWhitespace();
+        return pos_ < json_.size() ? json_[pos_] : '\0';
+    }
+
+    bool ReadString(std::string_view* view, std::string* decoded) {
+        if (!Consume('"')) {
+            return false;
+        }
+        const std::size_t begin = pos_;
+        while (pos_ < json_.size()) {
+            const char c = json_[pos_];
+            if (c == '"') {
+                if (view != nullptr) {
+                    *view = json_.substr(begin, pos_ - begin);
+                }
+                ++pos_;
+                return true;
+            }
+            if (c == '\\') {
+                if (!ReadEscapedString(begin, decoded)) {
+                    return false;
+                }
+                if (view != nullptr) {
+                    *view = *decoded;
+                }
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            ++pos_;
+        }
+        return false;
+    }
+
+    bool ReadUnsigned(std::uint64_t* value, bool* integral) {
+        SkipWhitespace();
+        const std::size_t begin = pos_;
+        if (!SkipNumber()) {
+            return false;
+        }
+        *integral = json_[begin] != '-';
+        std::uint64_t parsed = 0;
+        for (std::size_t i = begin; i < pos_ && *integral; ++i) {
+            const char c = json_[i];
+            if (c < '0' || c > '9') {
+                *integral = false;
+            } else if (parsed > (UINT64_MAX - static_cast<std::uint64_t>(c - '0')) / 10) {
+                *integral = false;
+            } else {
+                parsed = parsed * 10 + static_cast<std::uint64_t>(c - '0');
+            }
+        }
+        *value = parsed;
+        return true;
+    }
+
+    bool SkipValue(int depth = 0) {
+        switch (Peek()) {
+            case '"':
+                return ReadString(nullptr, nullptr);
+            case '{':
+                return (depth <= 1 && json_.size() - pos_ >= kIndexedScanBytes) ? SkipIndexed()
+                                                                                 : SkipContainer('}', depth);
+            case '[':
+                return (depth <= 1 && json_.size() - pos_ >= kIndexedScanBytes) ? SkipIndexed()
+                                                                                 : SkipContainer(']', depth);
+            case 't':
+                return ConsumeLiteral("true");
+            case 'f':
+                return ConsumeLiteral("false");
+            case 'n':
+                return ConsumeLiteral("null");
+            default:
+                return SkipNumber();
+        }
+    }
+
+    bool ReadMetrics(std::vector<TelemetryMetric>* metrics) {
+        if (!Consume('{')) {
+            return false;
+        }
+        if (Consume('}')) {
+            return true;
+        }
+        std::string_view key;
+        std::string_view text;
+        std::string unescapedKey;
+        std::string unescapedText;
+        metrics->reserve(kMetricReserve);
+        while (true) {
+            if (!ReadString(&key, &unescapedKey) || !Consume(':')) {
+                return false;
+            }
+            TelemetryMetric metric;
+            bool typed = true;
+            const char next = Peek();
+            const std::size_t begin = pos_;
+            switch (next) {
+                case '"':
+                    if (!ReadString(&text, &unescapedText)) {
+                        return false;
+                    }
+                    metric.value = TelemetryStringId{};
+                    typed = InternTelemetryValue(text, &std::get<TelemetryStringId>(metric.value).id);
+                    break;
+                case 't':
+                    metric.value = true;
+                    if (!ConsumeLiteral("true")) {
+                        return false;
+                    }
+                    break;
+                case 'f':
+                    metric.value = false;
+                    if (!ConsumeLiteral("false")) {
+                        return false;
+                    }
+                    break;
+                case '{':
+                case '[':
+                case 'n':
+                    typed = false;
+                    if (!SkipValue(1)) {
+                        return false;
+                    }
+                    break;
+                default: {
+                    if (!SkipNumber()) {
+                        return false;
+                    }
+                    double number = 0.0;
+                    typed = std::from_chars(json_.data() + begin, json_.data() + pos_, number).ec == std::errc();
+                    metric.value = number;
+                    break;
+                }
+            }
+            if (typed && InternTelemetryKey(key, &metric.keyId)) {
+                metrics->push_back(metric);
+            }
+            if (Consume('}')) {
+                return true;
+            }
+            if (!Consume(',')) {
+                return false;
+            }
+        }
+    }
+
+   private:
+    bool ReadEscapedString(std::size_t begin, std::string* out) {
+        std::string decoded(json_.data() + begin, pos_ - begin);
+        while (pos_ < json_.size()) {
+            const char c = json_[pos_++];
+            if (c == '"') {
+                if (out != nullptr) {
+                    *out = std::move(decoded);
+                }
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                decoded.push_back(c);
+                continue;
+            }
+            if (pos_ >= json_.size()) {
+                return false;
+            }
+            switch (json_[pos_++]) {
+                case '"':
+                    decoded.push_back('"');
+                    break;
+                case '\\':
+                    decoded.push_back('\\');
+                    break;
+                case '/':
+                    decoded.push_back('/');
+                    break;
+                case 'b':
+                    decoded.push_back('\b');
+                    break;
+                case 'f':
+                    decoded.push_back('\f');
+                    break;
+                case 'n':
+                    decoded.push_back('\n');
+                    break;
+                case 'r':
+                    decoded.push_back('\r');
+                    break;
+                case 't':
+                    decoded.push_back('\t');
+                    break;
+                case 'u':
+                    if (!ReadUnicodeEscape(&decoded)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return false;
     }
 
-    const std::size_t colonPos = json.find(':', keyPos + keyToken.size());
-    if (colonPos == std::string_view::npos) {
-        return std::nullopt;
+    bool ReadHex4(std::uint32_t* value) {
+        if (json_.size() - pos_ < 4) {
+            return false;
+        }
+        std::uint32_t parsed = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = json_[pos_++];
+            parsed <<= 4;
+            if (c >= '0' && c <= '9') {
+                parsed |= static_cast<std::uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                parsed |= static_cast<std::uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                parsed |= static_cast<std::uint32_t>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        *value = parsed;
+        return true;
     }
 
-    const std::size_t objectStart = json.find('{', colonPos + 1);
-    if (objectStart == std::string_view::npos) {
-        return std::nullopt;
+    bool ReadUnicodeEscape(std::string* out) {
+        std::uint32_t codePoint = 0;
+        if (!ReadHex4(&codePoint)) {
+            return false;
+        }
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+            std::uint32_t low = 0;
+            if (json_.substr(pos_, 2) != "\\u") {
+                return false;
+            }
+            pos_ += 2;
+            if (!ReadHex4(&low) || low < 0xDC00 || low > 0xDFFF) {
+                return false;
+            }
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+            return false;
+        }
+
+        if (codePoint < 0x80) {
+            out->push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            out->push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out->push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            out->push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out->push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        return true;
     }
 
+    bool SkipDigits() {
+        const std::size_t begin = pos_;
+        while (pos_ < json_.size() && json_[pos_] >= '0' && json_[pos_] <= '9') {
+            ++pos_;
+        }
+        return pos_ > begin;
+    }
+
+    bool SkipNumber() {
+        SkipWhitespace();
+        if (pos_ < json_.size() && json_[pos_] == '-') {
+            ++pos_;
+        }
+        if (pos_ < json_.size() && json_[pos_] == '0') {
+            ++pos_;
+        } else if (!SkipDigits()) {
+            return false;
+        }
+        if (pos_ < json_.size() && json_[pos_] == '.') {
+            ++pos_;
+            if (!SkipDigits()) {
+                return false;
+            }
+        }
+        if (pos_ < json_.size() && (json_[pos_] == 'e' || json_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < json_.size() && (json_[pos_] == '+' || json_[pos_] == '-')) {
+                ++pos_;
+            }
+            if (!SkipDigits()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ConsumeLiteral(std::string_view literal) {
+        if (json_.substr(pos_, literal.size()) != literal) {
+            return false;
+        }
+        pos_ += literal.size();
+        return true;
+    }
+
+    bool SkipIndexed() {
+        std::size_t length = 0;
+        if (!ScanJsonContainer(json_.substr(pos_), &length)) {
+            return false;
+        }
+        pos_ += length;
+        return true;
+    }
+
+    bool SkipContainer(char close, int depth) {
+        if (depth >= kMaxJsonDepth) {
+            return false;
+        }
+        ++pos_;
+        if (Consume(close)) {
+            return true;
+        }
+        while (true) {
+            if (close == '}' && (!ReadString(nullptr, nullptr) || !Consume(':'))) {
+                return false;
+            }
+            if (!SkipValue(depth + 1)) {
+                return false;
+            }
+            if (Consume(close)) {
+                return true;
+            }
+            if (!Consume(',')) {
+                return false;
+            }
+        }
+    }
+
+    std::string_view json_;
+    std::size_t pos_{0};
+};
+
+static_assert(kTelemetryFieldCount <= 32, "seen mask holds one bit per schema field");
+
+constexpr std::uint32_t FieldBit(TelemetryField field) {
+    return 1u << static_cast<unsigned>(field);
+}
+
+bool CheckLength(const TelemetryFieldSpec& spec, std::string_view value, std::string* error) {
+    if (value.size() >= spec.minLength && value.size() <= spec.maxLength) {
+        return true;
+    }
+    error->assign(spec.name);
+    if (spec.minLength == spec.maxLength) {
+        error->append(" must be ").append(std::to_string(spec.minLength)).append(" characters");
+    } else if (value.size() > spec.maxLength) {
+        error->append(" must be at most ").append(std::to_string(spec.maxLength)).append(" characters");
+    } else if (spec.minLength == 1) {
+        error->append(" must not be empty");
+    } else {
+        error->append(" must be at least ").append(std::to_string(spec.minLength)).append(" characters");
+    }
+    return false;
+}
+
+std::string_view TrimJsonWhitespace(std::string_view value) {
+    while (!value.empty() && IsJsonWhitespace(value.front())) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && IsJsonWhitespace(value.back())) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+bool SplitJsonArray(std::string_view array, std::vector<std::string_view>* packets, std::string* error) {
     int depth = 0;
     bool inString = false;
     bool escape = false;
-    for (std::size_t i = objectStart; i < json.size(); ++i) {
-        const char c = json[i];
-
+    std::size_t itemStart = 1;
+    for (std::size_t i = 0; i < array.size(); ++i) {
+        const char c = array[i];
         if (escape) {
             escape = false;
             continue;
         }
         if (c == '\\') {
-            escape = true;
+            escape = inString;
             continue;
         }
         if (c == '"') {
@@ -71,65 +480,211 @@ std::optional<std::string> ExtractObjectValue(std::string_view json, const std::
             continue;
         }
 
-        if (c == '{') {
+        if (c == '{' || c == '[') {
             ++depth;
-        } else if (c == '}') {
+        } else if (c == '}' || c == ']') {
             --depth;
             if (depth == 0) {
-                return std::string(json.substr(objectStart, i - objectStart + 1));
+                const std::string_view item = TrimJsonWhitespace(array.substr(itemStart, i - itemStart));
+                if (!item.empty()) {
+                    packets->push_back(item);
+                } else if (!packets->empty()) {
+                    *error = "empty element in batch array";
+                    return false;
+                }
+                if (!TrimJsonWhitespace(array.substr(i + 1)).empty()) {
+                    *error = "unexpected data after batch array";
+                    return false;
+                }
+                return true;
             }
+        } else if (c == ',' && depth == 1) {
+            const std::string_view item = TrimJsonWhitespace(array.substr(itemStart, i - itemStart));
+            if (item.empty()) {
+                *error = "empty element in batch array";
+                return false;
+            }
+            packets->push_back(item);
+            itemStart = i + 1;
         }
     }
-
-    return std::nullopt;
+    *error = "unterminated batch array";
+    return false;
 }
 
 }
 
 ParseTelemetryResult ParseTelemetryPacketJson(std::string_view payload) {
     ParseTelemetryResult result;
+    TelemetryPacketView& packet = result.packet;
+    std::uint32_t seen = 0;
 
-    const auto deviceId = ExtractStringValue(payload, "deviceId");
-    if (!deviceId.has_value()) {
-        result.error = "missing deviceId";
+    JsonCursor cursor(payload);
+    std::string_view key;
+    std::string unescapedKey;
+    std::string unescaped;
+    bool wellFormed = cursor.Consume('{');
+    if (wellFormed && !cursor.Consume('}')) {
+        while (true) {
+            if (!cursor.ReadString(&key, &unescapedKey) || !cursor.Consume(':')) {
+                wellFormed = false;
+                break;
+            }
+
+            const TelemetryField field = ClassifyTelemetryField(key);
+            const bool first = field != TelemetryField::kUnknown && (seen & FieldBit(field)) == 0;
+            const TelemetryFieldType type = TelemetryFieldSpecOf(field).type;
+            const char next = cursor.Peek();
+            if (first && type == TelemetryFieldType::kString && next == '"') {
+                const TelemetryStringMembers members = TelemetryStringMembersOf(field);
+                std::string_view& target = packet.*members.view;
+                seen |= FieldBit(field);
+                wellFormed = cursor.ReadString(&target, &unescaped);
+                if (wellFormed && !unescaped.empty()) {
+                    if (!result.decoded) {
+                        result.decoded = std::make_unique<TelemetryPacket>();
+                    }
+                    std::string& decoded = (*result.decoded).*members.owner;
+                    decoded = std::move(unescaped);
+                    target = decoded;
+                    unescaped.clear();
+                }
+            } else if (first && type == TelemetryFieldType::kInteger && (next == '-' || (next >= '0' && next <= '9'))) {
+                std::uint64_t timestamp = 0;
+                bool integral = false;
+                wellFormed = cursor.ReadUnsigned(&timestamp, &integral);
+                if (integral) {
+                    seen |= FieldBit(field);
+                    packet.timestamp = timestamp;
+                }
+            } else if (first && type == TelemetryFieldType::kObject && next == '{') {
+                seen |= FieldBit(field);
+                const std::size_t begin = cursor.Position();
+                wellFormed = cursor.ReadMetrics(&result.metrics);
+                packet.telemetryJson = payload.substr(begin, cursor.Position() - begin);
+                packet.metrics = result.metrics;
+            } else {
+                wellFormed = cursor.SkipValue();
+            }
+
+            if (!wellFormed || cursor.Consume('}')) {
+                break;
+            }
+            if (!cursor.Consume(',')) {
+                wellFormed = false;
+                break;
+            }
+        }
+    }
+    cursor.SkipWhitespace();
+    if (!wellFormed || !cursor.AtEnd()) {
+        result.error = "malformed JSON packet";
         return result;
     }
 
-    const auto timestamp = ExtractUnsignedValue(payload, "timestamp");
-    if (!timestamp.has_value()) {
-        result.error = "missing timestamp";
+    if (!ApplyTelemetrySchema(seen, &packet, &result.error)) {
         return result;
     }
 
-    const auto telemetry = ExtractObjectValue(payload, "telemetry");
-    if (!telemetry.has_value()) {
-        result.error = "missing telemetry object";
-        return result;
+    result.ok = true;
+    return result;
+}
+
+bool ApplyTelemetrySchema(std::uint32_t seen, TelemetryPacketView* packet, std::string* error) {
+    for (const TelemetryField field : kTelemetryRequiredFields) {
+        if ((seen & FieldBit(field)) == 0) {
+            const TelemetryFieldSpec& spec = TelemetryFieldSpecOf(field);
+            error->assign("missing ").append(spec.name);
+            if (spec.type == TelemetryFieldType::kObject) {
+                error->append(" object");
+            }
+            return false;
+        }
     }
+    for (std::size_t i = 0; i < kTelemetryFieldCount; ++i) {
+        const TelemetryField field = static_cast<TelemetryField>(i);
+        const TelemetryFieldSpec& spec = kTelemetryFields[i];
+        const TelemetryStringMembers members = TelemetryStringMembersOf(field);
+        if (members.view == nullptr) {
+            continue;
+        }
+        std::string_view& value = packet->*members.view;
+        if ((seen & FieldBit(field)) == 0) {
+            if (!spec.hasDefault) {
+                continue;
+            }
+            value = spec.defaultValue;
+        }
+        if (!TelemetryEnumAllows(field, value)) {
+            error->assign("invalid ").append(spec.name);
+            return false;
+        }
+        if (!CheckLength(spec, value, error)) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    const auto hashHex = ExtractStringValue(payload, "hash");
-    if (!hashHex.has_value()) {
-        result.error = "missing hash";
-        return result;
+bool CheckTelemetryLengths(const TelemetryPacketView& packet, std::string* error) {
+    for (std::size_t i = 0; i < kTelemetryFieldCount; ++i) {
+        const TelemetryStringMembers members = TelemetryStringMembersOf(static_cast<TelemetryField>(i));
+        if (members.view != nullptr && !CheckLength(kTelemetryFields[i], packet.*members.view, error)) {
+            return false;
+        }
     }
+    return true;
+}
 
-    const auto signature = ExtractStringValue(payload, "signature");
-    if (!signature.has_value()) {
-        result.error = "missing signature";
-        return result;
+bool DecodeTelemetryMetrics(std::string_view telemetryJson, std::vector<TelemetryMetric>* metrics) {
+    metrics->clear();
+    JsonCursor cursor(telemetryJson);
+    if (cursor.Peek() != '{' || !cursor.ReadMetrics(metrics)) {
+        return false;
     }
+    cursor.SkipWhitespace();
+    return cursor.AtEnd();
+}
 
-    result.packet.deviceId = *deviceId;
-    result.packet.timestamp = *timestamp;
-    result.packet.telemetryJson = *telemetry;
-    result.packet.hashHex = *hashHex;
-    result.packet.signature = *signature;
-    result.packet.pubKeyId = ExtractStringValue(payload, "pubKeyId").value_or("default-pubkey");
-    result.packet.transport = ExtractStringValue(payload, "transport").value_or("wifi");
-    result.packet.batchCode = ExtractStringValue(payload, "batchCode").value_or("");
+bool InternTelemetryKey(std::string_view key, std::uint32_t* id) {
+    thread_local InternCache cache;
+    static std::once_flag reported;
+    return key.size() <= kMaxInternedKeyBytes && InternCached(TelemetryKeyTable(), cache, reported, "key", key, id);
+}
 
-    result.ok = true;
-    return result;
+bool InternTelemetryValue(std::string_view value, std::uint32_t* id) {
+    thread_local InternCache cache;
+    static std::once_flag reported;
+    return value.size() <= kMaxInternedValueBytes &&
+           InternCached(TelemetryValueTable(), cache, reported, "string value", value, id);
+}
+
+StringInterner& TelemetryKeyTable() {
+    static StringInterner table;
+    return table;
+}
+
+StringInterner& TelemetryValueTable() {
+    static StringInterner table(kValueTableCapacity);
+    return table;
+}
+
+bool SplitTelemetryBatchJson(std::string_view payload, std::vector<std::string_view>* packets, std::string* error) {
+    packets->clear();
+    payload = TrimJsonWhitespace(payload);
+    if (!payload.empty() && payload.front() == '[') {
+        return SplitJsonArray(payload, packets, error);
+    }
+
+    while (!payload.empty()) {
+        const std::size_t lineEnd = payload.find('\n');
+        const std::string_view line = TrimJsonWhitespace(payload.substr(0, lineEnd));
+        if (!line.empty()) {
+            packets->push_back(line);
+        }
+        payload = (lineEnd == std::string_view::npos) ? std::string_view{} : payload.substr(lineEnd + 1);
+    }
+    return true;
 }
 
 bool IsHex64(std::string_view value) {
@@ -147,35 +702,7 @@ bool IsHex64(std::string_view value) {
 std::string JsonEscape(std::string_view value) {
     std::string escaped;
     escaped.reserve(value.size());
-
-    for (const char c : value) {
-        switch (c) {
-            case '"':
-                escaped += "\\\"";
-                break;
-            case '\\':
-                escaped += "\\\\";
-                break;
-            case '\b':
-                escaped += "\\b";
-                break;
-            case '\f':
-                escaped += "\\f";
-                break;
-            case '\n':
-                escaped += "\\n";
-                break;
-            case '\r':
-                escaped += "\\r";
-                break;
-            case '\t':
-                escaped += "\\t";
-                break;
-            default:
-                escaped += c;
-                break;
-        }
-    }
+    AppendJsonEscaped(value, &escaped);
     return escaped;
 }
 
@@ -0,0 +1,540 @@
+#include "transport/json_structural_index.h"
+
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AGRI_JSON_SCAN_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define AGRI_JSON_SCAN_NEON 1
+#endif
+
+namespace agri {
+
+namespace {
+
+constexpr std::size_t kBlockBytes = 64;
+constexpr std::size_t kMaxContainerDepth = 64;
+constexpr std::uint64_t kEvenBits = 0x5555555555555555ULL;
+constexpr std::uint64_t kHighBits = 0x8080808080808080ULL;
+
+struct BlockMasks {
+    std::uint64_t backslash{0};
+    std::uint64_t quote{0};
+    std::uint64_t op{0};
+    std::uint64_t whitespace{0};
+    std::uint64_t control{0};
+};
+
+using ClassifyFn = BlockMasks (*)(const char* block);
+
+bool IsOp(char c) {
+    return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+bool IsWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+BlockMasks ClassifyScalar(const char* block) {
+    BlockMasks masks;
+    for (std::size_t i = 0; i < kBlockBytes; ++i) {
+        const char c = block[i];
+        const std::uint64_t bit = 1ULL << i;
+        if (c == '\\') {
+            masks.backslash |= bit;
+        } else if (c == '"') {
+            masks.quote |= bit;
+        } else if (IsOp(c)) {
+            masks.op |= bit;
+        } else if (IsWhitespace(c)) {
+            masks.whitespace |= bit;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            masks.control |= bit;
+        }
+    }
+    return masks;
+}
+
+#if defined(AGRI_JSON_SCAN_X86)
+
+BlockMasks ClassifySse2(const char* block) {
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    BlockMasks masks;
+    for (std::size_t lane = 0; lane < kBlockBytes / 16; ++lane) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+        const auto eq = [&bytes](char c) { return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c)); };
+        const __m128i op = _mm_or_si128(_mm_or_si128(_mm_or_si128(eq('{'), eq('}')), _mm_or_si128(eq('['), eq(']'))),
+                                        _mm_or_si128(eq(':'), eq(',')));
+        const __m128i space = _mm_or_si128(_mm_or_si128(eq(' '), eq('\t')), _mm_or_si128(eq('\n'), eq('\r')));
+        const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(bytes, controlMax), controlMax);
+        const unsigned shift = static_cast<unsigned>(lane * 16);
+        const auto bits = [shift](__m128i mask) {
+            return static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(mask))) << shift;
+        };
+        masks.backslash |= bits(_mm_cmpeq_epi8(bytes, backslash));
+        masks.quote |= bits(_mm_cmpeq_epi8(bytes, quote));
+        masks.op |= bits(op);
+        masks.whitespace |= bits(space);
+        masks.control |= bits(control);
+    }
+    return masks;
+}
+
+__attribute__((target("avx2"))) BlockMasks ClassifyAvx2(const char* block) {
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i controlMax = _mm256_set1_epi8(0x1F);
+    BlockMasks masks;
+    for (std::size_t lane = 0; lane < kBlockBytes / 32; ++lane) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + lane * 32));
+        const auto eq = [&bytes](char c) __attribute__((target("avx2"))) {
+            return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c));
+        };
+        const __m256i op =
+            _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(eq('{'), eq('}')), _mm256_or_si256(eq('['), eq(']'))),
+                            _mm256_or_si256(eq(':'), eq(',')));
+        const __m256i space =
+            _mm256_or_si256(_mm256_or_si256(eq(' '), eq('\t')), _mm256_or_si256(eq('\n'), eq('\r')));
+        const __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(bytes, controlMax), controlMax);
+        const unsigned shift = static_cast<unsigned>(lane * 32);
+        const auto bits = [shift](__m256i mask) __attribute__((target("avx2"))) {
+            return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(mask))) << shift;
+        };
+        masks.backslash |= bits(_mm256_cmpeq_epi8(bytes, backslash));
+        masks.quote |= bits(_mm256_cmpeq_epi8(bytes, quote));
+        masks.op |= bits(op);
+        masks.whitespace |= bits(space);
+        masks.control |= bits(control);
+    }
+    return masks;
+}
+
+#endif
+
+#if defined(AGRI_JSON_SCAN_NEON)
+
+std::uint64_t NeonMovemask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+    static const std::uint8_t kWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t weights = vld1q_u8(kWeights);
+    const uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, weights), vandq_u8(m1, weights));
+    const uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, weights), vandq_u8(m3, weights));
+    const uint8x16_t sum2 = vpaddq_u8(sum0, sum1);
+    const uint8x16_t sum3 = vpaddq_u8(sum2, sum2);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum3), 0);
+}
+
+BlockMasks ClassifyNeon(const char* block) {
+    uint8x16_t bytes[4];
+    for (std::size_t lane = 0; lane < 4; ++lane) {
+        bytes[lane] = vld1q_u8(reinterpret_cast<const std::uint8_t*>(block + lane * 16));
+    }
+    const auto eq = [](uint8x16_t value, char c) { return vceqq_u8(value, vdupq_n_u8(static_cast<std::uint8_t>(c))); };
+    const auto mask = [&bytes](auto&& test) {
+        return NeonMovemask(test(bytes[0]), test(bytes[1]), test(bytes[2]), test(bytes[3]));
+    };
+
+    BlockMasks masks;
+    masks.backslash = mask([&eq](uint8x16_t v) { return eq(v, '\\'); });
+    masks.quote = mask([&eq](uint8x16_t v) { return eq(v, '"'); });
+    masks.op = mask([&eq](uint8x16_t v) {
+        return vorrq_u8(vorrq_u8(vorrq_u8(eq(v, '{'), eq(v, '}')), vorrq_u8(eq(v, '['), eq(v, ']'))),
+                        vorrq_u8(eq(v, ':'), eq(v, ',')));
+    });
+    masks.whitespace = mask([&eq](uint8x16_t v) {
+        return vorrq_u8(vorrq_u8(eq(v, ' '), eq(v, '\t')), vorrq_u8(eq(v, '\n'), eq(v, '\r')));
+    });
+    masks.control = mask([](uint8x16_t v) { return vcltq_u8(v, vdupq_n_u8(0x20)); });
+    return masks;
+}
+
+#endif
+
+ClassifyFn ClassifierFor(JsonScanBackend backend) {
+    switch (backend) {
+#if defined(AGRI_JSON_SCAN_X86)
+        case JsonScanBackend::kSse2:
+            return ClassifySse2;
+        case JsonScanBackend::kAvx2:
+            return ClassifyAvx2;
+#endif
+#if defined(AGRI_JSON_SCAN_NEON)
+        case JsonScanBackend::kNeon:
+            return ClassifyNeon;
+#endif
+        default:
+            return ClassifyScalar;
+    }
+}
+
+std::uint64_t PrefixXor(std::uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+std::uint64_t FindEscaped(std::uint64_t backslash, std::uint64_t* carry) {
+    backslash &= ~*carry;
+    const std::uint64_t followsEscape = (backslash << 1) | *carry;
+    const std::uint64_t oddSequenceStarts = backslash & ~kEvenBits & ~followsEscape;
+    std::uint64_t sequencesStartingOnEvenBits = 0;
+    *carry = __builtin_add_overflow(oddSequenceStarts, backslash, &sequencesStartingOnEvenBits) ? 1 : 0;
+    const std::uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+    return (kEvenBits ^ invertMask) & followsEscape;
+}
+
+bool IsHexDigit(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool ReadHex4(std::string_view text, std::size_t offset, std::uint32_t* value) {
+    if (text.size() < offset + 4) {
+        return false;
+    }
+    std::uint32_t parsed = 0;
+    for (std::size_t i = offset; i < offset + 4; ++i) {
+        const char c = text[i];
+        if (!IsHexDigit(c)) {
+            return false;
+        }
+        parsed = (parsed << 4) | static_cast<std::uint32_t>((c <= '9') ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+    *value = parsed;
+    return true;
+}
+
+bool ValidateEscapes(std::string_view content) {
+    std::size_t offset = 0;
+    while (true) {
+        const void* found = std::memchr(content.data() + offset, '\\', content.size() - offset);
+        if (found == nullptr) {
+            return true;
+        }
+        offset = static_cast<std::size_t>(static_cast<const char*>(found) - content.data()) + 1;
+        if (offset >= content.size()) {
+            return false;
+        }
+        const char escaped = content[offset];
+        if (escaped != 'u') {
+            if (std::strchr("\"\\/bfnrt", escaped) == nullptr || escaped == '\0') {
+                return false;
+            }
+            ++offset;
+            continue;
+        }
+        std::uint32_t codePoint = 0;
+        if (!ReadHex4(content, offset + 1, &codePoint)) {
+            return false;
+        }
+        offset += 5;
+        if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+            return false;
+        }
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+            std::uint32_t low = 0;
+            if (content.substr(offset, 2) != "\\u" || !ReadHex4(content, offset + 2, &low) || low < 0xDC00 ||
+                low > 0xDFFF) {
+                return false;
+            }
+            offset += 6;
+        }
+    }
+}
+
+const char* SkipDigits(const char* it, const char* end) {
+    while (it != end && static_cast<unsigned char>(*it - '0') <= 9) {
+        ++it;
+    }
+    return it;
+}
+
+std::uint64_t NonZeroBytes(std::uint64_t word) {
+    return (((word & ~kHighBits) + ~kHighBits) | word) & kHighBits;
+}
+
+bool IsJsonNumberSlow(const char* it, const char* end) {
+    if (*it == '-' && ++it == end) {
+        return false;
+    }
+    if (*it == '0') {
+        ++it;
+    } else {
+        const char* digits = SkipDigits(it, end);
+        if (digits == it) {
+            return false;
+        }
+        it = digits;
+    }
+    if (it != end && *it == '.') {
+        const char* digits = SkipDigits(++it, end);
+        if (digits == it) {
+            return false;
+        }
+        it = digits;
+    }
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        if (++it != end && (*it == '+' || *it == '-')) {
+            ++it;
+        }
+        const char* digits = SkipDigits(it, end);
+        if (digits == it) {
+            return false;
+        }
+        it = digits;
+    }
+    return it == end;
+}
+
+bool IsJsonScalar(const char* it, const char* end, const char* limit) {
+    switch (*it) {
+        case 't':
+            return std::string_view(it, static_cast<std::size_t>(end - it)) == "true";
+        case 'f':
+            return std::string_view(it, static_cast<std::size_t>(end - it)) == "false";
+        case 'n':
+            return std::string_view(it, static_cast<std::size_t>(end - it)) == "null";
+        default:
+            break;
+    }
+
+    const char* body = it + (*it == '-' ? 1 : 0);
+    const std::size_t length = static_cast<std::size_t>(end - body);
+    if constexpr (std::endian::native == std::endian::little) {
+        if (length != 0 && length <= 8 && body + 8 <= limit) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, body, sizeof(word));
+            const std::uint64_t lanes = (length == 8) ? kHighBits : kHighBits & ((1ULL << (8 * length)) - 1);
+            const std::uint64_t nonDigit =
+                NonZeroBytes(((word & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL) |
+                             (((word & 0x0F0F0F0F0F0F0F0FULL) + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL));
+            const std::uint64_t dots = ~NonZeroBytes(word ^ 0x2E2E2E2E2E2E2E2EULL) & lanes;
+            if ((nonDigit & lanes) == dots && (dots & (dots - 1)) == 0) {
+                const std::size_t integerDigits =
+                    (dots == 0) ? length : static_cast<std::size_t>(__builtin_ctzll(dots)) / 8;
+                return integerDigits != 0 && integerDigits + 1 != length && (body[0] != '0' || integerDigits == 1);
+            }
+        }
+    }
+    return IsJsonNumberSlow(it, end);
+}
+
+class StructuralWalker {
+   public:
+    StructuralWalker(std::string_view json, const JsonStructuralIndex& index)
+        : json_(json.data()),
+          jsonSize_(json.size()),
+          firstStringError_(index.firstStringError),
+          firstBackslash_(index.firstBackslash),
+          begin_(index.positions.data()),
+          next_(begin_),
+          end_(begin_ + index.positions.size()) {}
+
+    bool ScanContainer(std::size_t* length) {
+        char stack[kMaxContainerDepth];
+        std::size_t depth = 0;
+        bool expectKey = false;
+
+        while (true) {
+            if (expectKey && (!ReadString() || !Next(':'))) {
+                return false;
+            }
+            if (next_ == end_) {
+                return false;
+            }
+
+            const std::uint32_t position = *next_++;
+            const char c = json_[position];
+            if (c == '{' || c == '[') {
+                if (depth == kMaxContainerDepth) {
+                    return false;
+                }
+                const char close = (c == '{') ? '}' : ']';
+                stack[depth++] = close;
+                if (!Next(close)) {
+                    expectKey = c == '{';
+                    continue;
+                }
+                --depth;
+            } else if (depth == 0) {
+                return false;
+            } else if (c == '"') {
+                --next_;
+                if (!ReadString()) {
+                    return false;
+                }
+            } else if (!ReadScalar(position)) {
+                return false;
+            }
+
+            while (true) {
+                if (depth == 0) {
+                    *length = static_cast<std::size_t>(next_[-1]) + 1;
+                    return true;
+                }
+                if (Next(',')) {
+                    expectKey = stack[depth - 1] == '}';
+                    break;
+                }
+                if (!Next(stack[depth - 1])) {
+                    return false;
+                }
+                --depth;
+            }
+        }
+    }
+
+   private:
+    bool Next(char expected) {
+        if (next_ != end_ && json_[*next_] == expected) {
+            ++next_;
+            return true;
+        }
+        return false;
+    }
+
+    bool ReadString() {
+        if (end_ - next_ < 2 || json_[next_[0]] != '"' || json_[next_[1]] != '"') {
+            return false;
+        }
+        const std::uint32_t open = next_[0];
+        const std::uint32_t close = next_[1];
+        next_ += 2;
+        if (firstStringError_ > open && firstStringError_ < close) {
+            return false;
+        }
+        return firstBackslash_ > close || ValidateEscapes(std::string_view(json_ + open + 1, close - open - 1));
+    }
+
+    bool ReadScalar(std::uint32_t position) {
+        std::size_t end = (next_ != end_) ? *next_ : jsonSize_;
+        while (IsWhitespace(json_[end - 1])) {
+            --end;
+        }
+        return IsJsonScalar(json_ + position, json_ + end, json_ + jsonSize_);
+    }
+
+    const char* json_;
+    std::size_t jsonSize_;
+    std::size_t firstStringError_;
+    std::size_t firstBackslash_;
+    const std::uint32_t* begin_;
+    const std::uint32_t* next_;
+    const std::uint32_t* end_;
+};
+
+}
+
+JsonScanBackend DefaultJsonScanBackend() {
+    static const JsonScanBackend backend = [] {
+        for (const JsonScanBackend candidate : {JsonScanBackend::kAvx2, JsonScanBackend::kNeon, JsonScanBackend::kSse2}) {
+            if (JsonScanBackendSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return JsonScanBackend::kScalar;
+    }();
+    return backend;
+}
+
+bool JsonScanBackendSupported(JsonScanBackend backend) {
+    switch (backend) {
+        case JsonScanBackend::kScalar:
+            return true;
+#if defined(AGRI_JSON_SCAN_X86)
+        case JsonScanBackend::kSse2:
+            return __builtin_cpu_supports("sse2");
+        case JsonScanBackend::kAvx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#if defined(AGRI_JSON_SCAN_NEON)
+        case JsonScanBackend::kNeon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+std::string_view JsonScanBackendName(JsonScanBackend backend) {
+    switch (backend) {
+        case JsonScanBackend::kSse2:
+            return "sse2";
+        case JsonScanBackend::kAvx2:
+            return "avx2";
+        case JsonScanBackend::kNeon:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+void BuildJsonStructuralIndex(std::string_view json, JsonScanBackend backend, JsonStructuralIndex* index) {
+    const ClassifyFn classify = ClassifierFor(JsonScanBackendSupported(backend) ? backend : JsonScanBackend::kScalar);
+    index->positions.clear();
+    index->firstStringError = std::string_view::npos;
+    index->firstBackslash = std::string_view::npos;
+
+    std::uint64_t escapeCarry = 0;
+    std::uint64_t inStringCarry = 0;
+    std::uint64_t scalarCarry = 0;
+    char tail[kBlockBytes];
+    for (std::size_t offset = 0; offset < json.size(); offset += kBlockBytes) {
+        const char* block = json.data() + offset;
+        const std::size_t available = json.size() - offset;
+        if (available < kBlockBytes) {
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, available);
+            block = tail;
+        }
+        const BlockMasks masks = classify(block);
+
+        if (masks.backslash != 0 && index->firstBackslash == std::string_view::npos) {
+            index->firstBackslash = offset + static_cast<std::size_t>(__builtin_ctzll(masks.backslash));
+        }
+        const std::uint64_t escaped = FindEscaped(masks.backslash, &escapeCarry);
+        const std::uint64_t quotes = masks.quote & ~escaped;
+        const std::uint64_t inString = PrefixXor(quotes) ^ inStringCarry;
+        inStringCarry = static_cast<std::uint64_t>(static_cast<std::int64_t>(inString) >> 63);
+
+        const std::uint64_t stringErrors = masks.control & inString;
+        if (stringErrors != 0 && index->firstStringError == std::string_view::npos) {
+            index->firstStringError = offset + static_cast<std::size_t>(__builtin_ctzll(stringErrors));
+        }
+
+        const std::uint64_t scalar = ~(masks.op | masks.whitespace | quotes | inString);
+        const std::uint64_t scalarStarts = scalar & ~((scalar << 1) | scalarCarry);
+        scalarCarry = scalar >> 63;
+
+        std::uint64_t structurals = (masks.op & ~inString) | quotes | scalarStarts;
+        while (structurals != 0) {
+            index->positions.push_back(static_cast<std::uint32_t>(offset + __builtin_ctzll(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+}
+
+bool ScanJsonContainer(std::string_view json, JsonScanBackend backend, std::size_t* length) {
+    if (json.empty() || (json.front() != '{' && json.front() != '[') ||
+        json.size() > std::numeric_limits<std::uint32_t>::max()) {
+        return false;
+    }
+    thread_local JsonStructuralIndex index;
+    BuildJsonStructuralIndex(json, backend, &index);
+    return StructuralWalker(json, index).ScanContainer(length);
+}
+
+bool ScanJsonContainer(std::string_view json, std::size_t* length) {
+    return ScanJsonContainer(json, DefaultJsonScanBackend(), length);
+}
+
+}
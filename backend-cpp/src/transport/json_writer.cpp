@@ -0,0 +1,253 @@
+#include "transport/json_writer.h"
+
+#include <bit>
+#include <charconv>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define AGRI_JSON_ESCAPE_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define AGRI_JSON_ESCAPE_NEON 1
+#endif
+
+namespace agri {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+bool NeedsEscape(char c) {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+std::size_t PlainRunScalar(const char* data, std::size_t size) {
+    std::size_t i = 0;
+    while (i < size && !NeedsEscape(data[i])) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(AGRI_JSON_ESCAPE_X86)
+
+std::size_t PlainRunSse2(const char* data, std::size_t size) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i special =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+                         _mm_cmpeq_epi8(_mm_max_epu8(bytes, controlMax), controlMax));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + PlainRunScalar(data + i, size - i);
+}
+
+#elif defined(AGRI_JSON_ESCAPE_NEON)
+
+std::size_t PlainRunNeon(const char* data, std::size_t size) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t controlLimit = vdupq_n_u8(0x20);
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const std::uint8_t*>(data + i));
+        const uint8x16_t special =
+            vorrq_u8(vorrq_u8(vceqq_u8(bytes, quote), vceqq_u8(bytes, backslash)), vcltq_u8(bytes, controlLimit));
+        if (vmaxvq_u8(special) != 0) {
+            return i + PlainRunScalar(data + i, 16);
+        }
+    }
+    return i + PlainRunScalar(data + i, size - i);
+}
+
+#endif
+
+std::size_t PlainRun(const char* data, std::size_t size) {
+#if defined(AGRI_JSON_ESCAPE_X86)
+    return PlainRunSse2(data, size);
+#elif defined(AGRI_JSON_ESCAPE_NEON)
+    return PlainRunNeon(data, size);
+#else
+    return PlainRunScalar(data, size);
+#endif
+}
+
+void AppendEscapedChar(char c, std::string* out) {
+    switch (c) {
+        case '"':
+            out->append("\\\"");
+            break;
+        case '\\':
+            out->append("\\\\");
+            break;
+        case '\b':
+            out->append("\\b");
+            break;
+        case '\f':
+            out->append("\\f");
+            break;
+        case '\n':
+            out->append("\\n");
+            break;
+        case '\r':
+            out->append("\\r");
+            break;
+        case '\t':
+            out->append("\\t");
+            break;
+        default: {
+            const unsigned char byte = static_cast<unsigned char>(c);
+            const char escaped[] = {'\\', 'u', '0', '0', kHexDigits[byte >> 4], kHexDigits[byte & 0x0F]};
+            out->append(escaped, sizeof(escaped));
+            break;
+        }
+    }
+}
+
+}
+
+void AppendJsonEscaped(std::string_view value, std::string* out) {
+    const char* data = value.data();
+    std::size_t size = value.size();
+    while (size != 0) {
+        const std::size_t run = PlainRun(data, size);
+        out->append(data, run);
+        if (run == size) {
+            return;
+        }
+        AppendEscapedChar(data[run], out);
+        data += run + 1;
+        size -= run + 1;
+    }
+}
+
+JsonWriter& JsonWriter::BeginObject() {
+    Separate();
+    out_->push_back('{');
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+    out_->push_back('}');
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray() {
+    Separate();
+    out_->push_back('[');
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+    out_->push_back(']');
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+    Separate();
+    out_->push_back('"');
+    AppendJsonEscaped(key, out_);
+    out_->append("\":");
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::String(std::string_view value) {
+    Separate();
+    out_->push_back('"');
+    AppendJsonEscaped(value, out_);
+    out_->push_back('"');
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Uint(std::uint64_t value) {
+    Separate();
+    char buffer[20];
+    const auto converted = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_->append(buffer, converted.ptr);
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+    Separate();
+    out_->append(value ? "true" : "false");
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Null() {
+    Separate();
+    out_->append("null");
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Raw(std::string_view json) {
+    Separate();
+    out_->append(json);
+    comma_ = true;
+    return *this;
+}
+
+void JsonWriter::Separate() {
+    if (comma_) {
+        out_->push_back(',');
+    }
+}
+
+void WriteBlockchainReceiptJson(const std::optional<BlockchainReceipt>& receipt, JsonWriter* writer) {
+    if (!receipt.has_value()) {
+        writer->Null();
+        return;
+    }
+    writer->BeginObject()
+        .Key("txHash")
+        .String(receipt->txHash)
+        .Key("blockHeight")
+        .Uint(receipt->blockHeight)
+        .Key("submittedAt")
+        .String(receipt->submittedAtIso8601)
+        .EndObject();
+}
+
+void WriteTelemetryRecordJson(const TelemetryRecord& record, JsonWriter* writer) {
+    const TelemetryPacket& packet = record.packet;
+    writer->BeginObject()
+        .Key("recordId")
+        .Uint(record.recordId)
+        .Key("deviceId")
+        .String(packet.deviceId)
+        .Key("timestamp")
+        .Uint(packet.timestamp)
+        .Key("telemetry")
+        .Raw(packet.telemetryJson)
+        .Key("hash")
+        .String(packet.hashHex)
+        .Key("signature")
+        .String(packet.signature)
+        .Key("pubKeyId")
+        .String(packet.pubKeyId)
+        .Key("transport")
+        .String(packet.transport);
+    if (!packet.batchCode.empty()) {
+        writer->Key("batchCode").String(packet.batchCode);
+    }
+    writer->Key("receipt");
+    WriteBlockchainReceiptJson(record.receipt, writer);
+    writer->EndObject();
+}
+
+}
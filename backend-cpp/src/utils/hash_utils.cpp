@@ -1,10 +1,20 @@
 #include "utils/hash_utils.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define AGRI_SHA256_X86 1
+#endif
 
 #if AGRI_USE_OPENSSL && __has_include(<openssl/evp.h>)
 #include <openssl/evp.h>
@@ -13,62 +23,485 @@
 #define AGRI_HASH_OPENSSL_ENABLED 0
 #endif
 
-#if !AGRI_HASH_OPENSSL_ENABLED
-#include <functional>
-#endif
-
 namespace agri {
 
 namespace {
 
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+void AppendHex(const Sha256Digest& digest, std::string* out) {
+    for (const std::uint8_t value : digest) {
+        out->push_back(kHexDigits[value >> 4]);
+        out->push_back(kHexDigits[value & 0x0F]);
+    }
+}
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
 #if AGRI_HASH_OPENSSL_ENABLED
-std::string HexEncode(const unsigned char* bytes, std::size_t length) {
-    static constexpr char kHex[] = "0123456789abcdef";
-    std::string out;
-    out.reserve(length * 2);
+const EVP_MD* Sha256Method() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    static EVP_MD* const method = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+    return method != nullptr ? method : EVP_sha256();
+#else
+    return EVP_sha256();
+#endif
+}
+
+struct DigestContext {
+    DigestContext() : ctx(EVP_MD_CTX_new()) {}
+    ~DigestContext() { EVP_MD_CTX_free(ctx); }
+    DigestContext(const DigestContext&) = delete;
+    DigestContext& operator=(const DigestContext&) = delete;
+
+    EVP_MD_CTX* ctx;
+};
+#endif
 
-    for (std::size_t i = 0; i < length; ++i) {
-        const unsigned char value = bytes[i];
-        out.push_back(kHex[(value >> 4) & 0x0F]);
-        out.push_back(kHex[value & 0x0F]);
+constexpr std::size_t kBlockBytes = 64;
+constexpr std::size_t kNoMessage = std::numeric_limits<std::size_t>::max();
+
+constexpr std::uint32_t kInitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+alignas(64) constexpr std::uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+std::uint32_t LoadBigEndian(const std::uint8_t* bytes) {
+    return (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16) |
+           (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]);
+}
+
+void StoreDigest(const std::uint32_t state[8], Sha256Digest* digest) {
+    for (std::size_t i = 0; i < 8; ++i) {
+        (*digest)[4 * i] = static_cast<std::uint8_t>(state[i] >> 24);
+        (*digest)[4 * i + 1] = static_cast<std::uint8_t>(state[i] >> 16);
+        (*digest)[4 * i + 2] = static_cast<std::uint8_t>(state[i] >> 8);
+        (*digest)[4 * i + 3] = static_cast<std::uint8_t>(state[i]);
     }
-    return out;
 }
+
+class MessageBlocks {
+   public:
+    MessageBlocks() = default;
+    explicit MessageBlocks(Sha256Pieces pieces) : pieces_(pieces) {
+        for (const std::string_view piece : pieces) {
+            length_ += piece.size();
+        }
+        remaining_ = (length_ + 9 + kBlockBytes - 1) / kBlockBytes;
+    }
+
+    bool Done() const { return remaining_ == 0; }
+
+    void Next(std::uint8_t* block) {
+        std::size_t filled = 0;
+        while (filled < kBlockBytes && piece_ < pieces_.size()) {
+            const std::string_view piece = pieces_[piece_];
+            const std::size_t take = std::min(kBlockBytes - filled, piece.size() - offset_);
+            if (take != 0) {
+                std::memcpy(block + filled, piece.data() + offset_, take);
+                filled += take;
+                offset_ += take;
+            }
+            if (offset_ == piece.size()) {
+                ++piece_;
+                offset_ = 0;
+            }
+        }
+        if (filled < kBlockBytes) {
+            if (!terminated_) {
+                block[filled++] = 0x80;
+                terminated_ = true;
+            }
+            std::memset(block + filled, 0, kBlockBytes - filled);
+        }
+        if (--remaining_ == 0) {
+            const std::uint64_t bits = static_cast<std::uint64_t>(length_) * 8;
+            for (std::size_t i = 0; i < 8; ++i) {
+                block[kBlockBytes - 1 - i] = static_cast<std::uint8_t>(bits >> (8 * i));
+            }
+        }
+    }
+
+   private:
+    Sha256Pieces pieces_;
+    std::size_t piece_{0};
+    std::size_t offset_{0};
+    std::size_t length_{0};
+    std::size_t remaining_{0};
+    bool terminated_{false};
+};
+
+std::uint32_t RotateRight(std::uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+void CompressScalar(std::uint32_t state[8], const std::uint8_t* block) {
+    std::uint32_t w[64];
+    for (std::size_t t = 0; t < 16; ++t) {
+        w[t] = LoadBigEndian(block + 4 * t);
+    }
+    for (std::size_t t = 16; t < 64; ++t) {
+        const std::uint32_t s0 = RotateRight(w[t - 15], 7) ^ RotateRight(w[t - 15], 18) ^ (w[t - 15] >> 3);
+        const std::uint32_t s1 = RotateRight(w[t - 2], 17) ^ RotateRight(w[t - 2], 19) ^ (w[t - 2] >> 10);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (std::size_t t = 0; t < 64; ++t) {
+        const std::uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+        const std::uint32_t t1 = h + s1 + ((e & f) ^ (~e & g)) + kRoundConstants[t] + w[t];
+        const std::uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+        const std::uint32_t t2 = s0 + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+using CompressFn = void (*)(std::uint32_t state[8], const std::uint8_t* block);
+
+void HashEach(std::span<const Sha256Pieces> messages, CompressFn compress, Sha256Digest* digests) {
+    alignas(16) std::uint8_t block[kBlockBytes];
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        std::uint32_t state[8];
+        std::memcpy(state, kInitialState, sizeof(state));
+        MessageBlocks blocks(messages[i]);
+        while (!blocks.Done()) {
+            blocks.Next(block);
+            compress(state, block);
+        }
+        StoreDigest(state, &digests[i]);
+    }
+}
+
+#if defined(AGRI_SHA256_X86)
+
+__attribute__((target("sha,sse4.1,ssse3"))) void CompressShaNi(std::uint32_t state[8], const std::uint8_t* block) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+    const __m128i abefSaved = abef;
+    const __m128i cdghSaved = cdgh;
+
+    __m128i w[16];
+#pragma GCC unroll 16
+    for (int i = 0; i < 16; ++i) {
+        if (i < 4) {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i)), byteSwap);
+        } else {
+            const __m128i partial =
+                _mm_add_epi32(_mm_sha256msg1_epu32(w[i - 4], w[i - 3]), _mm_alignr_epi8(w[i - 1], w[i - 2], 4));
+            w[i] = _mm_sha256msg2_epu32(partial, w[i - 1]);
+        }
+        __m128i message =
+            _mm_add_epi32(w[i], _mm_load_si128(reinterpret_cast<const __m128i*>(kRoundConstants + 4 * i)));
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+        message = _mm_shuffle_epi32(message, 0x0E);
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+    }
+
+    abef = _mm_add_epi32(abef, abefSaved);
+    cdgh = _mm_add_epi32(cdgh, cdghSaved);
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+typedef std::uint32_t Lanes8 __attribute__((vector_size(32)));
+typedef std::uint32_t Lanes16 __attribute__((vector_size(64)));
+
+#define AGRI_SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+template <typename Lanes, std::size_t kLanes>
+[[gnu::always_inline]] inline void HashInterleaved(std::span<const Sha256Pieces> messages, Sha256Digest* digests) {
+    MessageBlocks readers[kLanes];
+    std::size_t owners[kLanes];
+    alignas(64) std::uint32_t state[8][kLanes];
+    alignas(64) std::uint32_t words[16][kLanes];
+    alignas(16) std::uint8_t block[kBlockBytes];
+    std::fill(owners, owners + kLanes, kNoMessage);
+
+    std::size_t next = 0;
+    while (true) {
+        bool active = false;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            if (owners[lane] == kNoMessage && next < messages.size()) {
+                owners[lane] = next;
+                readers[lane] = MessageBlocks(messages[next++]);
+                for (std::size_t i = 0; i < 8; ++i) {
+                    state[i][lane] = kInitialState[i];
+                }
+            }
+            if (owners[lane] == kNoMessage) {
+                for (std::size_t t = 0; t < 16; ++t) {
+                    words[t][lane] = 0;
+                }
+                continue;
+            }
+            active = true;
+            readers[lane].Next(block);
+            for (std::size_t t = 0; t < 16; ++t) {
+                words[t][lane] = LoadBigEndian(block + 4 * t);
+            }
+        }
+        if (!active) {
+            return;
+        }
+
+        Lanes w[16];
+        Lanes v[8];
+        std::memcpy(w, words, sizeof(w));
+        std::memcpy(v, state, sizeof(v));
+        Lanes a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+#pragma GCC unroll 64
+        for (std::size_t t = 0; t < 64; ++t) {
+            if (t >= 16) {
+                const Lanes x = w[(t - 15) & 15];
+                const Lanes y = w[(t - 2) & 15];
+                w[t & 15] += (AGRI_SHA256_ROTR(x, 7) ^ AGRI_SHA256_ROTR(x, 18) ^ (x >> 3)) + w[(t - 7) & 15] +
+                             (AGRI_SHA256_ROTR(y, 17) ^ AGRI_SHA256_ROTR(y, 19) ^ (y >> 10));
+            }
+            const Lanes t1 = h + (AGRI_SHA256_ROTR(e, 6) ^ AGRI_SHA256_ROTR(e, 11) ^ AGRI_SHA256_ROTR(e, 25)) +
+                             ((e & f) ^ (~e & g)) + kRoundConstants[t] + w[t & 15];
+            const Lanes t2 = (AGRI_SHA256_ROTR(a, 2) ^ AGRI_SHA256_ROTR(a, 13) ^ AGRI_SHA256_ROTR(a, 22)) +
+                             ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        v[0] += a;
+        v[1] += b;
+        v[2] += c;
+        v[3] += d;
+        v[4] += e;
+        v[5] += f;
+        v[6] += g;
+        v[7] += h;
+        std::memcpy(state, v, sizeof(v));
+
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            if (owners[lane] != kNoMessage && readers[lane].Done()) {
+                std::uint32_t laneState[8];
+                for (std::size_t i = 0; i < 8; ++i) {
+                    laneState[i] = state[i][lane];
+                }
+                StoreDigest(laneState, &digests[owners[lane]]);
+                owners[lane] = kNoMessage;
+            }
+        }
+    }
+}
+
+#undef AGRI_SHA256_ROTR
+
+__attribute__((target("avx2"))) void HashAvx2(std::span<const Sha256Pieces> messages, Sha256Digest* digests) {
+    HashInterleaved<Lanes8, 8>(messages, digests);
+}
+
+__attribute__((target("avx512f"))) void HashAvx512(std::span<const Sha256Pieces> messages, Sha256Digest* digests) {
+    HashInterleaved<Lanes16, 16>(messages, digests);
+}
+
+bool CpuHasShaExtensions() {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    return (ebx & (1u << 29)) != 0 && __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3");
+}
+
 #endif
 
 }
 
-std::string Sha256Hex(std::string_view input) {
+Sha256Digest Sha256(std::initializer_list<std::string_view> pieces) {
+    Sha256Digest digest{};
 #if AGRI_HASH_OPENSSL_ENABLED
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (ctx == nullptr) {
-        return std::string(64, '0');
+    thread_local DigestContext context;
+    EVP_MD_CTX* ctx = context.ctx;
+    if (ctx == nullptr || EVP_DigestInit_ex(ctx, Sha256Method(), nullptr) != 1) {
+        return digest;
+    }
+    for (const std::string_view piece : pieces) {
+        if (EVP_DigestUpdate(ctx, piece.data(), piece.size()) != 1) {
+            return Sha256Digest{};
+        }
     }
-
-    unsigned char digest[EVP_MAX_MD_SIZE] = {0};
     unsigned int digestLength = 0;
+    if (EVP_DigestFinal_ex(ctx, digest.data(), &digestLength) != 1 || digestLength != digest.size()) {
+        return Sha256Digest{};
+    }
+#else
+    const Sha256Pieces message(pieces.begin(), pieces.size());
+    const Sha256Backend backend =
+        Sha256BackendSupported(Sha256Backend::kShaNi) ? Sha256Backend::kShaNi : Sha256Backend::kScalar;
+    Sha256Batch(std::span<const Sha256Pieces>(&message, 1), backend, &digest);
+#endif
+    return digest;
+}
+
+Sha256Backend DefaultSha256Backend() {
+    static const Sha256Backend backend = [] {
+        for (const Sha256Backend candidate : {Sha256Backend::kAvx512, Sha256Backend::kShaNi, Sha256Backend::kAvx2}) {
+            if (Sha256BackendSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return Sha256Backend::kScalar;
+    }();
+    return backend;
+}
 
-    const int initOk = EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr);
-    const int updateOk = EVP_DigestUpdate(ctx, input.data(), input.size());
-    const int finalOk = EVP_DigestFinal_ex(ctx, digest, &digestLength);
+bool Sha256BackendSupported(Sha256Backend backend) {
+    switch (backend) {
+        case Sha256Backend::kScalar:
+            return true;
+#if defined(AGRI_SHA256_X86)
+        case Sha256Backend::kShaNi: {
+            static const bool supported = CpuHasShaExtensions();
+            return supported;
+        }
+        case Sha256Backend::kAvx2:
+            return __builtin_cpu_supports("avx2");
+        case Sha256Backend::kAvx512:
+            return __builtin_cpu_supports("avx512f");
+#else
+        case Sha256Backend::kShaNi:
+        case Sha256Backend::kAvx2:
+        case Sha256Backend::kAvx512:
+            return false;
+#endif
+    }
+    return false;
+}
 
-    EVP_MD_CTX_free(ctx);
+std::string_view Sha256BackendName(Sha256Backend backend) {
+    switch (backend) {
+        case Sha256Backend::kShaNi:
+            return "sha-ni";
+        case Sha256Backend::kAvx2:
+            return "avx2";
+        case Sha256Backend::kAvx512:
+            return "avx512";
+        case Sha256Backend::kScalar:
+            break;
+    }
+    return "scalar";
+}
 
-    if (initOk != 1 || updateOk != 1 || finalOk != 1) {
-        return std::string(64, '0');
+void Sha256Batch(std::span<const Sha256Pieces> messages, Sha256Digest* digests) {
+    Sha256Backend backend = DefaultSha256Backend();
+    const std::size_t lanes = (backend == Sha256Backend::kAvx512) ? 16 : (backend == Sha256Backend::kAvx2) ? 8 : 1;
+    if (messages.size() * 2 < lanes && Sha256BackendSupported(Sha256Backend::kShaNi)) {
+        backend = Sha256Backend::kShaNi;
     }
+    Sha256Batch(messages, backend, digests);
+}
 
-    return HexEncode(digest, digestLength);
-#else
-    std::hash<std::string> hasher;
-    const std::string text(input);
-    std::ostringstream stream;
-    stream << std::hex << std::setw(16) << std::setfill('0') << hasher(text + "|0")
-           << std::hex << std::setw(16) << std::setfill('0') << hasher(text + "|1")
-           << std::hex << std::setw(16) << std::setfill('0') << hasher(text + "|2")
-           << std::hex << std::setw(16) << std::setfill('0') << hasher(text + "|3");
-    return stream.str();
+void Sha256Batch(std::span<const Sha256Pieces> messages, Sha256Backend backend, Sha256Digest* digests) {
+    if (!Sha256BackendSupported(backend)) {
+        backend = Sha256Backend::kScalar;
+    }
+    switch (backend) {
+#if defined(AGRI_SHA256_X86)
+        case Sha256Backend::kShaNi:
+            HashEach(messages, CompressShaNi, digests);
+            return;
+        case Sha256Backend::kAvx2:
+            HashAvx2(messages, digests);
+            return;
+        case Sha256Backend::kAvx512:
+            HashAvx512(messages, digests);
+            return;
 #endif
+        default:
+            HashEach(messages, CompressScalar, digests);
+            return;
+    }
+}
+
+bool DecodeSha256Hex(std::string_view hex, Sha256Digest* digest) {
+    if (hex.size() != digest->size() * 2) {
+        return false;
+    }
+    for (std::size_t i = 0; i < digest->size(); ++i) {
+        const int high = HexValue(hex[2 * i]);
+        const int low = HexValue(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        (*digest)[i] = static_cast<std::uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+std::string Sha256Hex(std::string_view input) {
+    std::string hex;
+    hex.reserve(64);
+    AppendHex(Sha256({input}), &hex);
+    return hex;
+}
+
+std::string MerkleRootHex(std::vector<std::string> leafHashesHex) {
+    if (leafHashesHex.empty()) {
+        return Sha256Hex("");
+    }
+    while (leafHashesHex.size() > 1) {
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < leafHashesHex.size(); i += 2) {
+            if (i + 1 < leafHashesHex.size()) {
+                const Sha256Digest parent = Sha256({leafHashesHex[i], leafHashesHex[i + 1]});
+                std::string& node = leafHashesHex[next++];
+                node.clear();
+                AppendHex(parent, &node);
+            } else {
+                leafHashesHex[next++] = std::move(leafHashesHex[i]);
+            }
+        }
+        leafHashesHex.resize(next);
+    }
+    return leafHashesHex.front();
 }
 
 std::string CurrentUtcIso8601() {
@@ -0,0 +1,366 @@
+#include "utils/io_uring.h"
+
+#include <algorithm>
+
+#ifndef AGRI_USE_IO_URING
+#define AGRI_USE_IO_URING 0
+#endif
+
+#if AGRI_USE_IO_URING && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#define AGRI_IO_URING_ENABLED 1
+#else
+#define AGRI_IO_URING_ENABLED 0
+#endif
+
+namespace agri {
+
+#if AGRI_IO_URING_ENABLED
+
+namespace {
+
+constexpr int kMinKernelMajor = 6;
+constexpr int kMinKernelMinor = 0;
+constexpr unsigned kRequiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+
+template <typename T>
+T LoadAcquire(const T* value) {
+    return std::atomic_ref<T>(*const_cast<T*>(value)).load(std::memory_order_acquire);
+}
+
+template <typename T>
+void StoreRelease(T* value, T next) {
+    std::atomic_ref<T>(*value).store(next, std::memory_order_release);
+}
+
+void* MapRing(int fd, std::size_t size, off_t offset) {
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return (address == MAP_FAILED) ? nullptr : address;
+}
+
+}
+
+struct IoUring::Ring {
+    int fd{-1};
+    void* ringMap{nullptr};
+    std::size_t ringMapBytes{0};
+    io_uring_sqe* sqes{nullptr};
+    std::size_t sqesBytes{0};
+
+    unsigned* sqHead{nullptr};
+    unsigned* sqTail{nullptr};
+    unsigned* sqArray{nullptr};
+    unsigned sqMask{0};
+    unsigned sqEntries{0};
+    unsigned sqeTail{0};
+
+    unsigned* cqHead{nullptr};
+    unsigned* cqTail{nullptr};
+    unsigned cqMask{0};
+    io_uring_cqe* cqes{nullptr};
+
+    io_uring_buf_ring* bufferRing{nullptr};
+    std::size_t bufferRingBytes{0};
+    char* buffers{nullptr};
+    std::size_t buffersBytes{0};
+    std::size_t bufferBytes{0};
+    unsigned bufferMask{0};
+    std::uint16_t bufferTail{0};
+
+    ~Ring() {
+        if (buffers != nullptr) {
+            munmap(buffers, buffersBytes);
+        }
+        if (bufferRing != nullptr) {
+            munmap(bufferRing, bufferRingBytes);
+        }
+        if (sqes != nullptr) {
+            munmap(sqes, sqesBytes);
+        }
+        if (ringMap != nullptr) {
+            munmap(ringMap, ringMapBytes);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    void AddBuffer(std::uint16_t bufferId) {
+        io_uring_buf* buffer = reinterpret_cast<io_uring_buf*>(bufferRing) + (bufferTail & bufferMask);
+        buffer->addr = reinterpret_cast<std::uint64_t>(buffers + static_cast<std::size_t>(bufferId) * bufferBytes);
+        buffer->len = static_cast<std::uint32_t>(bufferBytes);
+        buffer->bid = bufferId;
+        ++bufferTail;
+    }
+};
+
+bool IoUringCompletion::More() const {
+    return (flags & IORING_CQE_F_MORE) != 0;
+}
+
+bool IoUringCompletion::HasBuffer() const {
+    return (flags & IORING_CQE_F_BUFFER) != 0;
+}
+
+std::uint16_t IoUringCompletion::BufferId() const {
+    return static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+IoUring::IoUring() = default;
+
+IoUring::~IoUring() = default;
+
+bool IoUring::Available() {
+    utsname name{};
+    int major = 0;
+    int minor = 0;
+    if (uname(&name) != 0 || std::sscanf(name.release, "%d.%d", &major, &minor) != 2) {
+        return false;
+    }
+    return major > kMinKernelMajor || (major == kMinKernelMajor && minor >= kMinKernelMinor);
+}
+
+bool IoUring::Init(unsigned entries) {
+    auto ring = std::make_unique<Ring>();
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = entries * 4;
+    ring->fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring->fd < 0 && errno == EINVAL) {
+        params = io_uring_params{};
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        ring->fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+    if (ring->fd < 0 || (params.features & kRequiredFeatures) != kRequiredFeatures) {
+        return false;
+    }
+
+    ring->ringMapBytes = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                               params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ring->ringMap = MapRing(ring->fd, ring->ringMapBytes, IORING_OFF_SQ_RING);
+    ring->sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes = static_cast<io_uring_sqe*>(MapRing(ring->fd, ring->sqesBytes, IORING_OFF_SQES));
+    if (ring->ringMap == nullptr || ring->sqes == nullptr) {
+        return false;
+    }
+
+    char* base = static_cast<char*>(ring->ringMap);
+    ring->sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+    ring->sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+    ring->sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+    ring->sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+    ring->sqEntries = params.sq_entries;
+    ring->sqeTail = *ring->sqTail;
+    ring->cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+    ring->cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+    ring->cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+    ring_ = std::move(ring);
+    return true;
+}
+
+bool IoUring::RegisterBufferRing(std::uint16_t groupId, std::size_t bufferCount, std::size_t bufferBytes) {
+    if ((bufferCount & (bufferCount - 1)) != 0 || bufferCount > 32768) {
+        return false;
+    }
+
+    ring_->bufferRingBytes = bufferCount * sizeof(io_uring_buf);
+    void* bufferRing = mmap(nullptr, ring_->bufferRingBytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    ring_->buffersBytes = bufferCount * bufferBytes;
+    void* buffers = mmap(nullptr, ring_->buffersBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring_->bufferRing = (bufferRing == MAP_FAILED) ? nullptr : static_cast<io_uring_buf_ring*>(bufferRing);
+    ring_->buffers = (buffers == MAP_FAILED) ? nullptr : static_cast<char*>(buffers);
+    if (ring_->bufferRing == nullptr || ring_->buffers == nullptr) {
+        return false;
+    }
+
+    io_uring_buf_reg registration{};
+    registration.ring_addr = reinterpret_cast<std::uint64_t>(ring_->bufferRing);
+    registration.ring_entries = static_cast<std::uint32_t>(bufferCount);
+    registration.bgid = groupId;
+    if (syscall(__NR_io_uring_register, ring_->fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        return false;
+    }
+
+    ring_->bufferBytes = bufferBytes;
+    ring_->bufferMask = static_cast<unsigned>(bufferCount - 1);
+    for (std::size_t i = 0; i < bufferCount; ++i) {
+        ring_->AddBuffer(static_cast<std::uint16_t>(i));
+    }
+    StoreRelease(&ring_->bufferRing->tail, ring_->bufferTail);
+    return true;
+}
+
+void IoUring::PrepareMultishotAccept(int fd, int acceptFlags, std::uint64_t userData) {
+    auto* sqe = static_cast<io_uring_sqe*>(NextSqe());
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->accept_flags = static_cast<std::uint32_t>(acceptFlags);
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = userData;
+}
+
+void IoUring::PrepareMultishotRecv(int fd, std::uint16_t groupId, std::uint64_t userData) {
+    auto* sqe = static_cast<io_uring_sqe*>(NextSqe());
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = groupId;
+    sqe->user_data = userData;
+}
+
+void IoUring::PrepareMultishotPoll(int fd, std::uint32_t events, std::uint64_t userData) {
+    auto* sqe = static_cast<io_uring_sqe*>(NextSqe());
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = events;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = userData;
+}
+
+void IoUring::PrepareSendMsg(int fd, const msghdr* message, int flags, bool linkNext, std::uint64_t userData) {
+    auto* sqe = static_cast<io_uring_sqe*>(NextSqe());
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(message);
+    sqe->len = 1;
+    sqe->msg_flags = static_cast<std::uint32_t>(flags);
+    sqe->flags = linkNext ? IOSQE_IO_LINK : 0;
+    sqe->user_data = userData;
+}
+
+void IoUring::PrepareCancel(std::uint64_t targetUserData, std::uint64_t userData) {
+    auto* sqe = static_cast<io_uring_sqe*>(NextSqe());
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = targetUserData;
+    sqe->user_data = userData;
+}
+
+bool IoUring::SubmitAndWait(int timeoutMs) {
+    StoreRelease(ring_->sqTail, ring_->sqeTail);
+    const unsigned toSubmit = ring_->sqeTail - LoadAcquire(ring_->sqHead);
+    const bool ready = LoadAcquire(ring_->cqTail) != *ring_->cqHead;
+
+    __kernel_timespec timeout{};
+    io_uring_getevents_arg arg{};
+    if (timeoutMs >= 0) {
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+        arg.ts = reinterpret_cast<std::uint64_t>(&timeout);
+    }
+    const long result = syscall(__NR_io_uring_enter, ring_->fd, toSubmit, ready ? 0 : 1,
+                                IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    return result >= 0 || errno == ETIME || errno == EINTR || errno == EBUSY || errno == EAGAIN;
+}
+
+std::size_t IoUring::ReapCompletions(std::vector<IoUringCompletion>* completions) {
+    unsigned head = *ring_->cqHead;
+    const unsigned tail = LoadAcquire(ring_->cqTail);
+    const std::size_t count = tail - head;
+    for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = ring_->cqes[head & ring_->cqMask];
+        completions->push_back(IoUringCompletion{cqe.user_data, cqe.res, cqe.flags});
+    }
+    StoreRelease(ring_->cqHead, head);
+    return count;
+}
+
+std::string_view IoUring::Buffer(std::uint16_t bufferId, std::size_t length) const {
+    return std::string_view(ring_->buffers + static_cast<std::size_t>(bufferId) * ring_->bufferBytes, length);
+}
+
+void IoUring::RecycleBuffer(std::uint16_t bufferId) {
+    ring_->AddBuffer(bufferId);
+    StoreRelease(&ring_->bufferRing->tail, ring_->bufferTail);
+}
+
+void* IoUring::NextSqe() {
+    if (ring_->sqeTail - LoadAcquire(ring_->sqHead) >= ring_->sqEntries) {
+        StoreRelease(ring_->sqTail, ring_->sqeTail);
+        syscall(__NR_io_uring_enter, ring_->fd, ring_->sqEntries, 0, 0, nullptr, 0);
+    }
+    const unsigned index = ring_->sqeTail & ring_->sqMask;
+    io_uring_sqe* sqe = &ring_->sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    ring_->sqArray[index] = index;
+    ++ring_->sqeTail;
+    return sqe;
+}
+
+#else
+
+struct IoUring::Ring {};
+
+bool IoUringCompletion::More() const {
+    return false;
+}
+
+bool IoUringCompletion::HasBuffer() const {
+    return false;
+}
+
+std::uint16_t IoUringCompletion::BufferId() const {
+    return 0;
+}
+
+IoUring::IoUring() = default;
+
+IoUring::~IoUring() = default;
+
+bool IoUring::Available() {
+    return false;
+}
+
+bool IoUring::Init(unsigned) {
+    return false;
+}
+
+bool IoUring::RegisterBufferRing(std::uint16_t, std::size_t, std::size_t) {
+    return false;
+}
+
+void IoUring::PrepareMultishotAccept(int, int, std::uint64_t) {}
+
+void IoUring::PrepareMultishotRecv(int, std::uint16_t, std::uint64_t) {}
+
+void IoUring::PrepareMultishotPoll(int, std::uint32_t, std::uint64_t) {}
+
+void IoUring::PrepareSendMsg(int, const msghdr*, int, bool, std::uint64_t) {}
+
+void IoUring::PrepareCancel(std::uint64_t, std::uint64_t) {}
+
+bool IoUring::SubmitAndWait(int) {
+    return false;
+}
+
+std::size_t IoUring::ReapCompletions(std::vector<IoUringCompletion>*) {
+    return 0;
+}
+
+std::string_view IoUring::Buffer(std::uint16_t, std::size_t) const {
+    return {};
+}
+
+void IoUring::RecycleBuffer(std::uint16_t) {}
+
+void* IoUring::NextSqe() {
+    return nullptr;
+}
+
+#endif
+
+}
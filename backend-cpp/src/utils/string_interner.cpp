@@ -0,0 +1,53 @@
+#include "utils/string_interner.h"
+
+#include <mutex>
+
+namespace agri {
+
+StringInterner::StringInterner(std::size_t capacity) : capacity_(capacity) {}
+
+bool StringInterner::Intern(std::string_view value, std::uint32_t* id) {
+    if (Find(value, id)) {
+        return true;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (const auto it = ids_.find(value); it != ids_.end()) {
+        *id = it->second;
+        return true;
+    }
+    if (values_.size() >= capacity_) {
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    *id = static_cast<std::uint32_t>(values_.size());
+    values_.emplace_back(value);
+    ids_.emplace(values_.back(), *id);
+    return true;
+}
+
+bool StringInterner::Find(std::string_view value, std::uint32_t* id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto it = ids_.find(value);
+    if (it == ids_.end()) {
+        return false;
+    }
+    *id = it->second;
+    return true;
+}
+
+std::string_view StringInterner::Lookup(std::uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return id < values_.size() ? std::string_view(values_[id]) : std::string_view();
+}
+
+std::size_t StringInterner::Size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return values_.size();
+}
+
+std::uint64_t StringInterner::Overflows() const {
+    return overflows_.load(std::memory_order_relaxed);
+}
+
+}
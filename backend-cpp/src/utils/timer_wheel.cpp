@@ -0,0 +1,178 @@
+#include "utils/timer_wheel.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace agri {
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point origin)
+    : tick_(std::max(tick, std::chrono::milliseconds(1))), origin_(origin) {
+    heads_.fill(kNone);
+}
+
+TimerWheel::TimerId TimerWheel::Create(std::uint64_t payload) {
+    TimerId id = 0;
+    if (!freeNodes_.empty()) {
+        id = freeNodes_.back();
+        freeNodes_.pop_back();
+        nodes_[id] = Node{};
+    } else {
+        id = static_cast<TimerId>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[id].payload = payload;
+    return id;
+}
+
+void TimerWheel::Schedule(TimerId id, Clock::time_point deadline) {
+    if (nodes_[id].linked) {
+        Unlink(id);
+    }
+    nodes_[id].expiry = std::max(TickAt(deadline, true), current_ + 1);
+    Link(id);
+}
+
+void TimerWheel::Cancel(TimerId id) {
+    if (nodes_[id].linked) {
+        Unlink(id);
+    }
+}
+
+void TimerWheel::Destroy(TimerId id) {
+    Cancel(id);
+    freeNodes_.push_back(id);
+}
+
+bool TimerWheel::Scheduled(TimerId id) const {
+    return nodes_[id].linked;
+}
+
+void TimerWheel::Advance(Clock::time_point now, std::vector<std::uint64_t>* expired) {
+    const std::uint64_t target = TickAt(now, false);
+    while (scheduled_ > 0 && current_ < target) {
+        const std::uint64_t next = NextEventTick();
+        if (next > target) {
+            break;
+        }
+        ProcessTick(next, expired);
+    }
+    current_ = std::max(current_, target);
+}
+
+int TimerWheel::MillisecondsUntilNextExpiry(Clock::time_point now) const {
+    if (scheduled_ == 0) {
+        return -1;
+    }
+    const Clock::time_point due = origin_ + tick_ * NextEventTick();
+    if (due <= now) {
+        return 0;
+    }
+    const auto wait = std::chrono::ceil<std::chrono::milliseconds>(due - now).count();
+    return static_cast<int>(std::min<std::int64_t>(wait, std::numeric_limits<int>::max()));
+}
+
+std::size_t TimerWheel::ScheduledCount() const {
+    return scheduled_;
+}
+
+std::uint64_t TimerWheel::TickAt(Clock::time_point time, bool roundUp) const {
+    if (time <= origin_) {
+        return 0;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin_).count();
+    const auto step = std::chrono::duration_cast<std::chrono::nanoseconds>(tick_).count();
+    const auto ticks = static_cast<std::uint64_t>(elapsed / step);
+    return (roundUp && elapsed % step != 0) ? ticks + 1 : ticks;
+}
+
+std::uint64_t TimerWheel::NextEventTick() const {
+    std::uint64_t next = std::numeric_limits<std::uint64_t>::max();
+    for (std::size_t level = 0; level < kLevels; ++level) {
+        if (occupied_[level] == 0) {
+            continue;
+        }
+        const unsigned shift = static_cast<unsigned>(level) * kSlotBits;
+        const std::uint64_t base = current_ >> shift;
+        const int start = static_cast<int>((base + 1) & (kSlots - 1));
+        const std::uint64_t distance = static_cast<std::uint64_t>(std::countr_zero(std::rotr(occupied_[level], start))) + 1;
+        next = std::min(next, (base + distance) << shift);
+    }
+    return next;
+}
+
+void TimerWheel::Link(std::uint32_t id) {
+    Node& node = nodes_[id];
+    std::size_t level = 0;
+    while (level + 1 < kLevels &&
+           (node.expiry >> (level * kSlotBits)) - (current_ >> (level * kSlotBits)) >= kSlots) {
+        ++level;
+    }
+    const unsigned shift = static_cast<unsigned>(level) * kSlotBits;
+    const std::uint64_t horizon = (current_ >> shift) + kSlots - 1;
+    const std::uint64_t slot = std::min(node.expiry >> shift, horizon) & (kSlots - 1);
+
+    node.bucket = static_cast<std::uint32_t>(level * kSlots + slot);
+    node.prev = kNone;
+    node.next = heads_[node.bucket];
+    node.linked = true;
+    if (node.next != kNone) {
+        nodes_[node.next].prev = id;
+    }
+    heads_[node.bucket] = id;
+    occupied_[level] |= std::uint64_t{1} << slot;
+    ++scheduled_;
+}
+
+void TimerWheel::Unlink(std::uint32_t id) {
+    Node& node = nodes_[id];
+    if (node.prev == kNone) {
+        heads_[node.bucket] = node.next;
+    } else {
+        nodes_[node.prev].next = node.next;
+    }
+    if (node.next != kNone) {
+        nodes_[node.next].prev = node.prev;
+    }
+    if (heads_[node.bucket] == kNone) {
+        occupied_[node.bucket / kSlots] &= ~(std::uint64_t{1} << (node.bucket % kSlots));
+    }
+    node.linked = false;
+    --scheduled_;
+}
+
+void TimerWheel::ProcessTick(std::uint64_t tick, std::vector<std::uint64_t>* expired) {
+    current_ = tick;
+    const auto detach = [this](std::size_t level, std::uint64_t slot) {
+        const std::size_t bucket = level * kSlots + slot;
+        const std::uint32_t head = heads_[bucket];
+        heads_[bucket] = kNone;
+        occupied_[level] &= ~(std::uint64_t{1} << slot);
+        return head;
+    };
+
+    for (std::size_t level = kLevels - 1; level > 0; --level) {
+        const unsigned shift = static_cast<unsigned>(level) * kSlotBits;
+        if ((tick & ((std::uint64_t{1} << shift) - 1)) != 0) {
+            continue;
+        }
+        std::uint32_t id = detach(level, (tick >> shift) & (kSlots - 1));
+        while (id != kNone) {
+            const std::uint32_t next = nodes_[id].next;
+            nodes_[id].linked = false;
+            --scheduled_;
+            Link(id);
+            id = next;
+        }
+    }
+
+    std::uint32_t id = detach(0, tick & (kSlots - 1));
+    while (id != kNone) {
+        const std::uint32_t next = nodes_[id].next;
+        nodes_[id].linked = false;
+        --scheduled_;
+        expired->push_back(nodes_[id].payload);
+        id = next;
+    }
+}
+
+}
@@ -0,0 +1,161 @@
+#include "utils/work_stealing_pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace agri {
+
+namespace {
+
+thread_local const WorkStealingPool* tCurrentPool = nullptr;
+thread_local std::size_t tCurrentWorker = 0;
+
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t workerCount) {
+    const std::size_t count = std::max<std::size_t>(1, workerCount);
+    queues_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    workers_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        workers_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(parkMutex_);
+    }
+    workAvailable_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void WorkStealingPool::Submit(Task task) {
+    const std::size_t index = (tCurrentPool == this)
+                                  ? tCurrentWorker
+                                  : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+    unfinishedTasks_.fetch_add(1, std::memory_order_acq_rel);
+    queuedTasks_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+
+    // Pairs with Park: a worker registers as sleeping before re-checking queuedTasks_, so either it sees this
+    // task or this load sees it and the notify is issued under parkMutex_, where it cannot be lost.
+    if (sleepingWorkers_.load(std::memory_order_seq_cst) != 0) {
+        {
+            std::lock_guard<std::mutex> lock(parkMutex_);
+        }
+        workAvailable_.notify_one();
+    }
+}
+
+void WorkStealingPool::WaitIdle() {
+    std::unique_lock<std::mutex> lock(idleMutex_);
+    idle_.wait(lock, [this] { return unfinishedTasks_.load(std::memory_order_acquire) == 0; });
+}
+
+std::size_t WorkStealingPool::WorkerCount() const {
+    return workers_.size();
+}
+
+std::uint64_t WorkStealingPool::StolenTaskCount() const {
+    return stolenTasks_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t WorkStealingPool::FailedTaskCount() const {
+    return failedTasks_.load(std::memory_order_relaxed);
+}
+
+void WorkStealingPool::WorkerLoop(std::size_t index) {
+    tCurrentPool = this;
+    tCurrentWorker = index;
+
+    while (true) {
+        Task task;
+        if (TryPopLocal(index, &task) || TrySteal(index, &task)) {
+            queuedTasks_.fetch_sub(1, std::memory_order_acq_rel);
+            RunTask(task);
+            FinishTask();
+            continue;
+        }
+
+        if (stopping_.load(std::memory_order_acquire) && queuedTasks_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+        Park();
+    }
+}
+
+void WorkStealingPool::RunTask(Task& task) {
+    // Callers own their error reporting; anything that escapes is a bug, so it is counted and logged rather
+    // than allowed to terminate the worker.
+    try {
+        task();
+    } catch (const std::exception& ex) {
+        failedTasks_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "worker task failed: " << ex.what() << std::endl;
+    } catch (...) {
+        failedTasks_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "worker task failed with a non-standard exception" << std::endl;
+    }
+}
+
+void WorkStealingPool::Park() {
+    std::unique_lock<std::mutex> lock(parkMutex_);
+    sleepingWorkers_.fetch_add(1, std::memory_order_seq_cst);
+    workAvailable_.wait(lock, [this] {
+        return stopping_.load(std::memory_order_seq_cst) || queuedTasks_.load(std::memory_order_seq_cst) > 0;
+    });
+    sleepingWorkers_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+bool WorkStealingPool::TryPopLocal(std::size_t index, Task* task) {
+    WorkerQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    *task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::TrySteal(std::size_t thief, Task* task) {
+    for (std::size_t offset = 1; offset < queues_.size(); ++offset) {
+        WorkerQueue& victim = *queues_[(thief + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+        *task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        stolenTasks_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::FinishTask() {
+    if (unfinishedTasks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex_);
+        }
+        idle_.notify_all();
+    }
+}
+
+}
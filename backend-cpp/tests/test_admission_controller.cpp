@@ -0,0 +1,131 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "api/admission_controller.h"
+
+namespace {
+
+struct ManualDispatcher {
+    std::vector<agri::AdmissionController::Task> tasks;
+
+    agri::AdmissionController::Dispatcher Bind() {
+        return [this](agri::AdmissionController::Task task) { tasks.push_back(std::move(task)); };
+    }
+
+    bool RunNext() {
+        if (tasks.empty()) {
+            return false;
+        }
+        agri::AdmissionController::Task task = std::move(tasks.front());
+        tasks.erase(tasks.begin());
+        task();
+        return true;
+    }
+};
+
+void TestAdmitsUpToLimitThenQueues() {
+    ManualDispatcher dispatcher;
+    agri::AdmissionConfig config;
+    config.maxInFlight = 2;
+    agri::AdmissionController controller(config, dispatcher.Bind());
+
+    std::vector<std::string> ran;
+    auto record = [&ran](std::string name) { return [&ran, name] { ran.push_back(name); }; };
+    assert(controller.Submit("gw", 10, record("one")) == agri::AdmissionDecision::kAdmitted);
+    assert(controller.Submit("gw", 10, record("two")) == agri::AdmissionDecision::kAdmitted);
+    assert(controller.Submit("gw", 10, record("three")) == agri::AdmissionDecision::kQueued);
+    assert(dispatcher.tasks.size() == 2);
+    assert(controller.Snapshot().inFlight == 2);
+    assert(controller.Snapshot().queued == 1);
+
+    while (dispatcher.RunNext()) {
+    }
+    assert((ran == std::vector<std::string>{"one", "two", "three"}));
+    const agri::AdmissionSnapshot snapshot = controller.Snapshot();
+    assert(snapshot.inFlight == 0 && snapshot.queued == 0 && snapshot.admitted == 3);
+    assert(snapshot.queuedByGateway.empty());
+}
+
+void TestShedsOnQueueLimits() {
+    ManualDispatcher dispatcher;
+    agri::AdmissionConfig config;
+    config.maxInFlight = 1;
+    config.maxQueued = 3;
+    config.maxQueuedPerGateway = 2;
+    agri::AdmissionController controller(config, dispatcher.Bind());
+
+    auto noop = [] {};
+    assert(controller.Submit("g1", 1, noop) == agri::AdmissionDecision::kAdmitted);
+    assert(controller.Submit("g1", 1, noop) == agri::AdmissionDecision::kQueued);
+    assert(controller.Submit("g1", 1, noop) == agri::AdmissionDecision::kQueued);
+    assert(controller.Submit("g1", 1, noop) == agri::AdmissionDecision::kGatewayLimited);
+    assert(controller.Submit("g2", 1, noop) == agri::AdmissionDecision::kQueued);
+    assert(controller.Submit("g3", 1, noop) == agri::AdmissionDecision::kOverloaded);
+
+    const agri::AdmissionSnapshot snapshot = controller.Snapshot();
+    assert(snapshot.queued == 3);
+    assert(snapshot.shedGatewayLimited == 1 && snapshot.shedOverloaded == 1);
+    assert(snapshot.queuedByGateway.size() == 2);
+    assert(snapshot.queuedByGateway[0].first == "g1" && snapshot.queuedByGateway[0].second == 2);
+    assert(snapshot.queuedByGateway[1].first == "g2" && snapshot.queuedByGateway[1].second == 1);
+
+    while (dispatcher.RunNext()) {
+    }
+    assert(controller.Snapshot().queued == 0);
+    assert(controller.Submit("g3", 1, noop) == agri::AdmissionDecision::kAdmitted);
+}
+
+void TestRoundRobinsBetweenGateways() {
+    ManualDispatcher dispatcher;
+    agri::AdmissionConfig config;
+    config.maxInFlight = 1;
+    config.quantumBytes = 100;
+    agri::AdmissionController controller(config, dispatcher.Bind());
+
+    std::string order;
+    auto mark = [&order](char name) { return [&order, name] { order.push_back(name); }; };
+    assert(controller.Submit("busy", 100, mark('x')) == agri::AdmissionDecision::kAdmitted);
+    for (int i = 0; i < 5; ++i) {
+        controller.Submit("busy", 100, mark('a'));
+    }
+    controller.Submit("quiet", 100, mark('b'));
+    controller.Submit("quiet", 100, mark('b'));
+
+    while (dispatcher.RunNext()) {
+    }
+    assert(order == "xababaaa");
+}
+
+void TestDeficitAccountsForRequestSize() {
+    ManualDispatcher dispatcher;
+    agri::AdmissionConfig config;
+    config.maxInFlight = 1;
+    config.quantumBytes = 1000;
+    agri::AdmissionController controller(config, dispatcher.Bind());
+
+    std::string order;
+    auto mark = [&order](char name) { return [&order, name] { order.push_back(name); }; };
+    controller.Submit("seed", 1, mark('x'));
+    controller.Submit("bulk", 3000, mark('B'));
+    controller.Submit("bulk", 3000, mark('B'));
+    for (int i = 0; i < 8; ++i) {
+        controller.Submit("sensor", 250, mark('s'));
+    }
+
+    while (dispatcher.RunNext()) {
+    }
+    assert(order == "xssssssssBB");
+}
+
+}
+
+int main() {
+    TestAdmitsUpToLimitThenQueues();
+    TestShedsOnQueueLimits();
+    TestRoundRobinsBetweenGateways();
+    TestDeficitAccountsForRequestSize();
+    std::cout << "admission controller tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "transport/cbor_parser.h"
+#include "utils/hash_utils.h"
+
+namespace {
+
+void AppendHead(std::uint8_t major, std::uint64_t value, std::string* out) {
+    const auto initial = static_cast<char>(major << 5);
+    if (value < 24) {
+        out->push_back(static_cast<char>(initial | static_cast<char>(value)));
+        return;
+    }
+    const int width = (value <= 0xFF) ? 1 : (value <= 0xFFFF) ? 2 : (value <= 0xFFFFFFFFu) ? 4 : 8;
+    const int info = (width == 1) ? 24 : (width == 2) ? 25 : (width == 4) ? 26 : 27;
+    out->push_back(static_cast<char>(initial | info));
+    for (int i = width - 1; i >= 0; --i) {
+        out->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void AppendText(const std::string& text, std::string* out) {
+    AppendHead(3, text.size(), out);
+    out->append(text);
+}
+
+void AppendBytes(const std::string& bytes, std::string* out) {
+    AppendHead(2, bytes.size(), out);
+    out->append(bytes);
+}
+
+void AppendFloat(float value, std::string* out) {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    out->push_back(static_cast<char>(0xFA));
+    for (int i = 3; i >= 0; --i) {
+        out->push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+std::string HexDecode(const std::string& hex) {
+    std::string out;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return out;
+}
+
+const std::string kTelemetryJson = "{\"temperature\":24.5,\"humidity\":62.3}";
+
+std::string EncodePacket(const std::string& hashHex, bool mapTelemetry) {
+    std::string out;
+    AppendHead(5, 7, &out);
+    AppendHead(0, 0, &out);
+    AppendText("lora-node-7", &out);
+    AppendHead(0, 1, &out);
+    AppendHead(0, 1700001000, &out);
+    AppendHead(0, 2, &out);
+    if (mapTelemetry) {
+        AppendHead(5, 2, &out);
+        AppendText("temperature", &out);
+        AppendFloat(24.5f, &out);
+        AppendText("humidity", &out);
+        AppendFloat(62.3f, &out);
+    } else {
+        AppendText(kTelemetryJson, &out);
+    }
+    AppendHead(0, 3, &out);
+    AppendBytes(HexDecode(hashHex), &out);
+    AppendHead(0, 4, &out);
+    AppendBytes(std::string(32, '\x91') + std::string(31, '\0') + "\x05", &out);
+    AppendHead(0, 5, &out);
+    AppendText("pubkey-1", &out);
+    AppendHead(0, 6, &out);
+    AppendText("lora", &out);
+    return out;
+}
+
+void TestDecodesCompactPacket() {
+    const std::string hashHex = agri::Sha256Hex("lora-node-7|1700001000|" + kTelemetryJson);
+    const std::string cbor = EncodePacket(hashHex, false);
+
+    const agri::ParseTelemetryResult parsed = agri::ParseTelemetryPacketCbor(cbor);
+    assert(parsed.ok);
+    assert(parsed.packet.deviceId == "lora-node-7");
+    assert(parsed.packet.timestamp == 1700001000);
+    assert(parsed.packet.telemetryJson == kTelemetryJson);
+    assert(parsed.packet.hashHex == hashHex);
+    std::string rHex;
+    for (int i = 0; i < 32; ++i) {
+        rHex += "91";
+    }
+    assert(parsed.packet.signature == "3026022100" + rHex + "020105");
+    assert(parsed.packet.pubKeyId == "pubkey-1");
+    assert(parsed.packet.transport == "lora");
+    assert(parsed.packet.batchCode.empty());
+
+    const std::string json = "{\"deviceId\":\"lora-node-7\",\"timestamp\":1700001000,\"telemetry\":" + kTelemetryJson +
+                             ",\"hash\":\"" + hashHex + "\",\"signature\":\"" + std::string(parsed.packet.signature) +
+                             "\",\"pubKeyId\":\"pubkey-1\",\"transport\":\"lora\"}";
+    assert(cbor.size() * 100 < json.size() * 60);
+}
+
+void TestRendersTelemetryMapAsJson() {
+    const agri::ParseTelemetryResult parsed = agri::ParseTelemetryPacketCbor(EncodePacket(std::string(64, 'a'), true));
+    assert(parsed.ok);
+    assert(parsed.packet.telemetryJson == kTelemetryJson);
+
+    std::string nested;
+    AppendHead(5, 6, &nested);
+    AppendText("deviceId", &nested);
+    AppendText("n", &nested);
+    AppendText("timestamp", &nested);
+    nested.append("\xC1\x1A\x65\x53\xF1\x00", 6);
+    AppendText("telemetry", &nested);
+    AppendHead(5, 3, &nested);
+    AppendText("depth", &nested);
+    AppendHead(1, 4, &nested);
+    AppendText("ok", &nested);
+    nested.push_back(static_cast<char>(0xF5));
+    AppendText("levels", &nested);
+    AppendHead(4, 2, &nested);
+    nested.append("\xF9\x3E\x00", 3);
+    nested.push_back(static_cast<char>(0xF6));
+    AppendText("hash", &nested);
+    AppendText(std::string(64, 'b'), &nested);
+    AppendText("signature", &nested);
+    AppendBytes("\x30\x06\x02\x01\x01\x02\x01\x02", &nested);
+    AppendText("vendorExtension", &nested);
+    AppendHead(4, 1, &nested);
+    AppendHead(0, 9, &nested);
+
+    const agri::ParseTelemetryResult named = agri::ParseTelemetryPacketCbor(nested);
+    assert(named.ok);
+    assert(named.packet.timestamp == 1700000000);
+    assert(named.packet.telemetryJson == "{\"depth\":-5,\"ok\":true,\"levels\":[1.5,null]}");
+    assert(named.packet.metrics.size() == 2);
+    assert(agri::TelemetryKeyTable().Lookup(named.packet.metrics[0].keyId) == "depth");
+    assert(std::get<double>(named.packet.metrics[0].value) == -5.0);
+    assert(std::get<bool>(named.packet.metrics[1].value));
+    assert(named.packet.hashHex == std::string(64, 'b'));
+    assert(named.packet.signature == "3006020101020102");
+    assert(named.packet.pubKeyId == "default-pubkey");
+    assert(named.packet.transport == "wifi");
+}
+
+void TestRejectsMalformedPackets() {
+    const std::string packet = EncodePacket(std::string(64, 'a'), false);
+    assert(agri::ParseTelemetryPacketCbor(packet.substr(0, packet.size() - 1)).error == "malformed CBOR packet");
+    assert(agri::ParseTelemetryPacketCbor(packet + "\x01").error == "malformed CBOR packet");
+
+    std::string textTelemetry;
+    AppendHead(5, 5, &textTelemetry);
+    AppendHead(0, 0, &textTelemetry);
+    AppendText("node", &textTelemetry);
+    AppendHead(0, 1, &textTelemetry);
+    AppendHead(0, 1, &textTelemetry);
+    AppendHead(0, 2, &textTelemetry);
+    AppendText("{\"temperature\":24.5,}", &textTelemetry);
+    AppendHead(0, 3, &textTelemetry);
+    AppendText(std::string(64, 'a'), &textTelemetry);
+    AppendHead(0, 4, &textTelemetry);
+    AppendText("00", &textTelemetry);
+    assert(agri::ParseTelemetryPacketCbor(textTelemetry).error == "telemetry must be a JSON object");
+
+    std::string missing;
+    AppendHead(5, 1, &missing);
+    AppendHead(0, 0, &missing);
+    AppendText("node", &missing);
+    assert(agri::ParseTelemetryPacketCbor(missing).error == "missing timestamp");
+
+    std::string shortHash;
+    AppendHead(5, 1, &shortHash);
+    AppendHead(0, 3, &shortHash);
+    AppendBytes("abc", &shortHash);
+    assert(agri::ParseTelemetryPacketCbor(shortHash).error == "malformed CBOR packet");
+
+    std::string shortTextHash;
+    AppendHead(5, 5, &shortTextHash);
+    AppendHead(0, 0, &shortTextHash);
+    AppendText("node", &shortTextHash);
+    AppendHead(0, 1, &shortTextHash);
+    AppendHead(0, 1, &shortTextHash);
+    AppendHead(0, 2, &shortTextHash);
+    AppendText("{}", &shortTextHash);
+    AppendHead(0, 3, &shortTextHash);
+    AppendText("aa", &shortTextHash);
+    AppendHead(0, 4, &shortTextHash);
+    AppendText("00", &shortTextHash);
+    assert(agri::ParseTelemetryPacketCbor(shortTextHash).error == "hash must be 64 characters");
+
+    std::string deep;
+    for (int i = 0; i < 40; ++i) {
+        AppendHead(4, 1, &deep);
+    }
+    AppendHead(0, 1, &deep);
+    std::string tooDeep;
+    AppendHead(5, 1, &tooDeep);
+    AppendHead(0, 9, &tooDeep);
+    tooDeep += deep;
+    assert(agri::ParseTelemetryPacketCbor(tooDeep).error == "malformed CBOR packet");
+}
+
+void TestSplitsCborSequence() {
+    const std::string first = EncodePacket(std::string(64, 'a'), false);
+    std::string notMap;
+    AppendHead(4, 2, &notMap);
+    AppendHead(0, 1, &notMap);
+    AppendText("x", &notMap);
+
+    std::vector<agri::ParseTelemetryResult> packets;
+    std::string error;
+    assert(agri::ParseTelemetryBatchCbor(first + notMap + first, &packets, &error));
+    assert(packets.size() == 3);
+    assert(packets[0].ok && packets[2].ok);
+    assert(!packets[1].ok && packets[1].error == "telemetry packet must be a CBOR map");
+
+    assert(!agri::ParseTelemetryBatchCbor(first + first.substr(0, 10), &packets, &error));
+    assert(error == "malformed CBOR sequence at item 1");
+}
+
+void TestConvertsRawSignatureToDer() {
+    const std::string r = "\x80" + std::string(31, '\x01');
+    const std::string s = std::string(30, '\0') + "\x7F\x02";
+    std::string rHex = "80";
+    for (int i = 0; i < 31; ++i) {
+        rHex += "01";
+    }
+    assert(agri::RawEcdsaSignatureToDerHex(r + s) == "3027022100" + rHex + "02027f02");
+}
+
+}
+
+int main() {
+    TestDecodesCompactPacket();
+    TestRendersTelemetryMapAsJson();
+    TestRejectsMalformedPackets();
+    TestSplitsCborSequence();
+    TestConvertsRawSignatureToDer();
+    std::cout << "test_cbor_parser passed" << std::endl;
+    return 0;
+}
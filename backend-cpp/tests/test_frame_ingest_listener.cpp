@@ -0,0 +1,340 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api/frame_ingest_listener.h"
+#include "blockchain/blockchain_client.h"
+#include "security/signature_verifier.h"
+#include "services/ingest_service.h"
+#include "storage/in_memory_telemetry_repository.h"
+#include "utils/hash_utils.h"
+
+namespace {
+
+class AcceptAllVerifier final : public agri::SignatureVerifier {
+   public:
+    bool Verify(const agri::TelemetryPacketView&) const override { return true; }
+};
+
+std::uint16_t PickFreePort(int type) {
+    const int fd = socket(AF_INET, type, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    close(fd);
+    return ntohs(address.sin_port);
+}
+
+sockaddr_in Loopback(std::uint16_t port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    return address;
+}
+
+int Connect(std::uint16_t port) {
+    const sockaddr_in address = Loopback(port);
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+void AppendBigEndian32(std::uint32_t value, std::string* out) {
+    for (int i = 3; i >= 0; --i) {
+        out->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+std::uint64_t ReadBigEndian(const std::string& bytes, std::size_t offset, std::size_t width) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < width; ++i) {
+        value = (value << 8) | static_cast<unsigned char>(bytes[offset + i]);
+    }
+    return value;
+}
+
+std::string FrameBody(std::uint32_t sequence, const std::string& payload) {
+    std::string body;
+    AppendBigEndian32(sequence, &body);
+    body += payload;
+    return body;
+}
+
+std::string TcpFrame(std::uint32_t sequence, const std::string& payload) {
+    const std::string body = FrameBody(sequence, payload);
+    std::string frame;
+    AppendBigEndian32(static_cast<std::uint32_t>(body.size()), &frame);
+    return frame + body;
+}
+
+std::string PacketJson(const std::string& deviceId, std::int64_t timestamp) {
+    const std::string telemetry = "{\"temperature\":21.5}";
+    const std::string hash = agri::Sha256Hex(deviceId + "|" + std::to_string(timestamp) + "|" + telemetry);
+    return "{\"deviceId\":\"" + deviceId + "\",\"timestamp\":" + std::to_string(timestamp) +
+           ",\"telemetry\":" + telemetry + ",\"hash\":\"" + hash +
+           "\",\"signature\":\"3006020101020101\",\"pubKeyId\":\"pubkey-1\",\"transport\":\"lora\"}";
+}
+
+struct Ack {
+    std::uint32_t sequence{0};
+    agri::FrameAckStatus status{agri::FrameAckStatus::kAccepted};
+    std::uint64_t recordId{0};
+    std::string message;
+};
+
+Ack DecodeAck(const std::string& bytes) {
+    assert(bytes.size() >= 13);
+    Ack ack;
+    ack.sequence = static_cast<std::uint32_t>(ReadBigEndian(bytes, 0, 4));
+    ack.status = static_cast<agri::FrameAckStatus>(bytes[4]);
+    ack.recordId = ReadBigEndian(bytes, 5, 8);
+    ack.message = bytes.substr(13);
+    return ack;
+}
+
+std::vector<Ack> ReadTcpAcks(int fd, std::size_t count) {
+    std::string pending;
+    std::vector<Ack> acks;
+    char buffer[4096];
+    while (acks.size() < count) {
+        if (pending.size() >= 4) {
+            const std::size_t length = ReadBigEndian(pending, 0, 4);
+            if (pending.size() >= 4 + length) {
+                acks.push_back(DecodeAck(pending.substr(4, length)));
+                pending.erase(0, 4 + length);
+                continue;
+            }
+        }
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        pending.append(buffer, static_cast<std::size_t>(received));
+    }
+    return acks;
+}
+
+class FailingSaveRepository final : public agri::TelemetryRepository {
+   public:
+    std::uint64_t Save(const agri::TelemetryPacketView&) override { throw std::runtime_error("disk full"); }
+    std::vector<std::uint64_t> SaveBatch(const std::vector<agri::TelemetryPacketView>&) override {
+        throw std::runtime_error("disk full");
+    }
+    bool AttachReceipt(std::uint64_t, const agri::BlockchainReceipt&) override { return false; }
+    bool AttachReceiptBatch(const std::vector<std::uint64_t>&, const agri::BlockchainReceipt&) override {
+        return false;
+    }
+    bool Delete(std::uint64_t) override { return false; }
+    std::optional<agri::TelemetryRecord> LatestByDevice(const std::string&) const override { return std::nullopt; }
+    std::optional<agri::TelemetryRecord> FindByTransaction(const std::string&) const override { return std::nullopt; }
+    std::vector<agri::TelemetryRecord> FindByBatch(const std::string&) const override { return {}; }
+    void ReadBatchPage(
+        agri::TelemetryBatchCursor* cursor,
+        std::size_t,
+        std::vector<agri::TelemetryRecord>*) const override {
+        cursor->exhausted = true;
+    }
+    std::uint64_t Size() const override { return 0; }
+};
+
+struct ListenerFixture {
+    agri::InMemoryTelemetryRepository repository;
+    AcceptAllVerifier verifier;
+    agri::MockBlockchainClient blockchain;
+    agri::IngestService ingestService;
+    std::atomic<int> observed{0};
+    agri::FrameIngestListener listener;
+    std::thread thread;
+
+    explicit ListenerFixture(agri::FrameIngestConfig config, agri::TelemetryRepository* store = nullptr)
+        : ingestService(store != nullptr ? *store : repository, verifier, blockchain),
+          listener(config, ingestService, [this](const agri::TelemetryPacketView&, const agri::IngestResult&) { ++observed; }),
+          thread([this] { listener.Start(); }) {}
+
+    ~ListenerFixture() {
+        listener.Stop();
+        thread.join();
+    }
+};
+
+void TestEncodesAck() {
+    const std::string ack = agri::EncodeFrameAck(0x01020304, agri::FrameAckStatus::kRejected, 0x0A0B, "no");
+    assert(ack == std::string("\x01\x02\x03\x04\x01\x00\x00\x00\x00\x00\x00\x0A\x0Bno", 15));
+}
+
+void TestAcknowledgesTcpFrames() {
+    agri::FrameIngestConfig config;
+    config.tcpPort = PickFreePort(SOCK_STREAM);
+    ListenerFixture fixture(config);
+
+    const int client = Connect(config.tcpPort);
+    assert(client >= 0);
+    const std::string stream = TcpFrame(7, PacketJson("tcp-node-1", 1700001000)) + TcpFrame(8, "{\"timestamp\":1}") +
+                               TcpFrame(9, PacketJson("tcp-node-2", 1700001001)) + TcpFrame(10, "\xA0");
+    for (const char byte : stream.substr(0, 5)) {
+        [[maybe_unused]] const ssize_t sentByte = send(client, &byte, 1, MSG_NOSIGNAL);
+        assert(sentByte == 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    [[maybe_unused]] const ssize_t sentRest = send(client, stream.data() + 5, stream.size() - 5, MSG_NOSIGNAL);
+    assert(sentRest == static_cast<ssize_t>(stream.size() - 5));
+
+    const std::vector<Ack> acks = ReadTcpAcks(client, 4);
+    assert(acks.size() == 4);
+    std::vector<std::uint32_t> sequences;
+    for (const Ack& ack : acks) {
+        sequences.push_back(ack.sequence);
+    }
+    assert((sequences == std::vector<std::uint32_t>{7, 8, 9, 10}));
+    assert(acks[0].status == agri::FrameAckStatus::kAccepted && acks[0].recordId != 0 && acks[0].message.empty());
+    assert(acks[1].status == agri::FrameAckStatus::kMalformed && acks[1].message == "missing deviceId");
+    assert(acks[2].status == agri::FrameAckStatus::kAccepted && acks[2].recordId != acks[0].recordId);
+    assert(acks[3].status == agri::FrameAckStatus::kMalformed);
+    assert(fixture.repository.LatestByDevice("tcp-node-2").has_value());
+    assert(fixture.observed.load() == 2);
+
+    const std::string oversized = std::string("\x00\x10\x00\x01", 4);
+    [[maybe_unused]] const ssize_t sentOversized = send(client, oversized.data(), oversized.size(), MSG_NOSIGNAL);
+    assert(sentOversized == 4);
+    char byte = 0;
+    [[maybe_unused]] const ssize_t closed = recv(client, &byte, 1, 0);
+    assert(closed == 0);
+    close(client);
+
+    const agri::FrameIngestStats stats = fixture.listener.Stats();
+    assert(stats.tcpConnections == 1);
+    assert(stats.tcpFrames == 4);
+    assert(stats.malformedFrames == 3);
+}
+
+void TestAcknowledgesUdpDatagrams() {
+    agri::FrameIngestConfig config;
+    config.udpPort = PickFreePort(SOCK_DGRAM);
+    config.maxDatagramBytes = 512;
+    ListenerFixture fixture(config);
+
+    const int client = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval timeout{0, 50 * 1000};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    const sockaddr_in address = Loopback(config.udpPort);
+    const auto sendDatagram = [&](const std::string& body) {
+        sendto(client, body.data(), body.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    };
+
+    char buffer[1024];
+    ssize_t received = -1;
+    for (int attempt = 0; attempt < 100 && received < 0; ++attempt) {
+        sendDatagram(FrameBody(1, PacketJson("udp-node-1", 1700002000)));
+        received = recv(client, buffer, sizeof(buffer), 0);
+    }
+    assert(received > 0);
+    const Ack first = DecodeAck(std::string(buffer, static_cast<std::size_t>(received)));
+    assert(first.sequence == 1 && first.status == agri::FrameAckStatus::kAccepted);
+
+    timeout.tv_sec = 5;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sendDatagram(FrameBody(2, PacketJson("udp-node-2", 1700002001)));
+    sendDatagram(FrameBody(3, "{" + std::string(600, ' ') + "}"));
+    sendDatagram(FrameBody(4, "not a packet"));
+
+    std::vector<Ack> acks;
+    for (int i = 0; i < 3; ++i) {
+        received = recv(client, buffer, sizeof(buffer), 0);
+        assert(received > 0);
+        acks.push_back(DecodeAck(std::string(buffer, static_cast<std::size_t>(received))));
+    }
+    close(client);
+
+    for (const Ack& ack : acks) {
+        if (ack.sequence == 2) {
+            assert(ack.status == agri::FrameAckStatus::kAccepted && ack.recordId != 0);
+        } else if (ack.sequence == 3) {
+            assert(ack.status == agri::FrameAckStatus::kMalformed && ack.message == "datagram exceeds 512 bytes");
+        } else {
+            assert(ack.sequence == 4 && ack.status == agri::FrameAckStatus::kMalformed);
+        }
+    }
+    assert(fixture.repository.LatestByDevice("udp-node-2").has_value());
+    assert(fixture.listener.Stats().ingestBatches >= 2);
+}
+
+void TestRejectsFramesWhenIngestThrows() {
+    FailingSaveRepository failing;
+    agri::FrameIngestConfig config;
+    config.tcpPort = PickFreePort(SOCK_STREAM);
+    config.udpPort = PickFreePort(SOCK_DGRAM);
+    config.maxUdpBatchesInFlight = 1;
+    ListenerFixture fixture(config, &failing);
+
+    const int client = Connect(config.tcpPort);
+    assert(client >= 0);
+    for (std::uint32_t round = 0; round < 3; ++round) {
+        const std::string stream = TcpFrame(2 * round, PacketJson("tcp-fail", 1700003000 + round)) +
+                                   TcpFrame(2 * round + 1, PacketJson("tcp-fail", 1700003100 + round));
+        [[maybe_unused]] const ssize_t sent = send(client, stream.data(), stream.size(), MSG_NOSIGNAL);
+        assert(sent == static_cast<ssize_t>(stream.size()));
+        const std::vector<Ack> acks = ReadTcpAcks(client, 2);
+        assert(acks.size() == 2);
+        for (const Ack& ack : acks) {
+            assert(ack.status == agri::FrameAckStatus::kRejected && ack.recordId == 0);
+            assert(ack.message == "ingest failed: disk full");
+        }
+    }
+    close(client);
+
+    const int udp = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval timeout{0, 50 * 1000};
+    setsockopt(udp, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    const sockaddr_in address = Loopback(config.udpPort);
+    char buffer[1024];
+    int rejected = 0;
+    for (int attempt = 0; attempt < 200 && rejected < 3; ++attempt) {
+        const std::string body =
+            FrameBody(static_cast<std::uint32_t>(attempt), PacketJson("udp-fail", 1700004000 + attempt));
+        sendto(udp, body.data(), body.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        const ssize_t received = recv(udp, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            const Ack ack = DecodeAck(std::string(buffer, static_cast<std::size_t>(received)));
+            assert(ack.status == agri::FrameAckStatus::kRejected && ack.message == "ingest failed: disk full");
+            ++rejected;
+        }
+    }
+    close(udp);
+    assert(rejected == 3);
+    assert(fixture.observed.load() == 0);
+}
+
+}
+
+int main() {
+    TestEncodesAck();
+    TestAcknowledgesTcpFrames();
+    TestAcknowledgesUdpDatagrams();
+    TestRejectsFramesWhenIngestThrows();
+    std::cout << "test_frame_ingest_listener passed" << std::endl;
+    return 0;
+}
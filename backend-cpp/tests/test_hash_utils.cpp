@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/hash_utils.h"
+
+namespace {
+
+constexpr agri::Sha256Backend kBackends[] = {
+    agri::Sha256Backend::kScalar, agri::Sha256Backend::kShaNi, agri::Sha256Backend::kAvx2,
+    agri::Sha256Backend::kAvx512};
+
+agri::Sha256Digest Digest(std::string_view hex) {
+    agri::Sha256Digest digest;
+    assert(agri::DecodeSha256Hex(hex, &digest));
+    return digest;
+}
+
+std::vector<agri::Sha256Digest> HashAll(const std::vector<agri::Sha256Pieces>& messages, agri::Sha256Backend backend) {
+    std::vector<agri::Sha256Digest> digests(messages.size());
+    agri::Sha256Batch(messages, backend, digests.data());
+    return digests;
+}
+
+void TestKnownAnswers() {
+    const std::string million(1000000, 'a');
+    const std::string_view abc[] = {"abc"};
+    const std::string_view empty[] = {""};
+    const std::string_view twoBlocks[] = {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+    const std::string_view split[] = {"a", "", "bc"};
+    const std::string_view longMessage[] = {million};
+    const std::vector<agri::Sha256Pieces> messages = {abc, empty, twoBlocks, split, longMessage};
+    const std::vector<agri::Sha256Digest> expected = {
+        Digest("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+        Digest("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"),
+        Digest("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"),
+        Digest("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+        Digest("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0")};
+
+    for (const agri::Sha256Backend backend : kBackends) {
+        assert(HashAll(messages, backend) == expected);
+    }
+    assert(agri::Sha256({"abc"}) == expected[0]);
+    assert(agri::Sha256Hex("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+void TestBackendsAgreeOnMixedBatches() {
+    std::string text;
+    for (std::size_t i = 0; i < 300; ++i) {
+        text.push_back(static_cast<char>('!' + (i * 7) % 90));
+    }
+
+    std::vector<std::string_view> storage;
+    storage.reserve(3 * 200);
+    std::vector<agri::Sha256Pieces> messages;
+    std::vector<agri::Sha256Digest> expected;
+    for (std::size_t length = 0; length < 200; ++length) {
+        const std::size_t cut = length / 3;
+        storage.push_back(std::string_view(text).substr(0, cut));
+        storage.push_back("|");
+        storage.push_back(std::string_view(text).substr(cut, length - cut));
+        messages.emplace_back(storage.data() + storage.size() - 3, 3);
+        expected.push_back(agri::Sha256({text.substr(0, cut), "|", text.substr(cut, length - cut)}));
+    }
+
+    const std::size_t counts[] = {0, 1, 7, 17, messages.size()};
+    for (const agri::Sha256Backend backend : kBackends) {
+        for (const std::size_t count : counts) {
+            const std::vector<agri::Sha256Pieces> batch(messages.begin(), messages.begin() + count);
+            const std::vector<agri::Sha256Digest> digests = HashAll(batch, backend);
+            assert(std::equal(digests.begin(), digests.end(), expected.begin()));
+        }
+    }
+}
+
+void TestDispatch() {
+    assert(agri::Sha256BackendSupported(agri::Sha256Backend::kScalar));
+    assert(agri::Sha256BackendSupported(agri::DefaultSha256Backend()));
+    assert(agri::Sha256BackendName(agri::Sha256Backend::kShaNi) == "sha-ni");
+    std::cout << "default sha256 backend: " << agri::Sha256BackendName(agri::DefaultSha256Backend()) << std::endl;
+}
+
+}
+
+int main() {
+    TestKnownAnswers();
+    TestBackendsAgreeOnMixedBatches();
+    TestDispatch();
+    std::cout << "test_hash_utils passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "api/http_request_parser.h"
+
+namespace {
+
+using agri::HttpHeaderId;
+using agri::HttpRequestParser;
+
+void TestParsesRequestWithBody() {
+    const std::string raw =
+        "POST /api/v1/ingest?dryRun=1 HTTP/1.1\r\n"
+        "Host: gateway\r\n"
+        "content-length:  7 \r\n"
+        "X-Gateway-Id: lora-gw-3\r\n"
+        "\r\n"
+        "{\"a\":1}";
+
+    HttpRequestParser parser;
+    assert(parser.Parse(raw) == HttpRequestParser::Status::kComplete);
+    const agri::HttpRequest& request = parser.Request();
+    assert(request.method == "POST");
+    assert(request.target == "/api/v1/ingest?dryRun=1");
+    assert(request.path == "/api/v1/ingest");
+    assert(request.query == "dryRun=1");
+    assert(request.body == "{\"a\":1}");
+    assert(request.headers.Get(HttpHeaderId::kContentLength) == "7");
+    assert(request.headers.Get("x-gateway-id") == "lora-gw-3");
+    assert(request.keepAlive);
+    assert(parser.ConsumedBytes() == raw.size());
+    assert(request.body.data() >= raw.data() && request.body.data() < raw.data() + raw.size());
+}
+
+void TestResumesAcrossPartialReads() {
+    const std::string raw =
+        "GET /health HTTP/1.0\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
+
+    HttpRequestParser parser;
+    std::string buffer;
+    for (std::size_t i = 0; i + 1 < raw.size(); ++i) {
+        buffer.push_back(raw[i]);
+        assert(parser.Parse(buffer) == HttpRequestParser::Status::kIncomplete);
+    }
+    buffer.push_back(raw.back());
+    assert(parser.Parse(buffer) == HttpRequestParser::Status::kComplete);
+    assert(parser.Request().path == "/health");
+    assert(parser.Request().keepAlive);
+}
+
+void TestStopsAtFirstPipelinedRequest() {
+    const std::string raw =
+        "GET /health HTTP/1.1\r\n\r\n"
+        "GET /api/v1/metrics/overview HTTP/1.1\r\nConnection: close\r\n\r\n";
+
+    HttpRequestParser parser;
+    assert(parser.Parse(raw) == HttpRequestParser::Status::kComplete);
+    assert(parser.Request().path == "/health");
+    const std::size_t consumed = parser.ConsumedBytes();
+
+    parser.Reset();
+    const std::string rest = raw.substr(consumed);
+    assert(parser.Parse(rest) == HttpRequestParser::Status::kComplete);
+    assert(parser.Request().path == "/api/v1/metrics/overview");
+    assert(!parser.Request().keepAlive);
+}
+
+void TestRejectsMalformedInput() {
+    HttpRequestParser parser;
+    assert(parser.Parse("GARBAGE\r\n\r\n") == HttpRequestParser::Status::kError);
+    assert(parser.ErrorStatus() == 400);
+
+    parser.Reset();
+    assert(parser.Parse("POST / HTTP/1.1\r\nContent-Length: 12x\r\n\r\n") == HttpRequestParser::Status::kError);
+    assert(parser.ErrorStatus() == 400);
+
+    HttpRequestParser smallParser(4);
+    assert(smallParser.Parse("POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\n") ==
+           HttpRequestParser::Status::kError);
+    assert(smallParser.ErrorStatus() == 413);
+
+    parser.Reset();
+    assert(parser.Parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n") ==
+           HttpRequestParser::Status::kError);
+    assert(parser.ErrorStatus() == 501);
+}
+
+void TestRebaseMovesViewsToNewBuffer() {
+    const std::string raw = "GET /ws/telemetry?deviceId=a HTTP/1.1\r\nUpgrade: websocket\r\n\r\n";
+
+    HttpRequestParser parser;
+    assert(parser.Parse(raw) == HttpRequestParser::Status::kComplete);
+    agri::HttpRequest request = parser.Request();
+
+    const std::string copy = raw;
+    request.Rebase(raw.data(), copy.data());
+    assert(request.path.data() == copy.data() + 4);
+    assert(request.query == "deviceId=a");
+    assert(request.headers.Get(HttpHeaderId::kUpgrade).data() > copy.data());
+    assert(request.headers.Get(HttpHeaderId::kUpgrade) == "websocket");
+}
+
+}
+
+int main() {
+    TestParsesRequestWithBody();
+    TestResumesAcrossPartialReads();
+    TestStopsAtFirstPipelinedRequest();
+    TestRejectsMalformedInput();
+    TestRebaseMovesViewsToNewBuffer();
+    std::cout << "test_http_request_parser passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "api/http_response_writer.h"
+
+namespace {
+
+void ConnectedPair(int* serverFd, int* clientFd) {
+    const int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    [[maybe_unused]] const int bound = bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    assert(bound == 0);
+    [[maybe_unused]] const int listening = listen(listenFd, 1);
+    assert(listening == 0);
+    socklen_t length = sizeof(address);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+
+    *clientFd = socket(AF_INET, SOCK_STREAM, 0);
+    [[maybe_unused]] const int connected = connect(*clientFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    assert(connected == 0);
+    *serverFd = accept(listenFd, nullptr, nullptr);
+    assert(*serverFd >= 0);
+    close(listenFd);
+
+    const int flags = fcntl(*serverFd, F_GETFL, 0);
+    fcntl(*serverFd, F_SETFL, flags | O_NONBLOCK);
+}
+
+std::string ReadExactly(int fd, std::size_t size) {
+    std::string out;
+    char buffer[65536];
+    while (out.size() < size) {
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        out.append(buffer, static_cast<std::size_t>(received));
+    }
+    return out;
+}
+
+void TestHeaderBlockRendering() {
+    agri::ResponseHeaderBlock head;
+    head.Render(404, "application/json", 27, true);
+    assert(head.View() ==
+           "HTTP/1.1 404 Not Found\r\nContent-Type: application/json\r\nContent-Length: 27\r\n"
+           "Connection: keep-alive\r\n\r\n");
+
+    head.Render(200, "text/plain", 0, false);
+    assert(head.View() == "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+    head.RenderChunked(200, "application/json", true);
+    assert(head.View() ==
+           "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n"
+           "Connection: keep-alive\r\n\r\n");
+    head.RenderChunkSize(300, true);
+    assert(head.View() == "\r\n12c\r\n");
+
+    head.Render(503, "application/json", 2, false, 3);
+    assert(head.View() ==
+           "HTTP/1.1 503 Service Unavailable\r\nContent-Type: application/json\r\nContent-Length: 2\r\n"
+           "Retry-After: 3\r\nConnection: close\r\n\r\n");
+
+    assert(agri::StatusText(413) == "Payload Too Large");
+    assert(agri::StatusText(429) == "Too Many Requests");
+    assert(agri::StatusText(299) == "Internal Server Error");
+}
+
+void TestBatchedAndZeroCopyFlush() {
+    int serverFd = -1;
+    int clientFd = -1;
+    ConnectedPair(&serverFd, &clientFd);
+
+    agri::OutboundQueue output;
+    output.EnableZeroCopy(serverFd, 64 * 1024);
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        const std::string body = "{\"n\":" + std::to_string(i) + "}";
+        agri::ResponseHeaderBlock head;
+        head.Render(200, "application/json", body.size(), true);
+        expected.append(head.View());
+        expected.append(body);
+        output.PushResponse(200, "application/json", body, true);
+    }
+
+    const std::string large(3 * 1024 * 1024, 'z');
+    agri::ResponseHeaderBlock largeHead;
+    largeHead.Render(200, "application/octet-stream", large.size(), false);
+    expected.append(largeHead.View());
+    expected.append(large);
+    output.PushResponse(200, "application/octet-stream", large, false);
+    output.PushRaw("tail");
+    expected.append("tail");
+    assert(output.PendingBytes() == expected.size());
+
+    std::string received;
+    std::thread reader([&] { received = ReadExactly(clientFd, expected.size()); });
+
+    while (true) {
+        const agri::OutboundQueue::FlushStatus status = output.Flush(serverFd);
+        assert(status != agri::OutboundQueue::FlushStatus::kError);
+        if (status == agri::OutboundQueue::FlushStatus::kDrained) {
+            break;
+        }
+        pollfd waitFor{serverFd, POLLOUT, 0};
+        poll(&waitFor, 1, 1000);
+    }
+    reader.join();
+
+    assert(output.Empty());
+    assert(output.PendingBytes() == 0);
+    assert(received == expected);
+
+    for (int attempt = 0; attempt < 100 && output.HasZeroCopyInFlight(); ++attempt) {
+        pollfd waitFor{serverFd, 0, 0};
+        poll(&waitFor, 1, 10);
+        output.ReapZeroCopyCompletions(serverFd);
+    }
+    assert(!output.HasZeroCopyInFlight());
+
+    close(serverFd);
+    close(clientFd);
+}
+
+void TestChunkedFraming() {
+    int serverFd = -1;
+    int clientFd = -1;
+    ConnectedPair(&serverFd, &clientFd);
+
+    agri::OutboundQueue output;
+    output.PushChunkedHead(200, "application/json", false);
+    output.PushChunk("{\"a\":[");
+    output.PushChunk("");
+    output.PushChunk(std::string(20, 'x'));
+    output.PushChunk("]}");
+    output.PushLastChunk();
+
+    const std::string expected =
+        "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n"
+        "Connection: close\r\n\r\n"
+        "6\r\n{\"a\":[\r\n14\r\n" + std::string(20, 'x') + "\r\n2\r\n]}\r\n0\r\n\r\n";
+    assert(output.PendingBytes() == expected.size());
+    [[maybe_unused]] agri::OutboundQueue::FlushStatus status = output.Flush(serverFd);
+    assert(status == agri::OutboundQueue::FlushStatus::kDrained);
+    assert(ReadExactly(clientFd, expected.size()) == expected);
+
+    output.PushChunkedHead(200, "application/json", true);
+    output.PushLastChunk();
+    status = output.Flush(serverFd);
+    assert(status == agri::OutboundQueue::FlushStatus::kDrained);
+    const std::string empty = ReadExactly(clientFd, 108);
+    assert(empty.size() == 108 && empty.compare(empty.size() - 5, 5, "0\r\n\r\n") == 0);
+
+    output.PushCloseDelimitedHead(200, "application/json");
+    output.PushChunk("{\"a\":");
+    output.PushChunk("1}");
+    output.PushLastChunk();
+    const std::string unframed =
+        "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\n\r\n{\"a\":1}";
+    assert(output.PendingBytes() == unframed.size());
+    status = output.Flush(serverFd);
+    assert(status == agri::OutboundQueue::FlushStatus::kDrained);
+    assert(ReadExactly(clientFd, unframed.size()) == unframed);
+
+    close(serverFd);
+    close(clientFd);
+}
+
+}
+
+int main() {
+    TestHeaderBlockRendering();
+    TestBatchedAndZeroCopyFlush();
+    TestChunkedFraming();
+    std::cout << "http response writer tests passed" << std::endl;
+    return 0;
+}
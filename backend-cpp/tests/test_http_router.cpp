@@ -0,0 +1,85 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "api/http_router.h"
+
+namespace {
+
+enum RouteId : std::size_t {
+    kHealth,
+    kIngest,
+    kDeviceLatest,
+    kDeviceSummary,
+    kTransaction,
+};
+
+agri::HttpRouter BuildRouter() {
+    agri::HttpRouter router;
+    router.Add("GET", "/health", kHealth);
+    router.Add("POST", "/api/v1/ingest", kIngest);
+    router.Add("GET", "/api/v1/devices/{deviceId}/latest", kDeviceLatest);
+    router.Add("GET", "/api/v1/devices/summary/latest", kDeviceSummary);
+    router.Add("GET", "/api/v1/transactions/{txHash}", kTransaction);
+    return router;
+}
+
+void TestMatchesLiteralAndParamRoutes() {
+    const agri::HttpRouter router = BuildRouter();
+    agri::RouteParams params;
+
+    assert(router.Match("GET", "/health", &params) == kHealth);
+    assert(router.Match("POST", "/api/v1/ingest", &params) == kIngest);
+
+    const std::string path = "/api/v1/devices/stm32-node-1/latest";
+    assert(router.Match("GET", path, &params) == kDeviceLatest);
+    assert(params.Get("deviceId") == "stm32-node-1");
+    assert(params.Get("deviceId").data() == path.data() + 16);
+
+    assert(router.Match("GET", "/api/v1/transactions/0xabc", &params) == kTransaction);
+    assert(params.Get("txHash") == "0xabc");
+}
+
+void TestPrefersLiteralSegmentsOverParams() {
+    const agri::HttpRouter router = BuildRouter();
+    agri::RouteParams params;
+
+    assert(router.Match("GET", "/api/v1/devices/summary/latest", &params) == kDeviceSummary);
+    assert(params.Size() == 0);
+}
+
+void TestRejectsUnknownRoutes() {
+    const agri::HttpRouter router = BuildRouter();
+    agri::RouteParams params;
+
+    assert(!router.Match("GET", "/api/v1/ingest", &params).has_value());
+    assert(!router.Match("GET", "/api/v1/devices//latest", &params).has_value());
+    assert(!router.Match("GET", "/api/v1/devices/a/latest/extra", &params).has_value());
+    assert(!router.Match("GET", "/health/", &params).has_value());
+    assert(!router.Match("DELETE", "/health", &params).has_value());
+}
+
+void TestParsesQueryParams() {
+    agri::QueryParams query;
+    query.Parse("deviceId=stm32-node-1&transport=lora&&flag&batchCode=BATCH%2D01+A");
+    assert(query.Size() == 4);
+    assert(query.Get("deviceId") == "stm32-node-1");
+    assert(query.Get("transport") == "lora");
+    assert(query.Get("flag").has_value() && query.Get("flag")->empty());
+    assert(!query.Get("missing").has_value());
+    assert(agri::QueryParams::Decode(*query.Get("batchCode")) == "BATCH-01 A");
+
+    query.Parse("");
+    assert(query.Size() == 0);
+}
+
+}
+
+int main() {
+    TestMatchesLiteralAndParamRoutes();
+    TestPrefersLiteralSegmentsOverParams();
+    TestRejectsUnknownRoutes();
+    TestParsesQueryParams();
+    std::cout << "test_http_router passed" << std::endl;
+    return 0;
+}
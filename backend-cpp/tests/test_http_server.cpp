@@ -0,0 +1,758 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api/http_server.h"
+#include "api/websocket_deflate.h"
+#include "api/websocket_frame.h"
+#include "blockchain/blockchain_client.h"
+#include "security/signature_verifier.h"
+#include "services/ingest_service.h"
+#include "storage/in_memory_telemetry_repository.h"
+
+namespace {
+
+std::uint16_t PickFreePort() {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    close(fd);
+    return ntohs(address.sin_port);
+}
+
+int Connect(std::uint16_t port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+void SendText(int fd, const std::string& text) {
+    std::size_t offset = 0;
+    while (offset < text.size()) {
+        const ssize_t sent = send(fd, text.data() + offset, text.size() - offset, MSG_NOSIGNAL);
+        assert(sent > 0);
+        offset += static_cast<std::size_t>(sent);
+    }
+}
+
+std::string ReadUntilClose(int fd) {
+    std::string out;
+    char buffer[4096];
+    while (true) {
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        out.append(buffer, static_cast<std::size_t>(received));
+    }
+    return out;
+}
+
+std::string ReadResponse(int fd, std::string* pending) {
+    char buffer[4096];
+    while (true) {
+        const std::size_t headerEnd = pending->find("\r\n\r\n");
+        if (headerEnd != std::string::npos) {
+            const std::size_t lengthPos = pending->find("Content-Length: ");
+            assert(lengthPos != std::string::npos && lengthPos < headerEnd);
+            const std::size_t contentLength = std::stoul(pending->substr(lengthPos + 16));
+            const std::size_t total = headerEnd + 4 + contentLength;
+            if (pending->size() >= total) {
+                std::string response = pending->substr(0, total);
+                pending->erase(0, total);
+                return response;
+            }
+        }
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return "";
+        }
+        pending->append(buffer, static_cast<std::size_t>(received));
+    }
+}
+
+int OpenWebSocket(std::uint16_t port,
+                  const std::string& target,
+                  const std::string& extraHeaders = "",
+                  std::string* handshakeOut = nullptr) {
+    const int fd = Connect(port);
+    assert(fd >= 0);
+    SendText(fd,
+             "GET " + target +
+                 " HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                 "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n" +
+                 extraHeaders + "\r\n");
+    std::string handshake;
+    char byte = 0;
+    while (handshake.find("\r\n\r\n") == std::string::npos && recv(fd, &byte, 1, 0) == 1) {
+        handshake.push_back(byte);
+    }
+    assert(handshake.rfind("HTTP/1.1 101 Switching Protocols\r\n", 0) == 0);
+    assert(handshake.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != std::string::npos);
+    if (handshakeOut != nullptr) {
+        *handshakeOut = handshake;
+    }
+    return fd;
+}
+
+std::string MaskedText(const std::string& payload) {
+    const char mask[4] = {'\x11', '\x22', '\x33', '\x44'};
+    std::string frame = {'\x81', static_cast<char>(0x80 | payload.size())};
+    frame.append(mask, sizeof(mask));
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    }
+    return frame;
+}
+
+void SaveBatchRecords(agri::InMemoryTelemetryRepository* repository, const std::string& batchCode, int count) {
+    agri::TelemetryPacket packet;
+    packet.deviceId = "stm32-node-7";
+    packet.telemetryJson = "{\"temperature\":21.5}";
+    packet.hashHex = "00";
+    packet.signature = "00";
+    packet.pubKeyId = "pk";
+    packet.transport = "lora";
+    packet.batchCode = batchCode;
+    for (int i = 0; i < count; ++i) {
+        packet.timestamp = 1700000000 + static_cast<std::uint64_t>(i);
+        repository->Save(packet);
+    }
+}
+
+agri::HttpIoBackend gIoBackend = agri::HttpIoBackend::kEpoll;
+
+agri::HttpServerConfig WithIoBackend(agri::HttpServerConfig config) {
+    config.ioBackend = gIoBackend;
+    return config;
+}
+
+struct ServerFixture {
+    agri::InMemoryTelemetryRepository repository;
+    agri::BasicSignatureVerifier verifier{agri::PublicKeyMap{}};
+    agri::MockBlockchainClient blockchain;
+    agri::IngestService ingestService{repository, verifier, blockchain};
+    std::uint16_t port{PickFreePort()};
+    agri::HttpServer server;
+    std::thread thread;
+
+    explicit ServerFixture(agri::HttpServerConfig config = {}, const agri::TelemetryRepository* reads = nullptr)
+        : server(port, ingestService, reads != nullptr ? *reads : repository, WithIoBackend(config)),
+          thread([this] { server.Start(); }) {}
+
+
+    ~ServerFixture() {
+        server.Stop();
+        thread.join();
+    }
+};
+
+// Read side that fails the way SQLite does under contention: device lookups throw, and batch traces return one
+// page before the cursor read throws.
+class FailingReadRepository final : public agri::TelemetryRepository {
+   public:
+    std::uint64_t Save(const agri::TelemetryPacketView&) override { return 0; }
+    std::vector<std::uint64_t> SaveBatch(const std::vector<agri::TelemetryPacketView>&) override { return {}; }
+    bool AttachReceipt(std::uint64_t, const agri::BlockchainReceipt&) override { return false; }
+    bool AttachReceiptBatch(const std::vector<std::uint64_t>&, const agri::BlockchainReceipt&) override {
+        return false;
+    }
+    bool Delete(std::uint64_t) override { return false; }
+    std::optional<agri::TelemetryRecord> LatestByDevice(const std::string&) const override {
+        throw std::runtime_error("database is locked");
+    }
+    std::optional<agri::TelemetryRecord> FindByTransaction(const std::string&) const override {
+        throw std::runtime_error("database is locked");
+    }
+    std::vector<agri::TelemetryRecord> FindByBatch(const std::string&) const override { return {}; }
+    void ReadBatchPage(
+        agri::TelemetryBatchCursor* cursor,
+        std::size_t,
+        std::vector<agri::TelemetryRecord>* page) const override {
+        if (cursor->started) {
+            throw std::runtime_error("database is locked");
+        }
+        cursor->started = true;
+        page->assign(1, agri::TelemetryRecord{});
+        page->front().recordId = 1;
+        page->front().packet.telemetryJson = "{}";
+    }
+    std::uint64_t Size() const override { return 0; }
+};
+
+void TestServesHealthWhileAnotherClientStalls() {
+    ServerFixture fixture;
+
+    const int stalled = Connect(fixture.port);
+    assert(stalled >= 0);
+    SendText(stalled, "POST /api/v1/ingest HTTP/1.1\r\nContent-Length: 100\r\n\r\n{\"device");
+
+    const int healthy = Connect(fixture.port);
+    assert(healthy >= 0);
+    SendText(healthy, "GET /health HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    const std::string response = ReadUntilClose(healthy);
+    assert(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    assert(response.find("{\"status\":\"ok\"}") != std::string::npos);
+
+    close(healthy);
+    close(stalled);
+}
+
+void TestRejectsMalformedRequest() {
+    ServerFixture fixture;
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(fd, "GARBAGE\r\n\r\n");
+    const std::string response = ReadUntilClose(fd);
+    assert(response.rfind("HTTP/1.1 400 Bad Request\r\n", 0) == 0);
+    close(fd);
+}
+
+void TestUnknownRouteReturnsNotFound() {
+    ServerFixture fixture;
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(fd, "GET /missing?x=1 HTTP/1.0\r\nHost: localhost\r\n\r\n");
+    const std::string response = ReadUntilClose(fd);
+    assert(response.rfind("HTTP/1.1 404 Not Found\r\n", 0) == 0);
+    close(fd);
+}
+
+bool FillUntil(int fd, std::string* pending, std::size_t size) {
+    char buffer[4096];
+    while (pending->size() < size) {
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        pending->append(buffer, static_cast<std::size_t>(received));
+    }
+    return true;
+}
+
+std::string ReadChunkedResponse(int fd, std::string* pending, std::string* body, std::size_t* chunks) {
+    std::size_t headerEnd = std::string::npos;
+    while ((headerEnd = pending->find("\r\n\r\n")) == std::string::npos) {
+        [[maybe_unused]] const bool filled = FillUntil(fd, pending, pending->size() + 1);
+        assert(filled);
+    }
+    const std::string head = pending->substr(0, headerEnd + 4);
+    assert(head.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+    pending->erase(0, headerEnd + 4);
+
+    body->clear();
+    *chunks = 0;
+    while (true) {
+        std::size_t lineEnd = std::string::npos;
+        while ((lineEnd = pending->find("\r\n")) == std::string::npos) {
+            [[maybe_unused]] const bool filled = FillUntil(fd, pending, pending->size() + 1);
+            assert(filled);
+        }
+        const std::size_t size = std::stoul(pending->substr(0, lineEnd), nullptr, 16);
+        [[maybe_unused]] const bool filled = FillUntil(fd, pending, lineEnd + 2 + size + 2);
+        assert(filled);
+        assert(pending->compare(lineEnd + 2 + size, 2, "\r\n") == 0);
+        body->append(*pending, lineEnd + 2, size);
+        pending->erase(0, lineEnd + 2 + size + 2);
+        if (size == 0) {
+            return head;
+        }
+        ++*chunks;
+    }
+}
+
+void TestKeepAliveServesPipelinedRequests() {
+    ServerFixture fixture;
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(
+        fd,
+        "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /api/v1/metrics/overview HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /missing HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    std::string pending;
+    const std::string first = ReadResponse(fd, &pending);
+    const std::string second = ReadResponse(fd, &pending);
+    const std::string third = ReadResponse(fd, &pending);
+    assert(first.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    assert(first.find("Connection: keep-alive\r\n") != std::string::npos);
+    assert(second.find("\"totalRequests\":0") != std::string::npos);
+    assert(second.find("\"keyOverflows\":0,") != std::string::npos);
+    assert(third.rfind("HTTP/1.1 404 Not Found\r\n", 0) == 0);
+    assert(third.find("route not found") != std::string::npos);
+
+    SendText(fd, "GET /api/v1/devices/stm32-unknown/latest HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    const std::string device = ReadResponse(fd, &pending);
+    assert(device.find("{\"error\":\"device not found\"}") != std::string::npos);
+
+    SendText(fd, "GET /health HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    const std::string last = ReadResponse(fd, &pending);
+    assert(last.find("Connection: close\r\n") != std::string::npos);
+    assert(ReadUntilClose(fd).empty());
+    close(fd);
+}
+
+void TestClosesAfterMaxRequestsPerConnection() {
+    agri::HttpServerConfig config;
+    config.maxRequestsPerConnection = 2;
+    ServerFixture fixture(config);
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(
+        fd,
+        "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    std::string pending;
+    const std::string first = ReadResponse(fd, &pending);
+    const std::string second = ReadResponse(fd, &pending);
+    assert(first.find("Connection: keep-alive\r\n") != std::string::npos);
+    assert(second.find("Connection: close\r\n") != std::string::npos);
+    assert(pending.empty());
+    assert(ReadUntilClose(fd).empty());
+    close(fd);
+}
+
+void TestClosesIdleConnections() {
+    agri::HttpServerConfig config;
+    config.idleTimeoutMs = 50;
+    ServerFixture fixture(config);
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    const auto begin = std::chrono::steady_clock::now();
+    assert(ReadUntilClose(fd).empty());
+    assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(5));
+    close(fd);
+}
+
+void TestClosesSlowPartialRequests() {
+    agri::HttpServerConfig config;
+    config.idleTimeoutMs = 60000;
+    config.readTimeoutMs = 100;
+    ServerFixture fixture(config);
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    const auto begin = std::chrono::steady_clock::now();
+    SendText(fd, "GET /health HTTP/1.1\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    SendText(fd, "Host: localhost\r\n");
+    assert(ReadUntilClose(fd).empty());
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    assert(elapsed >= std::chrono::milliseconds(100) && elapsed < std::chrono::seconds(5));
+    close(fd);
+
+    const int healthy = Connect(fixture.port);
+    SendText(healthy, "GET /health HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    assert(ReadUntilClose(healthy).rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    close(healthy);
+}
+
+}
+
+void TestAlertsWebSocketReceivesRejectedIngest() {
+    ServerFixture fixture;
+
+    const int ws = OpenWebSocket(fixture.port, "/ws/alerts?group=stm32-node");
+    const int other = OpenWebSocket(fixture.port, "/ws/alerts?deviceId=stm32-node-1");
+
+    const std::string body =
+        "{\"deviceId\":\"stm32-node-9\",\"timestamp\":1700001000,\"telemetry\":{\"temperature\":21.5},"
+        "\"hash\":\"" + std::string(64, '0') + "\",\"signature\":\"00\",\"pubKeyId\":\"missing\",\"transport\":\"lora\"}";
+    const int client = Connect(fixture.port);
+    assert(client >= 0);
+    SendText(client, "POST /api/v1/ingest HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\nContent-Length: " +
+                         std::to_string(body.size()) + "\r\n\r\n" + body);
+    assert(ReadUntilClose(client).rfind("HTTP/1.1 400 Bad Request\r\n", 0) == 0);
+    close(client);
+
+    unsigned char header[2] = {0, 0};
+    [[maybe_unused]] ssize_t received = recv(ws, header, 2, MSG_WAITALL);
+    assert(received == 2);
+    assert(header[0] == 0x81);
+    assert(header[1] < 126);
+    std::string payload(header[1], '\0');
+    received = recv(ws, payload.data(), payload.size(), MSG_WAITALL);
+    assert(received == static_cast<ssize_t>(payload.size()));
+    assert(payload.find("\"type\":\"ingest.rejected\"") != std::string::npos);
+    assert(payload.find("stm32-node-9") != std::string::npos);
+    close(ws);
+
+    char unexpected = 0;
+    assert(recv(other, &unexpected, 1, MSG_DONTWAIT) < 0 && errno == EAGAIN);
+    close(other);
+
+    const int rejected = Connect(fixture.port);
+    SendText(rejected,
+             "GET /ws/telemetry?room=7 HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n");
+    assert(ReadUntilClose(rejected).rfind("HTTP/1.1 400 Bad Request\r\n", 0) == 0);
+    close(rejected);
+}
+
+void TestIngestBatchReportsPerPacketResults() {
+    agri::HttpServerConfig config;
+    config.ingestMaxBatchPackets = 2;
+    ServerFixture fixture(config);
+
+    const std::string packet =
+        "{\"deviceId\":\"stm32-node-9\",\"timestamp\":1700001000,\"telemetry\":{\"temperature\":21.5},"
+        "\"hash\":\"00\",\"signature\":\"00\",\"pubKeyId\":\"missing\",\"transport\":\"lora\"}";
+    const auto post = [&](const std::string& body) {
+        const int client = Connect(fixture.port);
+        assert(client >= 0);
+        SendText(client, "POST /api/v1/ingest/batch HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n"
+                         "Content-Type: application/x-ndjson\r\nContent-Length: " +
+                             std::to_string(body.size()) + "\r\n\r\n" + body);
+        const std::string response = ReadUntilClose(client);
+        close(client);
+        return response;
+    };
+
+    const std::string response = post(packet + "\n{\"timestamp\":1}\n");
+    assert(response.rfind("HTTP/1.1 400 Bad Request\r\n", 0) == 0);
+    assert(response.find("\"accepted\":0,\"rejected\":2") != std::string::npos);
+    assert(response.find("{\"index\":0,\"accepted\":false,\"message\":\"hash must be 64 characters\"") !=
+           std::string::npos);
+    assert(response.find("{\"index\":1,\"accepted\":false,\"message\":\"missing deviceId\"") != std::string::npos);
+
+    assert(post("[" + packet + "," + packet + "," + packet + "]").rfind("HTTP/1.1 413 Payload Too Large\r\n", 0) == 0);
+    assert(post("[" + packet).find("{\"error\":\"unterminated batch array\"}") != std::string::npos);
+}
+
+void TestIngestDecodesCborPackets() {
+    ServerFixture fixture;
+
+    std::string packet("\xA5\x00\x66stm32a\x01\x1A\x65\x53\xF1\x00\x02\x62{}\x03\x58\x20", 22);
+    packet += std::string(32, '\x11');
+    packet += std::string("\x04\x42\x30\x00", 4);
+    const auto post = [&](const std::string& path, const std::string& contentType, const std::string& body) {
+        const int client = Connect(fixture.port);
+        assert(client >= 0);
+        SendText(client, "POST " + path + " HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\nContent-Type: " +
+                             contentType + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+        const std::string response = ReadUntilClose(client);
+        close(client);
+        return response;
+    };
+
+    const std::string single = post("/api/v1/ingest", "application/cbor", packet);
+    assert(single.rfind("HTTP/1.1 400 Bad Request\r\n", 0) == 0);
+    assert(single.find("\"message\":\"hash mismatch with payload\"") != std::string::npos);
+
+    const std::string batch = post("/api/v1/ingest/batch", "application/cbor-seq", packet + "\xA0");
+    assert(batch.find("{\"index\":0,\"accepted\":false,\"message\":\"hash mismatch with payload\"") != std::string::npos);
+    assert(batch.find("{\"index\":1,\"accepted\":false,\"message\":\"missing deviceId\"") != std::string::npos);
+    assert(post("/api/v1/ingest/batch", "application/cbor-seq", packet + packet.substr(0, 3))
+               .find("{\"error\":\"malformed CBOR sequence at item 1\"}") != std::string::npos);
+}
+
+void TestShedsIngestWhenQueueIsFull() {
+    agri::HttpServerConfig config;
+    config.workerThreads = 1;
+    config.ingestMaxInFlight = 1;
+    config.ingestMaxQueued = 0;
+    config.ingestRetryAfterSeconds = 7;
+    ServerFixture fixture(config);
+
+    const std::string body =
+        "{\"deviceId\":\"stm32-node-9\",\"timestamp\":1700001000,\"telemetry\":{\"temperature\":21.5},"
+        "\"hash\":\"00\",\"signature\":\"00\",\"pubKeyId\":\"missing\",\"transport\":\"lora\"}";
+    const std::string request = "POST /api/v1/ingest HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n"
+                                "X-Gateway-Id: gw-1\r\nContent-Length: " +
+                                std::to_string(body.size()) + "\r\n\r\n" + body;
+
+    std::vector<int> clients;
+    for (int i = 0; i < 24; ++i) {
+        const int fd = Connect(fixture.port);
+        assert(fd >= 0);
+        clients.push_back(fd);
+    }
+    for (const int fd : clients) {
+        SendText(fd, request);
+    }
+
+    std::size_t shed = 0;
+    for (const int fd : clients) {
+        const std::string response = ReadUntilClose(fd);
+        if (response.rfind("HTTP/1.1 503 Service Unavailable\r\n", 0) == 0) {
+            assert(response.find("Retry-After: 7\r\n") != std::string::npos);
+            assert(response.find("{\"error\":\"ingest queue full\"}") != std::string::npos);
+            ++shed;
+        } else {
+            assert(response.rfind("HTTP/1.1 400 Bad Request\r\n", 0) == 0);
+        }
+        close(fd);
+    }
+
+    const int metrics = Connect(fixture.port);
+    SendText(metrics, "GET /api/v1/metrics/overview HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    const std::string overview = ReadUntilClose(metrics);
+    close(metrics);
+    assert(overview.find("\"admission\":{\"inFlight\":0,\"maxInFlight\":1,\"queued\":0,\"maxQueued\":0,") !=
+           std::string::npos);
+    assert(overview.find("\"shedOverloaded\":" + std::to_string(shed) + ",") != std::string::npos);
+    assert(overview.find("\"admitted\":" + std::to_string(clients.size() - shed) + ",") != std::string::npos);
+}
+
+void TestShardedReactorsShareOnePort() {
+    agri::HttpServerConfig config;
+    config.reactorThreads = 3;
+    ServerFixture fixture(config);
+
+    std::vector<int> clients;
+    for (int i = 0; i < 12; ++i) {
+        const int fd = Connect(fixture.port);
+        assert(fd >= 0);
+        SendText(fd, "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        clients.push_back(fd);
+    }
+    for (const int fd : clients) {
+        std::string pending;
+        assert(ReadResponse(fd, &pending).find("{\"status\":\"ok\"}") != std::string::npos);
+        SendText(fd, "GET /api/v1/metrics/overview HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+        assert(ReadResponse(fd, &pending).find("\"totalRequests\":0") != std::string::npos);
+        assert(ReadUntilClose(fd).empty());
+        close(fd);
+    }
+}
+
+void TestStreamsLargeBatchTrace() {
+    ServerFixture fixture;
+
+    SaveBatchRecords(&fixture.repository, "LOT-BIG", 1000);
+    SaveBatchRecords(&fixture.repository, "LOT-SMALL", 1);
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(fd,
+             "GET /api/v1/batches/LOT-BIG/trace HTTP/1.1\r\nHost: localhost\r\n\r\n"
+             "GET /api/v1/batches/LOT-SMALL/trace HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    std::string pending;
+    std::string body;
+    std::size_t chunks = 0;
+    const std::string head = ReadChunkedResponse(fd, &pending, &body, &chunks);
+    assert(head.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    assert(head.find("Content-Length") == std::string::npos);
+    assert(chunks > 1);
+    assert(body.rfind("{\"batchCode\":\"LOT-BIG\",\"records\":[{\"recordId\":1,", 0) == 0);
+    assert(body.find("\"recordId\":1000,") != std::string::npos);
+    assert(body.size() > 20 && body.compare(body.size() - 16, 16, "}],\"count\":1000}") == 0);
+
+    const std::string small = ReadResponse(fd, &pending);
+    assert(small.find("Content-Length: ") != std::string::npos);
+    assert(small.find("\"records\":[{\"recordId\":1001,") != std::string::npos);
+    assert(small.find("],\"count\":1}") != std::string::npos);
+
+    SendText(fd, "GET /api/v1/batches/LOT-NONE/trace HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    const std::string empty = ReadResponse(fd, &pending);
+    assert(empty.find("{\"batchCode\":\"LOT-NONE\",\"records\":[],\"count\":0}") != std::string::npos);
+    close(fd);
+}
+
+void TestStreamsCloseDelimitedTraceToHttp10() {
+    ServerFixture fixture;
+    SaveBatchRecords(&fixture.repository, "LOT-OLD", 300);
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(fd, "GET /api/v1/batches/LOT-OLD/trace HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+    const std::string response = ReadUntilClose(fd);
+    const std::size_t headerEnd = response.find("\r\n\r\n");
+    assert(headerEnd != std::string::npos);
+    const std::string head = response.substr(0, headerEnd + 4);
+    const std::string body = response.substr(headerEnd + 4);
+    assert(head.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    assert(head.find("Transfer-Encoding") == std::string::npos);
+    assert(head.find("Content-Length") == std::string::npos);
+    assert(head.find("Connection: close\r\n") != std::string::npos);
+    assert(body.rfind("{\"batchCode\":\"LOT-OLD\",\"records\":[{\"recordId\":1,", 0) == 0);
+    assert(body.find("\"recordId\":300,") != std::string::npos);
+    assert(body.size() > 20 && body.compare(body.size() - 15, 15, "}],\"count\":300}") == 0);
+    close(fd);
+}
+
+void TestWebSocketNegotiatesPerMessageDeflate() {
+    ServerFixture fixture;
+
+    std::string handshake;
+    const int plain = OpenWebSocket(fixture.port, "/ws/telemetry", "", &handshake);
+    assert(handshake.find("Sec-WebSocket-Extensions") == std::string::npos);
+    close(plain);
+
+    const int deflate = OpenWebSocket(fixture.port, "/ws/telemetry",
+                                      "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n",
+                                      &handshake);
+    assert((handshake.find("Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover") !=
+            std::string::npos) == agri::PerMessageDeflateAvailable());
+    close(deflate);
+}
+
+void TestHandlerFailuresStillAnswer() {
+    const FailingReadRepository failing;
+    ServerFixture fixture({}, &failing);
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(fd, "GET /api/v1/devices/stm32-node-1/latest HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    std::string pending;
+    const std::string failed = ReadResponse(fd, &pending);
+    assert(failed.rfind("HTTP/1.1 500 Internal Server Error\r\n", 0) == 0);
+    assert(failed.find("{\"error\":\"internal server error\"}") != std::string::npos);
+
+    SendText(fd, "GET /health HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    assert(ReadResponse(fd, &pending).rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    close(fd);
+
+    const int stream = Connect(fixture.port);
+    assert(stream >= 0);
+    SendText(stream, "GET /api/v1/batches/LOT-1/trace HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    const std::string truncated = ReadUntilClose(stream);
+    assert(truncated.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    assert(truncated.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+    assert(truncated.find("\r\n0\r\n\r\n") == std::string::npos);
+    close(stream);
+}
+
+void TestUpgradeAfterPipelinedRequestKeepsLeftoverFrames() {
+    ServerFixture fixture;
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(fd,
+             "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n"
+             "GET /ws/telemetry HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n" +
+                 MaskedText("{\"type\":\"subscribe\",\"deviceId\":[\"node-2\"]}"));
+
+    std::string pending;
+    assert(ReadResponse(fd, &pending).rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    const std::string subscribed = agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kText, "{\"type\":\"subscribed\"}");
+    std::size_t handshakeEnd = std::string::npos;
+    while ((handshakeEnd = pending.find("\r\n\r\n")) == std::string::npos ||
+           pending.size() < handshakeEnd + 4 + subscribed.size()) {
+        [[maybe_unused]] const bool filled = FillUntil(fd, &pending, pending.size() + 1);
+        assert(filled);
+    }
+    assert(pending.rfind("HTTP/1.1 101 Switching Protocols\r\n", 0) == 0);
+    assert(pending.compare(handshakeEnd + 4, std::string::npos, subscribed) == 0);
+    close(fd);
+}
+
+void TestUpgradeDoesNotBlockReactorOnSlowReader() {
+    ServerFixture fixture;
+    SaveBatchRecords(&fixture.repository, "LOT-SLOW", 20000);
+
+    const int slow = socket(AF_INET, SOCK_STREAM, 0);
+    const int receiveBuffer = 4096;
+    setsockopt(slow, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(fixture.port);
+    [[maybe_unused]] const int connected = connect(slow, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    assert(connected == 0);
+    SendText(slow,
+             "GET /api/v1/batches/LOT-SLOW/trace HTTP/1.1\r\nHost: localhost\r\n\r\n"
+             "GET /ws/telemetry HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const int healthy = Connect(fixture.port);
+    assert(healthy >= 0);
+    const timeval timeout{5, 0};
+    setsockopt(healthy, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    SendText(healthy, "GET /health HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    assert(ReadUntilClose(healthy).rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    close(healthy);
+    close(slow);
+}
+
+void TestZeroCopyResponseSurvivesConnectionClose() {
+    agri::HttpServerConfig config;
+    config.zeroCopyThresholdBytes = 4096;
+    ServerFixture fixture(config);
+    SaveBatchRecords(&fixture.repository, "LOT-ZC", 1000);
+
+    const int fd = Connect(fixture.port);
+    assert(fd >= 0);
+    SendText(fd, "GET /api/v1/batches/LOT-ZC/trace HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    std::string pending;
+    std::string body;
+    std::size_t chunks = 0;
+    const std::string head = ReadChunkedResponse(fd, &pending, &body, &chunks);
+    assert(head.find("Connection: close\r\n") != std::string::npos);
+    assert(body.rfind("{\"batchCode\":\"LOT-ZC\",\"records\":[{\"recordId\":1,", 0) == 0);
+    assert(body.size() > 20 && body.compare(body.size() - 16, 16, "}],\"count\":1000}") == 0);
+    assert(ReadUntilClose(fd).empty());
+    close(fd);
+}
+
+void RunAll() {
+    TestServesHealthWhileAnotherClientStalls();
+    TestRejectsMalformedRequest();
+    TestUnknownRouteReturnsNotFound();
+    TestKeepAliveServesPipelinedRequests();
+    TestClosesAfterMaxRequestsPerConnection();
+    TestClosesIdleConnections();
+    TestClosesSlowPartialRequests();
+    TestAlertsWebSocketReceivesRejectedIngest();
+    TestIngestBatchReportsPerPacketResults();
+    TestIngestDecodesCborPackets();
+    TestShedsIngestWhenQueueIsFull();
+    TestShardedReactorsShareOnePort();
+    TestStreamsLargeBatchTrace();
+    TestStreamsCloseDelimitedTraceToHttp10();
+    TestWebSocketNegotiatesPerMessageDeflate();
+    TestHandlerFailuresStillAnswer();
+    TestUpgradeAfterPipelinedRequestKeepsLeftoverFrames();
+    TestUpgradeDoesNotBlockReactorOnSlowReader();
+    TestZeroCopyResponseSurvivesConnectionClose();
+}
+
+int main() {
+    RunAll();
+    if (agri::HttpServer::IoUringAvailable()) {
+        gIoBackend = agri::HttpIoBackend::kIoUring;
+        RunAll();
+    }
+    std::cout << "test_http_server passed" << std::endl;
+    return 0;
+}
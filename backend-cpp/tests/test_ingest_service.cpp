@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cctype>
 #include <iostream>
 #include <stdexcept>
 #include <string>
@@ -22,6 +23,7 @@
 #include "storage/in_memory_telemetry_repository.h"
 #include "storage/telemetry_repository.h"
 #include "utils/hash_utils.h"
+#include "utils/work_stealing_pool.h"
 
 namespace {
 
@@ -114,10 +116,10 @@ agri::PublicKeyMap BuildPublicKeys() {
     return keys;
 }
 
-agri::TelemetryPacket MakeValidPacket() {
+agri::TelemetryPacket MakeValidPacket(std::uint64_t sequence = 0) {
     agri::TelemetryPacket packet;
-    packet.deviceId = "stm32-node-1";
-    packet.timestamp = 1700001000;
+    packet.deviceId = "stm32-node-" + std::to_string(sequence % 4 + 1);
+    packet.timestamp = 1700001000 + sequence;
     packet.telemetryJson = "{\"temperature\":24.5,\"humidity\":62.3}";
     packet.pubKeyId = "pubkey-1";
     packet.transport = "wifi";
@@ -137,20 +139,43 @@ class ThrowingBlockchainClient final : public agri::BlockchainClient {
     }
 };
 
+class ThrowingVerifier final : public agri::SignatureVerifier {
+   public:
+    bool Verify(const agri::TelemetryPacketView& packet) const override {
+        if (packet.timestamp % 7 == 3) {
+            throw std::runtime_error("key store unavailable");
+        }
+        return true;
+    }
+};
+
 class AttachReceiptFailingRepository final : public agri::TelemetryRepository {
    public:
     explicit AttachReceiptFailingRepository(bool throwOnDelete)
         : throwOnDelete_(throwOnDelete) {}
 
-    std::uint64_t Save(const agri::TelemetryPacket&) override {
+    std::uint64_t Save(const agri::TelemetryPacketView&) override {
         hasRecord_ = true;
         return 1;
     }
 
+    std::vector<std::uint64_t> SaveBatch(const std::vector<agri::TelemetryPacketView>& packets) override {
+        hasRecord_ = !packets.empty();
+        std::vector<std::uint64_t> recordIds;
+        for (std::size_t i = 0; i < packets.size(); ++i) {
+            recordIds.push_back(i + 1);
+        }
+        return recordIds;
+    }
+
     bool AttachReceipt(std::uint64_t, const agri::BlockchainReceipt&) override {
         return false;
     }
 
+    bool AttachReceiptBatch(const std::vector<std::uint64_t>&, const agri::BlockchainReceipt&) override {
+        return false;
+    }
+
     bool Delete(std::uint64_t) override {
         deleteCalled_ = true;
         if (throwOnDelete_) {
@@ -172,6 +197,13 @@ class AttachReceiptFailingRepository final : public agri::TelemetryRepository {
         return {};
     }
 
+    void ReadBatchPage(agri::TelemetryBatchCursor* cursor,
+                       std::size_t,
+                       std::vector<agri::TelemetryRecord>* page) const override {
+        page->clear();
+        cursor->exhausted = true;
+    }
+
     std::uint64_t Size() const override {
         return hasRecord_ ? 1 : 0;
     }
@@ -222,6 +254,22 @@ void TestRejectsHashMismatch() {
     assert(metrics.rejectedRequests == 1);
 }
 
+void TestRejectsFieldsOutsideSchemaLengths() {
+    agri::InMemoryTelemetryRepository repository;
+    agri::BasicSignatureVerifier verifier(BuildPublicKeys());
+    agri::MockBlockchainClient blockchain;
+    agri::IngestService service(repository, verifier, blockchain);
+
+    agri::TelemetryPacket packet = MakeValidPacket();
+    packet.deviceId.clear();
+    assert(service.Ingest(packet).message == "deviceId must not be empty");
+
+    packet = MakeValidPacket();
+    packet.hashHex.pop_back();
+    assert(service.Ingest(packet).message == "hash must be 64 characters");
+    assert(repository.Size() == 0);
+}
+
 void TestRejectsInvalidSignature() {
     agri::InMemoryTelemetryRepository repository;
     agri::BasicSignatureVerifier verifier(BuildPublicKeys());
@@ -275,15 +323,135 @@ void TestRollbackFailureDoesNotMaskBlockchainError() {
     assert(repository.deleteCalled());
 }
 
+void TestIngestsBatchUnderOneAnchor() {
+    agri::InMemoryTelemetryRepository repository;
+    agri::BasicSignatureVerifier verifier(BuildPublicKeys());
+    agri::MockBlockchainClient blockchain;
+    agri::IngestService service(repository, verifier, blockchain);
+    agri::WorkStealingPool pool(2);
+
+    std::vector<agri::TelemetryPacket> packets;
+    for (std::uint64_t i = 0; i < 20; ++i) {
+        packets.push_back(MakeValidPacket(i));
+    }
+    packets[3].hashHex = agri::Sha256Hex("tampered");
+    packets[7].signature += "00";
+
+    const agri::BatchIngestResult batch =
+        service.IngestBatch(std::vector<agri::TelemetryPacketView>(packets.begin(), packets.end()), &pool);
+    assert(batch.results.size() == 20);
+    assert(batch.acceptedCount == 18);
+    assert(batch.receipt.has_value());
+    assert(batch.results[3].message == "hash mismatch with payload");
+    assert(batch.results[7].message == "signature verification failed");
+
+    std::vector<std::string> leaves;
+    for (std::size_t i = 0; i < packets.size(); ++i) {
+        if (i == 3 || i == 7) {
+            assert(!batch.results[i].accepted);
+            continue;
+        }
+        assert(batch.results[i].accepted);
+        assert(batch.results[i].receipt->txHash == batch.receipt->txHash);
+        leaves.push_back(packets[i].hashHex);
+    }
+    assert(batch.merkleRoot == agri::MerkleRootHex(leaves));
+    assert(repository.Size() == 18);
+    assert(repository.FindByTransaction(batch.receipt->txHash)->recordId == batch.results[0].recordId);
+
+    const agri::MetricsSnapshot metrics = service.GetMetricsSnapshot();
+    assert(metrics.totalRequests == 20);
+    assert(metrics.acceptedRequests == 18);
+    assert(metrics.rejectedRequests == 2);
+}
+
+void TestRollsBackBatchOnBlockchainFailure() {
+    agri::InMemoryTelemetryRepository repository;
+    agri::BasicSignatureVerifier verifier(BuildPublicKeys());
+    ThrowingBlockchainClient blockchain;
+    agri::IngestService service(repository, verifier, blockchain);
+
+    const agri::BatchIngestResult batch = service.IngestBatch({MakeValidPacket(0), MakeValidPacket(1)});
+    assert(batch.acceptedCount == 0);
+    assert(!batch.receipt.has_value());
+    assert(batch.results[0].message == "batch anchoring failed: simulated blockchain outage");
+    assert(repository.Size() == 0);
+}
+
+void TestBatchSurfacesVerifierExceptions() {
+    agri::InMemoryTelemetryRepository repository;
+    ThrowingVerifier verifier;
+    agri::MockBlockchainClient blockchain;
+    agri::IngestService service(repository, verifier, blockchain);
+    agri::WorkStealingPool pool(3);
+
+    std::vector<agri::TelemetryPacket> packets;
+    for (std::uint64_t i = 0; i < 64; ++i) {
+        packets.push_back(MakeValidPacket(i));
+    }
+    const std::vector<agri::TelemetryPacketView> views(packets.begin(), packets.end());
+    for (int round = 0; round < 50; ++round) {
+        std::string error;
+        try {
+            service.IngestBatch(views, &pool);
+        } catch (const std::runtime_error& ex) {
+            error = ex.what();
+        }
+        assert(error == "key store unavailable");
+    }
+    pool.WaitIdle();
+    assert(pool.FailedTaskCount() == 0);
+    assert(repository.Size() == 0);
+
+    const agri::BatchIngestResult batch = service.IngestBatch({packets[0], packets[1]}, &pool);
+    assert(batch.acceptedCount == 2);
+}
+
+void TestMerkleRootPairsLeaves() {
+    const std::string a = agri::Sha256Hex("a");
+    const std::string b = agri::Sha256Hex("b");
+    const std::string c = agri::Sha256Hex("c");
+    assert(agri::MerkleRootHex({a}) == a);
+    assert(agri::MerkleRootHex({a, b}) == agri::Sha256Hex(a + b));
+    assert(agri::MerkleRootHex({a, b, c}) == agri::Sha256Hex(agri::Sha256Hex(a + b) + c));
+}
+
+void TestStreamsSha256Pieces() {
+    const std::string canonical = "stm32-node-1|1700001000|{\"t\":1}";
+    agri::Sha256Digest expected;
+    assert(agri::DecodeSha256Hex(agri::Sha256Hex(canonical), &expected));
+    assert(agri::Sha256({"stm32-node-1", "|", "1700001000", "|", "{\"t\":1}"}) == expected);
+    assert(agri::Sha256({canonical}) == agri::Sha256({"", canonical, ""}));
+    assert(agri::Sha256({"a"}) != agri::Sha256({"b"}));
+#if AGRI_TEST_OPENSSL_ENABLED
+    assert(agri::Sha256Hex("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+#endif
+
+    agri::Sha256Digest decoded;
+    std::string upper = agri::Sha256Hex("abc");
+    for (char& c : upper) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    assert(agri::DecodeSha256Hex(upper, &decoded) && decoded == agri::Sha256({"abc"}));
+    assert(!agri::DecodeSha256Hex(upper.substr(1), &decoded));
+    assert(!agri::DecodeSha256Hex(std::string(63, 'a') + "g", &decoded));
+}
+
 }
 
 int main() {
     TestAcceptsValidPacket();
     TestRejectsHashMismatch();
+    TestRejectsFieldsOutsideSchemaLengths();
     TestRejectsInvalidSignature();
     TestRollsBackStorageOnBlockchainFailure();
     TestRollbackOnAttachReceiptFailure();
     TestRollbackFailureDoesNotMaskBlockchainError();
+    TestIngestsBatchUnderOneAnchor();
+    TestRollsBackBatchOnBlockchainFailure();
+    TestBatchSurfacesVerifierExceptions();
+    TestMerkleRootPairsLeaves();
+    TestStreamsSha256Pieces();
     std::cout << "test_ingest_service passed" << std::endl;
     return 0;
 }
@@ -1,8 +1,13 @@
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
 
 #include "transport/json_parser.h"
+#include "transport/telemetry_schema.h"
 
 namespace {
 
@@ -27,6 +32,13 @@ void TestParsesValidPayload() {
     assert(parsed.packet.pubKeyId == "pubkey-1");
     assert(parsed.packet.transport == "wifi");
     assert(parsed.packet.batchCode == "BATCH-2026-0001");
+    assert(parsed.decoded == nullptr);
+    assert(parsed.packet.deviceId.data() == payload.data() + payload.find("stm32-node-1"));
+    assert(parsed.packet.telemetryJson.data() == payload.data() + payload.find("{\"temperature\""));
+
+    const agri::TelemetryPacket record = parsed.packet.Materialize();
+    assert(record.deviceId == "stm32-node-1" && record.batchCode == "BATCH-2026-0001");
+    assert(agri::TelemetryPacketView(record).telemetryJson.data() == record.telemetryJson.data());
 }
 
 void TestRejectsMissingTelemetry() {
@@ -43,11 +55,175 @@ void TestRejectsMissingTelemetry() {
     assert(parsed.error == "missing telemetry object");
 }
 
+void TestHandlesEscapesAndNestedKeys() {
+    const std::string payload =
+        "{ \"telemetry\" : {\"deviceId\":\"inner\",\"note\":\"a \\\"}\\\" b\",\"timestamp\":5,\"list\":[{},[]]},"
+        "\"vendor\":{\"hash\":\"nested\"},"
+        "\"deviceId\":\"node \\\"7\\\" \\u00e9\\ud83c\\udf31\\/x\","
+        "\"timestamp\":1700001000,"
+        "\"hash\":\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\","
+        "\"signature\":\"bb\",\"batchCode\":null,\"deviceId\":\"second\" }\n";
+
+    std::vector<agri::ParseTelemetryResult> results;
+    results.push_back(agri::ParseTelemetryPacketJson(payload));
+    results.reserve(16);
+    const agri::ParseTelemetryResult& parsed = results.front();
+    assert(parsed.ok);
+    assert(parsed.decoded != nullptr && parsed.packet.deviceId.data() == parsed.decoded->deviceId.data());
+    assert(parsed.packet.hashHex.data() == payload.data() + payload.find(std::string(64, 'a')));
+    assert(parsed.packet.deviceId == "node \"7\" \xC3\xA9\xF0\x9F\x8C\xB1/x");
+    assert(parsed.packet.timestamp == 1700001000);
+    assert(parsed.packet.telemetryJson ==
+           "{\"deviceId\":\"inner\",\"note\":\"a \\\"}\\\" b\",\"timestamp\":5,\"list\":[{},[]]}");
+    assert(parsed.packet.hashHex == std::string(64, 'a'));
+    assert(parsed.packet.pubKeyId == "default-pubkey");
+    assert(parsed.packet.transport == "wifi");
+    assert(parsed.packet.batchCode.empty());
+}
+
+void TestRejectsMalformedPayloads() {
+    const std::string tail =
+        "\"telemetry\":{},\"hash\":\"" + std::string(64, 'a') + "\",\"signature\":\"bb\"}";
+    assert(agri::ParseTelemetryPacketJson("{\"deviceId\":\"n\",\"timestamp\":1.5," + tail).error == "missing timestamp");
+    assert(agri::ParseTelemetryPacketJson("{\"deviceId\":\"n\",\"timestamp\":-1," + tail).error == "missing timestamp");
+    assert(agri::ParseTelemetryPacketJson("{\"deviceId\":7,\"timestamp\":1," + tail).error == "missing deviceId");
+    assert(agri::ParseTelemetryPacketJson("{\"deviceId\":\"n\",\"timestamp\":1," + tail).ok);
+    assert(agri::ParseTelemetryPacketJson("{\"deviceId\":\"\",\"timestamp\":1," + tail).error ==
+           "deviceId must not be empty");
+    assert(agri::ParseTelemetryPacketJson(
+               "{\"deviceId\":\"n\",\"timestamp\":1,\"telemetry\":{},\"hash\":\"aa\",\"signature\":\"bb\"}")
+               .error == "hash must be 64 characters");
+
+    for (const std::string& broken :
+         {std::string("{\"deviceId\":\"n\",\"timestamp\":1," + tail + "x"),
+          std::string("{\"deviceId\":\"n\" \"timestamp\":1," + tail),
+          std::string("{\"deviceId\":\"n\\q\",\"timestamp\":1," + tail),
+          std::string("{\"deviceId\":\"\\ud800\",\"timestamp\":1," + tail),
+          std::string("{\"deviceId\":\"n\",\"timestamp\":01," + tail),
+          std::string("{\"deviceId\":\"n\",\"timestamp\":1,\"telemetry\":{\"a\":tru}}"),
+          std::string("{\"deviceId\":\"n\",\"timestamp\":1,\"telemetry\":{\"a\":1,}}"),
+          std::string("{\"deviceId\":\"n\",\"timestamp\":1"),
+          std::string(200, '[')}) {
+        assert(agri::ParseTelemetryPacketJson(broken).error == "malformed JSON packet");
+    }
+
+    std::string deep = "{\"deviceId\":\"n\",\"timestamp\":1,\"telemetry\":";
+    for (int i = 0; i < 100; ++i) {
+        deep += "{\"a\":";
+    }
+    deep += "1" + std::string(100, '}') + "}";
+    assert(agri::ParseTelemetryPacketJson(deep).error == "malformed JSON packet");
+}
+
+void TestAppliesGeneratedSchema() {
+    static_assert(agri::ClassifyTelemetryField("deviceId") == agri::TelemetryField::kDeviceId);
+    static_assert(agri::ClassifyTelemetryField("batchCode") == agri::TelemetryField::kBatchCode);
+    static_assert(agri::ClassifyTelemetryField("transport") == agri::TelemetryField::kTransport);
+    static_assert(agri::ClassifyTelemetryField("transpork") == agri::TelemetryField::kUnknown);
+    static_assert(agri::ClassifyTelemetryField("") == agri::TelemetryField::kUnknown);
+    static_assert(agri::TelemetryEnumAllows(agri::TelemetryField::kTransport, "lora"));
+    static_assert(!agri::TelemetryEnumAllows(agri::TelemetryField::kTransport, "zigbee"));
+    for (std::size_t i = 0; i < agri::kTelemetryFieldCount; ++i) {
+        const agri::TelemetryField field = static_cast<agri::TelemetryField>(i);
+        assert(agri::ClassifyTelemetryField(agri::kTelemetryFields[i].name) == field);
+    }
+
+    const std::string head = "{\"deviceId\":\"n\",\"timestamp\":1,\"telemetry\":{},\"hash\":\"" + std::string(64, 'a') +
+                             "\",\"signature\":\"bb\"";
+    const agri::ParseTelemetryResult defaulted = agri::ParseTelemetryPacketJson(head + "}");
+    assert(defaulted.ok && defaulted.packet.pubKeyId == "default-pubkey" && defaulted.packet.transport == "wifi");
+    assert(defaulted.packet.batchCode.empty());
+    assert(agri::ParseTelemetryPacketJson(head + ",\"transport\":\"lora\"}").packet.transport == "lora");
+    assert(agri::ParseTelemetryPacketJson(head + ",\"transport\":\"zigbee\"}").error == "invalid transport");
+}
+
+agri::TelemetryMetric Metric(std::string_view key, agri::TelemetryValue value) {
+    agri::TelemetryMetric metric;
+    assert(agri::TelemetryKeyTable().Find(key, &metric.keyId));
+    metric.value = value;
+    return metric;
+}
+
+void TestDecodesTypedMetrics() {
+    const std::string payload =
+        "{\"deviceId\":\"n\",\"timestamp\":1,\"hash\":\"" + std::string(64, 'a') + "\",\"signature\":\"bb\",\"telemetry\":"
+        "{\"temperature\":-24.5e0,\"pump\":true,\"status\":\"dry\",\"gps\":{\"lat\":1},"
+        "\"levels\":[1,2],\"note\":null,\"soil\\u0020ph\":6,\"log\":\"" + std::string(80, 'x') + "\",\"valve\":false}}";
+
+    const agri::ParseTelemetryResult parsed = agri::ParseTelemetryPacketJson(payload);
+    assert(parsed.ok);
+    std::uint32_t dry = 0;
+    assert(agri::TelemetryValueTable().Find("dry", &dry));
+    const std::vector<agri::TelemetryMetric> expected{
+        Metric("temperature", -24.5),
+        Metric("pump", true),
+        Metric("status", agri::TelemetryStringId{dry}),
+        Metric("soil ph", 6.0),
+        Metric("valve", false)};
+    assert(std::vector<agri::TelemetryMetric>(parsed.packet.metrics.begin(), parsed.packet.metrics.end()) == expected);
+    assert(agri::TelemetryKeyTable().Lookup(parsed.packet.metrics[1].keyId) == "pump");
+    assert(parsed.packet.Materialize().metrics == expected);
+
+    std::vector<agri::TelemetryMetric> metrics;
+    assert(agri::DecodeTelemetryMetrics(parsed.packet.telemetryJson, &metrics) && metrics == expected);
+    assert(agri::DecodeTelemetryMetrics(" {} ", &metrics) && metrics.empty());
+    assert(!agri::DecodeTelemetryMetrics("[1]", &metrics));
+    assert(!agri::DecodeTelemetryMetrics("{\"a\":1} {}", &metrics));
+    assert(!agri::DecodeTelemetryMetrics("{\"a\":01}", &metrics));
+}
+
+void TestBoundsInternedStringValues() {
+    std::uint32_t dry = 0;
+    assert(!agri::TelemetryKeyTable().Find("dry", &dry));
+    assert(agri::TelemetryValueTable().Find("dry", &dry));
+
+    std::vector<agri::TelemetryMetric> metrics;
+    const std::string exact(32, 'v');
+    assert(agri::DecodeTelemetryMetrics("{\"a\":\"" + exact + "\",\"b\":\"" + exact + "w\"}", &metrics));
+    assert(metrics.size() == 1);
+    assert(agri::TelemetryValueTable().Lookup(std::get<agri::TelemetryStringId>(metrics[0].value).id) == exact);
+
+    for (std::size_t i = 0; agri::TelemetryValueTable().Overflows() == 0; ++i) {
+        assert(i < 8192);
+        agri::DecodeTelemetryMetrics("{\"serial\":\"sn-" + std::to_string(i) + "\"}", &metrics);
+    }
+    assert(agri::DecodeTelemetryMetrics("{\"serial\":\"sn-overflow\",\"fresh-key\":1}", &metrics));
+    assert(metrics.size() == 1 && agri::TelemetryKeyTable().Lookup(metrics[0].keyId) == "fresh-key");
+    assert(agri::TelemetryKeyTable().Overflows() == 0);
+}
+
+void TestSplitsNdjsonAndArrayBatches() {
+    std::vector<std::string_view> packets;
+    std::string error;
+    assert(agri::SplitTelemetryBatchJson("{\"a\":1}\r\n\n  {\"b\":\"x\\n\"}\n", &packets, &error));
+    assert((packets == std::vector<std::string_view>{"{\"a\":1}", "{\"b\":\"x\\n\"}"}));
+
+    assert(agri::SplitTelemetryBatchJson(
+        " [ {\"a\":{\"t\":[1,2]}} , {\"b\":\"],\\\"{\"} ] ", &packets, &error));
+    assert((packets == std::vector<std::string_view>{"{\"a\":{\"t\":[1,2]}}", "{\"b\":\"],\\\"{\"}"}));
+
+    assert(agri::SplitTelemetryBatchJson("[]", &packets, &error));
+    assert(packets.empty());
+
+    assert(!agri::SplitTelemetryBatchJson("[{\"a\":1},]", &packets, &error));
+    assert(error == "empty element in batch array");
+    assert(!agri::SplitTelemetryBatchJson("[{\"a\":1}", &packets, &error));
+    assert(error == "unterminated batch array");
+    assert(!agri::SplitTelemetryBatchJson("[{\"a\":1}] x", &packets, &error));
+    assert(error == "unexpected data after batch array");
+}
+
 }
 
 int main() {
     TestParsesValidPayload();
     TestRejectsMissingTelemetry();
+    TestHandlesEscapesAndNestedKeys();
+    TestRejectsMalformedPayloads();
+    TestAppliesGeneratedSchema();
+    TestDecodesTypedMetrics();
+    TestSplitsNdjsonAndArrayBatches();
+    TestBoundsInternedStringValues();
     std::cout << "test_json_parser passed" << std::endl;
     return 0;
 }
@@ -0,0 +1,148 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "transport/json_parser.h"
+#include "transport/json_structural_index.h"
+
+namespace {
+
+const agri::JsonScanBackend kBackends[] = {
+    agri::JsonScanBackend::kScalar, agri::JsonScanBackend::kSse2, agri::JsonScanBackend::kAvx2,
+    agri::JsonScanBackend::kNeon};
+
+bool ScanAll(const std::string& json, std::size_t* length) {
+    bool expected = false;
+    std::size_t expectedLength = 0;
+    bool first = true;
+    for (const agri::JsonScanBackend backend : kBackends) {
+        if (!agri::JsonScanBackendSupported(backend)) {
+            continue;
+        }
+        std::size_t scanned = 0;
+        const bool ok = agri::ScanJsonContainer(json, backend, &scanned);
+        if (first) {
+            expected = ok;
+            expectedLength = scanned;
+            first = false;
+        }
+        assert(ok == expected);
+        assert(!ok || scanned == expectedLength);
+    }
+    *length = expectedLength;
+    return expected;
+}
+
+void TestIndexesStructuralCharacters() {
+    const std::string json = "{\"a\\\"{\": [1, true ,\"x\"], \"b\":-2.5e3}";
+    agri::JsonStructuralIndex index;
+    agri::BuildJsonStructuralIndex(json, agri::JsonScanBackend::kScalar, &index);
+    const std::vector<std::uint32_t> expected = {0, 1, 6, 7, 9, 10, 11, 13, 18, 19, 21, 22, 23, 25, 27, 28, 29, 35};
+    assert(index.positions == expected);
+    assert(index.firstStringError == std::string::npos);
+
+    agri::BuildJsonStructuralIndex("[\"a\tb\"]", agri::JsonScanBackend::kScalar, &index);
+    assert(index.firstStringError == 3);
+
+    assert(agri::JsonScanBackendSupported(agri::DefaultJsonScanBackend()));
+    assert(agri::JsonScanBackendName(agri::JsonScanBackend::kAvx2) == "avx2");
+}
+
+void TestValidatesContainers() {
+    std::size_t length = 0;
+    assert(ScanAll("{\"a\":[1,{\"b\":null}],\"c\":\"\\u00e9\\ud83c\\udf31\"} tail", &length) && length == 45);
+    assert(ScanAll("[]", &length) && length == 2);
+    assert(ScanAll("[ 0 , -0.5 , 1E+2 , false ]", &length) && length == 27);
+
+    for (const std::string& broken :
+         {std::string("{\"a\":1,}"), std::string("{\"a\" 1}"), std::string("[1 2]"), std::string("[01]"),
+          std::string("[tru]"), std::string("[1.]"), std::string("{1:2}"), std::string("[\"a\\x\"]"),
+          std::string("[\"\\ud800\"]"), std::string("[\"\\udc00\"]"), std::string("[\"a\x01\"]"),
+          std::string("[\"abc"), std::string("{\"a\":1"), std::string("\"a\"")}) {
+        assert(!ScanAll(broken, &length));
+    }
+
+    std::string nested(64, '[');
+    nested += std::string(64, ']');
+    assert(ScanAll(nested, &length) && length == 128);
+    assert(!ScanAll("[" + nested + "]", &length));
+}
+
+void TestHandlesEscapesAcrossBlocks() {
+    for (std::size_t pad = 50; pad < 70; ++pad) {
+        for (std::size_t slashes = 1; slashes <= 5; ++slashes) {
+            const std::string json = "[\"" + std::string(pad, 'x') + std::string(slashes, '\\') + "\"]";
+            std::size_t length = 0;
+            const bool ok = ScanAll(json + "  ", &length);
+            assert(ok == (slashes % 2 == 0));
+            assert(!ok || length == json.size());
+        }
+    }
+}
+
+void TestBackendsAgreeOnRandomInput() {
+    const std::string alphabet = "{}[]:,\"\\ \t\n01e.-+truefalsnl\x01\xC3\xA9ux";
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<std::size_t> size(1, 300);
+    for (int round = 0; round < 3000; ++round) {
+        std::string json = (round % 2 == 0) ? "{" : "[";
+        const std::size_t count = size(random);
+        for (std::size_t i = 0; i < count; ++i) {
+            json.push_back(alphabet[pick(random)]);
+        }
+
+        agri::JsonStructuralIndex reference;
+        agri::BuildJsonStructuralIndex(json, agri::JsonScanBackend::kScalar, &reference);
+        for (const agri::JsonScanBackend backend : kBackends) {
+            if (!agri::JsonScanBackendSupported(backend)) {
+                continue;
+            }
+            agri::JsonStructuralIndex index;
+            agri::BuildJsonStructuralIndex(json, backend, &index);
+            assert(index.positions == reference.positions);
+            assert(index.firstStringError == reference.firstStringError);
+        }
+        std::size_t length = 0;
+        ScanAll(json, &length);
+    }
+}
+
+std::string LargePacket(const std::string& spectrum) {
+    const std::string telemetry = "{\"sensor\":\"as7341\",\"bands\":[" + spectrum + "],\"note\":\"a \\\"}\\\"\"}";
+    return "{\"deviceId\":\"spectral-1\",\"timestamp\":1700001000,\"telemetry\":" + telemetry +
+           ",\"hash\":\"" + std::string(64, 'a') + "\",\"signature\":\"bb\"}";
+}
+
+void TestParserUsesIndexForLargeTelemetry() {
+    std::string spectrum;
+    for (int i = 0; i < 400; ++i) {
+        spectrum += (i == 0 ? "" : ",") + std::to_string(i * 7) + "." + std::to_string(i % 10);
+    }
+    const agri::ParseTelemetryResult parsed = agri::ParseTelemetryPacketJson(LargePacket(spectrum));
+    assert(parsed.ok);
+    assert(parsed.packet.telemetryJson.size() > 2000);
+    assert(parsed.packet.telemetryJson.rfind("{\"sensor\":\"as7341\",\"bands\":[0.0,7.1,", 0) == 0);
+    const std::string note = "\"note\":\"a \\\"}\\\"\"}";
+    assert(parsed.packet.telemetryJson.substr(parsed.packet.telemetryJson.size() - note.size()) == note);
+    assert(parsed.packet.hashHex == std::string(64, 'a'));
+
+    for (const std::string& broken : {spectrum + ",", spectrum + ",tru", spectrum + ",01", spectrum + ",\"a\x02\""}) {
+        assert(agri::ParseTelemetryPacketJson(LargePacket(broken)).error == "malformed JSON packet");
+    }
+}
+
+}
+
+int main() {
+    TestIndexesStructuralCharacters();
+    TestValidatesContainers();
+    TestHandlesEscapesAcrossBlocks();
+    TestBackendsAgreeOnRandomInput();
+    TestParserUsesIndexForLargeTelemetry();
+    std::cout << "test_json_structural_index passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "transport/json_parser.h"
+#include "transport/json_writer.h"
+
+namespace {
+
+std::string Escaped(std::string_view value) {
+    std::string out;
+    agri::AppendJsonEscaped(value, &out);
+    return out;
+}
+
+void TestEscapesSpecialAndControlCharacters() {
+    assert(Escaped("") == "");
+    assert(Escaped("plain") == "plain");
+    assert(Escaped("a\"b\\c") == "a\\\"b\\\\c");
+    assert(Escaped("\b\f\n\r\t") == "\\b\\f\\n\\r\\t");
+    assert(Escaped(std::string_view("\x00\x01\x1f", 3)) == "\\u0000\\u0001\\u001f");
+    assert(Escaped("\x7f\xc3\xa9 ") == "\x7f\xc3\xa9 ");
+    assert(agri::JsonEscape("line\x0b") == "line\\u000b");
+}
+
+void TestEscapesAcrossVectorBlocks() {
+    for (std::size_t length = 1; length <= 100; ++length) {
+        for (std::size_t position = 0; position < length; ++position) {
+            std::string input(length, 'x');
+            input[position] = '\x02';
+            const std::string expected =
+                std::string(position, 'x') + "\\u0002" + std::string(length - position - 1, 'x');
+            assert(Escaped(input) == expected);
+        }
+        assert(Escaped(std::string(length, 'y')) == std::string(length, 'y'));
+    }
+    assert(Escaped(std::string(40, '"')).size() == 80);
+}
+
+void TestWritesNestedDocuments() {
+    std::string json = "prefix:";
+    agri::JsonWriter writer(&json);
+    writer.BeginObject()
+        .Key("id")
+        .Uint(std::numeric_limits<std::uint64_t>::max())
+        .Key("ok")
+        .Bool(true)
+        .Key("none")
+        .Null()
+        .Key("list")
+        .BeginArray()
+        .Uint(0)
+        .BeginObject()
+        .EndObject()
+        .String("q\"")
+        .BeginArray()
+        .EndArray()
+        .EndArray()
+        .Key("raw")
+        .Raw("{\"a\":1}")
+        .Key("k\n")
+        .Bool(false)
+        .EndObject();
+    assert(json ==
+           "prefix:{\"id\":18446744073709551615,\"ok\":true,\"none\":null,"
+           "\"list\":[0,{},\"q\\\"\",[]],\"raw\":{\"a\":1},\"k\\n\":false}");
+}
+
+void TestWritesTelemetryRecord() {
+    agri::TelemetryRecord record;
+    record.recordId = 42;
+    record.packet.deviceId = "node\t1";
+    record.packet.timestamp = 1700000000;
+    record.packet.telemetryJson = "{\"temp\":21.5}";
+    record.packet.hashHex = "ab";
+    record.packet.signature = "cd";
+    record.packet.pubKeyId = "key";
+    record.packet.transport = "lora";
+
+    std::string json;
+    agri::JsonWriter writer(&json);
+    agri::WriteTelemetryRecordJson(record, &writer);
+    assert(json ==
+           "{\"recordId\":42,\"deviceId\":\"node\\t1\",\"timestamp\":1700000000,\"telemetry\":{\"temp\":21.5},"
+           "\"hash\":\"ab\",\"signature\":\"cd\",\"pubKeyId\":\"key\",\"transport\":\"lora\",\"receipt\":null}");
+
+    record.packet.batchCode = "lot-7";
+    record.receipt = agri::BlockchainReceipt{"0xfeed", 9, "2024-01-01T00:00:00Z"};
+    json.clear();
+    agri::JsonWriter second(&json);
+    agri::WriteTelemetryRecordJson(record, &second);
+    assert(json.find(",\"batchCode\":\"lot-7\",\"receipt\":{\"txHash\":\"0xfeed\",\"blockHeight\":9,"
+                     "\"submittedAt\":\"2024-01-01T00:00:00Z\"}}") != std::string::npos);
+}
+
+}
+
+int main() {
+    TestEscapesSpecialAndControlCharacters();
+    TestEscapesAcrossVectorBlocks();
+    TestWritesNestedDocuments();
+    TestWritesTelemetryRecord();
+    std::cout << "test_json_writer passed" << std::endl;
+    return 0;
+}
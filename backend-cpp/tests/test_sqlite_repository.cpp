@@ -2,8 +2,14 @@
 #include <filesystem>
 #include <iostream>
 #include <string>
+#include <variant>
+#include <vector>
 
+#include <sqlite3.h>
+
+#include "storage/in_memory_telemetry_repository.h"
 #include "storage/sqlite_telemetry_repository.h"
+#include "transport/json_parser.h"
 
 namespace fs = std::filesystem;
 
@@ -19,6 +25,8 @@ agri::TelemetryPacket BuildPacket() {
     packet.pubKeyId = "pubkey-1";
     packet.transport = "wifi";
     packet.batchCode = "BATCH-SQLITE-01";
+    [[maybe_unused]] const bool decoded = agri::DecodeTelemetryMetrics(packet.telemetryJson, &packet.metrics);
+    assert(decoded);
     return packet;
 }
 
@@ -45,6 +53,8 @@ void TestSqliteRepositoryRoundTrip() {
     assert(latest->recordId == recordId);
     assert(latest->receipt.has_value());
     assert(latest->receipt->txHash == receipt.txHash);
+    assert(latest->packet.metrics.size() == 1);
+    assert(std::get<double>(latest->packet.metrics[0].value) == 23.1);
 
     const auto byTx = repository.FindByTransaction(receipt.txHash);
     assert(byTx.has_value());
@@ -61,10 +71,138 @@ void TestSqliteRepositoryRoundTrip() {
     fs::remove(dbPath, ec);
 }
 
+void TestBatchCursorPages() {
+    const fs::path dbPath = fs::path("/tmp") / "agri_sqlite_repository_cursor_test.db";
+    std::error_code ec;
+    fs::remove(dbPath, ec);
+
+    agri::SQLiteTelemetryRepository sqlite(dbPath.string());
+    agri::InMemoryTelemetryRepository memory;
+    agri::TelemetryPacket packet = BuildPacket();
+    for (int i = 0; i < 10; ++i) {
+        packet.timestamp = 1700003000 + static_cast<std::uint64_t>(i / 2);
+        sqlite.Save(packet);
+        memory.Save(packet);
+    }
+
+    for (const agri::TelemetryRepository* repository :
+         {static_cast<const agri::TelemetryRepository*>(&sqlite), static_cast<const agri::TelemetryRepository*>(&memory)}) {
+        agri::TelemetryBatchCursor cursor;
+        cursor.batchCode = packet.batchCode;
+        std::vector<agri::TelemetryRecord> page;
+        std::vector<std::uint64_t> ids;
+        std::size_t pages = 0;
+        while (!cursor.exhausted) {
+            repository->ReadBatchPage(&cursor, 4, &page);
+            assert(page.size() <= 4);
+            for (const agri::TelemetryRecord& record : page) {
+                ids.push_back(record.recordId);
+            }
+            ++pages;
+        }
+        assert(pages == 3);
+        assert((ids == std::vector<std::uint64_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+
+        agri::TelemetryBatchCursor missing;
+        missing.batchCode = "BATCH-NONE";
+        repository->ReadBatchPage(&missing, 4, &page);
+        assert(page.empty() && missing.exhausted);
+    }
+
+    fs::remove(dbPath, ec);
+}
+
+void TestSaveBatchSharesReceipt() {
+    const fs::path dbPath = fs::path("/tmp") / "agri_sqlite_repository_batch_test.db";
+    std::error_code ec;
+    fs::remove(dbPath, ec);
+
+    agri::SQLiteTelemetryRepository sqlite(dbPath.string());
+    agri::InMemoryTelemetryRepository memory;
+    std::vector<agri::TelemetryPacket> packets(3, BuildPacket());
+    for (std::size_t i = 0; i < packets.size(); ++i) {
+        packets[i].timestamp += i;
+    }
+    const std::vector<agri::TelemetryPacketView> views(packets.begin(), packets.end());
+
+    agri::BlockchainReceipt receipt;
+    receipt.txHash = "0xbatchtxhash";
+    receipt.blockHeight = 777;
+    receipt.submittedAtIso8601 = "2026-02-23T00:00:00Z";
+
+    for (agri::TelemetryRepository* repository :
+         {static_cast<agri::TelemetryRepository*>(&sqlite), static_cast<agri::TelemetryRepository*>(&memory)}) {
+        const std::vector<std::uint64_t> ids = repository->SaveBatch(views);
+        assert((ids == std::vector<std::uint64_t>{1, 2, 3}));
+        assert(repository->Size() == 3);
+
+        assert(repository->AttachReceiptBatch(ids, receipt));
+        assert(!repository->AttachReceiptBatch({ids[0], 99}, receipt));
+        const auto byTx = repository->FindByTransaction(receipt.txHash);
+        assert(byTx.has_value() && byTx->recordId == 1);
+        for (const agri::TelemetryRecord& record : repository->FindByBatch(packets[0].batchCode)) {
+            assert(record.receipt.has_value() && record.receipt->blockHeight == 777);
+        }
+    }
+
+    fs::remove(dbPath, ec);
+}
+
+void TestMetricsSurviveRestart() {
+    const fs::path dbPath = fs::path("/tmp") / "agri_sqlite_repository_metrics_test.db";
+    std::error_code ec;
+    fs::remove(dbPath, ec);
+
+    agri::TelemetryPacket packet = BuildPacket();
+    packet.telemetryJson = "{\"temperature\":21.5,\"mode\":\"irrigating\",\"pumpOn\":true,\"tags\":[1]}";
+    [[maybe_unused]] const bool decoded = agri::DecodeTelemetryMetrics(packet.telemetryJson, &packet.metrics);
+    assert(decoded && packet.metrics.size() == 3);
+    const std::vector<agri::TelemetryMetric> expected = packet.metrics;
+
+    {
+        agri::SQLiteTelemetryRepository repository(dbPath.string());
+        repository.Save(packet);
+        packet.timestamp += 1;
+        const std::vector<agri::TelemetryPacketView> views{packet};
+        repository.SaveBatch(views);
+    }
+
+    {
+        agri::SQLiteTelemetryRepository repository(dbPath.string());
+        const std::vector<agri::TelemetryRecord> records = repository.FindByBatch(packet.batchCode);
+        assert(records.size() == 2);
+        for (const agri::TelemetryRecord& record : records) {
+            assert(record.packet.metrics == expected);
+        }
+        assert(agri::TelemetryValueTable().Lookup(std::get<agri::TelemetryStringId>(expected[1].value).id) ==
+               "irrigating");
+    }
+
+    // A database from before metrics were persisted is backfilled from the stored JSON on open.
+    sqlite3* db = nullptr;
+    [[maybe_unused]] const int opened = sqlite3_open(dbPath.string().c_str(), &db);
+    assert(opened == SQLITE_OK);
+    [[maybe_unused]] const int dropped = sqlite3_exec(db, "DROP TABLE telemetry_metrics;", nullptr, nullptr, nullptr);
+    assert(dropped == SQLITE_OK);
+    sqlite3_close(db);
+
+    {
+        agri::SQLiteTelemetryRepository repository(dbPath.string());
+        const auto latest = repository.LatestByDevice(packet.deviceId);
+        assert(latest.has_value() && latest->packet.metrics == expected);
+        assert(repository.Delete(latest->recordId));
+    }
+
+    fs::remove(dbPath, ec);
+}
+
 }
 
 int main() {
     TestSqliteRepositoryRoundTrip();
+    TestBatchCursorPages();
+    TestSaveBatchSharesReceipt();
+    TestMetricsSurviveRestart();
     std::cout << "test_sqlite_repository passed" << std::endl;
     return 0;
 }
@@ -0,0 +1,72 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/string_interner.h"
+
+namespace {
+
+void TestInternsStableIds() {
+    agri::StringInterner interner;
+    std::uint32_t temperature = 0;
+    std::uint32_t humidity = 0;
+    std::uint32_t again = 0;
+    assert(interner.Intern("temperature", &temperature));
+    assert(interner.Intern("humidity", &humidity));
+    assert(interner.Intern(std::string("temper") + "ature", &again));
+    assert(temperature == again && temperature != humidity);
+    assert(interner.Lookup(temperature) == "temperature");
+    assert(interner.Lookup(99).empty());
+    assert(interner.Size() == 2);
+
+    std::uint32_t found = 0;
+    assert(interner.Find("humidity", &found) && found == humidity);
+    assert(!interner.Find("battery", &found));
+}
+
+void TestRespectsCapacity() {
+    agri::StringInterner interner(2);
+    std::uint32_t id = 0;
+    assert(interner.Intern("a", &id) && interner.Intern("b", &id));
+    assert(!interner.Intern("c", &id));
+    assert(interner.Intern("a", &id) && id == 0);
+    assert(!interner.Intern("d", &id));
+    assert(interner.Size() == 2);
+    assert(interner.Overflows() == 2);
+}
+
+void TestConcurrentInterning() {
+    agri::StringInterner interner;
+    std::vector<std::vector<std::uint32_t>> ids(4);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < ids.size(); ++t) {
+        threads.emplace_back([&interner, &ids, t] {
+            for (int i = 0; i < 500; ++i) {
+                std::uint32_t id = 0;
+                assert(interner.Intern("metric-" + std::to_string(i), &id));
+                ids[t].push_back(id);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    assert(interner.Size() == 500);
+    for (const std::vector<std::uint32_t>& perThread : ids) {
+        assert(perThread == ids.front());
+    }
+    assert(interner.Lookup(ids.front()[42]) == "metric-42");
+}
+
+}
+
+int main() {
+    TestInternsStableIds();
+    TestRespectsCapacity();
+    TestConcurrentInterning();
+    std::cout << "test_string_interner passed" << std::endl;
+    return 0;
+}
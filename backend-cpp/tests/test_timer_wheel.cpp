@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "utils/timer_wheel.h"
+
+namespace {
+
+using Clock = agri::TimerWheel::Clock;
+using std::chrono::milliseconds;
+
+void TestFiresAtDeadline() {
+    const Clock::time_point origin = Clock::now();
+    agri::TimerWheel wheel(milliseconds(10), origin);
+    const agri::TimerWheel::TimerId early = wheel.Create(1);
+    const agri::TimerWheel::TimerId late = wheel.Create(2);
+    wheel.Schedule(early, origin + milliseconds(25));
+    wheel.Schedule(late, origin + milliseconds(900));
+    assert(wheel.ScheduledCount() == 2);
+    assert(wheel.MillisecondsUntilNextExpiry(origin) == 30);
+
+    std::vector<std::uint64_t> expired;
+    wheel.Advance(origin + milliseconds(29), &expired);
+    assert(expired.empty());
+    wheel.Advance(origin + milliseconds(30), &expired);
+    assert((expired == std::vector<std::uint64_t>{1}));
+    assert(!wheel.Scheduled(early) && wheel.Scheduled(late));
+
+    expired.clear();
+    wheel.Advance(origin + milliseconds(899), &expired);
+    assert(expired.empty());
+    wheel.Advance(origin + milliseconds(900), &expired);
+    assert((expired == std::vector<std::uint64_t>{2}));
+    assert(wheel.ScheduledCount() == 0);
+    assert(wheel.MillisecondsUntilNextExpiry(origin + milliseconds(900)) == -1);
+}
+
+void TestRescheduleAndCancel() {
+    const Clock::time_point origin = Clock::now();
+    agri::TimerWheel wheel(milliseconds(1), origin);
+    const agri::TimerWheel::TimerId moved = wheel.Create(7);
+    const agri::TimerWheel::TimerId cancelled = wheel.Create(8);
+    wheel.Schedule(moved, origin + milliseconds(5));
+    wheel.Schedule(cancelled, origin + milliseconds(5));
+    wheel.Schedule(moved, origin + milliseconds(5000));
+    wheel.Cancel(cancelled);
+    assert(wheel.ScheduledCount() == 1);
+
+    std::vector<std::uint64_t> expired;
+    wheel.Advance(origin + milliseconds(4999), &expired);
+    assert(expired.empty());
+    wheel.Advance(origin + milliseconds(5000), &expired);
+    assert((expired == std::vector<std::uint64_t>{7}));
+
+    wheel.Destroy(cancelled);
+    assert(wheel.Create(9) == cancelled);
+}
+
+void TestPastDeadlineFiresOnNextTick() {
+    const Clock::time_point origin = Clock::now();
+    agri::TimerWheel wheel(milliseconds(10), origin);
+    std::vector<std::uint64_t> expired;
+    wheel.Advance(origin + milliseconds(100), &expired);
+
+    const agri::TimerWheel::TimerId id = wheel.Create(3);
+    wheel.Schedule(id, origin);
+    assert(wheel.MillisecondsUntilNextExpiry(origin + milliseconds(100)) == 10);
+    wheel.Advance(origin + milliseconds(110), &expired);
+    assert((expired == std::vector<std::uint64_t>{3}));
+}
+
+void TestMatchesSortedDeadlinesAcrossLevels() {
+    const Clock::time_point origin = Clock::now();
+    agri::TimerWheel wheel(milliseconds(1), origin);
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> delay(1, 20 * 1000 * 1000);
+
+    std::vector<std::pair<std::int64_t, std::uint64_t>> deadlines;
+    for (std::uint64_t i = 0; i < 2000; ++i) {
+        const std::int64_t at = (i % 4 == 0) ? static_cast<std::int64_t>(i % 300) + 1 : delay(random);
+        deadlines.emplace_back(at, i);
+        wheel.Schedule(wheel.Create(i), origin + milliseconds(at));
+    }
+    std::sort(deadlines.begin(), deadlines.end());
+
+    std::vector<std::uint64_t> expired;
+    std::size_t checked = 0;
+    std::int64_t now = 0;
+    while (wheel.ScheduledCount() > 0) {
+        const int wait = wheel.MillisecondsUntilNextExpiry(origin + milliseconds(now));
+        assert(wait > 0);
+        now += wait;
+        wheel.Advance(origin + milliseconds(now), &expired);
+        for (; checked < expired.size(); ++checked) {
+            const auto match = std::find_if(deadlines.begin(), deadlines.end(), [&](const auto& entry) {
+                return entry.second == expired[checked];
+            });
+            assert(match->first == now);
+        }
+    }
+    assert(expired.size() == deadlines.size());
+}
+
+}
+
+int main() {
+    TestFiresAtDeadline();
+    TestRescheduleAndCancel();
+    TestPastDeadlineFiresOnNextTick();
+    TestMatchesSortedDeadlinesAcrossLevels();
+    std::cout << "timer wheel tests passed" << std::endl;
+    return 0;
+}
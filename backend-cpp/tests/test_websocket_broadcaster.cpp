@@ -0,0 +1,461 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api/websocket_broadcaster.h"
+
+namespace {
+
+bool WaitFor(const std::function<bool()>& condition) {
+    for (int attempt = 0; attempt < 500; ++attempt) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return condition();
+}
+
+void MakePair(int* serverFd, int* clientFd, int sendBufferBytes = 0) {
+    int fds[2] = {-1, -1};
+    [[maybe_unused]] const int created = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(created == 0);
+    if (sendBufferBytes > 0) {
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sendBufferBytes, sizeof(sendBufferBytes));
+        setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &sendBufferBytes, sizeof(sendBufferBytes));
+    }
+    *serverFd = fds[0];
+    *clientFd = fds[1];
+}
+
+void SendAll(int fd, const std::string& bytes) {
+    [[maybe_unused]] const ssize_t sent = send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+    assert(sent == static_cast<ssize_t>(bytes.size()));
+}
+
+std::string ReadExactly(int fd, std::size_t size) {
+    std::string out;
+    char buffer[4096];
+    while (out.size() < size) {
+        const ssize_t received = recv(fd, buffer, std::min(sizeof(buffer), size - out.size()), 0);
+        if (received <= 0) {
+            break;
+        }
+        out.append(buffer, static_cast<std::size_t>(received));
+    }
+    return out;
+}
+
+std::string ReadUntilClose(int fd) {
+    std::string out;
+    char buffer[65536];
+    while (true) {
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        out.append(buffer, static_cast<std::size_t>(received));
+    }
+    return out;
+}
+
+std::vector<std::string> DecodeTextFrames(const std::string& bytes) {
+    std::vector<std::string> payloads;
+    std::size_t offset = 0;
+    while (offset + 2 <= bytes.size()) {
+        if (static_cast<unsigned char>(bytes[offset]) == 0x88) {
+            break;
+        }
+        assert(static_cast<unsigned char>(bytes[offset]) == 0x81);
+        std::uint64_t length = static_cast<unsigned char>(bytes[offset + 1]) & 0x7F;
+        const std::size_t extended = (length == 126) ? 2 : (length == 127) ? 8 : 0;
+        if (offset + 2 + extended > bytes.size()) {
+            break;
+        }
+        offset += 2;
+        if (length == 126) {
+            length = (static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[offset])) << 8) |
+                     static_cast<unsigned char>(bytes[offset + 1]);
+            offset += 2;
+        } else if (length == 127) {
+            length = 0;
+            for (int i = 0; i < 8; ++i) {
+                length = (length << 8) | static_cast<unsigned char>(bytes[offset + i]);
+            }
+            offset += 8;
+        }
+        if (offset + length > bytes.size()) {
+            break;
+        }
+        payloads.push_back(bytes.substr(offset, length));
+        offset += length;
+    }
+    return payloads;
+}
+
+std::string TextFrame(const std::string& payload) {
+    return agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kText, payload);
+}
+
+std::string MaskedFrame(agri::WebSocketOpcode opcode, const std::string& payload) {
+    const char mask[4] = {'\x11', '\x22', '\x33', '\x44'};
+    std::string frame;
+    frame.push_back(static_cast<char>(0x80 | static_cast<std::uint8_t>(opcode)));
+    frame.push_back(static_cast<char>(0x80 | payload.size()));
+    frame.append(mask, sizeof(mask));
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    }
+    return frame;
+}
+
+void TestParseSlowClientPolicy() {
+    assert(agri::ParseSlowClientPolicy("disconnect") == agri::SlowClientPolicy::kDisconnect);
+}
+
+void TestFanOutByChannel() {
+    agri::WebSocketBroadcaster broadcaster;
+    broadcaster.Start();
+
+    int telemetryServer = -1;
+    int telemetryClient = -1;
+    int alertServer = -1;
+    int alertClient = -1;
+    MakePair(&telemetryServer, &telemetryClient);
+    MakePair(&alertServer, &alertClient);
+    broadcaster.AddClient(telemetryServer, agri::WebSocketChannel::kTelemetry, {}, "HANDSHAKE-T");
+    broadcaster.AddClient(alertServer, agri::WebSocketChannel::kAlerts, {}, "HANDSHAKE-A");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 2; }));
+
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, "{\"n\":1}", {"node-1", "", "lora"});
+    broadcaster.Publish(agri::WebSocketChannel::kAlerts, "{\"alert\":true}");
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, "{\"n\":2}", {"node-2", "", "wifi"});
+
+    assert(ReadExactly(telemetryClient, 11) == "HANDSHAKE-T");
+    const std::vector<std::string> telemetry = DecodeTextFrames(ReadExactly(telemetryClient, 18));
+    assert(telemetry.size() == 2);
+    assert(telemetry[0] == "{\"n\":1}");
+    assert(telemetry[1] == "{\"n\":2}");
+
+    assert(ReadExactly(alertClient, 11) == "HANDSHAKE-A");
+    const std::vector<std::string> alerts = DecodeTextFrames(ReadExactly(alertClient, 16));
+    assert(alerts.size() == 1 && alerts[0] == "{\"alert\":true}");
+
+    close(alertClient);
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 1; }));
+
+    broadcaster.Stop();
+    assert(ReadUntilClose(telemetryClient) == agri::EncodeWebSocketClose(agri::kWebSocketCloseGoingAway));
+    close(telemetryClient);
+}
+
+void TestRoutesEventsBySubscription() {
+    agri::WebSocketBroadcaster broadcaster;
+    broadcaster.Start();
+
+    int deviceServer = -1;
+    int deviceClient = -1;
+    int groupServer = -1;
+    int groupClient = -1;
+    MakePair(&deviceServer, &deviceClient);
+    MakePair(&groupServer, &groupClient);
+
+    agri::WebSocketSubscription device;
+    device.deviceIds = {"gh-1-node-1"};
+    agri::WebSocketSubscription group;
+    group.deviceGroups = {"gh-2"};
+    group.transports = {"lora"};
+    broadcaster.AddClient(deviceServer, agri::WebSocketChannel::kTelemetry, device, "");
+    broadcaster.AddClient(groupServer, agri::WebSocketChannel::kTelemetry, group, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 2; }));
+
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, "a", {"gh-2-node-1", "", "wifi"});
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, "b", {"gh-1-node-1", "", "lora"});
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, "c", {"gh-2-node-4", "", "lora"});
+    broadcaster.Publish(agri::WebSocketChannel::kAlerts, "d", {"gh-1-node-1", "", "lora"});
+    assert(WaitFor([&] { return broadcaster.Stats().publishedMessages == 4; }));
+
+    broadcaster.Stop();
+    assert((DecodeTextFrames(ReadUntilClose(deviceClient)) == std::vector<std::string>{"b"}));
+    assert((DecodeTextFrames(ReadUntilClose(groupClient)) == std::vector<std::string>{"c"}));
+    close(deviceClient);
+    close(groupClient);
+}
+
+void TestSlowClientDoesNotBlockOthers() {
+    agri::WebSocketBroadcasterConfig config;
+    config.maxQueuedFrames = 4;
+    config.slowClientPolicy = agri::SlowClientPolicy::kDrop;
+    agri::WebSocketBroadcaster broadcaster(config);
+    broadcaster.Start();
+
+    int slowServer = -1;
+    int slowClient = -1;
+    int fastServer = -1;
+    int fastClient = -1;
+    MakePair(&slowServer, &slowClient, 4096);
+    MakePair(&fastServer, &fastClient);
+    broadcaster.AddClient(slowServer, agri::WebSocketChannel::kTelemetry, {}, "");
+    broadcaster.AddClient(fastServer, agri::WebSocketChannel::kTelemetry, {}, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 2; }));
+
+    const std::string payload(2 * 1024, 'x');
+    const std::string frame = TextFrame(payload);
+    std::string fastReceived;
+    std::thread fastReader([&] { fastReceived = ReadExactly(fastClient, frame.size() * 20); });
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; ++i) {
+        broadcaster.Publish(agri::WebSocketChannel::kTelemetry, payload);
+    }
+    assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(1));
+
+    fastReader.join();
+    assert(DecodeTextFrames(fastReceived).size() == 20);
+    assert(WaitFor([&] { return broadcaster.Stats().publishedMessages == 20; }));
+    assert(broadcaster.Stats().droppedFrames > 0);
+    assert(broadcaster.ClientCount() == 2);
+
+    broadcaster.Stop();
+    const std::vector<std::string> slowFrames = DecodeTextFrames(ReadUntilClose(slowClient));
+    assert(slowFrames.size() < 20);
+    close(slowClient);
+    close(fastClient);
+}
+
+void TestCoalesceKeepsLatestPerKey() {
+    agri::WebSocketBroadcasterConfig config;
+    config.maxQueuedFrames = 3;
+    config.slowClientPolicy = agri::SlowClientPolicy::kCoalesce;
+    agri::WebSocketBroadcaster broadcaster(config);
+    broadcaster.Start();
+
+    int serverFd = -1;
+    int clientFd = -1;
+    MakePair(&serverFd, &clientFd, 4096);
+    broadcaster.AddClient(serverFd, agri::WebSocketChannel::kTelemetry, {}, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 1; }));
+
+    const std::string filler(256 * 1024, 'f');
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, filler, {"filler", "", ""});
+    for (int i = 0; i < 10; ++i) {
+        const std::string key = (i % 2 == 0) ? "node-a" : "node-b";
+        broadcaster.Publish(agri::WebSocketChannel::kTelemetry, key + ":" + std::to_string(i), {key, "", ""});
+    }
+    assert(WaitFor([&] { return broadcaster.Stats().publishedMessages == 11; }));
+    assert(broadcaster.Stats().coalescedFrames > 0);
+
+    const std::size_t expectedBytes =
+        TextFrame(filler).size() + TextFrame("node-a:8").size() + TextFrame("node-b:9").size();
+    const std::vector<std::string> frames = DecodeTextFrames(ReadExactly(clientFd, expectedBytes));
+    assert(frames.size() == 3);
+    assert(frames[0] == filler);
+    assert(frames[1] == "node-a:8");
+    assert(frames[2] == "node-b:9");
+
+    broadcaster.Stop();
+    assert(ReadUntilClose(clientFd) == agri::EncodeWebSocketClose(agri::kWebSocketCloseGoingAway));
+    close(clientFd);
+}
+
+void TestDisconnectPolicyClosesSlowClient() {
+    agri::WebSocketBroadcasterConfig config;
+    config.maxQueuedFrames = 2;
+    config.slowClientPolicy = agri::SlowClientPolicy::kDisconnect;
+    agri::WebSocketBroadcaster broadcaster(config);
+    broadcaster.Start();
+
+    int serverFd = -1;
+    int clientFd = -1;
+    MakePair(&serverFd, &clientFd, 4096);
+    broadcaster.AddClient(serverFd, agri::WebSocketChannel::kAlerts, {}, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 1; }));
+
+    const std::string payload(64 * 1024, 'a');
+    for (int i = 0; i < 5; ++i) {
+        broadcaster.Publish(agri::WebSocketChannel::kAlerts, payload);
+    }
+    assert(WaitFor([&] { return broadcaster.Stats().disconnectedClients == 1; }));
+    assert(broadcaster.ClientCount() == 0);
+
+    ReadUntilClose(clientFd);
+    close(clientFd);
+    broadcaster.Stop();
+}
+
+void TestControlFramesAndSubscribeMessages() {
+    agri::WebSocketBroadcaster broadcaster;
+    broadcaster.Start();
+
+    int serverFd = -1;
+    int clientFd = -1;
+    MakePair(&serverFd, &clientFd);
+    broadcaster.AddClient(serverFd, agri::WebSocketChannel::kTelemetry, {}, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 1; }));
+
+    const std::string ping = MaskedFrame(agri::WebSocketOpcode::kPing, "tick");
+    SendAll(clientFd, ping);
+    const std::string pong = agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kPong, "tick");
+    assert(ReadExactly(clientFd, pong.size()) == pong);
+
+    const std::string bad = MaskedFrame(agri::WebSocketOpcode::kText, "{\"type\":\"subscribe\",\"zone\":\"x\"}");
+    SendAll(clientFd, bad);
+    const std::string error = TextFrame("{\"type\":\"error\",\"message\":\"unknown subscription filter: zone\"}");
+    assert(ReadExactly(clientFd, error.size()) == error);
+
+    const std::string subscribe =
+        MaskedFrame(agri::WebSocketOpcode::kText, "{\"type\":\"subscribe\",\"deviceId\":[\"node-2\"]}");
+    SendAll(clientFd, subscribe);
+    const std::string subscribed = TextFrame("{\"type\":\"subscribed\"}");
+    assert(ReadExactly(clientFd, subscribed.size()) == subscribed);
+    assert(broadcaster.Stats().subscriptionUpdates == 1);
+
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, "one", {"node-1", "", ""});
+    broadcaster.Publish(agri::WebSocketChannel::kTelemetry, "two", {"node-2", "", ""});
+    assert(ReadExactly(clientFd, TextFrame("two").size()) == TextFrame("two"));
+
+    const std::string closeFrame = MaskedFrame(agri::WebSocketOpcode::kClose, std::string("\x03\xe8", 2));
+    SendAll(clientFd, closeFrame);
+    assert(ReadUntilClose(clientFd) == agri::EncodeWebSocketClose(agri::kWebSocketCloseNormal));
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 0; }));
+
+    close(clientFd);
+    broadcaster.Stop();
+}
+
+void TestProtocolErrorClosesClient() {
+    agri::WebSocketBroadcaster broadcaster;
+    broadcaster.Start();
+
+    int serverFd = -1;
+    int clientFd = -1;
+    MakePair(&serverFd, &clientFd);
+    broadcaster.AddClient(serverFd, agri::WebSocketChannel::kAlerts, {}, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 1; }));
+
+    const std::string unmasked = TextFrame("hello");
+    SendAll(clientFd, unmasked);
+    assert(ReadUntilClose(clientFd) == agri::EncodeWebSocketClose(agri::kWebSocketCloseProtocolError));
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 0; }));
+
+    close(clientFd);
+    broadcaster.Stop();
+}
+
+void TestRejectsInvalidUtf8AndReservedCloseCodes() {
+    agri::WebSocketBroadcaster broadcaster;
+    broadcaster.Start();
+
+    const auto closeReplyTo = [&broadcaster](const std::string& frame) {
+        int serverFd = -1;
+        int clientFd = -1;
+        MakePair(&serverFd, &clientFd);
+        broadcaster.AddClient(serverFd, agri::WebSocketChannel::kTelemetry, {}, "");
+        SendAll(clientFd, frame);
+        const std::string reply = ReadUntilClose(clientFd);
+        close(clientFd);
+        return reply;
+    };
+
+    assert(closeReplyTo(MaskedFrame(agri::WebSocketOpcode::kText, "{\"type\":\"subscribe\",\"x\":\"\xc0\xaf\"}")) ==
+           agri::EncodeWebSocketClose(agri::kWebSocketCloseInvalidPayload));
+    assert(closeReplyTo(MaskedFrame(agri::WebSocketOpcode::kClose, std::string("\x03\xed", 2))) ==
+           agri::EncodeWebSocketClose(agri::kWebSocketCloseProtocolError));
+    assert(closeReplyTo(MaskedFrame(agri::WebSocketOpcode::kClose, std::string("\x03\xe7", 2))) ==
+           agri::EncodeWebSocketClose(agri::kWebSocketCloseProtocolError));
+    assert(closeReplyTo(MaskedFrame(agri::WebSocketOpcode::kClose, std::string("\x03\xe8\xed\xa0\x80", 5))) ==
+           agri::EncodeWebSocketClose(agri::kWebSocketCloseInvalidPayload));
+    assert(closeReplyTo(MaskedFrame(agri::WebSocketOpcode::kClose, std::string("\x0f\xa0" "bye", 5))) ==
+           agri::EncodeWebSocketClose(4000));
+
+    broadcaster.Stop();
+}
+
+void TestClosesClientThatFloodsRepliesWithoutReading() {
+    agri::WebSocketBroadcasterConfig config;
+    config.maxQueuedFrames = 4;
+    config.slowClientPolicy = agri::SlowClientPolicy::kDrop;
+    agri::WebSocketBroadcaster broadcaster(config);
+    broadcaster.Start();
+
+    int serverFd = -1;
+    int clientFd = -1;
+    MakePair(&serverFd, &clientFd, 4096);
+    broadcaster.AddClient(serverFd, agri::WebSocketChannel::kTelemetry, {}, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 1; }));
+
+    const std::string ping = MaskedFrame(agri::WebSocketOpcode::kPing, std::string(120, 'p'));
+    for (int i = 0; i < 2000; ++i) {
+        SendAll(clientFd, ping);
+    }
+    assert(WaitFor([&] { return broadcaster.Stats().disconnectedClients == 1; }));
+
+    const std::string pong = agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kPong, std::string(120, 'p'));
+    const std::string policyClose = agri::EncodeWebSocketClose(agri::kWebSocketClosePolicyViolation);
+    const std::string received = ReadUntilClose(clientFd);
+    assert(received.size() > policyClose.size() && (received.size() - policyClose.size()) % pong.size() == 0);
+    assert(received.size() < 2000 * pong.size());
+    assert(received.compare(received.size() - policyClose.size(), policyClose.size(), policyClose) == 0);
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 0; }));
+
+    close(clientFd);
+    broadcaster.Stop();
+}
+
+void TestPingsClientsAndDropsUnresponsiveOnes() {
+    agri::WebSocketBroadcasterConfig config;
+    config.pingIntervalMs = 40;
+    agri::WebSocketBroadcaster broadcaster(config);
+    broadcaster.Start();
+
+    int lively = -1;
+    int livelyClient = -1;
+    int silent = -1;
+    int silentClient = -1;
+    MakePair(&lively, &livelyClient);
+    MakePair(&silent, &silentClient);
+    broadcaster.AddClient(lively, agri::WebSocketChannel::kTelemetry, {}, "");
+    broadcaster.AddClient(silent, agri::WebSocketChannel::kTelemetry, {}, "");
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 2; }));
+
+    const std::string ping = agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kPing, "");
+    const std::string pong = MaskedFrame(agri::WebSocketOpcode::kPong, "");
+    for (int i = 0; i < 3; ++i) {
+        assert(ReadExactly(livelyClient, ping.size()) == ping);
+        SendAll(livelyClient, pong);
+    }
+
+    assert(ReadUntilClose(silentClient).substr(0, ping.size()) == ping);
+    assert(WaitFor([&] { return broadcaster.ClientCount() == 1; }));
+    assert(broadcaster.Stats().pingTimeouts == 1);
+
+    close(livelyClient);
+    close(silentClient);
+    broadcaster.Stop();
+}
+
+}
+
+int main() {
+    TestParseSlowClientPolicy();
+    TestFanOutByChannel();
+    TestRoutesEventsBySubscription();
+    TestSlowClientDoesNotBlockOthers();
+    TestCoalesceKeepsLatestPerKey();
+    TestDisconnectPolicyClosesSlowClient();
+    TestControlFramesAndSubscribeMessages();
+    TestProtocolErrorClosesClient();
+    TestRejectsInvalidUtf8AndReservedCloseCodes();
+    TestClosesClientThatFloodsRepliesWithoutReading();
+    TestPingsClientsAndDropsUnresponsiveOnes();
+    std::cout << "websocket broadcaster tests passed" << std::endl;
+    return 0;
+}
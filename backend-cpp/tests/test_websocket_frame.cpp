@@ -0,0 +1,163 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "api/websocket_deflate.h"
+#include "api/websocket_frame.h"
+
+namespace {
+
+std::string MaskedFrame(std::uint8_t firstByte, const std::string& payload) {
+    const char mask[4] = {'\x0a', '\x1b', '\x2c', '\x3d'};
+    std::string frame;
+    frame.push_back(static_cast<char>(firstByte));
+    if (payload.size() <= 125) {
+        frame.push_back(static_cast<char>(0x80 | payload.size()));
+    } else {
+        frame.push_back(static_cast<char>(0x80 | 126));
+        frame.push_back(static_cast<char>((payload.size() >> 8) & 0xFF));
+        frame.push_back(static_cast<char>(payload.size() & 0xFF));
+    }
+    frame.append(mask, sizeof(mask));
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    }
+    return frame;
+}
+
+void TestEncodeFrameLengths() {
+    assert(agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kText, "hi") == std::string("\x81\x02hi", 4));
+    assert(agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kText, std::string(200, 'a')).size() == 204);
+    assert(agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kText, std::string(70000, 'a')).size() == 70010);
+    assert(agri::EncodeWebSocketFrame(agri::WebSocketOpcode::kText, "x", true)[0] == '\xc1');
+    assert(agri::EncodeWebSocketClose(1001) == std::string("\x88\x02\x03\xe9", 4));
+}
+
+void TestReadsMaskedAndFragmentedMessages() {
+    agri::WebSocketReader reader;
+    agri::WebSocketInbound inbound;
+
+    const std::string bytes = MaskedFrame(0x01, "hel") + MaskedFrame(0x89, "p") + MaskedFrame(0x80, "lo") +
+                              MaskedFrame(0x81, std::string(300, 'z'));
+    reader.Append(bytes.data(), 5);
+    assert(reader.Next(&inbound) == agri::WebSocketReader::Status::kIncomplete);
+    reader.Append(bytes.data() + 5, bytes.size() - 5);
+
+    assert(reader.Next(&inbound) == agri::WebSocketReader::Status::kReady);
+    assert(inbound.opcode == agri::WebSocketOpcode::kPing && inbound.payload == "p");
+    assert(reader.Next(&inbound) == agri::WebSocketReader::Status::kReady);
+    assert(inbound.opcode == agri::WebSocketOpcode::kText && inbound.payload == "hello");
+    assert(reader.Next(&inbound) == agri::WebSocketReader::Status::kReady);
+    assert(inbound.payload == std::string(300, 'z'));
+    assert(reader.Next(&inbound) == agri::WebSocketReader::Status::kIncomplete);
+    assert(reader.BufferedBytes() == 0);
+}
+
+void TestRejectsProtocolViolations() {
+    agri::WebSocketInbound inbound;
+
+    const auto expectError = [&inbound](const std::string& bytes, std::uint16_t code, std::size_t maxBytes = 1024) {
+        agri::WebSocketReader reader(maxBytes);
+        reader.Append(bytes.data(), bytes.size());
+        while (reader.Next(&inbound) == agri::WebSocketReader::Status::kReady) {
+        }
+        assert(reader.ErrorCode() == code);
+    };
+
+    expectError(std::string("\x81\x02hi", 4), agri::kWebSocketCloseProtocolError);
+    expectError(MaskedFrame(0x80, "orphan"), agri::kWebSocketCloseProtocolError);
+    expectError(MaskedFrame(0x01, "a") + MaskedFrame(0x81, "b"), agri::kWebSocketCloseProtocolError);
+    expectError(MaskedFrame(0x09, "ping"), agri::kWebSocketCloseProtocolError);
+    expectError(MaskedFrame(0x83, "?"), agri::kWebSocketCloseProtocolError);
+    expectError(MaskedFrame(0xc1, "rsv1 without deflate"), agri::kWebSocketCloseProtocolError);
+    expectError(MaskedFrame(0x81, std::string(200, 'x')), agri::kWebSocketCloseMessageTooBig, 128);
+    expectError(MaskedFrame(0x01, std::string(100, 'x')) + MaskedFrame(0x80, std::string(100, 'x')),
+                agri::kWebSocketCloseMessageTooBig, 128);
+}
+
+void TestValidatesUtf8AndCloseCodes() {
+    assert(agri::IsValidUtf8(""));
+    assert(agri::IsValidUtf8("plain ascii text that spans several words"));
+    assert(agri::IsValidUtf8("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x8c\xb1 \xf4\x8f\xbf\xbf"));
+    assert(!agri::IsValidUtf8("\xc0\xaf"));
+    assert(!agri::IsValidUtf8("\xe0\x80\xaf"));
+    assert(!agri::IsValidUtf8("\xed\xa0\x80"));
+    assert(!agri::IsValidUtf8("\xf4\x90\x80\x80"));
+    assert(!agri::IsValidUtf8("abcdefgh\xce"));
+    assert(!agri::IsValidUtf8("\xe2\x82"));
+    assert(!agri::IsValidUtf8("\x80"));
+    assert(!agri::IsValidUtf8("0123456789\xff"));
+
+    assert(agri::IsValidWebSocketCloseCode(agri::kWebSocketCloseNormal));
+    assert(agri::IsValidWebSocketCloseCode(1011));
+    assert(agri::IsValidWebSocketCloseCode(4000));
+    assert(!agri::IsValidWebSocketCloseCode(999));
+    assert(!agri::IsValidWebSocketCloseCode(1004));
+    assert(!agri::IsValidWebSocketCloseCode(1005));
+    assert(!agri::IsValidWebSocketCloseCode(1006));
+    assert(!agri::IsValidWebSocketCloseCode(1015));
+    assert(!agri::IsValidWebSocketCloseCode(2000));
+    assert(!agri::IsValidWebSocketCloseCode(5000));
+}
+
+void TestDeflateRoundTrip() {
+    if (!agri::PerMessageDeflateAvailable()) {
+        assert(!agri::NegotiatePerMessageDeflate("permessage-deflate").has_value());
+        return;
+    }
+
+    std::string payload;
+    for (int i = 0; i < 50; ++i) {
+        payload += "{\"type\":\"telemetry.ingested\",\"deviceId\":\"gh-1-node-" + std::to_string(i % 3) + "\"}";
+    }
+
+    agri::MessageDeflater deflater;
+    agri::MessageInflater inflater;
+    std::string compressed;
+    assert(deflater.Compress(payload, &compressed));
+    assert(compressed.size() < payload.size() / 4);
+
+    std::string restored;
+    assert(inflater.Decompress(compressed, payload.size(), &restored));
+    assert(restored == payload);
+    assert(!inflater.Decompress(compressed, payload.size() - 1, &restored));
+    assert(!inflater.Decompress("not deflate data", 1024, &restored));
+
+    std::string again;
+    assert(deflater.Compress(payload, &again));
+    assert(again == compressed);
+
+    agri::WebSocketReader reader(1024, true);
+    const std::string frame = MaskedFrame(0xc1, compressed);
+    reader.Append(frame.data(), frame.size());
+    agri::WebSocketInbound inbound;
+    assert(reader.Next(&inbound) == agri::WebSocketReader::Status::kReady);
+    assert(inbound.compressed && inbound.payload == compressed);
+}
+
+void TestNegotiatePerMessageDeflate() {
+    if (!agri::PerMessageDeflateAvailable()) {
+        return;
+    }
+    const std::string accepted = "permessage-deflate; server_no_context_takeover; client_no_context_takeover";
+    assert(agri::NegotiatePerMessageDeflate("permessage-deflate; client_max_window_bits") == accepted);
+    assert(agri::NegotiatePerMessageDeflate("x-webkit-deflate-frame, permessage-deflate") == accepted);
+    assert(agri::NegotiatePerMessageDeflate("permessage-deflate; server_max_window_bits=\"15\"") == accepted);
+    assert(!agri::NegotiatePerMessageDeflate("permessage-deflate; server_max_window_bits=10").has_value());
+    assert(!agri::NegotiatePerMessageDeflate("permessage-deflate; unknown").has_value());
+    assert(!agri::NegotiatePerMessageDeflate("").has_value());
+}
+
+}
+
+int main() {
+    TestEncodeFrameLengths();
+    TestReadsMaskedAndFragmentedMessages();
+    TestRejectsProtocolViolations();
+    TestValidatesUtf8AndCloseCodes();
+    TestDeflateRoundTrip();
+    TestNegotiatePerMessageDeflate();
+    std::cout << "websocket frame tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "api/websocket_subscription.h"
+
+namespace {
+
+std::vector<int> Candidates(const agri::WebSocketSubscriptionIndex& index, const agri::WebSocketEventKeys& keys) {
+    std::vector<int> fds;
+    index.ForEachCandidate(keys, [&fds](int fd) { fds.push_back(fd); });
+    std::sort(fds.begin(), fds.end());
+    return fds;
+}
+
+void TestParsesQueryFilters() {
+    agri::WebSocketSubscription subscription;
+    std::string error;
+    assert(agri::ParseWebSocketSubscription(
+        "deviceId=node-1,node-2&transport=lora&group=greenhouse-3-&deviceId=node-1&batchCode=LOT%2042",
+        &subscription,
+        &error));
+    assert((subscription.deviceIds == std::vector<std::string>{"node-1", "node-2"}));
+    assert((subscription.transports == std::vector<std::string>{"lora"}));
+    assert((subscription.deviceGroups == std::vector<std::string>{"greenhouse-3"}));
+    assert((subscription.batchCodes == std::vector<std::string>{"LOT 42"}));
+
+    agri::WebSocketSubscription empty;
+    assert(agri::ParseWebSocketSubscription("", &empty, &error));
+    assert(empty.Empty());
+
+    agri::WebSocketSubscription unknown;
+    assert(!agri::ParseWebSocketSubscription("room=7", &unknown, &error));
+    assert(error.find("room") != std::string::npos);
+}
+
+void TestParsesSubscribeMessages() {
+    agri::WebSocketSubscription subscription;
+    std::string error;
+    assert(agri::ParseWebSocketSubscribeMessage(
+        " { \"type\" : \"subscribe\", \"deviceId\": [\"n-1\", \"n-2,n-3\"], \"group\": \"gh-2-\" } ",
+        &subscription, &error));
+    assert((subscription.deviceIds == std::vector<std::string>{"n-1", "n-2", "n-3"}));
+    assert((subscription.deviceGroups == std::vector<std::string>{"gh-2"}));
+
+    agri::WebSocketSubscription empty;
+    assert(agri::ParseWebSocketSubscribeMessage("{\"type\":\"subscribe\"}", &empty, &error));
+    assert(empty.Empty());
+
+    agri::WebSocketSubscription rejected;
+    assert(!agri::ParseWebSocketSubscribeMessage("{\"deviceId\":\"n-1\"}", &rejected, &error));
+    assert(error == "control message type is required");
+    assert(!agri::ParseWebSocketSubscribeMessage("{\"type\":\"unsubscribe\"}", &rejected, &error));
+    assert(!agri::ParseWebSocketSubscribeMessage("{\"type\":\"subscribe\",\"room\":\"1\"}", &rejected, &error));
+    assert(error == "unknown subscription filter: room");
+    assert(!agri::ParseWebSocketSubscribeMessage("{\"type\":\"subscribe\",\"deviceId\":1}", &rejected, &error));
+    assert(!agri::ParseWebSocketSubscribeMessage("{\"type\":\"subscribe\"} x", &rejected, &error));
+}
+
+void TestMatchesAcrossDimensions() {
+    agri::WebSocketSubscription subscription;
+    subscription.deviceGroups = {"greenhouse-3"};
+    subscription.transports = {"lora"};
+
+    assert(subscription.Matches({"greenhouse-3-node-7", "", "lora"}));
+    assert(subscription.Matches({"greenhouse-3", "", "lora"}));
+    assert(!subscription.Matches({"greenhouse-3-node-7", "", "wifi"}));
+    assert(!subscription.Matches({"greenhouse-30-node-1", "", "lora"}));
+    assert(!subscription.Matches({"field-1", "", "lora"}));
+
+    assert(agri::DeviceInGroup("a-b-c", "a-b"));
+    assert(!agri::DeviceInGroup("a-bc", "a-b"));
+}
+
+void TestIndexReturnsOnlyCandidates() {
+    agri::WebSocketSubscriptionIndex index;
+
+    agri::WebSocketSubscription everything;
+    agri::WebSocketSubscription node1;
+    node1.deviceIds = {"gh-1-node-1"};
+    node1.transports = {"wifi"};
+    agri::WebSocketSubscription batch;
+    batch.batchCodes = {"LOT-42"};
+    agri::WebSocketSubscription groups;
+    groups.deviceGroups = {"gh-1", "gh-1-node", "gh-2"};
+    agri::WebSocketSubscription lora;
+    lora.transports = {"lora"};
+
+    index.Add(1, everything);
+    index.Add(2, node1);
+    index.Add(3, batch);
+    index.Add(4, groups);
+    index.Add(5, lora);
+    assert(index.Size() == 5);
+
+    assert((Candidates(index, {"gh-1-node-1", "", "lora"}) == std::vector<int>{1, 2, 4, 5}));
+    assert((Candidates(index, {"gh-2-node-9", "LOT-42", "wifi"}) == std::vector<int>{1, 3, 4}));
+    assert((Candidates(index, {"field-7", "", "wifi"}) == std::vector<int>{1}));
+
+    index.Remove(4, groups);
+    index.Remove(1, everything);
+    assert(index.Size() == 3);
+    assert((Candidates(index, {"gh-1-node-1", "", "lora"}) == std::vector<int>{2, 5}));
+}
+
+}
+
+int main() {
+    TestParsesQueryFilters();
+    TestParsesSubscribeMessages();
+    TestMatchesAcrossDimensions();
+    TestIndexReturnsOnlyCandidates();
+    std::cout << "websocket subscription tests passed" << std::endl;
+    return 0;
+}
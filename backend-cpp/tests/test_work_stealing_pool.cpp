@@ -0,0 +1,86 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include "utils/work_stealing_pool.h"
+
+namespace {
+
+void TestRunsAllSubmittedTasks() {
+    agri::WorkStealingPool pool(4);
+    std::atomic<int> completed{0};
+
+    for (int i = 0; i < 1000; ++i) {
+        pool.Submit([&completed] { completed.fetch_add(1); });
+    }
+    pool.WaitIdle();
+    assert(completed.load() == 1000);
+}
+
+void TestTasksSubmittedFromWorkersAreStolen() {
+    agri::WorkStealingPool pool(4);
+    std::atomic<int> completed{0};
+
+    pool.Submit([&pool, &completed] {
+        for (int i = 0; i < 64; ++i) {
+            pool.Submit([&completed] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                completed.fetch_add(1);
+            });
+        }
+    });
+    pool.WaitIdle();
+    assert(completed.load() == 64);
+    assert(pool.StolenTaskCount() > 0);
+}
+
+void TestDestructorDrainsQueuedTasks() {
+    std::atomic<int> completed{0};
+    {
+        agri::WorkStealingPool pool(2);
+        for (int i = 0; i < 100; ++i) {
+            pool.Submit([&completed] { completed.fetch_add(1); });
+        }
+    }
+    assert(completed.load() == 100);
+}
+
+void TestThrowingTasksAreCountedAndDoNotStopWorkers() {
+    agri::WorkStealingPool pool(2);
+    std::atomic<int> completed{0};
+
+    for (int i = 0; i < 10; ++i) {
+        pool.Submit([] { throw std::runtime_error("task failed"); });
+        pool.Submit([&completed] { completed.fetch_add(1); });
+    }
+    pool.WaitIdle();
+    assert(completed.load() == 10);
+    assert(pool.FailedTaskCount() == 10);
+}
+
+void TestWaitIdleAfterWorkersPark() {
+    agri::WorkStealingPool pool(4);
+    std::atomic<int> completed{0};
+
+    for (int round = 0; round < 50; ++round) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        pool.Submit([&completed] { completed.fetch_add(1); });
+        pool.WaitIdle();
+        assert(completed.load() == round + 1);
+    }
+}
+
+}
+
+int main() {
+    TestRunsAllSubmittedTasks();
+    TestTasksSubmittedFromWorkersAreStolen();
+    TestDestructorDrainsQueuedTasks();
+    TestThrowingTasksAreCountedAndDoNotStopWorkers();
+    TestWaitIdleAfterWorkersPark();
+    std::cout << "test_work_stealing_pool passed" << std::endl;
+    return 0;
+}